@@ -26,6 +26,12 @@
 #include <sys/types.h>
 #include <dirent.h>
 #endif
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 #include "core/Backend.hpp"
 #include <MNN/Interpreter.hpp>
@@ -115,8 +121,59 @@ static inline uint64_t getTimeInUs() {
     return time;
 }
 
+/**
+ Count dTLB load misses of the calling thread by perf event, only on Linux. The workers of thread pool are not
+ counted, use 1 thread to count the whole inference.
+ */
+class TLBMissCounter {
+public:
+    TLBMissCounter() {
+#if defined(__linux__)
+        struct perf_event_attr attr;
+        ::memset(&attr, 0, sizeof(attr));
+        attr.type           = PERF_TYPE_HW_CACHE;
+        attr.size           = sizeof(attr);
+        attr.config         = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        attr.disabled       = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv     = 1;
+        mFd = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+    }
+    ~TLBMissCounter() {
+#if defined(__linux__)
+        if (mFd >= 0) {
+            close(mFd);
+        }
+#endif
+    }
+    bool valid() const {
+        return mFd >= 0;
+    }
+    void begin() {
+#if defined(__linux__)
+        ioctl(mFd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(mFd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+    int64_t end() {
+        int64_t count = 0;
+#if defined(__linux__)
+        ioctl(mFd, PERF_EVENT_IOC_DISABLE, 0);
+        if (sizeof(count) != read(mFd, &count, sizeof(count))) {
+            count = -1;
+        }
+#endif
+        return count;
+    }
+
+private:
+    int mFd = -1;
+};
+
 std::vector<float> doBench(Model& model, int loop, int warmup = 10, int forward = MNN_FORWARD_CPU, bool only_inference = true,
-                           int numberThread = 4, int precision = 2, float sparsity = 0.0f, int sparseBlockOC = 1) {
+                           int numberThread = 4, int precision = 2, float sparsity = 0.0f, int sparseBlockOC = 1,
+                           bool hugePage = false, float* tlbMisses = nullptr) {
     auto revertor = std::unique_ptr<Revert>(new Revert(model.model_file.c_str()));
     revertor->initialize(sparsity, sparseBlockOC);
     auto modelBuffer      = revertor->getBuffer();
@@ -130,6 +187,7 @@ std::vector<float> doBench(Model& model, int loop, int warmup = 10, int forward
     MNN::BackendConfig backendConfig;
     backendConfig.precision = (MNN::BackendConfig::PrecisionMode)precision;
     backendConfig.power = MNN::BackendConfig::Power_High;
+    backendConfig.hugePage = hugePage;
     config.backendConfig = &backendConfig;
 
     std::vector<float> costs;
@@ -161,6 +219,10 @@ std::vector<float> doBench(Model& model, int loop, int warmup = 10, int forward
         outputTensor->unmap(MNN::Tensor::MAP_TENSOR_READ,  outputTensor->getDimensionType(), host);
     }
 
+    TLBMissCounter counter;
+    if (counter.valid()) {
+        counter.begin();
+    }
     for (int round = 0; round < loop; round++) {
         auto timeBegin = getTimeInUs();
         void* host = input->map(MNN::Tensor::MAP_TENSOR_WRITE,  input->getDimensionType());
@@ -171,6 +233,9 @@ std::vector<float> doBench(Model& model, int loop, int warmup = 10, int forward
         auto timeEnd = getTimeInUs();
         costs.push_back((timeEnd - timeBegin) / 1000.0);
     }
+    if (nullptr != tlbMisses) {
+        *tlbMisses = counter.valid() && loop > 0 ? (float)counter.end() / (float)loop : -1.0f;
+    }
     return costs;
 }
 
@@ -381,8 +446,10 @@ int main(int argc, const char* argv[]) {
     int precision = 2;
     float sparsity = 0.0f;
     int sparseBlockOC = 1;
+    // 0: default memory, 1: huge page, 2: compare both with dTLB load misses
+    int hugePage = 0;
     if (argc <= 2) {
-        std::cout << "Usage: " << argv[0] << " models_folder [loop_count] [warmup] [forwardtype] [numberThread] [precision] [weightSparsity]" << std::endl;
+        std::cout << "Usage: " << argv[0] << " models_folder [loop_count] [warmup] [forwardtype] [numberThread] [precision] [weightSparsity] [sparseBlockOC] [hugePage]" << std::endl;
         return 1;
     }
     if (argc >= 3) {
@@ -410,7 +477,11 @@ int main(int argc, const char* argv[]) {
         sparseBlockOC = atoi(argv[8]);
     }
 
-    std::cout << "Forward type: **" << forwardType(forward) << "** thread=" << numberThread << "** precision=" <<precision << "** sparsity=" <<sparsity << "** sparseBlockOC=" << sparseBlockOC << std::endl;
+    if(argc >= 10) {
+        hugePage = atoi(argv[9]);
+    }
+
+    std::cout << "Forward type: **" << forwardType(forward) << "** thread=" << numberThread << "** precision=" <<precision << "** sparsity=" <<sparsity << "** sparseBlockOC=" << sparseBlockOC << "** hugePage=" << hugePage << std::endl;
     std::vector<Model> models = findModelFiles(argv[1]);
 
     std::cout << "--------> Benchmarking... loop = " << argv[2] << ", warmup = " << warmup << std::endl;
@@ -419,8 +490,21 @@ int main(int argc, const char* argv[]) {
     // set_cpu_affinity();
 
     for (auto& m : models) {
-        std::vector<float> costs = doBench(m, loop, warmup, forward, false, numberThread, precision, sparsity, sparseBlockOC);
-        displayStats(m.name, costs);
+        if (hugePage != 2) {
+            std::vector<float> costs = doBench(m, loop, warmup, forward, false, numberThread, precision, sparsity, sparseBlockOC, hugePage == 1);
+            displayStats(m.name, costs);
+            continue;
+        }
+        float tlbMisses[2];
+        for (int i = 0; i < 2; ++i) {
+            std::vector<float> costs = doBench(m, loop, warmup, forward, false, numberThread, precision, sparsity, sparseBlockOC, i == 1, tlbMisses + i);
+            displayStats(m.name + (i == 1 ? " [huge page]" : ""), costs);
+        }
+        if (tlbMisses[0] >= 0.0f && tlbMisses[1] >= 0.0f) {
+            printf("[ - ] %-24s    dTLB load misses per inference: default = %.0f  huge page = %.0f\n", m.name.c_str(), tlbMisses[0], tlbMisses[1]);
+        } else {
+            printf("[ - ] %-24s    dTLB load misses are not available\n", m.name.c_str());
+        }
     }
 }
 #endif
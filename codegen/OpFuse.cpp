@@ -11,6 +11,8 @@
 #include "SourceModule.hpp"
 #include "opencl/OpenCLTarget.hpp"
 #include "metal/MetalTarget.hpp"
+#include "cpu/CPUTarget.hpp"
+#include "backend/cpu/CPUFuse.hpp"
 #include <queue>
 #include <unordered_map>
 
@@ -58,14 +60,45 @@ static void dumpCmd(const Command* cmd) {
     MNN_PRINT("}\n");
 }
 
+#ifdef MNN_CODEGEN_CPU
+// The cpu kernel computes the linear buffers, so the inputs must be scalar or have the layout of the output
+static bool isLegalForCPU(const Command* cmd) {
+    if (!CPUTarget::support(cmd->op) || cmd->outputs.size() != 1) {
+        return false;
+    }
+    auto output = cmd->outputs[0];
+    if (output->getType() != halide_type_of<float>() || output->elementSize() <= 1) {
+        return false;
+    }
+    auto format = TensorUtils::getDescribe(output)->dimensionFormat;
+    for (auto t : cmd->inputs) {
+        if (t->getType() != halide_type_of<float>()) {
+            return false;
+        }
+        if (t->elementSize() == 1) {
+            continue;
+        }
+        if (t->shape() != output->shape() || TensorUtils::getDescribe(t)->dimensionFormat != format) {
+            return false;
+        }
+    }
+    return true;
+}
+#endif
+
 // is legal fused type
-bool isLegal(const Command* cmd) {
+bool isLegal(const Command* cmd, MNNForwardType forwardType) {
     auto type = cmd->op->type();
     bool elemWise = type == OpType_BinaryOp
            || type == OpType_UnaryOp
            || type == OpType_ReLU
            || type == OpType_ReLU6
            || type == OpType_Eltwise;
+#ifdef MNN_CODEGEN_CPU
+    if (forwardType == MNN_FORWARD_CPU || forwardType == MNN_FORWARD_CPU_EXTENSION) {
+        return elemWise && isLegalForCPU(cmd);
+    }
+#endif
     if (elemWise) {
         for (auto t : cmd->inputs) {
             if (t->width() * UP_DIV(t->channel(), 4) > 16384) {
@@ -109,14 +142,14 @@ Node* LCA(Node* x, Node* y) {
     }
     return x;
 }
-bool allPathLegal(Node* s, Node* t) {
+bool allPathLegal(Node* s, Node* t, MNNForwardType type) {
     bool legal = true;
     std::queue<Node*> q;
     q.push(s);
     while (!q.empty()) {
         auto node = q.front();
         q.pop();
-        legal &= isLegal(node->cmd);
+        legal &= isLegal(node->cmd, type);
         for (auto succ : node->succ) {
             if (succ != t) {
                 q.push(succ);
@@ -125,7 +158,16 @@ bool allPathLegal(Node* s, Node* t) {
     }
     return legal;
 }
-std::vector<Node*> fuseNode(Node* root, std::vector<Node*>& edges) {
+// The outputs of the fused nodes except root are not computed, so they can't be used out of the set
+static bool isOutput(const Command* cmd) {
+    for (auto t : cmd->outputs) {
+        if (TensorUtils::getDescribe(t)->usage == Tensor::InsideDescribe::OUTPUT) {
+            return true;
+        }
+    }
+    return false;
+}
+std::vector<Node*> fuseNode(Node* root, std::vector<Node*>& edges, MNNForwardType type) {
     std::vector<Node*> fuseSet;
     std::queue<Node*> q;
     q.push(root);
@@ -134,7 +176,7 @@ std::vector<Node*> fuseNode(Node* root, std::vector<Node*>& edges) {
         fuseSet.insert(fuseSet.begin(), node);
         q.pop();
         for (auto child : node->domainateSucc) {
-            if (isLegal(child->cmd) && allPathLegal(child, root)) {
+            if (isLegal(child->cmd, type) && !isOutput(child->cmd) && allPathLegal(child, root, type)) {
                 q.push(child);
             } else {
                 edges.push_back(child);
@@ -157,6 +199,12 @@ bool codegen(std::vector<Schedule::OpCacheInfo>& infos, std::vector<std::vector<
         case MNN_FORWARD_METAL:
             target.reset(new MetalTarget);
             break;
+#endif
+#ifdef MNN_CODEGEN_CPU
+        case MNN_FORWARD_CPU:
+        case MNN_FORWARD_CPU_EXTENSION:
+            target.reset(new CPUTarget);
+            break;
 #endif
         default:
             return false;
@@ -181,6 +229,13 @@ bool codegen(std::vector<Schedule::OpCacheInfo>& infos, std::vector<std::vector<
         SharedPtr<Command> cmdPlugin;
         {
             auto sourceCode = fuseModule.codegen();
+#ifdef MNN_CODEGEN_CPU
+            // Keep the origin commands if the kernel can't be compiled
+            if ((type == MNN_FORWARD_CPU || type == MNN_FORWARD_CPU_EXTENSION) &&
+                nullptr == CPUFuse::load(sourceCode, fuseModule.kernelName())) {
+                continue;
+            }
+#endif
             std::unique_ptr<OpT> fuseOp(new OpT);
             fuseOp->type = OpType_Extra;
             fuseOp->name = fuseModule.opName();
@@ -289,8 +344,8 @@ bool opFuse(std::vector<Schedule::OpCacheInfo>& infos, MNNForwardType type) {
             continue;
         }
         std::vector<Node*> childs;
-        if (isLegal(root->cmd)) {
-            auto fuseSet = fuseNode(root, childs);
+        if (isLegal(root->cmd, type)) {
+            auto fuseSet = fuseNode(root, childs, type);
             if (fuseSet.size() > 1) {
                 fuseSets.emplace_back(std::move(fuseSet));
             }
@@ -5,6 +5,7 @@
 //  Created by MNN on 2022/11/14.
 //  Copyright © 2018, Alibaba Group Holding Limited
 //
+#include <map>
 #include <vector>
 #include <utility>
 #include <unordered_map>
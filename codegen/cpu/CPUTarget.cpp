@@ -0,0 +1,330 @@
+//
+//  CPUTarget.cpp
+//  MNN
+//
+//  Created by MNN on 2023/02/20.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <cmath>
+#include <string>
+#include <vector>
+#include <sstream>
+
+#include "MNN_generated.h"
+#include "CPUTarget.hpp"
+
+namespace MNN {
+static const char* unaryFunction(UnaryOpOperation type) {
+    switch (type) {
+        case UnaryOpOperation_ABS:
+            return "fabsf";
+        case UnaryOpOperation_FLOOR:
+            return "floorf";
+        case UnaryOpOperation_CEIL:
+            return "ceilf";
+        case UnaryOpOperation_SQRT:
+            return "sqrtf";
+        case UnaryOpOperation_EXP:
+            return "expf";
+        case UnaryOpOperation_LOG:
+            return "logf";
+        case UnaryOpOperation_SIN:
+            return "sinf";
+        case UnaryOpOperation_COS:
+            return "cosf";
+        case UnaryOpOperation_TAN:
+            return "tanf";
+        case UnaryOpOperation_ASIN:
+            return "asinf";
+        case UnaryOpOperation_ACOS:
+            return "acosf";
+        case UnaryOpOperation_ATAN:
+            return "atanf";
+        case UnaryOpOperation_LOG1P:
+            return "log1pf";
+        case UnaryOpOperation_ACOSH:
+            return "acoshf";
+        case UnaryOpOperation_SINH:
+            return "sinhf";
+        case UnaryOpOperation_ASINH:
+            return "asinhf";
+        case UnaryOpOperation_ATANH:
+            return "atanhf";
+        case UnaryOpOperation_ROUND:
+            return "roundf";
+        case UnaryOpOperation_COSH:
+            return "coshf";
+        case UnaryOpOperation_ERF:
+            return "erff";
+        case UnaryOpOperation_ERFC:
+            return "erfcf";
+        case UnaryOpOperation_EXPM1:
+            return "expm1f";
+        case UnaryOpOperation_TANH:
+            return "tanhf";
+        default:
+            return nullptr;
+    }
+}
+
+bool CPUTarget::support(const Op* op) {
+    switch (op->type()) {
+        case OpType_BinaryOp:
+        {
+            auto binary = op->main_as_BinaryOp();
+            if (binary->activationType() != 0 && binary->activationType() != 1) {
+                return false;
+            }
+            switch (binary->opType()) {
+                case BinaryOpOperation_ADD:
+                case BinaryOpOperation_SUB:
+                case BinaryOpOperation_MUL:
+                case BinaryOpOperation_DIV:
+                case BinaryOpOperation_REALDIV:
+                case BinaryOpOperation_MAXIMUM:
+                case BinaryOpOperation_MINIMUM:
+                case BinaryOpOperation_POW:
+                case BinaryOpOperation_SquaredDifference:
+                    return true;
+                default:
+                    return false;
+            }
+        }
+        case OpType_Eltwise:
+        {
+            auto eltwise = op->main_as_Eltwise();
+            if (nullptr != eltwise->coeff()) {
+                for (int i = 0; i < eltwise->coeff()->size(); ++i) {
+                    if (eltwise->coeff()->data()[i] != 1.0f) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+        case OpType_UnaryOp:
+        {
+            auto type = op->main_as_UnaryOp()->opType();
+            switch (type) {
+                case UnaryOpOperation_NEG:
+                case UnaryOpOperation_SQUARE:
+                case UnaryOpOperation_RSQRT:
+                case UnaryOpOperation_RECIPROCAL:
+                case UnaryOpOperation_SIGN:
+                case UnaryOpOperation_SIGMOID:
+                case UnaryOpOperation_HARDSWISH:
+                case UnaryOpOperation_GELU:
+                case UnaryOpOperation_GELU_STANDARD:
+                    return true;
+                default:
+                    return nullptr != unaryFunction(type);
+            }
+        }
+        case OpType_ReLU:
+        case OpType_ReLU6:
+            return true;
+        default:
+            return false;
+    }
+}
+
+std::string CPUTarget::type() {
+    return "float ";
+}
+std::string CPUTarget::macro() {
+    return
+    "#include <math.h>\n"
+    "#define OFFSET_CHECK\n";
+}
+std::string CPUTarget::number(float val) {
+    if (std::isnan(val)) {
+        return "NAN";
+    }
+    if (std::isinf(val)) {
+        return val > 0 ? "INFINITY" : "(-INFINITY)";
+    }
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "((float)%.9g)", val);
+    return buffer;
+}
+std::string CPUTarget::codegen(std::vector<std::string>& inputs, const Op* op) {
+    std::stringstream ss;
+    switch (op->type()) {
+        case MNN::OpType_BinaryOp:
+        {
+            auto lhs = inputs[0], rhs = inputs[1];
+            auto binary = op->main_as_BinaryOp();
+            auto type = static_cast<MNN::BinaryOpOperation>(binary->opType());
+            std::stringstream compute;
+            switch (type) {
+                case BinaryOpOperation_ADD:
+                    compute << "(" << lhs << "+" << rhs << ")";
+                    break;
+                case BinaryOpOperation_SUB:
+                    compute << "(" << lhs << "-" << rhs << ")";
+                    break;
+                case BinaryOpOperation_MUL:
+                    compute << "(" << lhs << "*" << rhs << ")";
+                    break;
+                case BinaryOpOperation_DIV:
+                case BinaryOpOperation_REALDIV:
+                    compute << "(" << lhs << "/" << rhs << ")";
+                    break;
+                case BinaryOpOperation_MAXIMUM:
+                    compute << "fmaxf(" << lhs << "," << rhs << ")";
+                    break;
+                case BinaryOpOperation_MINIMUM:
+                    compute << "fminf(" << lhs << "," << rhs << ")";
+                    break;
+                case BinaryOpOperation_POW:
+                    compute << "powf(" << lhs << "," << rhs << ")";
+                    break;
+                case BinaryOpOperation_SquaredDifference:
+                    compute << "((" << lhs << "-" << rhs << ")*(" << lhs << "-" << rhs << "))";
+                    break;
+                default:
+                    break;
+            }
+            if (binary->activationType() == 1) {
+                ss << "fmaxf(" << compute.str() << "," << number(0.0f) << ")";
+            } else {
+                ss << compute.str();
+            }
+            break;
+        }
+        case MNN::OpType_Eltwise:
+        {
+            auto type = op->main_as_Eltwise()->type();
+            if (type == EltwiseType_MAXIMUM) {
+                std::string result = inputs[0];
+                for (int i = 1; i < inputs.size(); i++) {
+                    result = "fmaxf(" + result + "," + inputs[i] + ")";
+                }
+                ss << result;
+                break;
+            }
+            const char* symbol = "+";
+            if (type == EltwiseType_SUB) {
+                symbol = "-";
+            } else if (type == EltwiseType_PROD) {
+                symbol = "*";
+            }
+            ss << "(" << inputs[0];
+            for (int i = 1; i < inputs.size(); i++) {
+                ss << symbol << inputs[i];
+            }
+            ss << ")";
+            break;
+        }
+        case MNN::OpType_UnaryOp:
+        {
+            auto type = op->main_as_UnaryOp()->opType();
+            auto x = inputs[0];
+            switch (type) {
+                case UnaryOpOperation_NEG:
+                    ss << "(-" << x << ")";
+                    break;
+                case UnaryOpOperation_SQUARE:
+                    ss << "(" << x << "*" << x << ")";
+                    break;
+                case UnaryOpOperation_RSQRT:
+                    ss << "(1.0f/sqrtf(" << x << "))";
+                    break;
+                case UnaryOpOperation_RECIPROCAL:
+                    ss << "(1.0f/" << x << ")";
+                    break;
+                case UnaryOpOperation_SIGN:
+                    ss << "((float)((" << x << ">0.0f)-(" << x << "<0.0f)))";
+                    break;
+                case UnaryOpOperation_SIGMOID:
+                    ss << "(1.0f/(1.0f+expf(-" << x << ")))";
+                    break;
+                case UnaryOpOperation_HARDSWISH:
+                    ss << "(" << x << "*fminf(fmaxf(" << x << "+3.0f,0.0f),6.0f)*(1.0f/6.0f))";
+                    break;
+                case UnaryOpOperation_GELU:
+                    ss << "(0.5f*" << x << "*(1.0f+tanhf(0.7978845608f*(" << x << "+0.044715f*" << x << "*" << x << "*" << x << "))))";
+                    break;
+                case UnaryOpOperation_GELU_STANDARD:
+                    ss << "(0.5f*" << x << "*(1.0f+erff(" << x << "*0.7071067932f)))";
+                    break;
+                default:
+                    ss << unaryFunction(type) << "(" << x << ")";
+                    break;
+            }
+            break;
+        }
+        case MNN::OpType_ReLU6:
+        {
+            auto relu6 = op->main_as_Relu6();
+            float minv = 0.0f, maxv = 6.0f;
+            if (nullptr != relu6) {
+                minv = relu6->minValue();
+                maxv = relu6->maxValue();
+            }
+            ss << "fminf(fmaxf(" << inputs[0] << "," << number(minv) << ")," << number(maxv) << ")";
+            break;
+        }
+        case MNN::OpType_ReLU:
+        {
+            auto x = inputs[0];
+            auto relu = op->main_as_Relu();
+            float slope = nullptr != relu ? relu->slope() : 0.0f;
+            if (slope == 0.0f) {
+                ss << "fmaxf(" << x << "," << number(0.0f) << ")";
+            } else {
+                ss << "(" << x << ">0.0f?" << x << ":" << x << "*" << number(slope) << ")";
+            }
+            break;
+        }
+        default:
+            break;
+    }
+    return ss.str();
+}
+std::string CPUTarget::load(const std::string& base, const std::string& offset) {
+    return base + "[" + offset + "]";
+}
+std::string CPUTarget::loadscalar(const std::string& base) {
+    return base + "[0]";
+}
+std::string CPUTarget::store(const std::string base, const std::string& offset, const std::string& data) {
+    return base + "[" + offset + "] = " + data + ";\n";
+}
+
+std::string CPUTarget::proto(const std::string& name, const std::vector<std::string>& inputs, const std::vector<std::string>& outputs) {
+    // The element function is declared first, so the loop over [start, end) can call it and the compiler vectorizes
+    // the loop after inlining
+    std::stringstream args;
+    for (auto& input : inputs) {
+        args << "const float* " << input << ", ";
+    }
+    for (auto& output : outputs) {
+        args << "float* " << output << ", ";
+    }
+    args << "long offset";
+    std::stringstream proto;
+    proto << "static inline void " << name << "(" << args.str() << ");\n";
+    proto << "void " << name << "_run(float** inputs, float** outputs, long start, long end) {\n";
+    for (int i = 0; i < inputs.size(); ++i) {
+        proto << "    const float* " << inputs[i] << " = inputs[" << i << "];\n";
+    }
+    for (int i = 0; i < outputs.size(); ++i) {
+        proto << "    float* " << outputs[i] << " = outputs[" << i << "];\n";
+    }
+    proto << "    for (long offset = start; offset < end; ++offset) {\n";
+    proto << "        " << name << "(";
+    for (auto& input : inputs) {
+        proto << input << ", ";
+    }
+    for (auto& output : outputs) {
+        proto << output << ", ";
+    }
+    proto << "offset);\n";
+    proto << "    }\n";
+    proto << "}\n";
+    proto << "static inline void " << name << "(" << args.str() << ")";
+    return proto.str();
+}
+} // MNN
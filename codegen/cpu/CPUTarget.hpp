@@ -0,0 +1,29 @@
+//
+//  CPUTarget.hpp
+//  MNN
+//
+//  Created by MNN on 2023/02/20.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+#include "../SourceModule.hpp"
+namespace MNN {
+
+// Generate C for the fused elementwise ops, compiled at runtime and run by CPUFuse
+class CPUTarget : public Target {
+public:
+    CPUTarget() {}
+    ~CPUTarget() {}
+    // Whether the op can be generated by this target
+    static bool support(const MNN::Op* op);
+    std::string codegen(std::vector<std::string>& inputs, const MNN::Op* op) override;
+private:
+    std::string type() override;
+    std::string macro() override;
+    std::string number(float val) override;
+    std::string load(const std::string& base, const std::string& offset) override;
+    std::string loadscalar(const std::string& base) override;
+    std::string store(const std::string base, const std::string& offset, const std::string& data) override;
+    std::string proto(const std::string& name, const std::vector<std::string>& inputs, const std::vector<std::string>& outputs) override;
+};
+
+}
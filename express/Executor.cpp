@@ -271,6 +271,18 @@ void Executor::RuntimeManager::setHint(Interpreter::HintMode mode, int value) {
         case Interpreter::STRICT_CHECK_MODEL:
             mInside->checkNetBuffer = value > 0;
             break;
+        case Interpreter::MEMORY_PLAN:
+            mInside->modes.memoryPlan = value > 0;
+            break;
+        case Interpreter::TRACE:
+            mInside->modes.trace->store(value > 0);
+            break;
+        case Interpreter::INTER_OP_PARALLEL:
+            mInside->modes.interOpParallel = value > 0;
+            break;
+        case Interpreter::RESIZE_CACHE_SIZE:
+            mInside->modes.resizeCacheSize = value;
+            break;
         default:
             break;
     }
@@ -295,6 +307,13 @@ bool Executor::RuntimeManager::getInfo(Interpreter::SessionInfoCode code, void*
                 *dst = mInside->mRuntime.first.begin()->first;
             }
         } break;
+        case Interpreter::RESIZE_CACHE: {
+            // Sum of the modules loaded by this RuntimeManager
+            auto dst = (int*)ptr;
+            dst[0]   = mInside->modes.resizeCacheInfo->hit.load();
+            dst[1]   = mInside->modes.resizeCacheInfo->miss.load();
+            return true;
+        } break;
         default: {
             // Do nothing
         } break;
@@ -308,6 +327,7 @@ Executor::RuntimeManager::RuntimeManager() {
     mInside->modes.callBackMode = Interpreter::Session_Release;
     mInside->modes.inputMode = Interpreter::Session_Input_User;
     mInside->modes.outputMode = Interpreter::Session_Output_User;
+    mInside->modes.resizeCacheInfo.reset(new Session::ResizeCacheInfo);
 }
 Executor::RuntimeManager::~RuntimeManager() {
     delete mInside;
@@ -372,9 +392,12 @@ void Executor::RuntimeManager::setCache(std::string cacheName) {
         MNN_ERROR("Empty cacheFile\n");
         return;
     }
+    mInside->mInfo->onSetCacheRecord(true);
     std::unique_ptr<FileLoader> loader(new FileLoader(mInside->mCache->cacheFile.c_str()));
     if (!loader->valid()) {
         MNN_ERROR("Load Cache file error.\n");
+        // Reset cache, so that the runtime record cache for updateCache
+        loadCache(mInside->mInfo, nullptr, 0);
         return;
     }
     bool result = loader->read();
@@ -413,6 +436,7 @@ void Executor::RuntimeManager::updateCache() {
 
     // Backend_Auto and no Async work, then don't need updateCache
     if(mInside->modes.backendMode == Interpreter::Session_Backend_Auto && !(mInside->mInfo->hasAsyncWork())) {
+        mInside->mInfo->onSetCacheRecord(false);
         return;
     }
 
@@ -429,6 +453,7 @@ void Executor::RuntimeManager::updateCache() {
     }
     // Reset cache
     loadCache(mInside->mInfo, nullptr, 0);
+    mInside->mInfo->onSetCacheRecord(false);
 }
 
 std::vector<bool> Executor::RuntimeManager::isBackendSupport(const std::vector<MNNForwardType> types) {
@@ -1710,6 +1710,19 @@ VARP _GridSample(VARP input, VARP grid, InterpolationMethod mode, GridSamplePadd
     return (Variable::create(Expr::create(std::move(op), {input, grid})));
 }
 
+VARP _Attention(VARP query, VARP key, VARP value, VARP mask, float scale, bool keyTransposed) {
+    std::unique_ptr<OpT> op(new OpT);
+    op->type       = OpType_Attention;
+    op->main.type  = OpParameter_AttentionParam;
+    op->main.value = new AttentionParamT;
+    op->main.AsAttentionParam()->scale         = scale;
+    op->main.AsAttentionParam()->keyTransposed = keyTransposed;
+    if (nullptr == mask) {
+        return (Variable::create(Expr::create(std::move(op), {query, key, value})));
+    }
+    return (Variable::create(Expr::create(std::move(op), {query, key, value, mask})));
+}
+
 VARP _FloatToInt8(VARP x, VARP scale, char minValue/*For future*/, char maxValue/*For future*/) {
     auto xInfo = x->getInfo();
     auto scaleInfo = scale->getInfo();
@@ -0,0 +1,223 @@
+//
+//  BatchModule.cpp
+//  MNN
+//
+//  Created by MNN on 2021/12/13.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include "BatchModule.hpp"
+#include <string.h>
+#include <chrono>
+#include <MNN/expr/ExprCreator.hpp>
+
+namespace MNN {
+namespace Express {
+
+// Copy [offset, offset + batch) of dimension 0 to a new variable, which doesn't depend on src
+static VARP _copyBatch(VARP src, int offset, int batch) {
+    auto info = src->getInfo();
+    if (nullptr == info) {
+        return nullptr;
+    }
+    if (info->order == NC4HW4) {
+        src  = _Convert(src, NCHW);
+        info = src->getInfo();
+    }
+    auto dims = info->dim;
+    if (dims.empty() || dims[0] <= 0) {
+        return nullptr;
+    }
+    size_t batchBytes = (size_t)(info->size / dims[0]) * info->type.bytes();
+    dims[0]  = batch;
+    auto dst = _Input(dims, info->order, info->type);
+    auto srcPtr = src->readMap<uint8_t>();
+    auto dstPtr = dst->writeMap<uint8_t>();
+    if (nullptr == srcPtr || nullptr == dstPtr) {
+        return nullptr;
+    }
+    ::memcpy(dstPtr, srcPtr + offset * batchBytes, batch * batchBytes);
+    return dst;
+}
+
+BatchModule::BatchModule(std::shared_ptr<Module> module, const BatchConfig& config) {
+    mModule = module;
+    mConfig = config;
+    mConfig.maxBatch = std::max(1, mConfig.maxBatch);
+    setType("BatchModule");
+    setName(module->name());
+    registerModel({module});
+}
+
+bool BatchModule::_canMerge(const Request* first, const Request* other) {
+    if (first->batch <= 0 || other->batch <= 0 || first->inputs.size() != other->inputs.size()) {
+        return false;
+    }
+    for (int i = 0; i < first->inputs.size(); ++i) {
+        auto infoF = first->inputs[i]->getInfo();
+        auto infoO = other->inputs[i]->getInfo();
+        if (infoF->order != infoO->order || infoF->type != infoO->type || infoF->dim.size() != infoO->dim.size()) {
+            return false;
+        }
+        for (int d = 1; d < infoF->dim.size(); ++d) {
+            if (infoF->dim[d] != infoO->dim[d]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+std::vector<BatchModule::Request*> BatchModule::_takeRequests() {
+    std::vector<Request*> result;
+    int batch = 0;
+    auto first = mRequests.front();
+    for (auto iter = mRequests.begin(); iter != mRequests.end();) {
+        auto request = *iter;
+        if (request != first && (batch + request->batch > mConfig.maxBatch || !_canMerge(first, request))) {
+            iter++;
+            continue;
+        }
+        batch += request->batch;
+        result.emplace_back(request);
+        iter = mRequests.erase(iter);
+        if (batch >= mConfig.maxBatch) {
+            break;
+        }
+    }
+    return result;
+}
+
+void BatchModule::_execute(const std::vector<Request*>& requests) {
+    auto runSingle = [this](Request* request) {
+        auto outputs = mModule->onForward(request->inputs);
+        request->outputs.resize(outputs.size());
+        for (int i = 0; i < outputs.size(); ++i) {
+            auto info = outputs[i]->getInfo();
+            if (nullptr == info || info->dim.empty()) {
+                // Can't copy by batch, compute it for the caller
+                outputs[i].fix(VARP::CONSTANT);
+                request->outputs[i] = outputs[i];
+                continue;
+            }
+            // The outputs may share memory with the module, copy it before next forward
+            request->outputs[i] = _copyBatch(outputs[i], 0, info->dim[0]);
+        }
+    };
+    if (requests.size() == 1) {
+        runSingle(requests[0]);
+        return;
+    }
+    int totalBatch = 0;
+    for (auto request : requests) {
+        totalBatch += request->batch;
+    }
+    std::vector<VARP> inputs(requests[0]->inputs.size());
+    for (int i = 0; i < inputs.size(); ++i) {
+        auto info = requests[0]->inputs[i]->getInfo();
+        auto dims = info->dim;
+        dims[0]   = totalBatch;
+        inputs[i] = _Input(dims, info->order, info->type);
+        auto dstPtr = inputs[i]->writeMap<uint8_t>();
+        size_t batchBytes = (size_t)(info->size / info->dim[0]) * info->type.bytes();
+        for (auto request : requests) {
+            ::memcpy(dstPtr, request->inputs[i]->readMap<uint8_t>(), request->batch * batchBytes);
+            dstPtr += request->batch * batchBytes;
+        }
+    }
+    auto outputs = mModule->onForward(inputs);
+    bool batchValid = !outputs.empty();
+    for (auto& output : outputs) {
+        auto info = output->getInfo();
+        if (nullptr == info || info->dim.empty() || info->dim[0] != totalBatch) {
+            batchValid = false;
+            break;
+        }
+    }
+    if (!batchValid) {
+        // The outputs can't be split by batch, compute requests one by one
+        for (auto request : requests) {
+            runSingle(request);
+        }
+        return;
+    }
+    int offset = 0;
+    for (auto request : requests) {
+        request->outputs.resize(outputs.size());
+        for (int i = 0; i < outputs.size(); ++i) {
+            request->outputs[i] = _copyBatch(outputs[i], offset, request->batch);
+        }
+        offset += request->batch;
+    }
+}
+
+std::vector<Express::VARP> BatchModule::onForward(const std::vector<Express::VARP>& inputs) {
+    Request request;
+    request.inputs = inputs;
+    request.batch  = 0;
+    bool inputValid = !inputs.empty();
+    for (auto& input : inputs) {
+        auto info = input->getInfo();
+        if (nullptr == info || info->dim.empty() || info->order == NC4HW4) {
+            inputValid = false;
+            break;
+        }
+    }
+    if (inputValid) {
+        request.batch = inputs[0]->getInfo()->dim[0];
+        for (auto& input : inputs) {
+            if (input->getInfo()->dim[0] != request.batch) {
+                // Can't merge, run alone
+                request.batch = 0;
+                break;
+            }
+        }
+    }
+    std::unique_lock<std::mutex> _l(mLock);
+    mRequests.emplace_back(&request);
+    mCondition.notify_all();
+    while (!request.done) {
+        if (mHasLeader) {
+            mCondition.wait(_l);
+            continue;
+        }
+        mHasLeader = true;
+        // Wait for more requests until the batch is full or timeout
+        auto timeEnd = std::chrono::steady_clock::now() + std::chrono::microseconds(mConfig.maxWaitUs);
+        while (true) {
+            auto first = mRequests.front();
+            int batch  = 0;
+            for (auto r : mRequests) {
+                if (r == first || _canMerge(first, r)) {
+                    batch += r->batch;
+                }
+            }
+            if (first->batch <= 0 || batch >= mConfig.maxBatch) {
+                break;
+            }
+            if (mCondition.wait_until(_l, timeEnd) == std::cv_status::timeout) {
+                break;
+            }
+        }
+        auto requests = _takeRequests();
+        _l.unlock();
+        _execute(requests);
+        _l.lock();
+        for (auto r : requests) {
+            r->done = true;
+        }
+        mHasLeader = false;
+        mCondition.notify_all();
+    }
+    return request.outputs;
+}
+
+Module* Module::createBatching(std::shared_ptr<Module> module, const BatchConfig& config) {
+    if (nullptr == module) {
+        return nullptr;
+    }
+    return new BatchModule(module, config);
+}
+
+} // namespace Express
+} // namespace MNN
@@ -0,0 +1,49 @@
+//
+//  BatchModule.hpp
+//  MNN
+//
+//  Created by MNN on 2021/12/13.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#ifndef BatchModule_hpp
+#define BatchModule_hpp
+#include <MNN/expr/Module.hpp>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+namespace MNN {
+namespace Express {
+/**
+ Merge onForward calls from multiple threads along dimension 0 and run them as one forward of the origin module.
+ The first waiting caller becomes the leader: it waits at most maxWaitUs for more requests, runs the merged
+ forward and copies each caller's part of the outputs, other callers just wait for the result.
+ */
+class BatchModule : public Module {
+public:
+    BatchModule(std::shared_ptr<Module> module, const BatchConfig& config);
+    virtual ~ BatchModule() = default;
+    virtual std::vector<Express::VARP> onForward(const std::vector<Express::VARP>& inputs) override;
+
+private:
+    struct Request {
+        std::vector<VARP> inputs;
+        std::vector<VARP> outputs;
+        int batch = 0;
+        bool done = false;
+    };
+    // Take requests that can merge with the first one, at most mConfig.maxBatch
+    std::vector<Request*> _takeRequests();
+    void _execute(const std::vector<Request*>& requests);
+    static bool _canMerge(const Request* first, const Request* other);
+
+    std::shared_ptr<Module> mModule;
+    BatchConfig mConfig;
+    std::mutex mLock;
+    std::condition_variable mCondition;
+    std::deque<Request*> mRequests;
+    bool mHasLeader = false;
+};
+} // namespace Express
+} // namespace MNN
+#endif
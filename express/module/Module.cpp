@@ -15,8 +15,11 @@
 #include "MNN_generated.h"
 #include "Utils.hpp"
 #include "RuntimeAttr.hpp"
+#include "core/AsyncQueue.hpp"
 
 #include <MNN/AutoTime.hpp>
+#include <string.h>
+#include <mutex>
 #ifdef MNN_INTERNAL_ENABLED
 #include "internal/auth/ModelAuth.hpp"
 #include "internal/logging/Log.hpp"
@@ -26,7 +29,7 @@
 namespace MNN {
 namespace Express {
 
-static Module* loadInternal(const std::vector<std::string>& inputs, const std::vector<std::string>& outputs, const uint8_t* buffer, size_t length, const std::shared_ptr<MNN::Express::Executor::RuntimeManager> _rtMgr, const Module::Config* config, bool enforceAuth);
+static Module* loadInternal(const std::vector<std::string>& inputs, const std::vector<std::string>& outputs, std::shared_ptr<BufferStorage> bufferStorage, const std::shared_ptr<MNN::Express::Executor::RuntimeManager> _rtMgr, const Module::Config* config, bool enforceAuth);
 
 class EmptyModule : public Module {
 public:
@@ -52,6 +55,9 @@ protected:
 };
 void Module::destroy(Module* m) {
     if (nullptr != m) {
+        if (nullptr != m->mAsyncQueue) {
+            m->mAsyncQueue->wait();
+        }
         delete m;
     }
 }
@@ -63,6 +69,87 @@ Module* Module::createEmpty(const std::vector<Express::VARP>& parameters) {
 Express::VARP Module::forward(Express::VARP input) {
     return this->onForward({input})[0];
 }
+static std::mutex gAsyncQueueLock;
+static std::shared_ptr<AsyncQueue> _getAsyncQueue(std::shared_ptr<AsyncQueue>& queue) {
+    std::lock_guard<std::mutex> _l(gAsyncQueueLock);
+    if (nullptr == queue) {
+        queue.reset(new AsyncQueue);
+    }
+    return queue;
+}
+
+// The outputs may share memory with the module, copy them for the next request
+static bool _copyOutputs(std::vector<VARP>& outputs) {
+    for (auto& var : outputs) {
+        auto source = var;
+        auto info   = source->getInfo();
+        if (nullptr == info) {
+            return false;
+        }
+        bool pack = info->order == NC4HW4;
+        if (pack) {
+            source = _Convert(source, NCHW);
+            info   = source->getInfo();
+        }
+        auto ptr = source->readMap<uint8_t>();
+        if (nullptr == ptr && info->size > 0) {
+            return false;
+        }
+        auto copy = _Input(info->dim, info->order, info->type);
+        if (info->size > 0) {
+            ::memcpy(copy->writeMap<uint8_t>(), ptr, info->size * info->type.bytes());
+        }
+        copy->setName(var->name());
+        var = pack ? _Convert(copy, NC4HW4) : copy;
+    }
+    return true;
+}
+
+void Module::forwardAsync(const std::vector<Express::VARP>& inputs, std::function<void(std::vector<Express::VARP>)> callback) {
+    auto queue    = _getAsyncQueue(mAsyncQueue);
+    auto executor = ExecutorScope::Current();
+    // Hold the inputs until run, then the outputs until finish
+    std::shared_ptr<std::vector<VARP>> outputs(new std::vector<VARP>(inputs));
+    auto run = [this, executor, outputs]() {
+        ExecutorScope scope(executor);
+        // Take the inputs out so that they're released under the executor
+        std::vector<VARP> inputs;
+        inputs.swap(*outputs);
+        *outputs = onForward(inputs);
+        if (!_copyOutputs(*outputs)) {
+            MNN_ERROR("Failed to compute the outputs of module %s\n", mName.c_str());
+            outputs->clear();
+        }
+    };
+    std::function<void()> finish;
+    if (nullptr != callback) {
+        finish = [callback, outputs, executor]() {
+            ExecutorScope scope(executor);
+            callback(std::move(*outputs));
+        };
+    } else {
+        finish = [outputs, executor]() {
+            // Release the outputs under their executor
+            ExecutorScope scope(executor);
+            outputs->clear();
+        };
+    }
+    queue->post(std::move(run), std::move(finish));
+}
+
+std::future<std::vector<Express::VARP>> Module::forwardAsync(const std::vector<Express::VARP>& inputs) {
+    std::shared_ptr<std::promise<std::vector<VARP>>> promise(new std::promise<std::vector<VARP>>);
+    auto future = promise->get_future();
+    forwardAsync(inputs, [promise](std::vector<VARP> outputs) {
+        promise->set_value(std::move(outputs));
+    });
+    return future;
+}
+
+void Module::getAsyncInfo(float* info) {
+    _getAsyncQueue(mAsyncQueue)->getInfo(info);
+}
+
 std::vector<Express::VARP> Module::parameters() const {
     std::vector<Express::VARP> result;
     _collectParameters(result);
@@ -145,6 +232,21 @@ Module* Module::load(const std::vector<std::string>& inputs, const std::vector<s
 }
 
 Module* Module::load(const std::vector<std::string>& inputs, const std::vector<std::string>& outputs, const char* fileName, const std::shared_ptr<MNN::Express::Executor::RuntimeManager> rtMgr, const Module::Config* config) {
+    if (nullptr != config && config->mapFile) {
+        std::shared_ptr<FileLoader> loader(new FileLoader(fileName));
+        if (!loader->valid()) {
+            MNN_ERROR("Error for open %s\n", fileName);
+            return nullptr;
+        }
+        if (loader->map()) {
+            std::shared_ptr<BufferStorage> bufferStorage(new BufferStorage);
+            bufferStorage->storage = loader->mapData();
+            bufferStorage->offset = 0;
+            bufferStorage->allocated_size = loader->size();
+            bufferStorage->mapFile = loader;
+            return loadInternal(inputs, outputs, bufferStorage, rtMgr, config, true);
+        }
+    }
     AutoStorage<uint8_t> buffer;
     {
         FileLoader loader(fileName);
@@ -313,10 +415,17 @@ static void _loadInputs(Module::Info* info, const std::vector<std::string>& inpu
 }
 
 Module* Module::load(const std::vector<std::string>& inputs, const std::vector<std::string>& outputs, const uint8_t* buffer, size_t length, const std::shared_ptr<MNN::Express::Executor::RuntimeManager> _rtMgr, const Module::Config* config) {
-    return loadInternal(inputs, outputs, buffer, length, _rtMgr, config, true);
+    std::shared_ptr<BufferStorage> bufferStorage(new BufferStorage);
+    bufferStorage->storage = new uint8_t[length];
+    ::memcpy(bufferStorage->storage, buffer, length);
+    bufferStorage->offset = 0;
+    bufferStorage->allocated_size = length;
+    return loadInternal(inputs, outputs, bufferStorage, _rtMgr, config, true);
 }
 
-static Module* loadInternal(const std::vector<std::string>& inputs, const std::vector<std::string>& outputs, const uint8_t* buffer, size_t length, const std::shared_ptr<MNN::Express::Executor::RuntimeManager> _rtMgr, const Module::Config* config, bool enforceAuth) {
+static Module* loadInternal(const std::vector<std::string>& inputs, const std::vector<std::string>& outputs, std::shared_ptr<BufferStorage> bufferStorage, const std::shared_ptr<MNN::Express::Executor::RuntimeManager> _rtMgr, const Module::Config* config, bool enforceAuth) {
+    auto buffer = bufferStorage->buffer();
+    auto length = bufferStorage->size();
     // Check if runtime is valid
     if (nullptr != _rtMgr && _rtMgr->getInside()->mRuntime.first.empty()) {
         MNN_ERROR("Invalid runtime\n");
@@ -360,7 +469,7 @@ static Module* loadInternal(const std::vector<std::string>& inputs, const std::v
     if ((!inputs.empty()) && (!outputs.empty())) {
         _loadInputs(info.get(), inputs, net);
         info->runTimeManager = rtMgr;
-        std::shared_ptr<Module> m(PipelineModule::load(inputs, outputs, buffer, length, rtMgr, config));
+        std::shared_ptr<Module> m(PipelineModule::load(inputs, outputs, bufferStorage, rtMgr, config));
         return new NetModule(m, info, net, length, (float)_time.durationInUs() / 1000.0f);
     }
     std::set<int> inputIdx, outputIdx, realInput, realOutput;
@@ -401,7 +510,7 @@ static Module* loadInternal(const std::vector<std::string>& inputs, const std::v
             }
         }
     }
-    std::shared_ptr<Module> m(PipelineModule::load(info->inputNames, info->outputNames, buffer, length, rtMgr, config));
+    std::shared_ptr<Module> m(PipelineModule::load(info->inputNames, info->outputNames, bufferStorage, rtMgr, config));
     _loadInputs(info.get(), info->inputNames, net);
     info->runTimeManager = rtMgr;
     return new NetModule(m, info, net, length, (float)_time.durationInUs() / 1000.0f);
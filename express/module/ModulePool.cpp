@@ -0,0 +1,161 @@
+//
+//  ModulePool.cpp
+//  MNN
+//
+//  Created by MNN on 2021/12/18.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <MNN/expr/Module.hpp>
+#include <MNN/expr/ExecutorScope.hpp>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+namespace MNN {
+namespace Express {
+
+// Run the cloned module under its own executor
+class PoolInstanceModule : public Module {
+public:
+    PoolInstanceModule(std::shared_ptr<Executor> executor, std::shared_ptr<Module> module) {
+        mExecutor = executor;
+        mModule   = module;
+        setType("PoolInstanceModule");
+        setName(module->name());
+    }
+    virtual ~PoolInstanceModule() {
+        ExecutorScope _s(mExecutor);
+        mModule.reset();
+    }
+    virtual std::vector<Express::VARP> onForward(const std::vector<Express::VARP>& inputs) override {
+        ExecutorScope _s(mExecutor);
+        return mModule->onForward(inputs);
+    }
+
+private:
+    std::shared_ptr<Executor> mExecutor;
+    std::shared_ptr<Module> mModule;
+};
+
+struct ModulePool::Inside {
+    enum State {
+        EMPTY = 0,
+        IDLE,
+        BUSY,
+    };
+    struct Slot {
+        std::atomic_int state = {EMPTY};
+        std::shared_ptr<Module> module;
+    };
+    std::shared_ptr<Module> origin;
+    Config config;
+    std::unique_ptr<Slot[]> slots;
+    // Number of slots which are created, slots below it are never EMPTY
+    std::atomic_int created = {0};
+    // Max number of instances, reduced if the module can't be cloned
+    int maxInstance = 0;
+
+    // Slow path: create instance or wait for check in
+    std::mutex lock;
+    std::condition_variable condition;
+    std::atomic_int waiting = {0};
+
+    int tryAcquire(int hint) {
+        int number = created.load();
+        for (int i = 0; i < number; ++i) {
+            int index    = (hint + i) % number;
+            int expected = IDLE;
+            if (slots[index].state.compare_exchange_strong(expected, BUSY)) {
+                return index;
+            }
+        }
+        return -1;
+    }
+    void release(int index) {
+        slots[index].state.store(IDLE);
+        if (waiting.load() > 0) {
+            std::lock_guard<std::mutex> _l(lock);
+            condition.notify_one();
+        }
+    }
+};
+
+ModulePool* ModulePool::create(std::shared_ptr<Module> module, const Config& config) {
+    if (nullptr == module) {
+        return nullptr;
+    }
+    auto pool           = new ModulePool;
+    pool->mInside       = new Inside;
+    auto inside         = pool->mInside;
+    inside->origin      = module;
+    inside->config      = config;
+    inside->maxInstance = std::max(1, config.maxInstance);
+    inside->slots.reset(new Inside::Slot[inside->maxInstance]);
+    return pool;
+}
+
+void ModulePool::destroy(ModulePool* pool) {
+    delete pool;
+}
+
+ModulePool::~ModulePool() {
+    delete mInside;
+}
+
+int ModulePool::size() const {
+    return mInside->created.load();
+}
+
+std::shared_ptr<Module> ModulePool::acquire() {
+    // Each thread starts from the instance it used last time
+    static thread_local int gHint = 0;
+    auto inside = mInside;
+    int index   = inside->tryAcquire(gHint);
+    if (index < 0) {
+        std::unique_lock<std::mutex> _l(inside->lock);
+        inside->waiting++;
+        while (true) {
+            index = inside->tryAcquire(gHint);
+            if (index >= 0) {
+                break;
+            }
+            int number = inside->created.load();
+            if (number < inside->maxInstance) {
+                // The origin is never run, so cloning it doesn't race with the forward of other instances
+                auto executor = Executor::newExecutor(inside->config.type, inside->config.backendConfig, inside->config.numThread);
+                std::shared_ptr<Module> module;
+                {
+                    ExecutorScope _s(executor);
+                    module.reset(Module::clone(inside->origin.get(), true), Module::destroy);
+                }
+                if (nullptr != module) {
+                    auto& slot  = inside->slots[number];
+                    slot.module.reset(new PoolInstanceModule(executor, module));
+                    slot.state.store(Inside::BUSY);
+                    inside->created.store(number + 1);
+                    index = number;
+                    break;
+                }
+                MNN_ERROR("Module %s can't be cloned for pool\n", inside->origin->name().c_str());
+                inside->maxInstance = number;
+            }
+            if (0 == number) {
+                inside->waiting--;
+                return nullptr;
+            }
+            inside->condition.wait(_l);
+        }
+        inside->waiting--;
+    }
+    gHint = index;
+    auto module = inside->slots[index].module;
+    // The slot keeps the instance, the returned pointer only checks it in
+    return std::shared_ptr<Module>(module.get(), [inside, index](Module*) {
+        inside->release(index);
+    });
+}
+
+} // namespace Express
+} // namespace MNN
@@ -558,8 +558,17 @@ static Module* _createSubModule(std::shared_ptr<BufferStorage> bufferStorage, co
 }
 
 Module* PipelineModule::load(const std::vector<std::string>& inputs, const std::vector<std::string>& outputs, const uint8_t* buffer, size_t length, const std::shared_ptr<MNN::Express::Executor::RuntimeManager> rtMgr, const Module::Config* config) {
+    std::shared_ptr<BufferStorage> bufferStorage(new BufferStorage);
+    bufferStorage->storage = new uint8_t[length];
+    ::memcpy(bufferStorage->storage, buffer, length);
+    bufferStorage->offset = 0;
+    bufferStorage->allocated_size = length;
+    return load(inputs, outputs, bufferStorage, rtMgr, config);
+}
+
+Module* PipelineModule::load(const std::vector<std::string>& inputs, const std::vector<std::string>& outputs, std::shared_ptr<BufferStorage> bufferStorage, std::shared_ptr<MNN::Express::Executor::RuntimeManager> rtMgr, const Module::Config* config) {
     // Create Subgraph
-    auto net = GetNet(buffer);
+    auto net = GetNet(bufferStorage->buffer());
     if (nullptr == net->oplists() || nullptr == net->tensorName()) {
         MNN_ERROR("Invalid net, for null oplist or tensorName\n");
         return nullptr;
@@ -568,14 +577,8 @@ Module* PipelineModule::load(const std::vector<std::string>& inputs, const std::
     if (nullptr == config) {
         config = &defaultConfig;
     }
-    auto subGraphs = net->subgraphs();
     std::map<std::string, SubGraph> subGraphMap;
     _createSubGraph(net, rtMgr, config, subGraphMap);
-    std::shared_ptr<BufferStorage> bufferStorage(new BufferStorage);
-    bufferStorage->storage = new uint8_t[length];
-    ::memcpy(bufferStorage->storage, buffer, length);
-    bufferStorage->offset = 0;
-    bufferStorage->allocated_size = length;
     return load(inputs, outputs, bufferStorage, rtMgr, config, subGraphMap);
 }
 
@@ -597,7 +600,12 @@ Module* PipelineModule::load(const std::vector<std::string>& inputs, const std::
     sharedConst->defaultBackend = defaultBackend;
     ErrorCode code = NO_ERROR;
     std::set<int> noneedComputeIndexes;
-    initConstTensors(sharedConst->allTensors, net, defaultBackend.get(), code);
+    if (nullptr != bufferStorage->mapFile.get()) {
+        // Const tensors use the mapped model in place, keep it with them
+        sharedConst->referenceConstData = true;
+        sharedConst->constDataStorage = bufferStorage;
+    }
+    initConstTensors(sharedConst->allTensors, net, defaultBackend.get(), code, sharedConst->referenceConstData);
     if (NO_ERROR != code) {
         MNN_ERROR("Alloc memory for const tensor error\n");
         return nullptr;
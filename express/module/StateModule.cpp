@@ -0,0 +1,201 @@
+//
+//  StateModule.cpp
+//  MNN
+//
+//  Created by MNN on 2021/12/22.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include "StateModule.hpp"
+#include <string.h>
+#include <algorithm>
+#include <MNN/expr/ExprCreator.hpp>
+
+namespace MNN {
+namespace Express {
+
+StateModule::StateModule(std::shared_ptr<Module> module, std::vector<StateIndex> indexes, std::vector<Variable::Info> infos, int capacity) {
+    mModule       = module;
+    mInitCapacity = std::max(1, capacity);
+    auto info     = module->getInfo();
+    mInputIsState.resize(info->inputNames.size(), false);
+    mOutputIsState.resize(info->outputNames.size(), false);
+    for (int i = 0; i < indexes.size(); ++i) {
+        std::shared_ptr<State> state(new State);
+        state->index = indexes[i];
+        state->info  = infos[i];
+        auto& dims   = state->info.dim;
+        dims[state->index.axis] = 0;
+        int inside = state->info.type.bytes();
+        for (int d = state->index.axis + 1; d < dims.size(); ++d) {
+            inside *= dims[d];
+        }
+        state->insideBytes = inside;
+        state->info.syncSize();
+        mInputIsState[state->index.input]   = true;
+        mOutputIsState[state->index.output] = true;
+        mStates.emplace_back(state);
+    }
+    setType("StateModule");
+    setName(module->name());
+    registerModel({module});
+}
+
+void StateModule::onClearCache() {
+    // Keep the storage for the next sequence
+    for (auto& state : mStates) {
+        state->length = 0;
+        state->past   = nullptr;
+    }
+}
+
+VARP StateModule::_past(State& state) {
+    auto info = state.info;
+    info.dim[state.index.axis] = state.length;
+    info.syncSize();
+    // Create the new one before releasing the last, so that the origin module sees a different input tensor
+    auto past  = Variable::create(Expr::create(std::move(info), state.storage.get(), VARP::INPUT, Expr::REF));
+    state.past = past;
+    return past;
+}
+
+bool StateModule::_append(State& state, VARP present) {
+    auto info = present->getInfo();
+    if (nullptr == info) {
+        return false;
+    }
+    if (info->order == NC4HW4) {
+        present = _Convert(present, state.info.order);
+        info    = present->getInfo();
+    }
+    auto& dims = state.info.dim;
+    if (info->dim.size() != dims.size() || info->type != state.info.type) {
+        MNN_ERROR("The state output %s doesn't match its input\n", present->name().c_str());
+        return false;
+    }
+    for (int d = 0; d < dims.size(); ++d) {
+        if (d != state.index.axis && info->dim[d] != dims[d]) {
+            MNN_ERROR("The state output %s doesn't match its input at dimension %d\n", present->name().c_str(), d);
+            return false;
+        }
+    }
+    int step = info->dim[state.index.axis];
+    auto src = present->readMap<uint8_t>();
+    if (step <= 0 || nullptr == src) {
+        return step == 0;
+    }
+    if (state.length + step > state.capacity) {
+        int capacity = std::max(std::max(state.capacity * 2, state.length + step), mInitCapacity);
+        auto storage = (uint8_t*)MNNMemoryAllocAlign(capacity * state.insideBytes, MNN_MEMORY_ALIGN_DEFAULT);
+        if (nullptr == storage) {
+            MNN_ERROR("Not enough memory for state %s\n", present->name().c_str());
+            return false;
+        }
+        if (state.length > 0) {
+            ::memcpy(storage, state.storage.get(), state.length * state.insideBytes);
+        }
+        state.storage.set(storage, capacity * state.insideBytes);
+        state.capacity = capacity;
+    }
+    ::memcpy(state.storage.get() + state.length * state.insideBytes, src, step * state.insideBytes);
+    state.length += step;
+    return true;
+}
+
+std::vector<Express::VARP> StateModule::onForward(const std::vector<Express::VARP>& inputs) {
+    std::vector<VARP> moduleInputs(mInputIsState.size());
+    int userIndex = 0;
+    for (int i = 0; i < moduleInputs.size(); ++i) {
+        if (mInputIsState[i]) {
+            continue;
+        }
+        if (userIndex >= inputs.size()) {
+            MNN_ERROR("StateModule need %d inputs but %d is given\n", (int)(moduleInputs.size() - mStates.size()), (int)inputs.size());
+            return {};
+        }
+        moduleInputs[i] = inputs[userIndex++];
+    }
+    for (auto& state : mStates) {
+        moduleInputs[state->index.input] = _past(*state);
+    }
+    auto moduleOutputs = mModule->onForward(moduleInputs);
+    if (moduleOutputs.size() != mOutputIsState.size()) {
+        return {};
+    }
+    for (auto& state : mStates) {
+        if (!_append(*state, moduleOutputs[state->index.output])) {
+            return {};
+        }
+    }
+    std::vector<VARP> outputs;
+    for (int i = 0; i < moduleOutputs.size(); ++i) {
+        if (!mOutputIsState[i]) {
+            outputs.emplace_back(moduleOutputs[i]);
+        }
+    }
+    return outputs;
+}
+
+Module* StateModule::clone(CloneContext* ctx) const {
+    std::shared_ptr<Module> module(mModule->clone(ctx));
+    if (nullptr == module) {
+        return nullptr;
+    }
+    std::vector<StateIndex> indexes;
+    std::vector<Variable::Info> infos;
+    for (auto& state : mStates) {
+        indexes.emplace_back(state->index);
+        infos.emplace_back(state->info);
+    }
+    return this->cloneBaseTo(ctx, new StateModule(module, indexes, infos, mInitCapacity));
+}
+
+Module* Module::createStateful(std::shared_ptr<Module> module, const StateConfig& config) {
+    if (nullptr == module) {
+        return nullptr;
+    }
+    auto info = module->getInfo();
+    if (nullptr == info) {
+        return nullptr;
+    }
+    std::vector<StateModule::StateIndex> indexes;
+    std::vector<Variable::Info> infos;
+    for (auto& state : config.states) {
+        auto inputIter  = std::find(info->inputNames.begin(), info->inputNames.end(), state.input);
+        auto outputIter = std::find(info->outputNames.begin(), info->outputNames.end(), state.output);
+        if (inputIter == info->inputNames.end() || outputIter == info->outputNames.end()) {
+            MNN_ERROR("Can't find state %s -> %s in module\n", state.input.c_str(), state.output.c_str());
+            return nullptr;
+        }
+        StateModule::StateIndex index;
+        index.input  = (int)(inputIter - info->inputNames.begin());
+        index.output = (int)(outputIter - info->outputNames.begin());
+        if (index.input >= info->inputs.size()) {
+            return nullptr;
+        }
+        auto inputInfo = info->inputs[index.input];
+        int dimSize    = (int)inputInfo.dim.size();
+        index.axis     = state.axis < 0 ? state.axis + dimSize : state.axis;
+        if (index.axis < 0 || index.axis >= dimSize || inputInfo.order == NC4HW4) {
+            MNN_ERROR("Invalid axis or format for state %s\n", state.input.c_str());
+            return nullptr;
+        }
+        for (int d = 0; d < dimSize; ++d) {
+            if (d != index.axis && inputInfo.dim[d] <= 0) {
+                MNN_ERROR("The shape of state %s must be known except the axis\n", state.input.c_str());
+                return nullptr;
+            }
+            if (d < index.axis && inputInfo.dim[d] != 1) {
+                // Otherwise the past isn't contiguous and must be copied every step
+                MNN_ERROR("The axis of state %s must be outermost, such as [seq, head, dim]\n", state.input.c_str());
+                return nullptr;
+            }
+        }
+        indexes.emplace_back(index);
+        infos.emplace_back(std::move(inputInfo));
+    }
+    return new StateModule(module, std::move(indexes), std::move(infos), config.capacity);
+}
+
+} // namespace Express
+} // namespace MNN
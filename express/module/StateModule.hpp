@@ -0,0 +1,60 @@
+//
+//  StateModule.hpp
+//  MNN
+//
+//  Created by MNN on 2021/12/22.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#ifndef StateModule_hpp
+#define StateModule_hpp
+#include <MNN/expr/Module.hpp>
+#include "core/AutoStorage.h"
+namespace MNN {
+namespace Express {
+/**
+ Keep named state tensors of the origin module between onForward calls. The axis of each state is outermost,
+ the state is stored as [capacity, inside] and the origin module takes [length, inside] of it in place, the
+ output of current step is copied to [length, length + step).
+ */
+class StateModule : public Module {
+public:
+    struct StateIndex {
+        // Index in the inputs / outputs of origin module
+        int input;
+        int output;
+        int axis;
+    };
+    StateModule(std::shared_ptr<Module> module, std::vector<StateIndex> indexes, std::vector<Variable::Info> infos, int capacity);
+    virtual ~ StateModule() = default;
+    virtual std::vector<Express::VARP> onForward(const std::vector<Express::VARP>& inputs) override;
+
+protected:
+    virtual void onClearCache() override;
+
+private:
+    struct State {
+        StateIndex index;
+        // The shape with length 0 along the axis
+        Variable::Info info;
+        // Bytes of one step
+        int insideBytes = 0;
+        int capacity = 0;
+        int length = 0;
+        AutoStorage<uint8_t> storage;
+        // Input of last forward, keep it alive until the next one
+        VARP past;
+    };
+    Module* clone(CloneContext* ctx) const override;
+    VARP _past(State& state);
+    bool _append(State& state, VARP present);
+
+    std::shared_ptr<Module> mModule;
+    std::vector<std::shared_ptr<State>> mStates;
+    std::vector<bool> mInputIsState;
+    std::vector<bool> mOutputIsState;
+    int mInitCapacity;
+};
+} // namespace Express
+} // namespace MNN
+#endif
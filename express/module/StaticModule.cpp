@@ -158,6 +158,8 @@ static void _resizeTensor(Tensor* tensor, const Tensor* dims, Session* session,
 void StaticModule::resetInputOutputs() {
     mPrevInputTensor.resize(mResource->mInputs.size());
     mInputTensors.resize(mResource->mInputs.size());
+    mInputBuffers.clear();
+    mInputBuffers.resize(mResource->mInputs.size());
     auto& pipelineInfo = mSession->getPipelineInfo(0);
     for (int i = 0; i < mResource->mInputs.size(); ++i) {
         mInputTensors[i] = mSession->getTensor(mResource->mInputs[i]);
@@ -194,6 +196,9 @@ StaticModule::StaticModule(std::vector<int> inputs,
     mResource->mBnInfo.user = &mResource->mBnConfig;
     mResource->mModes.inputMode = config.shapeMutable ? Interpreter::Session_Input_User : Interpreter::Session_Input_Inside;
     mResource->mModes.outputMode = Interpreter::Session_Output_User;
+    if (mResource->mModes.resizeCacheSize > 0 && nullptr == mResource->mModes.resizeCacheInfo) {
+        mResource->mModes.resizeCacheInfo.reset(new Session::ResizeCacheInfo);
+    }
     std::shared_ptr<BufferStorage> net_storage;
     std::map<const Op*, std::pair<std::shared_ptr<Execution>, DataType>> exeCache;
     MNN_ASSERT(1 == scheduleInfo.pipelineInfo.size());
@@ -261,8 +266,81 @@ StaticModule::StaticModule(std::vector<int> inputs,
     }
 }
 StaticModule::~StaticModule() {
+    mSessionCache.clear();
     mSession         = nullptr;
 }
+
+static std::vector<int> _shapeKey(const std::vector<Express::VARP>& inputs) {
+    std::vector<int> key;
+    for (auto& input : inputs) {
+        auto tensor = Utils::getTensor(input);
+        key.emplace_back(tensor->buffer().dimensions);
+        for (int i = 0; i < tensor->buffer().dimensions; ++i) {
+            key.emplace_back(tensor->length(i));
+        }
+        key.emplace_back(tensor->getType().code);
+        key.emplace_back(tensor->getType().bits);
+        key.emplace_back(TensorUtils::getDescribe(tensor)->dimensionFormat);
+    }
+    return key;
+}
+
+void StaticModule::switchSession(const std::vector<Express::VARP>& inputs) {
+    auto key = _shapeKey(inputs);
+    if (key == mShapeKey) {
+        return;
+    }
+    if (mShapeKey.empty()) {
+        // First forward, use the origin session
+        mShapeKey = std::move(key);
+        return;
+    }
+    auto& info = mResource->mModes.resizeCacheInfo;
+    auto iter  = mSessionCache.begin();
+    for (; iter != mSessionCache.end(); ++iter) {
+        if (iter->shapeKey == key) {
+            break;
+        }
+    }
+    if (iter == mSessionCache.end()) {
+        info->miss++;
+        if (mResource->mModes.resizeCacheSize <= 1) {
+            // Only keep current session, resize it
+            mShapeKey = std::move(key);
+            return;
+        }
+    } else {
+        info->hit++;
+    }
+    SessionCache current;
+    current.shapeKey        = std::move(mShapeKey);
+    current.session         = mSession;
+    current.inputTensors    = std::move(mInputTensors);
+    current.prevInputTensor = std::move(mPrevInputTensor);
+    current.outputTensors   = std::move(mOutputTensors);
+    current.inputBuffers    = std::move(mInputBuffers);
+    if (iter == mSessionCache.end() && mSessionCache.size() + 1 < mResource->mModes.resizeCacheSize) {
+        // Create a new session sharing the weights, it will be resized for the new shape
+        auto rt = mSession->getRuntime();
+        mSession.reset(mSession->clone(std::move(rt), mResource->mSharedConst));
+        resetInputOutputs();
+    } else {
+        if (iter == mSessionCache.end()) {
+            // Reuse the least recently used session, it will be resized for the new shape
+            iter = std::prev(mSessionCache.end());
+        }
+        mSession         = iter->session;
+        mInputTensors    = std::move(iter->inputTensors);
+        mPrevInputTensor = std::move(iter->prevInputTensor);
+        mOutputTensors   = std::move(iter->outputTensors);
+        mInputBuffers    = std::move(iter->inputBuffers);
+        mSessionCache.erase(iter);
+        // The input variables bound last time may be released
+        onClearCache();
+    }
+    mSessionCache.emplace_front(std::move(current));
+    mShapeKey = std::move(key);
+}
 void StaticModule::onClearCache() {
     if (nullptr != mSession) {
         for (int i=0; i<mPrevInputTensor.size(); ++i) {
@@ -297,6 +375,9 @@ std::vector<Express::VARP> StaticModule::onForward(const std::vector<Express::VA
 #endif
 
     MNN_ASSERT(inputs.size() == mInputTensors.size());
+    if (mResource->mModes.resizeCacheSize > 0 && mResource->mModes.inputMode == Interpreter::Session_Input_User && !mResource->mUseContentInputs) {
+        switchSession(inputs);
+    }
     auto& pipelineInfo = mSession->getPipelineInfo(0);
     if (mResource->mModes.inputMode == Interpreter::Session_Input_User) {
         for (int i = 0; i < inputs.size(); ++i) {
@@ -353,6 +434,22 @@ std::vector<Express::VARP> StaticModule::onForward(const std::vector<Express::VA
                     std::get<2>(cacheIter->second) = false;
                     std::get<3>(cacheIter->second) = false;
                 }
+            } else if (mResource->mModes.resizeCacheSize > 1 && 0 == inputTensor->buffer().device &&
+                       nullptr != inputTensor->host<void>() && nullptr == srcDes->tensorArrayAttr.get() &&
+                       MNN_DATA_FORMAT_NC4HW4 != srcDes->dimensionFormat) {
+                // Copy to the buffer of the session instead of referring the variable, so a kept session only
+                // malloc when the size changes
+                auto& buffer = mInputBuffers[i];
+                auto size    = inputTensor->size();
+                if (nullptr == buffer.get() || buffer->size() != size) {
+                    buffer.reset(new AutoStorage<uint8_t>(size));
+                }
+                ::memcpy(buffer->get(), inputTensor->host<void>(), size);
+                needMalloc = mInputTensors[i]->buffer().host != buffer->get() || mInputTensors[i]->buffer().device != 0;
+                des->backend = srcDes->backend;
+                mInputTensors[i]->buffer().host   = buffer->get();
+                mInputTensors[i]->buffer().device = 0;
+                des->extra.offset = 0;
             } else {
                 needMalloc = TensorUtils::refTensorContent(mInputTensors[i], inputTensor);
             }
@@ -10,6 +10,8 @@
 #define StaticModule_hpp
 
 #include <MNN/expr/Module.hpp>
+#include <list>
+#include "core/AutoStorage.h"
 #include "core/Schedule.hpp"
 #include "core/Session.hpp"
 
@@ -27,6 +29,7 @@ public:
 private:
     StaticModule() = default;
     void resetInputOutputs();
+    void switchSession(const std::vector<Express::VARP>& inputs);
 
     Module* clone(CloneContext* ctx) const override;
     struct Resource {
@@ -50,6 +53,22 @@ private:
     std::vector<Tensor*> mPrevInputTensor;
     std::vector<Tensor*> mOutputTensors;
     std::shared_ptr<Resource> mResource;
+
+    // Resized session for other input shapes, most recently used first
+    struct SessionCache {
+        std::vector<int> shapeKey;
+        std::shared_ptr<Session> session;
+        std::vector<Tensor*> inputTensors;
+        std::vector<Tensor*> prevInputTensor;
+        std::vector<Tensor*> outputTensors;
+        std::vector<std::shared_ptr<AutoStorage<uint8_t>>> inputBuffers;
+    };
+    std::list<SessionCache> mSessionCache;
+    // Input shapes of mSession
+    std::vector<int> mShapeKey;
+    // Host inputs are copied to the buffers of mSession when sessions are kept, so the input pointers don't change
+    // and switching back to a kept session needn't malloc again
+    std::vector<std::shared_ptr<AutoStorage<uint8_t>>> mInputBuffers;
 };
 }
 }
@@ -0,0 +1,586 @@
+//
+//  TiledModule.cpp
+//  MNN
+//
+//  Created by MNN on 2021/12/27.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include "TiledModule.hpp"
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <MNN/expr/ExprCreator.hpp>
+#include <MNN/expr/ExecutorScope.hpp>
+#include "core/Macro.h"
+#include "RuntimeAttr.hpp"
+#include "MNN_generated.h"
+
+namespace MNN {
+namespace Express {
+
+namespace {
+struct SpatialInfo {
+    // Whether the tensor depends on the positions of the tiled input
+    bool spatial = false;
+    // Input pixels per pixel and the input pixels needed on each side, [y, x]
+    float scale[2] = {1.0f, 1.0f};
+    float halo[2]  = {0.0f, 0.0f};
+};
+} // namespace
+
+// Pixels one output depends on at the wider side of its strided position, padBegin < 0 means unknown
+static int _sideExtent(int extent, int padBegin) {
+    if (padBegin < 0) {
+        return extent;
+    }
+    return std::max(padBegin, extent - padBegin);
+}
+
+static int _gcd(int a, int b) {
+    while (b != 0) {
+        int t = a % b;
+        a     = b;
+        b     = t;
+    }
+    return a;
+}
+
+// Resize factors [y, x] of an Interp op, return false if they aren't a constant scale
+static bool _interpFactor(const Op* op, const std::vector<const Op*>& producers, float* factor) {
+    auto interp = op->main_as_Interp();
+    if (nullptr == interp || interp->alignCorners() || interp->ctm() == CoordinateTransformationMode_AlignCorners ||
+        interp->ctm() == CoordinateTransformationMode_TensorflowCropAndResize) {
+        return false;
+    }
+    if (1 == op->inputIndexes()->size()) {
+        if (interp->outputWidth() != 0 || interp->outputHeight() != 0) {
+            return false;
+        }
+        factor[0] = interp->heightScale();
+        factor[1] = interp->widthScale();
+        return factor[0] > 0.0f && factor[1] > 0.0f;
+    }
+    // Onnx's Resize with constant scales for [n, c, h, w]
+    auto shapeOp = producers[op->inputIndexes()->Get(1)];
+    if (nullptr == shapeOp || OpType_Const != shapeOp->type()) {
+        return false;
+    }
+    auto blob = shapeOp->main_as_Blob();
+    if (nullptr == blob || DataType_DT_FLOAT != blob->dataType() || nullptr == blob->float32s() ||
+        4 != blob->float32s()->size()) {
+        return false;
+    }
+    factor[0] = blob->float32s()->Get(2);
+    factor[1] = blob->float32s()->Get(3);
+    return factor[0] > 0.0f && factor[1] > 0.0f;
+}
+
+bool TiledModule::computeTiling(const Net* net, int inputIndex, const std::vector<int>& outputIndexes, Tiling& tiling) {
+    auto ops          = net->oplists();
+    int tensorNumber  = net->tensorName()->size();
+    std::vector<SpatialInfo> infos(tensorNumber);
+    std::vector<const Op*> producers(tensorNumber, nullptr);
+    infos[inputIndex].spatial = true;
+    int channelAxis = 1;
+    for (int i = 0; i < ops->size(); ++i) {
+        auto op = ops->GetAs<Op>(i);
+        if (nullptr == op->outputIndexes()) {
+            continue;
+        }
+        for (auto index : *op->outputIndexes()) {
+            producers[index] = op;
+            if (index == inputIndex && OpType_Input == op->type() && nullptr != op->main_as_Input() &&
+                MNN_DATA_FORMAT_NHWC == op->main_as_Input()->dformat()) {
+                channelAxis = 3;
+            }
+        }
+    }
+    auto isChannel = [channelAxis](int axis) {
+        return axis == channelAxis || axis == channelAxis - 4;
+    };
+    for (int i = 0; i < ops->size(); ++i) {
+        auto op = ops->GetAs<Op>(i);
+        if (nullptr == op->inputIndexes() || nullptr == op->outputIndexes()) {
+            continue;
+        }
+        auto name = nullptr != op->name() ? op->name()->c_str() : "";
+        SpatialInfo info;
+        for (auto index : *op->inputIndexes()) {
+            auto& input = infos[index];
+            if (!input.spatial) {
+                continue;
+            }
+            if (!info.spatial) {
+                info = input;
+                continue;
+            }
+            if (info.scale[0] != input.scale[0] || info.scale[1] != input.scale[1]) {
+                MNN_ERROR("Can't tile op %s whose inputs have different strides\n", name);
+                return false;
+            }
+            info.halo[0] = std::max(info.halo[0], input.halo[0]);
+            info.halo[1] = std::max(info.halo[1], input.halo[1]);
+        }
+        if (!info.spatial) {
+            continue;
+        }
+        bool valid = true;
+        switch (op->type()) {
+            case OpType_Convolution:
+            case OpType_ConvolutionDepthwise:
+            case OpType_ConvInt8:
+            case OpType_DepthwiseConvInt8:
+            case OpType_Deconvolution:
+            case OpType_DeconvolutionDepthwise: {
+                auto conv = op->main_as_Convolution2D();
+                if (nullptr == conv || nullptr == conv->common()) {
+                    valid = false;
+                    break;
+                }
+                auto common   = conv->common();
+                int kernel[2] = {common->kernelY(), common->kernelX()};
+                int stride[2] = {common->strideY(), common->strideX()};
+                int dilate[2] = {common->dilateY(), common->dilateX()};
+                int pad[2]    = {-1, -1};
+                if (PadMode_VALID == common->padMode()) {
+                    pad[0] = 0;
+                    pad[1] = 0;
+                } else if (PadMode_CAFFE == common->padMode()) {
+                    pad[0] = common->padY();
+                    pad[1] = common->padX();
+                    if (nullptr != common->pads() && common->pads()->size() >= 2) {
+                        pad[0] = common->pads()->Get(0);
+                        pad[1] = common->pads()->Get(1);
+                    }
+                }
+                bool deconv = OpType_Deconvolution == op->type() || OpType_DeconvolutionDepthwise == op->type();
+                for (int d = 0; d < 2; ++d) {
+                    int extent = (kernel[d] - 1) * dilate[d];
+                    if (deconv) {
+                        info.halo[d] += (UP_DIV(extent, stride[d]) + 1) * info.scale[d];
+                        info.scale[d] /= (float)stride[d];
+                    } else {
+                        info.halo[d] += _sideExtent(extent, pad[d]) * info.scale[d];
+                        info.scale[d] *= (float)stride[d];
+                    }
+                }
+                break;
+            }
+            case OpType_Pooling:
+            case OpType_PoolInt8: {
+                auto pool = op->main_as_Pool();
+                if (nullptr == pool || pool->isGlobal()) {
+                    valid = false;
+                    break;
+                }
+                int kernel[2] = {pool->kernelY(), pool->kernelX()};
+                int stride[2] = {pool->strideY(), pool->strideX()};
+                int pad[2]    = {-1, -1};
+                if (PoolPadType_VALID == pool->padType()) {
+                    pad[0] = 0;
+                    pad[1] = 0;
+                } else if (PoolPadType_CAFFE == pool->padType()) {
+                    pad[0] = pool->padY();
+                    pad[1] = pool->padX();
+                    if (nullptr != pool->pads() && pool->pads()->size() >= 2) {
+                        pad[0] = pool->pads()->Get(0);
+                        pad[1] = pool->pads()->Get(1);
+                    }
+                }
+                for (int d = 0; d < 2; ++d) {
+                    info.halo[d] += _sideExtent(kernel[d] - 1, pad[d]) * info.scale[d];
+                    info.scale[d] *= (float)stride[d];
+                }
+                break;
+            }
+            case OpType_Interp: {
+                float factor[2];
+                if (!_interpFactor(op, producers, factor)) {
+                    valid = false;
+                    break;
+                }
+                int extent = 3 == op->main_as_Interp()->resizeType() ? 2 : 1;
+                for (int d = 0; d < 2; ++d) {
+                    info.halo[d] += extent * info.scale[d];
+                    info.scale[d] /= factor[d];
+                }
+                break;
+            }
+            case OpType_Softmax:
+            case OpType_Concat:
+                valid = nullptr != op->main_as_Axis() && isChannel(op->main_as_Axis()->axis());
+                break;
+            case OpType_ArgMax:
+                valid = nullptr != op->main_as_ArgMax() && isChannel(op->main_as_ArgMax()->axis());
+                break;
+            case OpType_Slice:
+                valid = nullptr != op->main_as_Slice() && isChannel(op->main_as_Slice()->axis());
+                break;
+            case OpType_Shape:
+            case OpType_Size:
+            case OpType_Rank:
+                info.spatial = false;
+                break;
+            // Pointwise in space
+            case OpType_ReLU:
+            case OpType_ReLU6:
+            case OpType_PReLU:
+            case OpType_ELU:
+            case OpType_Selu:
+            case OpType_Sigmoid:
+            case OpType_TanH:
+            case OpType_Threshold:
+            case OpType_BatchNorm:
+            case OpType_Scale:
+            case OpType_Eltwise:
+            case OpType_BinaryOp:
+            case OpType_UnaryOp:
+            case OpType_Cast:
+            case OpType_ConvertTensor:
+            case OpType_Dropout:
+            case OpType_Identity:
+            case OpType_Int8ToFloat:
+            case OpType_FloatToInt8:
+                break;
+            default:
+                valid = false;
+                break;
+        }
+        if (!valid) {
+            MNN_ERROR("Can't tile op %s of type %s\n", name, EnumNameOpType(op->type()));
+            return false;
+        }
+        for (auto index : *op->outputIndexes()) {
+            infos[index] = info;
+        }
+    }
+    float halo[2] = {0.0f, 0.0f};
+    tiling.align[0] = 1;
+    tiling.align[1] = 1;
+    for (auto& info : infos) {
+        if (!info.spatial) {
+            continue;
+        }
+        for (int d = 0; d < 2; ++d) {
+            halo[d] = std::max(halo[d], info.halo[d]);
+            // Strides must be integers or the reciprocals of integers
+            auto scale = info.scale[d] >= 1.0f ? info.scale[d] : 1.0f / info.scale[d];
+            int stride = (int)roundf(scale);
+            if (fabsf(scale - (float)stride) > 1e-3f) {
+                MNN_ERROR("Can't tile the module for a fractional stride %f\n", info.scale[d]);
+                return false;
+            }
+            if (info.scale[d] >= 1.0f) {
+                tiling.align[d] = tiling.align[d] / _gcd(tiling.align[d], stride) * stride;
+            }
+        }
+    }
+    for (int d = 0; d < 2; ++d) {
+        tiling.halo[d] = UP_DIV((int)ceilf(halo[d]), tiling.align[d]) * tiling.align[d];
+    }
+    tiling.scales.clear();
+    for (auto index : outputIndexes) {
+        auto& info = infos[index];
+        if (!info.spatial) {
+            MNN_ERROR("Can't tile the module for output %s which doesn't depend on the input\n", net->tensorName()->GetAsString(index)->c_str());
+            return false;
+        }
+        tiling.scales.emplace_back(std::vector<float>{info.scale[0], info.scale[1]});
+    }
+    return true;
+}
+
+// Spatial size [height, width] of a NCHW / NHWC variable, and the blocks beside them
+static bool _layout(const Variable::Info* info, int* size, int& outside, int& insideBytes) {
+    if (nullptr == info || info->dim.size() != 4 || info->order == NC4HW4) {
+        return false;
+    }
+    int axis    = NHWC == info->order ? 1 : 2;
+    size[0]     = info->dim[axis];
+    size[1]     = info->dim[axis + 1];
+    outside     = info->dim[0];
+    insideBytes = info->type.bytes();
+    if (NHWC == info->order) {
+        insideBytes *= info->dim[3];
+    } else {
+        outside *= info->dim[1];
+    }
+    return true;
+}
+
+static void _copyRegion(uint8_t* dst, const int* dstSize, const int* dstBegin, const uint8_t* src, const int* srcSize,
+                        const int* srcBegin, const int* count, int outside, int insideBytes) {
+    for (int o = 0; o < outside; ++o) {
+        auto dstO = dst + (size_t)o * dstSize[0] * dstSize[1] * insideBytes;
+        auto srcO = src + (size_t)o * srcSize[0] * srcSize[1] * insideBytes;
+        for (int y = 0; y < count[0]; ++y) {
+            ::memcpy(dstO + ((size_t)(dstBegin[0] + y) * dstSize[1] + dstBegin[1]) * insideBytes,
+                     srcO + ((size_t)(srcBegin[0] + y) * srcSize[1] + srcBegin[1]) * insideBytes,
+                     (size_t)count[1] * insideBytes);
+        }
+    }
+}
+
+// Input pixels to output pixels, return false if it's not an integer
+static bool _toOutput(int value, float scale, int& result) {
+    float v = (float)value / scale;
+    result  = (int)roundf(v);
+    return fabsf(v - (float)result) < 1e-3f;
+}
+
+TiledModule::TiledModule(std::shared_ptr<Module> module, const TileConfig& config, const Tiling& tiling) {
+    mModule = module;
+    mConfig = config;
+    mTiling = tiling;
+    mConfig.parallel = std::max(1, mConfig.parallel);
+    setType("TiledModule");
+    setName(module->name());
+    registerModel({module});
+}
+
+TiledModule::~TiledModule() {
+    for (auto& instance : mInstances) {
+        ExecutorScope _s(instance.first);
+        instance.second.reset();
+    }
+}
+
+bool TiledModule::_forward(Module* module, const Tile& tile, const std::vector<VARP>& inputs, const uint8_t* source,
+                           const int* size, const int* window) {
+    auto info = inputs[0]->getInfo();
+    int srcSize[2], outside, insideBytes;
+    _layout(info, srcSize, outside, insideBytes);
+    auto dims = info->dim;
+    int axis  = NHWC == info->order ? 1 : 2;
+    dims[axis]     = window[0];
+    dims[axis + 1] = window[1];
+    auto x = _Input(dims, info->order, info->type);
+    int zero[2] = {0, 0};
+    _copyRegion(x->writeMap<uint8_t>(), window, zero, source, size, tile.window, window, outside, insideBytes);
+    auto tileInputs = inputs;
+    tileInputs[0]   = x;
+    auto outputs    = module->onForward(tileInputs);
+    if (outputs.size() != mTiling.scales.size()) {
+        MNN_ERROR("TiledModule: the module has %d outputs, but %d is expected\n", (int)outputs.size(), (int)mTiling.scales.size());
+        return false;
+    }
+    for (int k = 0; k < outputs.size(); ++k) {
+        auto output = outputs[k];
+        auto outInfo = output->getInfo();
+        if (nullptr != outInfo && outInfo->order == NC4HW4) {
+            output  = _Convert(output, NCHW);
+            outInfo = output->getInfo();
+        }
+        int outSize[2], outOutside, outInsideBytes;
+        auto outPtr = output->readMap<uint8_t>();
+        if (!_layout(outInfo, outSize, outOutside, outInsideBytes) || nullptr == outPtr) {
+            MNN_ERROR("TiledModule: output %d isn't a 4 dimension image\n", k);
+            return false;
+        }
+        auto scale = mTiling.scales[k].data();
+        if (mOutputs.size() <= k) {
+            // The first tile, decide the full output from the tail beyond window / scale, such as added by padding
+            auto fullDims = outInfo->dim;
+            int outAxis   = NHWC == outInfo->order ? 1 : 2;
+            std::vector<int> tail(2);
+            for (int d = 0; d < 2; ++d) {
+                int windowOut, sizeOut;
+                if (!_toOutput(window[d], scale[d], windowOut) || !_toOutput(size[d], scale[d], sizeOut)) {
+                    return false;
+                }
+                tail[d] = outSize[d] - windowOut;
+                fullDims[outAxis + d] = sizeOut + tail[d];
+            }
+            auto full = _Input(fullDims, outInfo->order, outInfo->type);
+            mOutputs.emplace_back(full);
+            mOutputPtrs.emplace_back(full->writeMap<uint8_t>());
+            mOutputTails.emplace_back(tail);
+        }
+        int fullSize[2], dstBegin[2], srcBegin[2], count[2];
+        for (int d = 0; d < 2; ++d) {
+            int sizeOut;
+            if (!_toOutput(size[d], scale[d], sizeOut) || !_toOutput(tile.begin[d], scale[d], dstBegin[d]) ||
+                !_toOutput(tile.begin[d] - tile.window[d], scale[d], srcBegin[d]) ||
+                !_toOutput(tile.end[d] - tile.begin[d], scale[d], count[d])) {
+                return false;
+            }
+            fullSize[d] = sizeOut + mOutputTails[k][d];
+            if (tile.end[d] == size[d]) {
+                count[d] += mOutputTails[k][d];
+            }
+            if (srcBegin[d] + count[d] > outSize[d] || dstBegin[d] + count[d] > fullSize[d]) {
+                MNN_ERROR("TiledModule: the halo isn't enough for output %d\n", k);
+                return false;
+            }
+        }
+        _copyRegion(mOutputPtrs[k], fullSize, dstBegin, outPtr, outSize, srcBegin, count, outOutside, outInsideBytes);
+    }
+    return true;
+}
+
+// The clones for the parallel tiles use the same backend, config and threads as the original module
+static std::shared_ptr<Executor> _createExecutor(const Module* module) {
+    auto info = module->getInfo();
+    if (nullptr == info || nullptr == info->runTimeManager) {
+        auto attr = ExecutorScope::Current()->getAttr();
+        return Executor::newExecutor(attr->firstType.first, BackendConfig(), attr->firstType.second);
+    }
+    auto rtMgr = info->runTimeManager;
+    int type   = MNN_FORWARD_CPU;
+    rtMgr->getInfo(Interpreter::BACKENDS, &type);
+    BackendConfig config;
+    if (nullptr != rtMgr->getBnConfig()) {
+        config = *rtMgr->getBnConfig();
+    }
+    return Executor::newExecutor((MNNForwardType)type, config, rtMgr->getInside()->mNumberThread);
+}
+
+std::vector<Express::VARP> TiledModule::onForward(const std::vector<Express::VARP>& inputs) {
+    if (inputs.empty()) {
+        return {};
+    }
+    auto input = inputs[0];
+    auto info  = input->getInfo();
+    if (nullptr != info && info->order == NC4HW4) {
+        input = _Convert(input, NCHW);
+        info  = input->getInfo();
+    }
+    int size[2], outside, insideBytes;
+    if (!_layout(info, size, outside, insideBytes)) {
+        return mModule->onForward(inputs);
+    }
+    int core[2], window[2];
+    bool aligned = true, single = true;
+    int tileSize[2] = {mConfig.tileHeight, mConfig.tileWidth};
+    for (int d = 0; d < 2; ++d) {
+        auto align = mTiling.align[d];
+        aligned    = aligned && size[d] % align == 0;
+        core[d]    = UP_DIV(std::max(tileSize[d], 1), align) * align;
+        window[d]  = std::min(core[d] + 2 * mTiling.halo[d], size[d]);
+        single     = single && window[d] == size[d];
+    }
+    if (!aligned || single) {
+        return mModule->onForward(inputs);
+    }
+    std::vector<Tile> tiles;
+    for (int y = 0; y < size[0]; y += core[0]) {
+        for (int x = 0; x < size[1]; x += core[1]) {
+            Tile tile;
+            tile.begin[0] = y;
+            tile.begin[1] = x;
+            for (int d = 0; d < 2; ++d) {
+                tile.end[d]    = std::min(tile.begin[d] + core[d], size[d]);
+                tile.window[d] = std::min(std::max(tile.begin[d] - mTiling.halo[d], 0), size[d] - window[d]);
+            }
+            tiles.emplace_back(tile);
+        }
+    }
+    // Compute the inputs before sharing them with other threads
+    auto source = input->readMap<uint8_t>();
+    if (nullptr == source) {
+        return {};
+    }
+    std::vector<VARP> tileInputs = inputs;
+    tileInputs[0] = input;
+    for (int i = 1; i < tileInputs.size(); ++i) {
+        tileInputs[i]->readMap<uint8_t>();
+    }
+    mOutputs.clear();
+    mOutputPtrs.clear();
+    mOutputTails.clear();
+    std::atomic_bool success(_forward(mModule.get(), tiles[0], tileInputs, source, size, window));
+    std::atomic_int next(1);
+    auto run = [&](Module* module) {
+        while (success) {
+            int index = next++;
+            if (index >= tiles.size()) {
+                break;
+            }
+            if (!_forward(module, tiles[index], tileInputs, source, size, window)) {
+                success = false;
+            }
+        }
+    };
+    std::vector<std::thread> threads;
+    int threadNumber = std::min(mConfig.parallel, (int)tiles.size() - 1);
+    for (int t = 0; t + 1 < threadNumber; ++t) {
+        if (t >= mInstances.size()) {
+            auto executor = _createExecutor(mModule.get());
+            std::shared_ptr<Module> module;
+            {
+                ExecutorScope _s(executor);
+                module.reset(Module::clone(mModule.get(), true), Module::destroy);
+            }
+            if (nullptr == module) {
+                MNN_ERROR("Module %s can't be cloned for tiles\n", mModule->name().c_str());
+                break;
+            }
+            mInstances.emplace_back(std::make_pair(executor, module));
+        }
+        auto instance = mInstances[t];
+        threads.emplace_back([instance, &run]() {
+            ExecutorScope _s(instance.first);
+            run(instance.second.get());
+        });
+    }
+    run(mModule.get());
+    for (auto& t : threads) {
+        t.join();
+    }
+    std::vector<VARP> outputs;
+    if (success) {
+        outputs = std::move(mOutputs);
+    }
+    mOutputs.clear();
+    mOutputPtrs.clear();
+    mOutputTails.clear();
+    return outputs;
+}
+
+Module* TiledModule::clone(CloneContext* ctx) const {
+    std::shared_ptr<Module> module(mModule->clone(ctx));
+    if (nullptr == module) {
+        return nullptr;
+    }
+    return this->cloneBaseTo(ctx, new TiledModule(module, mConfig, mTiling));
+}
+
+Module* Module::loadTiled(const std::vector<std::string>& inputs, const std::vector<std::string>& outputs, const uint8_t* buffer, size_t length, const TileConfig& tileConfig, const std::shared_ptr<MNN::Express::Executor::RuntimeManager> rtMgr, const Config* config) {
+    std::shared_ptr<Module> module(Module::load(inputs, outputs, buffer, length, rtMgr, config), Module::destroy);
+    if (nullptr == module) {
+        return nullptr;
+    }
+    auto info = module->getInfo();
+    if (nullptr == info || info->inputNames.empty()) {
+        return nullptr;
+    }
+    auto net   = GetNet(buffer);
+    auto names = net->tensorName();
+    auto find  = [names](const std::string& name) {
+        for (int i = 0; i < names->size(); ++i) {
+            if (names->GetAsString(i)->str() == name) {
+                return i;
+            }
+        }
+        return -1;
+    };
+    int inputIndex = find(info->inputNames[0]);
+    std::vector<int> outputIndexes;
+    for (auto& name : info->outputNames) {
+        outputIndexes.emplace_back(find(name));
+        if (outputIndexes.back() < 0) {
+            return nullptr;
+        }
+    }
+    TiledModule::Tiling tiling;
+    if (inputIndex < 0 || !TiledModule::computeTiling(net, inputIndex, outputIndexes, tiling)) {
+        return nullptr;
+    }
+    return new TiledModule(module, tileConfig, tiling);
+}
+
+} // namespace Express
+} // namespace MNN
@@ -0,0 +1,65 @@
+//
+//  TiledModule.hpp
+//  MNN
+//
+//  Created by MNN on 2021/12/27.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#ifndef TiledModule_hpp
+#define TiledModule_hpp
+#include <MNN/expr/Module.hpp>
+#include <MNN/expr/Executor.hpp>
+namespace MNN {
+struct Net;
+namespace Express {
+/**
+ Run a fully convolutional module over spatial tiles of its first input. All the tiles use the same window, which
+ is the tile extended by the halo on each side and shifted inside the image at the borders, so the origin module
+ is resized only once. Output position o of a tile corresponds to input position o * scale of the window, the
+ valid part of the outputs are copied to the full outputs, and the tiles at the end also copy the tail which
+ the padding of the last layers may add.
+ */
+class TiledModule : public Module {
+public:
+    struct Tiling {
+        // Multiple of all the strides, the window and tiles begin at its multiples, [y, x]
+        int align[2] = {1, 1};
+        // Input pixels a tile needs on each side
+        int halo[2] = {0, 0};
+        // Input pixels per pixel of each output
+        std::vector<std::vector<float>> scales;
+    };
+    // Compute the tiling of the net for its tensor inputIndex, return false if the net can't be tiled
+    static bool computeTiling(const Net* net, int inputIndex, const std::vector<int>& outputIndexes, Tiling& tiling);
+
+    TiledModule(std::shared_ptr<Module> module, const TileConfig& config, const Tiling& tiling);
+    virtual ~ TiledModule();
+    virtual std::vector<Express::VARP> onForward(const std::vector<Express::VARP>& inputs) override;
+
+private:
+    struct Tile {
+        // Part of the input computed by this tile, [y, x]
+        int begin[2];
+        int end[2];
+        // Begin of the window
+        int window[2];
+    };
+    // Forward one tile and copy its outputs, allocate the full outputs from the first one
+    bool _forward(Module* module, const Tile& tile, const std::vector<VARP>& inputs, const uint8_t* source, const int* size,
+                  const int* window);
+    Module* clone(CloneContext* ctx) const override;
+
+    std::shared_ptr<Module> mModule;
+    TileConfig mConfig;
+    Tiling mTiling;
+    // Clones of the module for the extra threads, with their own executors
+    std::vector<std::pair<std::shared_ptr<Executor>, std::shared_ptr<Module>>> mInstances;
+    // Full outputs of current forward
+    std::vector<VARP> mOutputs;
+    std::vector<uint8_t*> mOutputPtrs;
+    std::vector<std::vector<int>> mOutputTails;
+};
+} // namespace Express
+} // namespace MNN
+#endif
@@ -10,6 +10,7 @@
 #define MNN_Interpreter_hpp
 
 #include <functional>
+#include <future>
 #include <map>
 #include <memory>
 #include <string>
@@ -111,6 +112,14 @@ public:
      * @return created net if success, NULL otherwise.
      */
     static Interpreter* createFromFile(const char* file);
+    /**
+     * @brief create net from file.
+     * @param file      given file.
+     * @param mapFile   map the file instead of reading it into a private buffer. Const data are used in place
+     *                  and processes loading the same file share the pages. Fall back to read if mapping fails.
+     * @return created net if success, NULL otherwise.
+     */
+    static Interpreter* createFromFile(const char* file, bool mapFile);
     /**
      * @brief create net from buffer.
      * @param buffer    given data buffer.
@@ -187,6 +196,17 @@ public:
         MAX_TUNING_NUMBER = 0,
         // Strictly check model file or not, default 1. if set 0, will not check model file valid/invalid
         STRICT_CHECK_MODEL = 1,
+        // Place dynamic memory by the lifetime based plan or not, default 0. If set 1, resize twice if the plan use less memory
+        MEMORY_PLAN = 2,
+        // Record Chrome trace events of ops, thread pool tasks and memory in session resize / run, default 0. See dumpTrace
+        // It's read in each run, so it can be changed for the created sessions
+        TRACE = 3,
+        // Run independent branches of the graph concurrently on the thread pool, default 0. Only for session run without callback
+        INTER_OP_PARALLEL = 4,
+        // Number of input shapes whose encoded session is kept by static Module with mutable shape, default 0 (disabled).
+        // Switching back to a kept shape skips resize. See RESIZE_CACHE for hit / miss. Only for Module, set it by
+        // Executor::RuntimeManager::setHint, Interpreter::setSessionHint rejects it
+        RESIZE_CACHE_SIZE = 5,
     };
     /**
      * @brief The API shoud be called before create session.
@@ -194,6 +214,14 @@ public:
      * @param value     Hint value
      */
     void setSessionHint(HintMode mode, int value);
+
+    /**
+     * @brief write the events recorded by sessions with TRACE hint as Chrome trace JSON, and clear them.
+     * the file can be opened by chrome://tracing or Perfetto.
+     * @param fileName  path of the JSON file
+     * @return true if success
+     */
+    static bool dumpTrace(const char* fileName);
 public:
     /**
      * @brief create runtimeInfo separately with schedule config.
@@ -290,6 +318,23 @@ public:
      */
     ErrorCode runSession(Session* session) const;
 
+    /**
+     * @brief run session on the internal worker pool and wait for the outputs there, without blocking the caller.
+     * runs of the same session are executed in order, different sessions run concurrently. don't touch the
+     * input / output tensors of the session until the run is finished. see ASYNC_QUEUE for the queue status.
+     * @param session   given session.
+     * @return future of the result of running, ready after the outputs are ready.
+     */
+    std::future<ErrorCode> runSessionAsync(Session* session) const;
+
+    /**
+     * @brief run session on the internal worker pool, the same as above except for the completion.
+     * @param session   given session.
+     * @param callback  called on the worker thread with the result after the outputs are ready, the next run of
+     *                  the session starts after it returns, so it can read the outputs.
+     */
+    void runSessionAsync(Session* session, std::function<void(ErrorCode)> callback) const;
+
     /*
      * @brief run session.
      * @param session   given session.
@@ -340,6 +385,17 @@ public:
         /** Resize Info, int*, 0: ready to execute, 1: need malloc, 2: need resize */
         RESIZE_STATUS = 3,
 
+        /** memory session will use in MB if dynamic memory is placed by the lifetime based plan, float*.
+         The plan is only recorded with MEMORY_PLAN hint, otherwise it's the same as MEMORY */
+        PLANNED_MEMORY = 4,
+
+        /** Hit / miss number of the shape keyed resize cache (see RESIZE_CACHE_SIZE hint), int*, length >= 2 */
+        RESIZE_CACHE = 5,
+
+        /** Status of runSessionAsync, float*, length >= 4: max concurrent runs of the worker pool, runs in flight,
+         average / max time in ms from submit to start */
+        ASYNC_QUEUE = 6,
+
         ALL
     };
 
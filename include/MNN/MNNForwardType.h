@@ -66,6 +66,7 @@ typedef enum {
 } MNNGpuMode;
 
 #ifdef __cplusplus
+#include <vector>
 namespace MNN {
 struct BackendConfig {
     enum MemoryMode { Memory_Normal = 0, Memory_High, Memory_Low };
@@ -85,6 +86,16 @@ struct BackendConfig {
         void* sharedContext = nullptr;
         size_t flags; // Valid for CPU Backend
     };
+
+    /** Valid for CPU Backend. Bind the threads of the runtime to the CPUs and place its memory on their NUMA node,
+     such as one runtime per socket on servers. If cpuIds is empty, use the CPUs of numaNode if it's not negative.
+     The thread number of the runtime is limited to the number of CPUs. By default the threads are not bound. */
+    std::vector<int> cpuIds;
+    int numaNode = -1;
+
+    /** Valid for CPU Backend. Back the memory of the runtime with 2MB huge pages to reduce TLB misses of large
+     weights and activations in GEMM, only effective on Linux. Default false. */
+    bool hugePage = false;
 };
 
     /** acquire runtime status by Runtime::getCurrentStatus with following keys,
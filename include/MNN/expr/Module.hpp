@@ -9,6 +9,8 @@
 #ifndef MNN_Train_Module_hpp
 #define MNN_Train_Module_hpp
 
+#include <functional>
+#include <future>
 #include <vector>
 #include <unordered_map>
 
@@ -17,6 +19,7 @@
 #include <MNN/MNNForwardType.h>
 
 namespace MNN {
+class AsyncQueue;
 namespace Express {
 struct SubGraph;
 class MNN_PUBLIC Module {
@@ -25,6 +28,18 @@ public:
     virtual ~Module()                                                                      = default;
     virtual std::vector<Express::VARP> onForward(const std::vector<Express::VARP>& inputs) = 0;
     Express::VARP forward(Express::VARP input);
+    /**
+     Run onForward on the internal worker pool without blocking the caller, under the executor of the calling
+     thread. Requests of the same module run in order and those of different modules run concurrently. The outputs
+     are copied out of the module, so they stay valid while the next request runs. The module must not be used by
+     onForward or destroyed meanwhile, Module::destroy waits for the requests. Return empty outputs if failed.
+     */
+    std::future<std::vector<Express::VARP>> forwardAsync(const std::vector<Express::VARP>& inputs);
+    // The callback is called on the worker thread, the next request runs after it returns
+    void forwardAsync(const std::vector<Express::VARP>& inputs, std::function<void(std::vector<Express::VARP>)> callback);
+    // Status of forwardAsync, float*, length >= 4: max concurrent requests of the worker pool, requests in flight,
+    // average / max time in ms from submit to start
+    void getAsyncInfo(float* info);
     std::vector<Express::VARP> parameters() const;
     bool loadParameters(const std::vector<Express::VARP>& parameters);
     void setIsTraining(const bool isTraining);
@@ -63,7 +78,11 @@ public:
         // The weights will be rearranged in a general way, so the best implementation
         // may not be adopted if `rearrange` is enabled.
         bool rearrange = false;
-        
+
+        // Map the model file instead of reading it when loading from file, const data are used in place
+        // and processes loading the same file share the pages. Disabled by default.
+        bool mapFile = false;
+
         BackendInfo* backend = nullptr;
     };
     static Module* load(const std::vector<std::string>& inputs, const std::vector<std::string>& outputs, const uint8_t* buffer, size_t length, const Config* config = nullptr);
@@ -76,6 +95,60 @@ public:
 
     static Module* clone(const Module* module, const bool shareParams = false);
 
+    struct BatchConfig {
+        // Max total batch of the merged forward
+        int maxBatch = 8;
+        // Max time in microseconds the first request waits for others
+        int maxWaitUs = 1000;
+    };
+    /**
+     Create a module which can be called from multiple threads. Concurrent onForward calls are concatenated
+     along dimension 0 and computed by one forward of the origin module, then the outputs are split back.
+     Requests whose inputs differ beside dimension 0 are computed separately. The origin module must support
+     resizing the batch, such as loaded with shapeMutable = true, and shouldn't be used elsewhere meanwhile.
+     */
+    static Module* createBatching(std::shared_ptr<Module> module, const BatchConfig& config);
+
+    struct StateConfig {
+        struct State {
+            // Name of the input which takes the state of previous steps, such as past key / value
+            std::string input;
+            // Name of the output which gives the state of current step only, it's appended to the state
+            std::string output;
+            // The axis along which the state grows, may be negative. The dimensions before it must be 1
+            int axis = 0;
+        };
+        std::vector<State> states;
+        // Initial capacity along the axis, the storage is doubled when it's full
+        int capacity = 64;
+    };
+    /**
+     Create a module for autoregressive decoding which keeps the states between onForward calls. The states are
+     removed from the inputs and outputs of the origin module, which must be loaded from a model for the names.
+     After each forward the output of current step is appended in place to the preallocated storage, and next
+     forward takes the whole state without copy. The axis must be outermost, all the dimensions before it are 1,
+     such as key / value cache in [1, seq, hidden] or [seq, head, dim]. Call clearCache() to begin a new sequence.
+     */
+    static Module* createStateful(std::shared_ptr<Module> module, const StateConfig& config);
+
+    struct TileConfig {
+        // Size of the tiles the first input is split into, rounded up to a multiple of the model's total stride
+        int tileHeight = 256;
+        int tileWidth  = 256;
+        // Tiles computed at the same time, the extra ones by clones of the module with their own single thread executor
+        int parallel = 1;
+    };
+    /**
+     Load a fully convolutional model, such as segmentation or super resolution, which runs over spatial tiles of
+     its first input so that the intermediate memory is bounded by the tile size instead of the image size. The
+     receptive field halo and the stride alignment are computed from the convolutions and poolings of the model,
+     each tile is extended by the halo, computed by the same resized module and the valid part of its outputs is
+     copied to the full outputs. Other inputs are passed to every tile. Return nullptr if the model has an op which
+     mixes spatial positions beyond a local window, such as global pooling, reshape or matmul. If the input is not a
+     multiple of the alignment or not larger than one tile, the module runs on the whole input.
+     */
+    static Module* loadTiled(const std::vector<std::string>& inputs, const std::vector<std::string>& outputs, const uint8_t* buffer, size_t length, const TileConfig& tileConfig, const std::shared_ptr<MNN::Express::Executor::RuntimeManager> rtMgr = nullptr, const Config* config = nullptr);
+
     struct Info {
         // Input info load from model
         std::vector<Variable::Info> inputs;
@@ -128,6 +201,43 @@ private:
     bool mIsTraining = true;
     std::string mName;
     std::string mType;
+    std::shared_ptr<MNN::AsyncQueue> mAsyncQueue;
+};
+
+/**
+ Thread safe pool of module instances for serving from many threads. Instances are cloned from the origin module
+ lazily up to maxInstance, sharing its constants and packed weights, and each one has its own executor so that they
+ can resize and run concurrently. The origin module is only used as the template for cloning.
+ */
+class MNN_PUBLIC ModulePool {
+public:
+    struct Config {
+        // Max instances created by the pool
+        int maxInstance = 4;
+        // Runtime for each instance
+        MNNForwardType type = MNN_FORWARD_CPU;
+        int numThread = 1;
+        BackendConfig backendConfig;
+    };
+    static ModulePool* create(std::shared_ptr<Module> module, const Config& config);
+    static void destroy(ModulePool* pool);
+    ~ModulePool();
+
+    /**
+     Check out an idle instance, create one if all are busy and the number is under maxInstance, otherwise wait
+     for one. The fast path only uses atomic operations. The instance is checked in when the returned pointer is
+     released, its outputs are valid until then, and it must be released before the pool.
+     Return nullptr if the module can't be cloned.
+     */
+    std::shared_ptr<Module> acquire();
+
+    // Number of created instances
+    int size() const;
+
+private:
+    ModulePool() = default;
+    struct Inside;
+    Inside* mInside = nullptr;
 };
 
 struct SubGraph {
@@ -172,6 +172,12 @@ MNN_PUBLIC VARP _Col2Im(VARP x, VARP outputShape, INTS kernelSize, INTS dilate,
  Onnx's Loop
  */
 MNN_PUBLIC VARPS _Loop(VARPS x, const std::string& submoduleName);
+/**
+ Fused attention: softmax(query * key^T * scale + mask) * value, the [seqQ, seqK] scores is not materialized.
+ query: [..., seqQ, dim], key: [..., seqK, dim] ([..., dim, seqK] if keyTransposed), value: [..., seqK, dimV]
+ mask: additive mask broadcastable to [..., seqQ, seqK], can be nullptr
+ */
+MNN_PUBLIC VARP _Attention(VARP query, VARP key, VARP value, VARP mask, float scale, bool keyTransposed = false);
 MNN_PUBLIC VARP _ROIPooling(VARP input, VARP roi, int pooledHeight, int pooledWidth, float spatialScale, bool outputGrad = false, VARP backwardDiff = nullptr);
 MNN_PUBLIC VARP _ROIAlign(VARP input, VARP roi, int pooledHeight, int pooledWidth, float spatialScale, int samplingRatio, bool aligned, PoolingMode poolType, bool outputGrad = false, VARP backwardDiff = nullptr);
 
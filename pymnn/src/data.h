@@ -136,15 +136,15 @@ class_basic_call_impl(DataLoader)
 class_basic_init_impl(DataLoader)
 static PyObject* PyMNNDataLoader_new(PyTypeObject *type, PyObject *args, PyObject *kwargs) {
     PyObject* dataset = nullptr;
-    int batch_size, num_workers = 0;
+    int batch_size, num_workers = 0, ring_depth = 0;
     int shuffle = 1;
-    static char *kwlist[] = { "dataset", "batch_size", "shuffle", "num_workers", NULL };
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "Oi|ii", kwlist, &dataset, &batch_size, &shuffle, &num_workers)) {
-        PyMNN_ERROR("DataLoader require args: Dataset, int, |int, int)");
+    static char *kwlist[] = { "dataset", "batch_size", "shuffle", "num_workers", "ring_depth", NULL };
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "Oi|iii", kwlist, &dataset, &batch_size, &shuffle, &num_workers, &ring_depth)) {
+        PyMNN_ERROR("DataLoader require args: Dataset, int, |int, int, int)");
     }
     std::shared_ptr<Dataset> dataset_ = std::move(toDataset(dataset));
     PyMNNDataLoader *self = (PyMNNDataLoader *)type->tp_alloc(type, 0);
-    self->ptr = DataLoader::makeDataLoader(dataset_, batch_size, true, shuffle, num_workers);
+    self->ptr = DataLoader::makeDataLoader(dataset_, batch_size, true, shuffle, num_workers, ring_depth);
     return (PyObject*)self;
 }
 static PyObject* PyMNNDataLoader_getiter_number(PyMNNDataLoader *self, void *closure) {
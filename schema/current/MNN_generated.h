@@ -261,11 +261,12 @@ enum OpType {
   OpType_If = 601,
   OpType_LayerNorm = 603,
   OpType_GridSample = 604,
+  OpType_Attention = 605,
   OpType_MIN = OpType_AbsVal,
-  OpType_MAX = OpType_GridSample
+  OpType_MAX = OpType_Attention
 };
 
-inline const OpType (&EnumValuesOpType())[175] {
+inline const OpType (&EnumValuesOpType())[176] {
   static const OpType values[] = {
     OpType_AbsVal,
     OpType_QuantizedAdd,
@@ -441,7 +442,8 @@ inline const OpType (&EnumValuesOpType())[175] {
     OpType_While,
     OpType_If,
     OpType_LayerNorm,
-    OpType_GridSample
+    OpType_GridSample,
+    OpType_Attention
   };
   return values;
 }
@@ -1053,13 +1055,14 @@ inline const char * const *EnumNamesOpType() {
     "",
     "LayerNorm",
     "GridSample",
+    "Attention",
     nullptr
   };
   return names;
 }
 
 inline const char *EnumNameOpType(OpType e) {
-  if (e < OpType_AbsVal || e > OpType_GridSample) return "";
+  if (e < OpType_AbsVal || e > OpType_Attention) return "";
   const size_t index = static_cast<int>(e);
   return EnumNamesOpType()[index];
 }
@@ -1160,11 +1163,12 @@ enum OpParameter {
   OpParameter_LoopParam = 92,
   OpParameter_ImageProcessParam = 93,
   OpParameter_CumSum = 94,
+  OpParameter_AttentionParam = 95,
   OpParameter_MIN = OpParameter_NONE,
-  OpParameter_MAX = OpParameter_CumSum
+  OpParameter_MAX = OpParameter_AttentionParam
 };
 
-inline const OpParameter (&EnumValuesOpParameter())[95] {
+inline const OpParameter (&EnumValuesOpParameter())[96] {
   static const OpParameter values[] = {
     OpParameter_NONE,
     OpParameter_QuantizedAdd,
@@ -1260,7 +1264,8 @@ inline const OpParameter (&EnumValuesOpParameter())[95] {
     OpParameter_GridSample,
     OpParameter_LoopParam,
     OpParameter_ImageProcessParam,
-    OpParameter_CumSum
+    OpParameter_CumSum,
+    OpParameter_AttentionParam
   };
   return values;
 }
@@ -1362,13 +1367,14 @@ inline const char * const *EnumNamesOpParameter() {
     "LoopParam",
     "ImageProcessParam",
     "CumSum",
+    "AttentionParam",
     nullptr
   };
   return names;
 }
 
 inline const char *EnumNameOpParameter(OpParameter e) {
-  if (e < OpParameter_NONE || e > OpParameter_CumSum) return "";
+  if (e < OpParameter_NONE || e > OpParameter_AttentionParam) return "";
   const size_t index = static_cast<int>(e);
   return EnumNamesOpParameter()[index];
 }
@@ -1753,6 +1759,10 @@ template<> struct OpParameterTraits<CumSum> {
   static const OpParameter enum_value = OpParameter_CumSum;
 };
 
+template<> struct OpParameterTraits<AttentionParam> {
+  static const OpParameter enum_value = OpParameter_AttentionParam;
+};
+
 struct OpParameterUnion {
   OpParameter type;
   void *value;
@@ -2536,6 +2546,14 @@ struct OpParameterUnion {
     return type == OpParameter_CumSum ?
       reinterpret_cast<const CumSumT *>(value) : nullptr;
   }
+  AttentionParamT *AsAttentionParam() {
+    return type == OpParameter_AttentionParam ?
+      reinterpret_cast<AttentionParamT *>(value) : nullptr;
+  }
+  const AttentionParamT *AsAttentionParam() const {
+    return type == OpParameter_AttentionParam ?
+      reinterpret_cast<const AttentionParamT *>(value) : nullptr;
+  }
 };
 
 bool VerifyOpParameter(flatbuffers::Verifier &verifier, const void *obj, OpParameter type);
@@ -3588,6 +3606,9 @@ struct Op FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   const CumSum *main_as_CumSum() const {
     return main_type() == OpParameter_CumSum ? static_cast<const CumSum *>(main()) : nullptr;
   }
+  const AttentionParam *main_as_AttentionParam() const {
+    return main_type() == OpParameter_AttentionParam ? static_cast<const AttentionParam *>(main()) : nullptr;
+  }
   const flatbuffers::String *name() const {
     return GetPointer<const flatbuffers::String *>(10);
   }
@@ -3996,6 +4017,10 @@ template<> inline const CumSum *Op::main_as<CumSum>() const {
   return main_as_CumSum();
 }
 
+template<> inline const AttentionParam *Op::main_as<AttentionParam>() const {
+  return main_as_AttentionParam();
+}
+
 struct OpBuilder {
   flatbuffers::FlatBufferBuilder &fbb_;
   flatbuffers::uoffset_t start_;
@@ -5614,6 +5639,10 @@ inline bool VerifyOpParameter(flatbuffers::Verifier &verifier, const void *obj,
       auto ptr = reinterpret_cast<const CumSum *>(obj);
       return verifier.VerifyTable(ptr);
     }
+    case OpParameter_AttentionParam: {
+      auto ptr = reinterpret_cast<const AttentionParam *>(obj);
+      return verifier.VerifyTable(ptr);
+    }
     default: return false;
   }
 }
@@ -6008,6 +6037,10 @@ inline void *OpParameterUnion::UnPack(const void *obj, OpParameter type, const f
       auto ptr = reinterpret_cast<const CumSum *>(obj);
       return ptr->UnPack(resolver);
     }
+    case OpParameter_AttentionParam: {
+      auto ptr = reinterpret_cast<const AttentionParam *>(obj);
+      return ptr->UnPack(resolver);
+    }
     default: return nullptr;
   }
 }
@@ -6390,6 +6423,10 @@ inline flatbuffers::Offset<void> OpParameterUnion::Pack(flatbuffers::FlatBufferB
       auto ptr = reinterpret_cast<const CumSumT *>(value);
       return CreateCumSum(_fbb, ptr, _rehasher).Union();
     }
+    case OpParameter_AttentionParam: {
+      auto ptr = reinterpret_cast<const AttentionParamT *>(value);
+      return CreateAttentionParam(_fbb, ptr, _rehasher).Union();
+    }
     default: return 0;
   }
 }
@@ -6772,6 +6809,10 @@ inline OpParameterUnion::OpParameterUnion(const OpParameterUnion &u) FLATBUFFERS
       value = new CumSumT(*reinterpret_cast<CumSumT *>(u.value));
       break;
     }
+    case OpParameter_AttentionParam: {
+      value = new AttentionParamT(*reinterpret_cast<AttentionParamT *>(u.value));
+      break;
+    }
     default:
       break;
   }
@@ -7249,6 +7290,11 @@ inline void OpParameterUnion::Reset() {
       delete ptr;
       break;
     }
+    case OpParameter_AttentionParam: {
+      auto ptr = reinterpret_cast<AttentionParamT *>(value);
+      delete ptr;
+      break;
+    }
     default: break;
   }
   value = nullptr;
@@ -7431,12 +7477,13 @@ inline const flatbuffers::TypeTable *OpTypeTypeTable() {
     { flatbuffers::ET_INT, 0, 0 },
     { flatbuffers::ET_INT, 0, 0 },
     { flatbuffers::ET_INT, 0, 0 },
+    { flatbuffers::ET_INT, 0, 0 },
     { flatbuffers::ET_INT, 0, 0 }
   };
   static const flatbuffers::TypeFunction type_refs[] = {
     OpTypeTypeTable
   };
-  static const int64_t values[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 62, 63, 64, 65, 66, 67, 68, 69, 70, 71, 72, 73, 74, 75, 76, 77, 78, 79, 80, 81, 82, 83, 84, 85, 86, 87, 88, 89, 90, 91, 92, 93, 94, 95, 96, 97, 98, 99, 100, 101, 102, 103, 104, 105, 106, 107, 108, 109, 110, 111, 112, 113, 114, 115, 116, 117, 118, 119, 120, 121, 122, 128, 129, 130, 131, 132, 133, 134, 135, 136, 137, 138, 139, 140, 141, 142, 143, 144, 145, 146, 147, 148, 149, 150, 151, 152, 153, 154, 256, 257, 258, 259, 260, 261, 262, 263, 264, 265, 266, 267, 268, 269, 512, 513, 514, 515, 516, 517, 518, 600, 601, 603, 604 };
+  static const int64_t values[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 62, 63, 64, 65, 66, 67, 68, 69, 70, 71, 72, 73, 74, 75, 76, 77, 78, 79, 80, 81, 82, 83, 84, 85, 86, 87, 88, 89, 90, 91, 92, 93, 94, 95, 96, 97, 98, 99, 100, 101, 102, 103, 104, 105, 106, 107, 108, 109, 110, 111, 112, 113, 114, 115, 116, 117, 118, 119, 120, 121, 122, 128, 129, 130, 131, 132, 133, 134, 135, 136, 137, 138, 139, 140, 141, 142, 143, 144, 145, 146, 147, 148, 149, 150, 151, 152, 153, 154, 256, 257, 258, 259, 260, 261, 262, 263, 264, 265, 266, 267, 268, 269, 512, 513, 514, 515, 516, 517, 518, 600, 601, 603, 604, 605 };
   static const char * const names[] = {
     "AbsVal",
     "QuantizedAdd",
@@ -7612,10 +7659,11 @@ inline const flatbuffers::TypeTable *OpTypeTypeTable() {
     "While",
     "If",
     "LayerNorm",
-    "GridSample"
+    "GridSample",
+    "Attention"
   };
   static const flatbuffers::TypeTable tt = {
-    flatbuffers::ST_ENUM, 175, type_codes, type_refs, values, names
+    flatbuffers::ST_ENUM, 176, type_codes, type_refs, values, names
   };
   return &tt;
 }
@@ -7716,7 +7764,8 @@ inline const flatbuffers::TypeTable *OpParameterTypeTable() {
     { flatbuffers::ET_SEQUENCE, 0, 90 },
     { flatbuffers::ET_SEQUENCE, 0, 91 },
     { flatbuffers::ET_SEQUENCE, 0, 92 },
-    { flatbuffers::ET_SEQUENCE, 0, 93 }
+    { flatbuffers::ET_SEQUENCE, 0, 93 },
+    { flatbuffers::ET_SEQUENCE, 0, 94 }
   };
   static const flatbuffers::TypeFunction type_refs[] = {
     QuantizedAddTypeTable,
@@ -7812,7 +7861,8 @@ inline const flatbuffers::TypeTable *OpParameterTypeTable() {
     GridSampleTypeTable,
     LoopParamTypeTable,
     ImageProcessParamTypeTable,
-    CumSumTypeTable
+    CumSumTypeTable,
+    AttentionParamTypeTable
   };
   static const char * const names[] = {
     "NONE",
@@ -7909,10 +7959,11 @@ inline const flatbuffers::TypeTable *OpParameterTypeTable() {
     "GridSample",
     "LoopParam",
     "ImageProcessParam",
-    "CumSum"
+    "CumSum",
+    "AttentionParam"
   };
   static const flatbuffers::TypeTable tt = {
-    flatbuffers::ST_UNION, 95, type_codes, type_refs, nullptr, names
+    flatbuffers::ST_UNION, 96, type_codes, type_refs, nullptr, names
   };
   return &tt;
 }
@@ -19,12 +19,17 @@ struct GridSampleT;
 struct ImageProcessParam;
 struct ImageProcessParamT;
 
+struct AttentionParam;
+struct AttentionParamT;
+
 inline const flatbuffers::TypeTable *TensorConvertInfoTypeTable();
 
 inline const flatbuffers::TypeTable *GridSampleTypeTable();
 
 inline const flatbuffers::TypeTable *ImageProcessParamTypeTable();
 
+inline const flatbuffers::TypeTable *AttentionParamTypeTable();
+
 enum SampleMode {
   SampleMode_BILINEAR = 0,
   SampleMode_NEAREST = 1,
@@ -528,6 +533,71 @@ inline flatbuffers::Offset<ImageProcessParam> CreateImageProcessParam(
 
 flatbuffers::Offset<ImageProcessParam> CreateImageProcessParam(flatbuffers::FlatBufferBuilder &_fbb, const ImageProcessParamT *_o, const flatbuffers::rehasher_function_t *_rehasher = nullptr);
 
+struct AttentionParamT : public flatbuffers::NativeTable {
+  typedef AttentionParam TableType;
+  float scale;
+  bool keyTransposed;
+  AttentionParamT()
+      : scale(1.0f),
+        keyTransposed(false) {
+  }
+};
+
+struct AttentionParam FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  typedef AttentionParamT NativeTableType;
+  static const flatbuffers::TypeTable *MiniReflectTypeTable() {
+    return AttentionParamTypeTable();
+  }
+  float scale() const {
+    return GetField<float>(4, 1.0f);
+  }
+  bool keyTransposed() const {
+    return GetField<uint8_t>(6, 0) != 0;
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyField<float>(verifier, 4) &&
+           VerifyField<uint8_t>(verifier, 6) &&
+           verifier.EndTable();
+  }
+  AttentionParamT *UnPack(const flatbuffers::resolver_function_t *_resolver = nullptr) const;
+  void UnPackTo(AttentionParamT *_o, const flatbuffers::resolver_function_t *_resolver = nullptr) const;
+  static flatbuffers::Offset<AttentionParam> Pack(flatbuffers::FlatBufferBuilder &_fbb, const AttentionParamT* _o, const flatbuffers::rehasher_function_t *_rehasher = nullptr);
+};
+
+struct AttentionParamBuilder {
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_scale(float scale) {
+    fbb_.AddElement<float>(4, scale, 1.0f);
+  }
+  void add_keyTransposed(bool keyTransposed) {
+    fbb_.AddElement<uint8_t>(6, static_cast<uint8_t>(keyTransposed), 0);
+  }
+  explicit AttentionParamBuilder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  AttentionParamBuilder &operator=(const AttentionParamBuilder &);
+  flatbuffers::Offset<AttentionParam> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = flatbuffers::Offset<AttentionParam>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<AttentionParam> CreateAttentionParam(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    float scale = 1.0f,
+    bool keyTransposed = false) {
+  AttentionParamBuilder builder_(_fbb);
+  builder_.add_scale(scale);
+  builder_.add_keyTransposed(keyTransposed);
+  return builder_.Finish();
+}
+
+flatbuffers::Offset<AttentionParam> CreateAttentionParam(flatbuffers::FlatBufferBuilder &_fbb, const AttentionParamT *_o, const flatbuffers::rehasher_function_t *_rehasher = nullptr);
+
 inline TensorConvertInfoT *TensorConvertInfo::UnPack(const flatbuffers::resolver_function_t *_resolver) const {
   auto _o = new TensorConvertInfoT();
   UnPackTo(_o, _resolver);
@@ -645,6 +715,35 @@ inline flatbuffers::Offset<ImageProcessParam> CreateImageProcessParam(flatbuffer
       _draw);
 }
 
+inline AttentionParamT *AttentionParam::UnPack(const flatbuffers::resolver_function_t *_resolver) const {
+  auto _o = new AttentionParamT();
+  UnPackTo(_o, _resolver);
+  return _o;
+}
+
+inline void AttentionParam::UnPackTo(AttentionParamT *_o, const flatbuffers::resolver_function_t *_resolver) const {
+  (void)_o;
+  (void)_resolver;
+  { auto _e = scale(); _o->scale = _e; };
+  { auto _e = keyTransposed(); _o->keyTransposed = _e; };
+}
+
+inline flatbuffers::Offset<AttentionParam> AttentionParam::Pack(flatbuffers::FlatBufferBuilder &_fbb, const AttentionParamT* _o, const flatbuffers::rehasher_function_t *_rehasher) {
+  return CreateAttentionParam(_fbb, _o, _rehasher);
+}
+
+inline flatbuffers::Offset<AttentionParam> CreateAttentionParam(flatbuffers::FlatBufferBuilder &_fbb, const AttentionParamT *_o, const flatbuffers::rehasher_function_t *_rehasher) {
+  (void)_rehasher;
+  (void)_o;
+  struct _VectorArgs { flatbuffers::FlatBufferBuilder *__fbb; const AttentionParamT* __o; const flatbuffers::rehasher_function_t *__rehasher; } _va = { &_fbb, _o, _rehasher}; (void)_va;
+  auto _scale = _o->scale;
+  auto _keyTransposed = _o->keyTransposed;
+  return MNN::CreateAttentionParam(
+      _fbb,
+      _scale,
+      _keyTransposed);
+}
+
 inline const flatbuffers::TypeTable *SampleModeTypeTable() {
   static const flatbuffers::TypeCode type_codes[] = {
     { flatbuffers::ET_CHAR, 0, 0 },
@@ -845,6 +944,21 @@ inline const flatbuffers::TypeTable *ImageProcessParamTypeTable() {
   return &tt;
 }
 
+inline const flatbuffers::TypeTable *AttentionParamTypeTable() {
+  static const flatbuffers::TypeCode type_codes[] = {
+    { flatbuffers::ET_FLOAT, 0, -1 },
+    { flatbuffers::ET_BOOL, 0, -1 }
+  };
+  static const char * const names[] = {
+    "scale",
+    "keyTransposed"
+  };
+  static const flatbuffers::TypeTable tt = {
+    flatbuffers::ST_TABLE, 2, type_codes, nullptr, nullptr, names
+  };
+  return &tt;
+}
+
 }  // namespace MNN
 
 #endif  // FLATBUFFERS_GENERATED_USERDEFINE_MNN_H_
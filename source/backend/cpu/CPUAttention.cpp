@@ -0,0 +1,202 @@
+//
+//  CPUAttention.cpp
+//  MNN
+//
+//  Created by MNN on 2021/12/10.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include "backend/cpu/CPUAttention.hpp"
+#include <float.h>
+#include <math.h>
+#include <string.h>
+#include "backend/cpu/CPUBackend.hpp"
+#include "backend/cpu/compute/CommonOptFunction.h"
+#include "core/Concurrency.h"
+#include "core/Macro.h"
+
+// Query rows computed together, they share the loaded key / value block
+#define ATTENTION_QUERY_TILE 4
+// Keys computed each step, the scores of a tile is ATTENTION_QUERY_TILE x ATTENTION_KEY_BLOCK
+#define ATTENTION_KEY_BLOCK 64
+
+namespace MNN {
+
+CPUAttention::CPUAttention(Backend* b, float scale, bool keyTransposed) : Execution(b) {
+    mScale         = scale;
+    mKeyTransposed = keyTransposed;
+}
+
+ErrorCode CPUAttention::onResize(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs) {
+    auto query = inputs[0];
+    auto key   = inputs[1];
+    auto value = inputs[2];
+    auto dims  = query->dimensions();
+    mBatch     = 1;
+    for (int i = 0; i < dims - 2; ++i) {
+        mBatch *= query->length(i);
+    }
+    mSeqQ = query->length(dims - 2);
+    mDim  = query->length(dims - 1);
+    mSeqK = mKeyTransposed ? key->length(dims - 1) : key->length(dims - 2);
+    mDimV = value->length(dims - 1);
+
+    mMaskBatchOffset.clear();
+    mMaskRowStride = 0;
+    mMaskColStride = 0;
+    if (inputs.size() > 3) {
+        // Align mask dimensions to [..., seqQ, seqK] from the right
+        auto mask      = inputs[3];
+        auto maskDims  = mask->dimensions();
+        std::vector<int> strides(dims, 0);
+        int stride = 1;
+        for (int i = maskDims - 1; i >= 0; --i) {
+            auto outIndex = i + dims - maskDims;
+            if (mask->length(i) > 1) {
+                strides[outIndex] = stride;
+            }
+            stride *= mask->length(i);
+        }
+        mMaskRowStride = strides[dims - 2];
+        mMaskColStride = strides[dims - 1];
+        mMaskBatchOffset.resize(mBatch);
+        for (int b = 0; b < mBatch; ++b) {
+            int offset = 0;
+            int index  = b;
+            for (int i = dims - 3; i >= 0; --i) {
+                offset += (index % query->length(i)) * strides[i];
+                index /= query->length(i);
+            }
+            mMaskBatchOffset[b] = offset;
+        }
+    }
+
+    mThreadNumber = static_cast<CPUBackend*>(backend())->threadNumber();
+    // scores, output accumulator, running max and running sum for each thread
+    int threadSize = ATTENTION_QUERY_TILE * (ATTENTION_KEY_BLOCK + mDimV + 2);
+    mTempBuffer.reset(Tensor::createDevice<float>({mThreadNumber, threadSize}));
+    auto res = backend()->onAcquireBuffer(mTempBuffer.get(), Backend::DYNAMIC);
+    if (!res) {
+        return OUT_OF_MEMORY;
+    }
+    backend()->onReleaseBuffer(mTempBuffer.get(), Backend::DYNAMIC);
+    return NO_ERROR;
+}
+
+ErrorCode CPUAttention::onExecute(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs) {
+    auto queryPtr = inputs[0]->host<float>();
+    auto keyPtr   = inputs[1]->host<float>();
+    auto valuePtr = inputs[2]->host<float>();
+    const float* maskPtr = inputs.size() > 3 ? inputs[3]->host<float>() : nullptr;
+    auto outputPtr = outputs[0]->host<float>();
+    auto seqQ = mSeqQ, seqK = mSeqK, dim = mDim, dimV = mDimV;
+    auto scale         = mScale;
+    auto keyTransposed = mKeyTransposed;
+    int queryTileCount = UP_DIV(seqQ, ATTENTION_QUERY_TILE);
+    int totalWork      = mBatch * queryTileCount;
+    int threadSize     = mTempBuffer->length(1);
+    const float expOffset[] = {1.0f, 0.0f};
+
+    MNN_CONCURRENCY_BEGIN(tId, mThreadNumber) {
+        auto scores = mTempBuffer->host<float>() + tId * threadSize;
+        auto accum  = scores + ATTENTION_QUERY_TILE * ATTENTION_KEY_BLOCK;
+        auto maxV   = accum + ATTENTION_QUERY_TILE * dimV;
+        auto sumV   = maxV + ATTENTION_QUERY_TILE;
+        for (int work = (int)tId; work < totalWork; work += mThreadNumber) {
+            int b         = work / queryTileCount;
+            int rowStart  = (work % queryTileCount) * ATTENTION_QUERY_TILE;
+            int rowCount  = ALIMIN(ATTENTION_QUERY_TILE, seqQ - rowStart);
+            auto query    = queryPtr + ((size_t)b * seqQ + rowStart) * dim;
+            auto key      = keyPtr + (size_t)b * seqK * dim;
+            auto value    = valuePtr + (size_t)b * seqK * dimV;
+            const float* mask = nullptr;
+            if (nullptr != maskPtr) {
+                mask = maskPtr + mMaskBatchOffset[b] + rowStart * mMaskRowStride;
+            }
+            ::memset(accum, 0, rowCount * dimV * sizeof(float));
+            for (int r = 0; r < rowCount; ++r) {
+                maxV[r] = -FLT_MAX;
+                sumV[r] = 0.0f;
+            }
+            for (int kStart = 0; kStart < seqK; kStart += ATTENTION_KEY_BLOCK) {
+                int kCount = ALIMIN(ATTENTION_KEY_BLOCK, seqK - kStart);
+                // scores = query * key^T * scale + mask
+                if (keyTransposed) {
+                    // key: [dim, seqK], vectorize along keys
+                    for (int r = 0; r < rowCount; ++r) {
+                        auto dst = scores + r * ATTENTION_KEY_BLOCK;
+                        auto q   = query + r * dim;
+                        ::memset(dst, 0, kCount * sizeof(float));
+                        for (int d = 0; d < dim; ++d) {
+                            MNNVectorScaleAdd(dst, key + (size_t)d * seqK + kStart, 1.0f, q[d], kCount);
+                        }
+                    }
+                } else {
+                    for (int j = 0; j < kCount; ++j) {
+                        auto k = key + (size_t)(kStart + j) * dim;
+                        for (int r = 0; r < rowCount; ++r) {
+                            scores[r * ATTENTION_KEY_BLOCK + j] = MNNVectorDot(query + r * dim, k, dim);
+                        }
+                    }
+                }
+                for (int r = 0; r < rowCount; ++r) {
+                    auto dst = scores + r * ATTENTION_KEY_BLOCK;
+                    float blockMax = -FLT_MAX;
+                    for (int j = 0; j < kCount; ++j) {
+                        dst[j] = dst[j] * scale;
+                        if (nullptr != mask) {
+                            dst[j] += mask[r * mMaskRowStride + (kStart + j) * mMaskColStride];
+                        }
+                        blockMax = ALIMAX(blockMax, dst[j]);
+                    }
+                    // Online softmax: rescale the previous result by exp(oldMax - newMax)
+                    float newMax = ALIMAX(maxV[r], blockMax);
+                    for (int j = 0; j < kCount; ++j) {
+                        dst[j] = dst[j] - newMax;
+                    }
+                    MNNExp(dst, dst, expOffset, kCount);
+                    float blockSum = 0.0f;
+                    for (int j = 0; j < kCount; ++j) {
+                        blockSum += dst[j];
+                    }
+                    float correct = expf(maxV[r] - newMax);
+                    maxV[r]       = newMax;
+                    sumV[r]       = sumV[r] * correct + blockSum;
+                    auto acc      = accum + r * dimV;
+                    MNNVectorScaleAdd(acc, value + (size_t)kStart * dimV, correct, dst[0], dimV);
+                    for (int j = 1; j < kCount; ++j) {
+                        MNNVectorScaleAdd(acc, value + (size_t)(kStart + j) * dimV, 1.0f, dst[j], dimV);
+                    }
+                }
+            }
+            auto dst = outputPtr + ((size_t)b * seqQ + rowStart) * dimV;
+            for (int r = 0; r < rowCount; ++r) {
+                float invSum = 1.0f / sumV[r];
+                ::memset(dst + r * dimV, 0, dimV * sizeof(float));
+                MNNVectorScaleAdd(dst + r * dimV, accum + r * dimV, 1.0f, invSum, dimV);
+            }
+        }
+    }
+    MNN_CONCURRENCY_END();
+    return NO_ERROR;
+}
+
+class CPUAttentionCreator : public CPUBackend::Creator {
+public:
+    virtual Execution* onCreate(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs,
+                                const MNN::Op* op, Backend* backend) const override {
+        if (inputs.size() > 3 && inputs[3]->getType() != halide_type_of<float>()) {
+            MNN_ERROR("Attention only support float mask, code = %d, bits = %d\n", inputs[3]->getType().code, inputs[3]->getType().bits);
+            return nullptr;
+        }
+        auto param = op->main_as_AttentionParam();
+        if (nullptr == param) {
+            return new CPUAttention(backend, 1.0f, false);
+        }
+        return new CPUAttention(backend, param->scale(), param->keyTransposed());
+    }
+};
+
+REGISTER_CPU_OP_CREATOR(CPUAttentionCreator, OpType_Attention);
+
+} // namespace MNN
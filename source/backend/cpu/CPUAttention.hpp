@@ -0,0 +1,45 @@
+//
+//  CPUAttention.hpp
+//  MNN
+//
+//  Created by MNN on 2021/12/10.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#ifndef CPUAttention_hpp
+#define CPUAttention_hpp
+
+#include "core/Execution.hpp"
+#include "MNN_generated.h"
+
+namespace MNN {
+/**
+ softmax(query * key^T * scale + mask) * value, computed tile by tile with online softmax,
+ so that the [seqQ, seqK] score matrix is never materialized.
+ */
+class CPUAttention : public Execution {
+public:
+    CPUAttention(Backend *b, float scale, bool keyTransposed);
+    virtual ~CPUAttention() = default;
+    virtual ErrorCode onResize(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
+    virtual ErrorCode onExecute(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
+
+private:
+    float mScale;
+    bool mKeyTransposed;
+    int mBatch   = 0;
+    int mSeqQ    = 0;
+    int mSeqK    = 0;
+    int mDim     = 0;
+    int mDimV    = 0;
+    int mThreadNumber = 1;
+    // Mask offset for each batch and strides for seqQ / seqK, stride is zero for broadcast dimension
+    std::vector<int> mMaskBatchOffset;
+    int mMaskRowStride = 0;
+    int mMaskColStride = 0;
+    std::shared_ptr<Tensor> mTempBuffer;
+};
+
+} // namespace MNN
+
+#endif /* CPUAttention_hpp */
@@ -10,6 +10,7 @@
 #include <cmath>
 #include <mutex>
 #include "CPUResizeCache.hpp"
+#include "CPUWeightCache.hpp"
 #include "core/BufferAllocator.hpp"
 #include "CPUTensorConvert.hpp"
 #include "compute/CommonOptFunction.h"
@@ -50,20 +51,44 @@ ErrorCode CastWrapExecution::onExecute(const std::vector<Tensor*>& inputs, const
 }
 
 CPURuntime::CPURuntime(const Backend::Info& info) {
-    mStaticAllocator.reset(new BufferAllocator(BufferAllocator::Allocator::createDefault()));
+    mWeightCache.reset(new CPUWeightCache);
     mThreadNumber = info.numThread;
     mThreadNumber = std::max(1, mThreadNumber);
     mThreadNumber = std::min(mThreadNumber, MAX_THREAD_NUMBER);
     mPower   = BackendConfig::Power_Normal;
     mMemory  = BackendConfig::Memory_Normal;
     mPrecision = BackendConfig::Precision_Normal;
-    mFlops = MNNGetCPUFlops(mThreadNumber);
+    std::vector<int> cpuIds;
     if (info.user != nullptr) {
         mPrecision = info.user->precision;
         mPower = info.user->power;
         mMemory = info.user->memory;
         mFlags = info.user->flags;
+        cpuIds = info.user->cpuIds;
+        mNumaNode = info.user->numaNode;
+    }
+    if (cpuIds.empty() && mNumaNode >= 0) {
+        cpuIds = MNNGetNUMANodeCPUs(mNumaNode);
+        if (cpuIds.empty()) {
+            MNN_ERROR("Can't find the CPUs of NUMA node %d, don't bind the runtime\n", mNumaNode);
+            mNumaNode = -1;
+        }
+    }
+    if (!cpuIds.empty()) {
+        if (mNumaNode < 0) {
+            mNumaNode = MNNGetCPUNUMANode(cpuIds[0]);
+        }
+        mThreadNumber = std::min(mThreadNumber, (int)cpuIds.size());
+        cpuIds.resize(mThreadNumber);
+    }
+    if (nullptr != info.user && info.user->hugePage) {
+        mStaticAllocator.reset(new BufferAllocator(BufferAllocator::Allocator::createHugePage(mNumaNode)));
+    } else if (mNumaNode >= 0) {
+        mStaticAllocator.reset(new BufferAllocator(BufferAllocator::Allocator::createNUMA(mNumaNode)));
+    } else {
+        mStaticAllocator.reset(new BufferAllocator(BufferAllocator::Allocator::createDefault()));
     }
+    mFlops = MNNGetCPUFlops(mThreadNumber);
 
 #ifdef _OPENMP
     switch (mPower) {
@@ -78,14 +103,18 @@ CPURuntime::CPURuntime(const Backend::Info& info) {
     }
 #endif
 #ifdef MNN_USE_THREAD_POOL
-    mThreadNumber = ThreadPool::init(mThreadNumber);
+    if (!cpuIds.empty() && mThreadNumber > 1) {
+        mThreadPool = ThreadPool::createBound(cpuIds);
+    } else {
+        mThreadNumber = ThreadPool::init(mThreadNumber);
+    }
     if (mThreadNumber > 1) {
-        mTaskIndex = ThreadPool::acquireWorkIndex();
+        mTaskIndex = ThreadPool::acquireWorkIndex(mThreadPool.get());
     } else {
         mTaskIndex = -1;
     }
     if (mTaskIndex >= 0 && mPower == BackendConfig::Power_High) {
-        ThreadPool::active();
+        ThreadPool::active(mThreadPool.get());
     }
 #endif
 #ifdef LOG_VERBOSE
@@ -95,9 +124,9 @@ CPURuntime::CPURuntime(const Backend::Info& info) {
 CPURuntime:: ~ CPURuntime() {
 #ifdef MNN_USE_THREAD_POOL
     if (mTaskIndex >= 0 && mPower == BackendConfig::Power_High) {
-        ThreadPool::deactive();
+        ThreadPool::deactive(mThreadPool.get());
     }
-    ThreadPool::releaseWorkIndex(mTaskIndex);
+    ThreadPool::releaseWorkIndex(mTaskIndex, mThreadPool.get());
 #endif
 }
 float CPURuntime::onGetMemoryInMB() {
@@ -167,11 +196,23 @@ void CPURuntime::onGabageCollect(int level) {
     mStaticAllocator->release(false);
 }
 
+bool CPURuntime::onSetCache(const void* buffer, size_t size) {
+    return mWeightCache->setCache(buffer, size);
+}
+
+void CPURuntime::onSetCacheRecord(bool record) {
+    mWeightCache->setRecord(record);
+}
+
+std::pair<const void*, size_t> CPURuntime::onGetCache() {
+    return mWeightCache->getCache();
+}
+
 
 void CPURuntime::onConcurrencyBegin() const {
 #ifdef MNN_USE_THREAD_POOL
     if (mTaskIndex >= 0 && mPower != BackendConfig::Power_High) {
-        ThreadPool::active();
+        ThreadPool::active(mThreadPool.get());
     }
 #else
 #ifdef _OPENMP
@@ -184,7 +225,7 @@ void CPURuntime::onConcurrencyBegin() const {
 void CPURuntime::onConcurrencyEnd() const {
 #ifdef MNN_USE_THREAD_POOL
     if (mTaskIndex >= 0 && mPower != BackendConfig::Power_High) {
-        ThreadPool::deactive();
+        ThreadPool::deactive(mThreadPool.get());
     }
 #endif
 }
@@ -217,6 +258,7 @@ CPUBackend::CPUBackend(const CPURuntime* runtime, BackendConfig::PrecisionMode p
     mCoreFunctions = MNNGetCoreFunctions();
     mInt8CoreFunctions = MNNGetInt8CoreFunctions();
     mCache = new CPUResizeCache;
+    mMemoryPlan = std::make_pair(0, 0);
 }
 
 CPUBackend::~CPUBackend() {
@@ -231,6 +273,78 @@ void CPUBackend::onExecuteEnd() const {
     mRuntime->onConcurrencyEnd();
 }
 
+void CPUBackend::onResizeBegin() {
+    if (mReplayPlan) {
+        mDynamicAllocator->beginReplay();
+    }
+    if (mRecordPlan) {
+        mDynamicAllocator->beginRecord();
+    }
+}
+
+void CPUBackend::onResizeEnd() {
+    if (mReplayPlan) {
+        mReplayPlan = false;
+        if (!mDynamicAllocator->endReplay()) {
+            MNN_PRINT("Memory plan is not matched in resize, part of buffers use free list\n");
+        }
+    }
+    if (!mRecordPlan) {
+        mMemoryPlan = std::make_pair(0, 0);
+        return;
+    }
+    auto plannedSize = mDynamicAllocator->endRecord();
+    mMemoryPlan = std::make_pair(mDynamicAllocator->totalSize(), plannedSize);
+}
+
+void CPUBackend::onRecordMemory(bool record) {
+    mRecordPlan = record;
+}
+
+std::pair<size_t, size_t> CPUBackend::onPlanMemory(bool bind) {
+    mReplayPlan = bind && mMemoryPlan.second < mMemoryPlan.first;
+    if (mReplayPlan) {
+        // Memory of last resize is released in next onClearBuffer, return it to system so that the arena can reuse it
+        mReleaseStatic = true;
+    }
+    return mMemoryPlan;
+}
+
+void CPUBackend::onResizeBarrier(bool begin) {
+    if (begin) {
+        mDynamicAllocator->barrierBegin();
+    } else {
+        mDynamicAllocator->barrierEnd();
+    }
+}
+
+void CPUBackend::onResizeGroup(bool begin) {
+    if (begin) {
+        mDynamicAllocator->beginGroup();
+        // The temp tensor in cache is filled by the execution which creates it, the execution of another group may
+        // run before it, so each group use its own cache. The tensors are kept until onClearBuffer
+        std::shared_ptr<CPUResizeCache> cache(new CPUResizeCache);
+        mGroupCaches.emplace_back(cache);
+        mOuterCaches.emplace_back(mCache);
+        mCache = cache.get();
+    } else {
+        mDynamicAllocator->endGroup();
+        mCache = mOuterCaches.back();
+        mOuterCaches.pop_back();
+    }
+}
+
+bool CPUBackend::onConcurrentRun(const std::function<void(int)>& task, int number) const {
+#ifdef MNN_USE_THREAD_POOL
+    if (taskIndex() >= 0 && threadNumber() > 1) {
+        // Tasks are spread over the workers, the parallel compute inside one task steals the idle workers
+        ThreadPool::enqueue(std::make_pair(task, number), taskIndex(), threadPool());
+        return true;
+    }
+#endif
+    return false;
+}
+
 class CPUMemObj : public Backend::MemObj {
 public:
     CPUMemObj(BufferAllocator* allocator, std::pair<void*, int> points, int size) {
@@ -239,7 +353,9 @@ public:
         mSize = size;
     }
     virtual ~ CPUMemObj() {
-        mAllocator->free(mPoint);
+        if (nullptr != mAllocator) {
+            mAllocator->free(mPoint);
+        }
     }
     inline int getSize() const {
         return mSize;
@@ -250,6 +366,10 @@ private:
     int mSize;
 };
 
+Backend::MemObj* CPUBackend::createReferenceMemObj(int size) {
+    return new CPUMemObj(nullptr, std::make_pair(nullptr, 0), size);
+}
+
 Backend::MemObj* CPUBackend::allocBuffer(int size, Tensor* dest, StorageType storageType) {
     auto originMem = TensorUtils::getDescribe(dest)->mem.get();
     if (nullptr != originMem) {
@@ -412,7 +532,12 @@ const Runtime* CPUBackend::getRuntime() {
 
 bool CPUBackend::onClearBuffer() {
     mCache->reset();
+    mGroupCaches.clear();
     mDynamicAllocator->release(true);
+    if (mReleaseStatic) {
+        mReleaseStatic = false;
+        mStaticAllocator->release(false);
+    }
     return true;
 }
 
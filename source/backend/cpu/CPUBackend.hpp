@@ -17,6 +17,8 @@
 
 namespace MNN {
 class BufferAllocator;
+class CPUWeightCache;
+class ThreadPool;
 class CPURuntime : public Runtime {
 public:
     friend class CPUBackend;
@@ -29,13 +31,21 @@ public:
     virtual CompilerType onGetCompilerType() const override {
         return Compiler_Loop;
     }
+    virtual bool onSetCache(const void* buffer, size_t size) override;
+    virtual void onSetCacheRecord(bool record) override;
+    virtual std::pair<const void*, size_t> onGetCache() override;
     void onConcurrencyBegin() const;
     void onConcurrencyEnd() const;
 
 private:
     std::shared_ptr<BufferAllocator> mStaticAllocator;
+    std::shared_ptr<CPUWeightCache> mWeightCache;
     int mThreadNumber;
     mutable int mTaskIndex;
+    // Pool bound to the CPUs of BackendConfig, nullptr for the shared one
+    std::shared_ptr<ThreadPool> mThreadPool;
+    // NUMA node of the memory, -1 if not bound
+    int mNumaNode = -1;
     BackendConfig::MemoryMode mMemory;
     BackendConfig::PowerMode mPower;
     BackendConfig::PrecisionMode mPrecision;
@@ -67,6 +77,13 @@ public:
 
     virtual void onExecuteBegin() const override;
     virtual void onExecuteEnd() const override;
+    virtual void onResizeBegin() override;
+    virtual void onResizeEnd() override;
+    virtual void onRecordMemory(bool record) override;
+    virtual std::pair<size_t, size_t> onPlanMemory(bool bind) override;
+    virtual void onResizeBarrier(bool begin) override;
+    virtual void onResizeGroup(bool begin) override;
+    virtual bool onConcurrentRun(const std::function<void(int)>& task, int number) const override;
 
     const CoreFunctions* functions() const {
         return mCoreFunctions;
@@ -102,15 +119,22 @@ public:
     CPUResizeCache* getCache() const {
         return mCache;
     }
+    // Packed weight cache shared by the backends of one runtime
+    CPUWeightCache* getWeightCache() const {
+        return mRuntime->mWeightCache.get();
+    }
 
     virtual const Runtime* getRuntime() override;
 
 #ifdef MNN_USE_THREAD_POOL
     inline int taskIndex() const {return mRuntime->mTaskIndex;}
+    inline ThreadPool* threadPool() const {return mRuntime->mThreadPool.get();}
 #endif
     static void initCreatorMap();
     static int getBytes(const Backend* backend, const Tensor* output);
     static DataType getDataType(const Tensor* tensor);
+    // Wrap memory not owned by backend, such as mapped model data, it won't be freed on release
+    static MemObj* createReferenceMemObj(int size);
 
 
 protected:
@@ -125,6 +149,14 @@ private:
     BackendConfig::MemoryMode mMemory;
     static std::map<OpType, CPUBackend::Creator*>* gCreator;
     CPUResizeCache* mCache;
+    // Caches of the groups resized for concurrent execution and the caches outside them, see onResizeGroup
+    std::vector<std::shared_ptr<CPUResizeCache>> mGroupCaches;
+    std::vector<CPUResizeCache*> mOuterCaches;
+    // Dynamic memory allocated in last resize and the planned peak by live range
+    std::pair<size_t, size_t> mMemoryPlan;
+    bool mReplayPlan = false;
+    bool mRecordPlan = false;
+    bool mReleaseStatic = false;
 };
 /** execution cast wrapper. insert tensor cast dynamic. */
 class CastWrapExecution : public Execution {
@@ -0,0 +1,162 @@
+//
+//  CPUFuse.cpp
+//  MNN
+//
+//  Created by MNN on 2023/02/20.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include "backend/cpu/CPUFuse.hpp"
+#include "backend/cpu/CPUBackend.hpp"
+#include "compute/CommonOptFunction.h"
+#include "core/Concurrency.h"
+#include "core/Macro.h"
+#ifdef MNN_CODEGEN_CPU
+#include <dlfcn.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <sstream>
+#endif
+
+namespace MNN {
+#ifdef MNN_CODEGEN_CPU
+static bool _readFile(const std::string& path, std::string& content) {
+    std::ifstream input(path);
+    if (!input.good()) {
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << input.rdbuf();
+    content = buffer.str();
+    return true;
+}
+
+static CPUFuse::Kernel _openKernel(const std::string& library, const std::string& name) {
+    auto handle = dlopen(library.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (nullptr == handle) {
+        return nullptr;
+    }
+    auto kernel = (CPUFuse::Kernel)dlsym(handle, (name + "_run").c_str());
+    if (nullptr == kernel) {
+        dlclose(handle);
+    }
+    return kernel;
+}
+
+static CPUFuse::Kernel _compileKernel(const std::string& source, const std::string& name) {
+    mkdir(MNN_CODEGEN_CPU_CACHE, 0755);
+    char hash[32];
+    snprintf(hash, sizeof(hash), "%016llx", (unsigned long long)std::hash<std::string>()(source));
+    auto base       = std::string(MNN_CODEGEN_CPU_CACHE) + "/" + hash;
+    auto sourcePath = base + ".c";
+    auto library    = base + ".so";
+    // Compiled by this or another process before, the source is compared in case of hash collision
+    std::string cached;
+    if (_readFile(sourcePath, cached) && cached == source) {
+        auto kernel = _openKernel(library, name);
+        if (nullptr != kernel) {
+            return kernel;
+        }
+    }
+    // Other processes may use the cache at the same time, so compile to the files of this process and rename them
+    auto suffix = "." + std::to_string(getpid());
+    {
+        std::ofstream output(sourcePath + suffix);
+        output << source;
+        if (!output.good()) {
+            MNN_ERROR("Can't write fused kernel to %s\n", MNN_CODEGEN_CPU_CACHE);
+            return nullptr;
+        }
+    }
+    auto command = std::string(MNN_CODEGEN_CPU_COMPILER) + " -O3 -march=native -ffast-math -fPIC -shared -x c -o " +
+                   library + suffix + " " + sourcePath + suffix + " -lm";
+    if (0 != system(command.c_str())) {
+        MNN_ERROR("Compile fused kernel %s failed\n", name.c_str());
+        unlink((sourcePath + suffix).c_str());
+        unlink((library + suffix).c_str());
+        return nullptr;
+    }
+    rename((library + suffix).c_str(), library.c_str());
+    rename((sourcePath + suffix).c_str(), sourcePath.c_str());
+    return _openKernel(library, name);
+}
+#endif
+
+CPUFuse::Kernel CPUFuse::load(const std::string& source, const std::string& name) {
+#ifdef MNN_CODEGEN_CPU
+    // The kernels are kept for the life of the process, failed sources are kept too so that they are not compiled again
+    static std::mutex gMutex;
+    static std::map<std::string, Kernel> gKernels;
+    std::lock_guard<std::mutex> _l(gMutex);
+    auto iter = gKernels.find(source);
+    if (iter != gKernels.end()) {
+        return iter->second;
+    }
+    auto kernel = _compileKernel(source, name);
+    gKernels.insert(std::make_pair(source, kernel));
+    return kernel;
+#else
+    return nullptr;
+#endif
+}
+
+CPUFuse::CPUFuse(Backend* backend, Kernel kernel) : Execution(backend), mKernel(kernel) {
+    // nothing to do
+}
+
+ErrorCode CPUFuse::onExecute(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs) {
+    // All the inputs are scalar or have the same shape and format as the outputs
+    auto size     = static_cast<CPUBackend*>(backend())->getTensorSize(outputs[0]);
+    auto schedule = static_cast<CPUBackend*>(backend())->multiThreadDivide(size);
+    std::vector<float*> inputPtrs(inputs.size());
+    std::vector<float*> outputPtrs(outputs.size());
+    for (int i = 0; i < inputs.size(); ++i) {
+        inputPtrs[i] = inputs[i]->host<float>();
+    }
+    for (int i = 0; i < outputs.size(); ++i) {
+        outputPtrs[i] = outputs[i]->host<float>();
+    }
+    auto kernel    = mKernel;
+    auto inputPtr  = inputPtrs.data();
+    auto outputPtr = outputPtrs.data();
+    MNN_CONCURRENCY_BEGIN(tId, schedule.second) {
+        int start = schedule.first * (int)tId;
+        int end   = std::min(start + schedule.first, size);
+        if (tId == schedule.second - 1) {
+            end = size;
+        }
+        if (start < end) {
+            kernel(inputPtr, outputPtr, start, end);
+        }
+    }
+    MNN_CONCURRENCY_END();
+    return NO_ERROR;
+}
+
+class CPUFuseCreator : public CPUBackend::Creator {
+public:
+    virtual Execution* onCreate(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs,
+                                const MNN::Op* op, Backend* backend) const override {
+        auto extra = op->main_as_Extra();
+        if (nullptr == extra || nullptr == extra->type() || nullptr == extra->info()) {
+            return nullptr;
+        }
+        // The kernels compute in float
+        if (static_cast<CPUBackend*>(backend)->functions()->bytes != 4) {
+            return nullptr;
+        }
+        auto source = std::string(reinterpret_cast<const char*>(extra->info()->data()));
+        auto kernel = CPUFuse::load(source, extra->type()->str());
+        if (nullptr == kernel) {
+            return nullptr;
+        }
+        return new CPUFuse(backend, kernel);
+    }
+};
+
+REGISTER_CPU_OP_CREATOR(CPUFuseCreator, OpType_Extra);
+} // namespace MNN
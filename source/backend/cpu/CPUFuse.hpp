@@ -0,0 +1,33 @@
+//
+//  CPUFuse.hpp
+//  MNN
+//
+//  Created by MNN on 2023/02/20.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#ifndef CPUFuse_hpp
+#define CPUFuse_hpp
+
+#include <string>
+#include "core/Execution.hpp"
+
+namespace MNN {
+// Elementwise ops fused by codegen/OpFuse, run by the C kernel compiled at runtime
+class CPUFuse : public Execution {
+public:
+    // Compute the elements in [start, end) of all the outputs
+    typedef void (*Kernel)(float** inputs, float** outputs, long start, long end);
+    // Load the kernel of the source from the process cache or the cache directory, compile it if not found.
+    // Return nullptr if codegen for cpu is not built or the compile fails
+    MNN_PUBLIC static Kernel load(const std::string& source, const std::string& name);
+
+    CPUFuse(Backend* backend, Kernel kernel);
+    virtual ~CPUFuse() = default;
+    virtual ErrorCode onExecute(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs) override;
+
+private:
+    Kernel mKernel;
+};
+} // namespace MNN
+#endif /* CPUFuse_hpp */
@@ -11,6 +11,7 @@
 #include <string.h>
 #include <mutex>
 #include "core/Macro.h"
+#include "core/TensorUtils.hpp"
 #ifdef MNN_USE_NEON
 #include <arm_neon.h>
 #endif
@@ -325,6 +326,22 @@ ErrorCode CPUImageProcess::onResize(const std::vector<Tensor *> &inputs, const s
             samplerDest = samplerBuffer.get();
         }
     }
+    // Float NCHW / NC4HW4 outputs are written plane by plane, so that the consumer (usually the first convolution)
+    // reads them without another layout conversion
+    mPack = 0;
+    if (dtype.code == halide_type_float) {
+        auto format = TensorUtils::getDescribe(output)->dimensionFormat;
+        if (MNN_DATA_FORMAT_NC4HW4 == format) {
+            mPack = backend() ? static_cast<CPUBackend*>(backend())->functions()->pack : 4;
+            if (4 == mPack && oc <= 4) {
+                // Only one plane, its pixels are the same as 4 channel ones
+                mPack = 0;
+                oc    = 4;
+            }
+        } else if (MNN_DATA_FORMAT_NCHW == format && oc > 1) {
+            mPack = 1;
+        }
+    }
     // choose float blitter
     if (dtype.code == halide_type_float) {
         blitFloat = choose(destFormat, oc);
@@ -339,10 +356,38 @@ ErrorCode CPUImageProcess::onResize(const std::vector<Tensor *> &inputs, const s
             blitBuffer.reset(new uint8_t[4 * CACHE_SIZE]);
             blitDest = blitBuffer.get();
         }
+        if (mPack > 0) {
+            if (backend()) {
+                cacheBufferPack.reset(Tensor::createDevice<float>(std::vector<int>{4 * CACHE_SIZE}));
+                backend()->onAcquireBuffer(cacheBufferPack.get(), Backend::DYNAMIC);
+                packDest = cacheBufferPack->host<float>();
+            } else {
+                packBuffer.reset(new float[4 * CACHE_SIZE]);
+                packDest = packBuffer.get();
+            }
+        }
     }
     return NO_ERROR;
 }
 
+// Scatter a tile of interleaved pixels into the planes of pack channels, the last plane is padded with zero
+static void _scatterPlanes(const float* source, float* dest, int count, int channel, int pack, size_t planeStride) {
+    int planes = UP_DIV(channel, pack);
+    for (int z = 0; z < planes; ++z) {
+        auto dstZ  = dest + z * planeStride;
+        auto srcZ  = source + z * pack;
+        int valid  = std::min(pack, channel - z * pack);
+        if (valid < pack) {
+            ::memset(dstZ, 0, count * pack * sizeof(float));
+        }
+        for (int x = 0; x < count; ++x) {
+            for (int c = 0; c < valid; ++c) {
+                dstZ[x * pack + c] = srcZ[x * channel + c];
+            }
+        }
+    }
+}
+
 ErrorCode CPUImageProcess::onExecute(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) {
     if (0 == mStride) {
         mStride = iw * ic;
@@ -439,7 +484,13 @@ ErrorCode CPUImageProcess::onExecute(const std::vector<Tensor *> &inputs, const
             }
             // Turn float
             if (blitFloat) {
-                blitFloat(blitDest, (float*)dstStart, mean, normal, count);
+                if (mPack > 0) {
+                    blitFloat(blitDest, packDest, mean, normal, count);
+                    _scatterPlanes(packDest, (float*)dest + ((size_t)dy * ow + xStart) * mPack, count, oc, mPack,
+                                   (size_t)oh * ow * mPack);
+                } else {
+                    blitFloat(blitDest, (float*)dstStart, mean, normal, count);
+                }
             }
         }
     }
@@ -88,6 +88,11 @@ private:
     std::shared_ptr<Tensor> cacheBuffer, cacheBufferRGBA;
     std::unique_ptr<uint8_t[]> samplerBuffer, blitBuffer;
     uint8_t* samplerDest = nullptr, *blitDest = nullptr;
+    // Channels per plane of a float NCHW (1) / NC4HW4 (pack) output, 0 for interleaved
+    int mPack = 0;
+    std::shared_ptr<Tensor> cacheBufferPack;
+    std::unique_ptr<float[]> packBuffer;
+    float* packDest = nullptr;
     const CoreFunctions* coreFunctions = nullptr;
     bool draw = false;
     int mStride = 0;
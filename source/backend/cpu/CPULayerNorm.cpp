@@ -12,6 +12,7 @@
 #include "core/Concurrency.h"
 #include "core/OpCommonUtils.hpp"
 #include "backend/cpu/CPUBackend.hpp"
+#include "backend/cpu/CPULayerNormInt8.hpp"
 #include "backend/cpu/compute/CommonOptFunction.h"
 #include "MNN_generated.h"
 
@@ -138,6 +139,9 @@ public:
     Execution* onCreate(const std::vector<Tensor*>& inputs,
                         const std::vector<Tensor*>& outputs,
                         const MNN::Op* op, Backend* backend) const override {
+        if (CPUBackend::getDataType(outputs[0]) == DataType_DT_INT8) {
+            return new CPULayerNormInt8(op, backend);
+        }
         return new CPULayerNorm(op, backend);
     }
 };
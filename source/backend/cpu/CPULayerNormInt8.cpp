@@ -0,0 +1,117 @@
+//
+//  CPULayerNormInt8.cpp
+//  MNN
+//
+//  Created by MNN on 2022/01/10.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <cmath>
+#include "backend/cpu/CPULayerNormInt8.hpp"
+#include "backend/cpu/CPUBackend.hpp"
+#include "core/Concurrency.h"
+#include "core/Macro.h"
+#include "core/OpCommonUtils.hpp"
+#include "core/TensorUtils.hpp"
+
+namespace MNN {
+#ifdef MNN_USE_SSE
+// Int8 tensors are stored as uint8 with offset 128 on x86
+typedef uint8_t StorageType;
+static const int kStorageOffset = 128;
+#else
+typedef int8_t StorageType;
+static const int kStorageOffset = 0;
+#endif
+CPULayerNormInt8::CPULayerNormInt8(const MNN::Op* op, Backend* backend) : Execution(backend) {
+    const auto* param = op->main_as_LayerNorm();
+    mAxisSize = param->axis()->size();
+    mGroup    = param->group();
+    mEpsilon  = param->epsilon();
+    if (USE_EXTERNAL_DATA(param)) {
+        auto size = static_cast<int>(param->external()->Get(1) / sizeof(float));
+        mGamma.resize(size);
+        mBeta.resize(size);
+        OpCommonUtils::loadExternalDatas(backend, {(char*)mGamma.data(), (char*)mBeta.data()}, param->external()->data());
+        return;
+    }
+    if (param->gamma() && param->beta()) {
+        mGamma.assign(param->gamma()->begin(), param->gamma()->end());
+        mBeta.assign(param->beta()->begin(), param->beta()->end());
+    }
+}
+
+ErrorCode CPULayerNormInt8::onResize(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs) {
+    auto input       = inputs[0];
+    auto inputQuant  = TensorUtils::getDescribe(input)->quantAttr.get();
+    auto outputQuant = TensorUtils::getDescribe(outputs[0])->quantAttr.get();
+    if (nullptr == inputQuant || nullptr == outputQuant) {
+        return NOT_SUPPORT;
+    }
+    mOutside = 1;
+    mInside  = 1;
+    int rank = input->dimensions();
+    if (mGroup > 1) {
+        mOutside = input->length(0) * mGroup;
+        for (int i = 1; i < rank; i++) {
+            mInside *= input->length(i);
+        }
+        mInside /= mGroup;
+    } else {
+        for (int i = 0; i < rank - mAxisSize; ++i) {
+            mOutside *= input->length(i);
+        }
+        for (int i = rank - mAxisSize; i < rank; ++i) {
+            mInside *= input->length(i);
+        }
+    }
+    bool hasGammaBeta = !mGamma.empty();
+    if (hasGammaBeta && ((int)mGamma.size() < mInside || (int)mBeta.size() < mInside)) {
+        MNN_ERROR("Size of gamma and beta are less than the normalized size in CPULayerNormInt8.\n");
+        return INPUT_DATA_ERROR;
+    }
+    float outputScale = outputQuant->scale == 0.f ? 0.f : 1.0f / outputQuant->scale;
+    mScaledGamma.resize(mInside);
+    mScaledBeta.resize(mInside);
+    for (int i = 0; i < mInside; ++i) {
+        mScaledGamma[i] = (hasGammaBeta ? mGamma[i] : 1.0f) * outputScale;
+        mScaledBeta[i]  = (hasGammaBeta ? mBeta[i] : 0.0f) * outputScale + outputQuant->zero;
+    }
+    mInputScale = inputQuant->scale;
+    mOutputMin  = outputQuant->min;
+    mOutputMax  = outputQuant->max;
+    return NO_ERROR;
+}
+
+ErrorCode CPULayerNormInt8::onExecute(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs) {
+    auto src          = inputs[0]->host<StorageType>();
+    auto dst          = outputs[0]->host<StorageType>();
+    const int inside  = mInside;
+    auto gamma        = mScaledGamma.data();
+    auto beta         = mScaledBeta.data();
+    MNN_CONCURRENCY_BEGIN(tId, mOutside) {
+        auto srcRow = src + tId * inside;
+        auto dstRow = dst + tId * inside;
+        // The input zero point and the storage offset cancel out in x - mean, so the stored values are used
+        int64_t sum   = 0;
+        int64_t sumSq = 0;
+        for (int i = 0; i < inside; ++i) {
+            int v = srcRow[i];
+            sum += v;
+            sumSq += v * v;
+        }
+        // n^2 * variance in the int8 domain, exact in integer
+        int64_t varianceN2 = sumSq * inside - sum * sum;
+        float variance     = (float)varianceN2 / ((float)inside * (float)inside) * mInputScale * mInputScale;
+        float a = mInputScale / sqrtf(variance + mEpsilon);
+        float b = -(float)sum / (float)inside * a;
+        for (int i = 0; i < inside; ++i) {
+            float value = roundf(((float)srcRow[i] * a + b) * gamma[i] + beta[i]);
+            value = std::min(std::max(value, mOutputMin), mOutputMax);
+            dstRow[i] = (StorageType)((int)value + kStorageOffset);
+        }
+    }
+    MNN_CONCURRENCY_END();
+    return NO_ERROR;
+}
+} // namespace MNN
@@ -0,0 +1,45 @@
+//
+//  CPULayerNormInt8.hpp
+//  MNN
+//
+//  Created by MNN on 2022/01/10.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#ifndef CPULayerNormInt8_hpp
+#define CPULayerNormInt8_hpp
+
+#include "core/Execution.hpp"
+#include "MNN_generated.h"
+
+namespace MNN {
+/**
+ Int8 in / int8 out layer norm for the tensors not in NC4HW4. The mean and variance of each row are computed from
+ the integer sum and sum of squares of the int8 values, which are exact, then gamma / beta and the output scale are
+ folded into one multiply and add per element.
+ */
+class CPULayerNormInt8 : public Execution {
+public:
+    CPULayerNormInt8(const MNN::Op* op, Backend* backend);
+    virtual ~CPULayerNormInt8() = default;
+    virtual ErrorCode onResize(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs) override;
+    virtual ErrorCode onExecute(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs) override;
+
+private:
+    int mAxisSize  = 0;
+    int mGroup     = 1;
+    float mEpsilon = 0.001f;
+    int mInside    = 1;
+    int mOutside   = 1;
+    std::vector<float> mGamma;
+    std::vector<float> mBeta;
+    // gamma / outputScale and beta / outputScale + outputZero for each element of the row
+    std::vector<float> mScaledGamma;
+    std::vector<float> mScaledBeta;
+    float mInputScale;
+    float mOutputMin;
+    float mOutputMax;
+};
+} // namespace MNN
+
+#endif /* CPULayerNormInt8_hpp */
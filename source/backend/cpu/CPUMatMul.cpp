@@ -20,11 +20,17 @@
 using Vec4 = MNN::Math::Vec<float, 4>;
 namespace MNN {
 
-CPUMatMul::CPUMatMul(Backend* backend, bool transposeA, bool transposeB, bool transposeC, bool multiThread)
-    : Execution(backend), mTransposeA(transposeA), mTransposeB(transposeB), mTransposeC(transposeC), mSupportMultiThread(multiThread) {
+CPUMatMul::CPUMatMul(Backend* backend, bool transposeA, bool transposeB, bool transposeC, bool multiThread, bool constantB)
+    : Execution(backend), mTransposeA(transposeA), mTransposeB(transposeB), mTransposeC(transposeC), mSupportMultiThread(multiThread), mConstantB(constantB) {
     mComputer.reset(new StrassenMatrixComputor(backend, mSupportMultiThread, 5));
 }
 
+CPUMatMul::~CPUMatMul() {
+    if (nullptr != mPackedB) {
+        backend()->onReleaseBuffer(mPackedB.get(), Backend::STATIC);
+    }
+}
+
 void CPUMatMul::_scheduleForVecE(int e, int l, int h) {
     int numberThread = mSupportMultiThread ? static_cast<CPUBackend*>(backend())->threadNumber() : 1;
     MNN_ASSERT(e == 1);
@@ -92,19 +98,44 @@ ErrorCode CPUMatMul::onResize(const std::vector<Tensor*>& inputs, const std::vec
     core->MNNGetMatMulPackMode(&eP, &lP, &hP);
     auto bufferAlloc = static_cast<CPUBackend*>(backend())->getBufferAllocator();
     auto ATPtrAlloc = bufferAlloc->alloc(UP_DIV(l, core->pack) * e * core->pack * core->bytes);
-    auto BTPtrAlloc = bufferAlloc->alloc(UP_DIV(h, hP) * UP_DIV(l, lP) * lP * hP * core->bytes);
+    int BTSize      = UP_DIV(h, hP) * UP_DIV(l, lP) * lP * hP * core->bytes;
+    std::pair<void*, size_t> BTPtrAlloc(nullptr, 0);
+    uint8_t* BTPtr  = nullptr;
+    if (mConstantB) {
+        mBPacked = false;
+        if (nullptr == mPackedB || mPackedB->length(0) != BTSize) {
+            if (nullptr != mPackedB) {
+                backend()->onReleaseBuffer(mPackedB.get(), Backend::STATIC);
+            }
+            mPackedB.reset(Tensor::createDevice<uint8_t>({BTSize}));
+            if (!backend()->onAcquireBuffer(mPackedB.get(), Backend::STATIC)) {
+                mPackedB.reset();
+                return OUT_OF_MEMORY;
+            }
+        }
+        BTPtr = mPackedB->host<uint8_t>();
+    } else {
+        BTPtrAlloc = bufferAlloc->alloc(BTSize);
+        if (nullptr == BTPtrAlloc.first) {
+            return OUT_OF_MEMORY;
+        }
+        BTPtr = (uint8_t*)BTPtrAlloc.first + BTPtrAlloc.second;
+    }
     auto CTPtrAlloc = bufferAlloc->alloc(UP_DIV(h, core->pack) * e * core->pack * core->bytes);
-    if (nullptr == ATPtrAlloc.first || nullptr == BTPtrAlloc.first || nullptr == CTPtrAlloc.first) {
+    if (nullptr == ATPtrAlloc.first || nullptr == CTPtrAlloc.first) {
         return OUT_OF_MEMORY;
     }
-    auto BTPtr = (uint8_t*)BTPtrAlloc.first + BTPtrAlloc.second;
     auto ATPtr = (uint8_t*)ATPtrAlloc.first + ATPtrAlloc.second;
     auto CTPtr = (uint8_t*)CTPtrAlloc.first + CTPtrAlloc.second;
 
     float* BTempPtr = (float*)BTPtr;
     int numberThread = mSupportMultiThread ? ((CPUBackend*)backend())->threadNumber() : 1;
     mPreFunctions.emplace_back(std::make_pair([BTempPtr, l, h, this, core] (int tId, const float* APtr, const float* BPtr, const float* Bias) {
+        if (mBPacked) {
+            return;
+        }
         core->MNNPackForMatMul_B(BTempPtr, BPtr, h, l, mTransposeB);
+        mBPacked = mConstantB;
     } , 1));
     if (mTransposeA) {
         // l, e -> lC4, e, 4
@@ -183,7 +214,9 @@ ErrorCode CPUMatMul::onResize(const std::vector<Tensor*>& inputs, const std::vec
         }, 1));
     }
     bufferAlloc->free(ATPtrAlloc);
-    bufferAlloc->free(BTPtrAlloc);
+    if (nullptr != BTPtrAlloc.first) {
+        bufferAlloc->free(BTPtrAlloc);
+    }
     bufferAlloc->free(CTPtrAlloc);
     return NO_ERROR;
 }
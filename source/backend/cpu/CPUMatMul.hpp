@@ -17,8 +17,9 @@ namespace MNN {
 
 class CPUMatMul : public Execution {
 public:
-    CPUMatMul(Backend *backend, bool transposeA, bool transposeB, bool transposeC, bool multiThread);
-    virtual ~CPUMatMul() = default;
+    // If constantB, B is packed into a static buffer on the first execute after resize and reused by the later ones
+    CPUMatMul(Backend *backend, bool transposeA, bool transposeB, bool transposeC, bool multiThread, bool constantB = false);
+    virtual ~CPUMatMul();
     virtual ErrorCode onResize(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
     virtual ErrorCode onExecute(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
     void execute(const float* APtr, const float* BPtr, float* CPtr, const float* BiasPtr);
@@ -34,6 +35,9 @@ private:
     std::vector<std::pair<std::function<void(int, const float*, const float*, const float*, float*)>, int>> mPostFunctions;
     std::shared_ptr<StrassenMatrixComputor> mComputer;
     bool mStrassenUseBiasDirectly = false;
+    bool mConstantB = false;
+    bool mBPacked   = false;
+    std::shared_ptr<Tensor> mPackedB;
 };
 } // namespace MNN
 
@@ -28,6 +28,7 @@ extern void ___CPUPoolCreator__OpType_Pooling__();
 extern void ___CPUDetCreator__OpType_Det__();
 extern void ___CPUHistogramCreator__OpType_Histogram__();
 extern void ___CPUPluginCreator__OpType_Plugin__();
+extern void ___CPUFuseCreator__OpType_Extra__();
 extern void ___CPUInt8ToFloatCreator__OpType_Int8ToFloat__();
 extern void ___CPUROIAlignCreator__OpType_ROIAlign__();
 extern void ___CPUROIPoolingCreator__OpType_ROIPooling__();
@@ -66,6 +67,7 @@ extern void ___CPUSetDiff1DCreator__OpType_SetDiff1D__();
 extern void ___CPUEltwiseInt8Creator__OpType_EltwiseInt8__();
 extern void ___CPUSvdCreator__OpType_Svd__();
 extern void ___CPULayerNormCreator__OpType_LayerNorm__();
+extern void ___CPUAttentionCreator__OpType_Attention__();
 
 void registerCPUOps() {
 ___CPUCropAndResizeCreator__OpType_CropAndResize__();
@@ -96,6 +98,7 @@ ___CPUPoolCreator__OpType_Pooling__();
 ___CPUDetCreator__OpType_Det__();
 ___CPUHistogramCreator__OpType_Histogram__();
 ___CPUPluginCreator__OpType_Plugin__();
+___CPUFuseCreator__OpType_Extra__();
 ___CPUInt8ToFloatCreator__OpType_Int8ToFloat__();
 ___CPUROIAlignCreator__OpType_ROIAlign__();
 ___CPUROIPoolingCreator__OpType_ROIPooling__();
@@ -134,5 +137,6 @@ ___CPUSetDiff1DCreator__OpType_SetDiff1D__();
 ___CPUEltwiseInt8Creator__OpType_EltwiseInt8__();
 ___CPUSvdCreator__OpType_Svd__();
 ___CPULayerNormCreator__OpType_LayerNorm__();
+___CPUAttentionCreator__OpType_Attention__();
 }
 }
@@ -9,8 +9,9 @@
 #include "backend/cpu/CPURNNSequenceGRU.hpp"
 #include <math.h>
 #include "backend/cpu/CPUBackend.hpp"
-#include "backend/cpu/compute/ConvOpt.h"
-#include "math/Matrix.hpp"
+#include "backend/cpu/compute/CommonOptFunction.h"
+#include "core/Concurrency.h"
+#include "core/Macro.h"
 #include "core/TensorUtils.hpp"
 
 namespace MNN {
@@ -19,102 +20,26 @@ static inline float sigmoid(float x) {
     return 1. / (1. + expf(-x));
 }
 
-static inline void ArrayProduct(float* C, float* A, float* B, const int length) {
-    int numUnit4 = length >> 2;
-    if (numUnit4 > 0) {
-        MNNMatrixProd(C, A, B, numUnit4, 0, 0, 0, 1);
-    }
-    for (int i = numUnit4 << 2; i < length; i++) {
-        C[i] = A[i] * B[i];
-    }
-    return;
-}
-
-static inline void ArrayAdd(float* C, float* A, float* B, const int length) {
-    int numUnit4 = length >> 2;
-    if (numUnit4 > 0) {
-        MNNMatrixAdd(C, A, B, numUnit4, 0, 0, 0, 1);
-    }
-    for (int i = numUnit4 << 2; i < length; i++) {
-        C[i] = A[i] + B[i];
-    }
-    return;
-}
-
-// implement GRU cell function
-// Ref: tensorflow/python/ops/rnn_cell_impl.py
-static void runRNNStep(const float* input, const int inputLength, const bool linearBeforeReset,
-                       std::shared_ptr<Tensor>& hiddenState, const int numUnits, Tensor* gateWeight, Tensor* gateBias,
-                       Tensor* candidateWeight, Tensor* candidateBias, Tensor* recurrentBias,
-                       std::shared_ptr<Tensor>& inputAndState, std::shared_ptr<Tensor>& gate,
-                       std::shared_ptr<Tensor>& resetHt) {
-    // gate is (z_t, r_t)
-    auto inputAndStatePtr = inputAndState->host<float>();
-    auto hiddenStatePtr   = hiddenState->host<float>();
-    ::memcpy(inputAndStatePtr, input, inputLength * sizeof(float));
-    ::memcpy(inputAndStatePtr + inputLength, hiddenStatePtr, numUnits * sizeof(float));
-    inputAndState->setLength(1, inputLength + numUnits);
-    // to be fused
-    // // [x_t, h_t-1] * [W_zr, R_zr]: (1, inputLength + numUnits) X (inputLength + numUnits, 2 * numUnits)
-    Math::Matrix::multi(gate.get(), inputAndState.get(), gateWeight);
-    Math::Matrix::add(gate.get(), gate.get(), gateBias);
-
-    recurrentBias->setLength(1, 2 * numUnits);
-    Math::Matrix::add(gate.get(), gate.get(), recurrentBias);
-    // (1, 2*numUnits)
-    const int gateSize = gate->elementSize();
-    auto gatePtr       = gate->host<float>();
-    for (int i = 0; i < gateSize; ++i) {
-        gatePtr[i] = sigmoid(gatePtr[i]);
-    }
-    // reset gate, // r_t is the second segment
-    auto rtPtr = gatePtr + numUnits;
-
-    if (linearBeforeReset) {
-        // calculate Rt (.) (Ht_1 * Rh + Rbh)
-        auto recurrentHiddenBiasPtr = recurrentBias->host<float>() + 2 * numUnits;
-        auto rhWeightPtr = candidateWeight->host<float>() + inputLength * numUnits;
-        Tensor* rhWeight = Tensor::create({numUnits, numUnits}, candidateWeight->getType(), (void*)(rhWeightPtr), TensorUtils::getDimType(candidateWeight));
-        Math::Matrix::multi(resetHt.get(), hiddenState.get(), rhWeight);
-        ArrayAdd(resetHt->host<float>(), resetHt->host<float>(), recurrentHiddenBiasPtr, numUnits),
-        ArrayProduct(resetHt->host<float>(), rtPtr, resetHt->host<float>(), numUnits);
-
-        // calculate Xt * Wh
-        Tensor* XtWhTensor = Tensor::create({1, numUnits}, inputAndState->getType(), (void*)(inputAndStatePtr + inputLength + numUnits), TensorUtils::getDimType(inputAndState.get()));
-        Tensor* inputTensor = Tensor::create({1, inputLength}, inputAndState->getType(), (void*)(input), TensorUtils::getDimType(inputAndState.get()));
-        candidateWeight->setLength(0, inputLength);
-        Math::Matrix::multi(XtWhTensor, inputTensor, candidateWeight);
-        // sum 3 parts
-        ArrayAdd(resetHt->host<float>(), resetHt->host<float>(), XtWhTensor->host<float>(), numUnits);
-        ArrayAdd(rtPtr, resetHt->host<float>(), candidateBias->host<float>(), numUnits),
-        candidateWeight->setLength(0, inputLength + numUnits);
-
-        // release wrapper
-        delete rhWeight;
-        delete XtWhTensor;
-        delete inputTensor;
-    } else {
-        // r_t: (1, numUnits)
-        auto resetGatePtr = inputAndStatePtr + inputLength;
-        // h_t1(1, numUnits) = r_t(1, numUnits) * h_t-1_(1, numUnits)
-        ArrayProduct(resetGatePtr, rtPtr, hiddenStatePtr, numUnits);
-        // deal with recurrent bias and linear_before_reset parameter
-        auto recurrentBiasAddedPtr = inputAndStatePtr + inputLength + numUnits;
-        auto recurrentHiddenBiasPtr = recurrentBias->host<float>() + 2 * numUnits;
-
-        ArrayAdd(recurrentBiasAddedPtr, recurrentHiddenBiasPtr, candidateBias->host<float>(), numUnits);
-        // [x_t, h_t1](1, inputLength + numUnits) * candidateWeight_(inputLength + numUnits, numUnits)
-        Math::Matrix::multi(resetHt.get(), inputAndState.get(), candidateWeight);
-        // reuse r_t memory as h_t'
-        ArrayAdd(rtPtr, resetHt->host<float>(), recurrentBiasAddedPtr, numUnits);
-    }
-
-    for (int i = 0; i < numUnits; ++i) {
-        hiddenStatePtr[i] =
-            (1 - gatePtr[i]) * tanhf(rtPtr[i]) + gatePtr[i] * hiddenStatePtr[i];
+// Units are divided into slabs, slab s owns [s * slabUnit, s * slabUnit + w) and is stored from numUnits * 3 * s * slabUnit:
+// [numUnits, 3 * w] of (R_z, R_r, R_h) for linearBeforeReset, otherwise [numUnits, 2 * w] of (R_z, R_r) and then
+// [numUnits, w] of R_h, which is multiplied by r_t * h_t-1 after the reset gate of all units are computed.
+static void _packRecurrentWeight(float* dst, const float* gateWeight, const float* candidateWeight, int inputLength,
+                                 int numUnits, int slabNumber, int slabUnit, bool linearBeforeReset) {
+    for (int s = 0; s < slabNumber; ++s) {
+        int start     = s * slabUnit;
+        int w         = ALIMIN(slabUnit, numUnits - start);
+        auto slab     = dst + numUnits * 3 * start;
+        int gateCols  = linearBeforeReset ? 3 * w : 2 * w;
+        auto hSlab    = linearBeforeReset ? slab + 2 * w : slab + numUnits * gateCols;
+        int hStride   = linearBeforeReset ? gateCols : w;
+        for (int k = 0; k < numUnits; ++k) {
+            auto gateSrc = gateWeight + (inputLength + k) * 2 * numUnits;
+            auto candSrc = candidateWeight + (inputLength + k) * numUnits;
+            ::memcpy(slab + k * gateCols, gateSrc + start, w * sizeof(float));
+            ::memcpy(slab + k * gateCols + w, gateSrc + numUnits + start, w * sizeof(float));
+            ::memcpy(hSlab + k * hStride, candSrc + start, w * sizeof(float));
+        }
     }
-
-    inputAndState->setLength(1, inputLength + 2 * numUnits);
 }
 
 CPURNNSequenceGRU::CPURNNSequenceGRU(const Op* op, Backend* backend) : MNN::Execution(backend) {
@@ -127,28 +52,78 @@ CPURNNSequenceGRU::CPURNNSequenceGRU(const Op* op, Backend* backend) : MNN::Exec
 }
 
 CPURNNSequenceGRU::~CPURNNSequenceGRU() {
-    // Do nothing
+    for (auto t : {mInputWeight.get(), mInputBias.get(), mRecurrentWeight.get()}) {
+        if (nullptr != t) {
+            backend()->onReleaseBuffer(t, Backend::STATIC);
+        }
+    }
 }
 
 ErrorCode CPURNNSequenceGRU::onResize(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs) {
     MNN_ASSERT(1 + 5 * (mIsBidirectionalRNN + 1) <= inputs.size());
     auto input                 = inputs[0];
+    const int seqLength        = input->length(0);
+    const int batchSize        = input->length(1);
     const int inputLastDimSize = input->length(2);
-    mHiddenState.reset(Tensor::createDevice<float>(std::vector<int>{1, mNumUnits}));
-    mInputAndState.reset(Tensor::createDevice<float>(std::vector<int>{1, inputLastDimSize + mNumUnits + mNumUnits}));
-    mGate.reset(Tensor::createDevice<float>(std::vector<int>{1, 2 * mNumUnits}));
-    mResetHt.reset(Tensor::createDevice<float>(std::vector<int>{1, mNumUnits}));
-
-    backend()->onAcquireBuffer(mHiddenState.get(), Backend::DYNAMIC);
-    backend()->onAcquireBuffer(mInputAndState.get(), Backend::DYNAMIC);
-    backend()->onAcquireBuffer(mGate.get(), Backend::DYNAMIC);
-    backend()->onAcquireBuffer(mResetHt.get(), Backend::DYNAMIC);
-
-    backend()->onReleaseBuffer(mHiddenState.get(), Backend::DYNAMIC);
-    backend()->onReleaseBuffer(mInputAndState.get(), Backend::DYNAMIC);
-    backend()->onReleaseBuffer(mGate.get(), Backend::DYNAMIC);
-    backend()->onReleaseBuffer(mResetHt.get(), Backend::DYNAMIC);
-
+    const int direction        = mIsBidirectionalRNN ? 2 : 1;
+    const int gateLength       = direction * 3 * mNumUnits;
+    int threadNumber           = static_cast<CPUBackend*>(backend())->threadNumber();
+    // Small recurrence doesn't worth the synchronization of each step
+    int slabNumber = 1;
+    if (mNumUnits >= 64) {
+        slabNumber = ALIMIN(ALIMAX(threadNumber / direction, 1), UP_DIV(mNumUnits, 8));
+    }
+    int slabUnit = UP_DIV(UP_DIV(mNumUnits, slabNumber), 8) * 8;
+    slabNumber   = UP_DIV(mNumUnits, slabUnit);
+    mConstantWeight = true;
+    for (int i = 1; i < 1 + 5 * direction; ++i) {
+        if (TensorUtils::getDescribe(inputs[i])->usage != Tensor::InsideDescribe::CONSTANT) {
+            mConstantWeight = false;
+        }
+    }
+    // The packed weights only change with the input length and the slabs
+    if (nullptr == mInputWeight || mInputWeight->length(0) != inputLastDimSize || slabNumber != mSlabNumber || slabUnit != mSlabUnit) {
+        for (auto t : {mInputWeight.get(), mInputBias.get(), mRecurrentWeight.get()}) {
+            if (nullptr != t) {
+                backend()->onReleaseBuffer(t, Backend::STATIC);
+            }
+        }
+        mInputWeight.reset(Tensor::createDevice<float>({inputLastDimSize, gateLength}));
+        mInputBias.reset(Tensor::createDevice<float>({gateLength}));
+        mRecurrentWeight.reset(Tensor::createDevice<float>({direction, 3 * mNumUnits * mNumUnits}));
+        for (auto t : {mInputWeight.get(), mInputBias.get(), mRecurrentWeight.get()}) {
+            if (!backend()->onAcquireBuffer(t, Backend::STATIC)) {
+                mInputWeight.reset();
+                return OUT_OF_MEMORY;
+            }
+        }
+        mWeightPacked = false;
+    }
+    mSlabNumber = slabNumber;
+    mSlabUnit   = slabUnit;
+
+    mInputGate.reset(Tensor::createDevice<float>({seqLength * batchSize, gateLength}));
+    mHiddenState.reset(Tensor::createDevice<float>({direction, 2, batchSize, mNumUnits}));
+    mGate.reset(Tensor::createDevice<float>({direction, batchSize, mNumUnits}));
+    mResetHt.reset(Tensor::createDevice<float>({direction, batchSize, mNumUnits}));
+    mTemp.reset(Tensor::createDevice<float>({direction * mSlabNumber, 3 * mSlabUnit}));
+    std::vector<Tensor*> buffers = {mInputGate.get(), mHiddenState.get(), mGate.get(), mResetHt.get(), mTemp.get()};
+    for (auto t : buffers) {
+        if (!backend()->onAcquireBuffer(t, Backend::DYNAMIC)) {
+            return OUT_OF_MEMORY;
+        }
+    }
+    // The projection of all steps: [seq * batch, input] x [input, direction * 3 * units] + bias
+    std::shared_ptr<Tensor> A(Tensor::createDevice<float>({seqLength * batchSize, inputLastDimSize}));
+    std::shared_ptr<Tensor> C(Tensor::createDevice<float>({seqLength * batchSize, gateLength}));
+    mInputProjection.reset(new CPUMatMul(backend(), false, false, true, true, mConstantWeight));
+    auto code = mInputProjection->onResize({A.get(), mInputWeight.get(), mInputBias.get()}, {C.get()});
+    if (NO_ERROR != code) {
+        return code;
+    }
+    for (auto t : buffers) {
+        backend()->onReleaseBuffer(t, Backend::DYNAMIC);
+    }
     return NO_ERROR;
 }
 
@@ -158,93 +133,163 @@ ErrorCode CPURNNSequenceGRU::onExecute(const std::vector<Tensor*>& inputs, const
     auto outputSize = outputs.size();
     const int forwardParamNumber = 5;
     MNN_ASSERT(inputSize >= 1 + forwardParamNumber * (mIsBidirectionalRNN + 1));
-    auto fwGateWeight = inputs[1];
-    auto fwGateBias = inputs[2];
-    auto fwCandidateWeight = inputs[3];
-    auto fwCandidateBias = inputs[4];
-    auto fwRecurrentBias = inputs[5];
-
-    // fwGateWeight->printShape();// mFwGateWeight
-    // fwGateBias->printShape();// mFwGateBias
-    // fwCandidateWeight->printShape();// mFwCandidateWeight
-    // fwCandidateBias->printShape();// mFwCandidateBias
-    // fwRecurrentBias->printShape();// mFwRecurrentBias
-
-    // firstly set the hidden state to zero
-    float* const hiddenStatePtr   = mHiddenState->host<float>();
-    const int hiddenStateDataSize = mHiddenState->size();
+    auto core = MNNGetCoreFunctions();
 
     auto input                    = inputs[0];  // shape :(seq_length, batch_size, input_size)
     auto output                   = outputs[0]; // shape :(seq_length, num_directions, batch_size, hidden_size)
-    float* const inputPtr         = input->host<float>();
     float* const outputPtr        = output->host<float>();
-
     float* outputYhPtr = mKeepAllOutputs && outputSize > 1 ? outputs[1]->host<float>() : outputs[0]->host<float>();
+    bool needYh = (mKeepAllOutputs && outputSize > 1) || !mKeepAllOutputs;
+
     const int batchSize           = input->length(1);
-    const int SequenceStride      = input->stride(0);
     const int inputSequenceLength = input->length(0);
     const int inputCodeLength     = input->length(2);
-    // MNN_PRINT("inputSequenceLength:%d, batchSize:%d, inputCodeLength:%d, mNumUnits:%d, hiddenStateDataSize:%d\n", inputSequenceLength, batchSize, inputCodeLength, mNumUnits, hiddenStateDataSize);
-    for (int b = 0; b < batchSize; ++b) { // swap order
-        if (inputSize > 1 + forwardParamNumber * (mIsBidirectionalRNN + 1)) {
-            auto source = inputs[inputSize - 1]->host<uint8_t>() + b * hiddenStateDataSize;
-            ::memcpy(hiddenStatePtr, source, hiddenStateDataSize);
-        } else {
-            ::memset(hiddenStatePtr, 0, hiddenStateDataSize);
+    const int direction           = mIsBidirectionalRNN ? 2 : 1;
+    const int numUnits            = mNumUnits;
+    const int gateLength          = direction * 3 * numUnits;
+    const bool linearBeforeReset  = mlinearBeforeReset;
+
+    // Pack weights of all directions, only once if they are constant
+    auto inputWeight     = mInputWeight->host<float>();
+    auto inputBias       = mInputBias->host<float>();
+    auto recurrentWeight = mRecurrentWeight->host<float>();
+    auto hiddenStatePtr  = mHiddenState->host<float>();
+    for (int d = 0; d < direction && !mWeightPacked; ++d) {
+        auto gateWeight      = inputs[1 + d * forwardParamNumber]->host<float>();
+        auto gateBias        = inputs[2 + d * forwardParamNumber]->host<float>();
+        auto candidateWeight = inputs[3 + d * forwardParamNumber]->host<float>();
+        auto candidateBias   = inputs[4 + d * forwardParamNumber]->host<float>();
+        auto recurrentBias   = inputs[5 + d * forwardParamNumber]->host<float>();
+        for (int k = 0; k < inputCodeLength; ++k) {
+            auto dst = inputWeight + k * gateLength + d * 3 * numUnits;
+            ::memcpy(dst, gateWeight + k * 2 * numUnits, 2 * numUnits * sizeof(float));
+            ::memcpy(dst + 2 * numUnits, candidateWeight + k * numUnits, numUnits * sizeof(float));
         }
-
-        for (int i = 0; i < inputSequenceLength; ++i) {
-            const int inputOffset = i * SequenceStride + b * inputCodeLength;
-            runRNNStep(inputPtr + inputOffset, inputCodeLength, mlinearBeforeReset, mHiddenState, mNumUnits, fwGateWeight, fwGateBias,
-                       fwCandidateWeight, fwCandidateBias, fwRecurrentBias, mInputAndState, mGate, mResetHt);
-
-            if (mKeepAllOutputs) {
-                ::memcpy(outputPtr + i * output->stride(0) + b * mNumUnits, hiddenStatePtr, hiddenStateDataSize);
-            }
+        // Recurrent bias of gates is added with input, so is the one of candidate if it's outside the reset
+        auto bias = inputBias + d * 3 * numUnits;
+        for (int j = 0; j < 2 * numUnits; ++j) {
+            bias[j] = gateBias[j] + recurrentBias[j];
         }
-        if ((mKeepAllOutputs && outputSize > 1) || !mKeepAllOutputs) {
-            ::memcpy(outputYhPtr, hiddenStatePtr, hiddenStateDataSize);
-            outputYhPtr += mNumUnits;
+        for (int j = 0; j < numUnits; ++j) {
+            bias[2 * numUnits + j] = candidateBias[j] + (linearBeforeReset ? 0.0f : recurrentBias[2 * numUnits + j]);
         }
-
+        _packRecurrentWeight(recurrentWeight + d * 3 * numUnits * numUnits, gateWeight, candidateWeight, inputCodeLength,
+                             numUnits, mSlabNumber, mSlabUnit, linearBeforeReset);
     }
-
-    // backward rnn
-    if (mIsBidirectionalRNN) {
-        float* outputYhPtr = mKeepAllOutputs && outputSize > 1 ? outputs[1]->host<float>() : outputs[0]->host<float>();
-        outputYhPtr += batchSize * mNumUnits;
-        // todo: modify the inputOffset
-        MNN_ASSERT(11 <= inputs.size());
-        auto bwGateWeight = inputs[6];
-        auto bwGateBias = inputs[7];
-        auto bwCandidateWeight = inputs[8];
-        auto bwCandidateBias = inputs[9];
-        auto bwRecurrentBias = inputs[10];
-
-        auto outputBw            = outputs[0];
-        float* const outputBwPtr = outputBw->host<float>();
+    mWeightPacked = mConstantWeight;
+    for (int d = 0; d < direction; ++d) {
+        // firstly set the hidden state to the initial one or zero
+        auto hiddenState = hiddenStatePtr + d * 2 * batchSize * numUnits;
+        if (inputSize > 1 + forwardParamNumber * direction) {
+            ::memcpy(hiddenState, inputs[inputSize - 1]->host<float>() + d * batchSize * numUnits, batchSize * numUnits * sizeof(float));
+        } else {
+            ::memset(hiddenState, 0, batchSize * numUnits * sizeof(float));
+        }
+    }
+    mInputProjection->execute(input->host<float>(), inputWeight, mInputGate->host<float>(), inputBias);
+
+    // implement GRU cell function
+    // Ref: tensorflow/python/ops/rnn_cell_impl.py
+    // Each task computes a slab of units for one direction, the backward direction runs from the last step
+    auto inputGatePtr = mInputGate->host<float>();
+    auto gatePtr      = mGate->host<float>();
+    auto resetHtPtr   = mResetHt->host<float>();
+    auto tempPtr      = mTemp->host<float>();
+    const int slabNumber = mSlabNumber;
+    const int slabUnit   = mSlabUnit;
+    const int taskNumber = direction * slabNumber;
+    auto updateHidden = [&](int d, int t, int b, int j, float z, float candidate, const float* hPrev, float* hNext) {
+        float value = (1 - z) * tanhf(candidate) + z * hPrev[b * numUnits + j];
+        hNext[b * numUnits + j] = value;
+        if (mKeepAllOutputs) {
+            outputPtr[t * output->stride(0) + (d * batchSize + b) * numUnits + j] = value;
+        }
+    };
+    // [x_t, h_t-1] * [W_zr, R_zr], h_t' = tanh(x_t * W_h + r_t (.) (h_t-1 * R_h + Rb_h) + Wb_h) for linearBeforeReset
+    auto gateFunction = [&](int tId, int step) {
+        int d      = tId / slabNumber;
+        int start  = (tId % slabNumber) * slabUnit;
+        int w      = ALIMIN(slabUnit, numUnits - start);
+        int t      = d == 0 ? step : inputSequenceLength - 1 - step;
+        auto hPrev = hiddenStatePtr + (d * 2 + step % 2) * batchSize * numUnits;
+        auto hNext = hiddenStatePtr + (d * 2 + (step + 1) % 2) * batchSize * numUnits;
+        auto slab  = recurrentWeight + d * 3 * numUnits * numUnits + numUnits * 3 * start;
+        auto temp  = tempPtr + tId * 3 * slabUnit;
+        auto recurrentHiddenBias = inputs[5 + d * forwardParamNumber]->host<float>() + 2 * numUnits;
+        MatMulParam param;
+        param.e            = 1;
+        param.l            = numUnits;
+        param.h            = linearBeforeReset ? 3 * w : 2 * w;
+        param.numberThread = 1;
+        param.ATranspose   = false;
+        param.BTranspose   = false;
         for (int b = 0; b < batchSize; ++b) {
-
-            if (inputSize > 1 + forwardParamNumber * 2) {
-                auto source = inputs[inputSize - 1]->host<uint8_t>() + (batchSize + b) * hiddenStateDataSize;
-                ::memcpy(hiddenStatePtr, source, hiddenStateDataSize);
-            } else {
-                ::memset(hiddenStatePtr, 0, hiddenStateDataSize);
-            }
-
-            for (int i = inputSequenceLength - 1; i >= 0; i--) {
-                const int inputOffset = i * SequenceStride + b * inputCodeLength;
-                runRNNStep(inputPtr + inputOffset, inputCodeLength, mlinearBeforeReset, mHiddenState, mNumUnits, bwGateWeight, bwGateBias,
-                           bwCandidateWeight, bwCandidateBias, bwRecurrentBias, mInputAndState, mGate, mResetHt);
-                if (mKeepAllOutputs) {
-                    ::memcpy(outputBwPtr + i * outputBw->stride(0) + (batchSize + b) * mNumUnits,
-                             hiddenStatePtr, hiddenStateDataSize);
+            core->MNNComputeMatMulForE_1(hPrev + b * numUnits, slab, temp, nullptr, &param, 0);
+            auto inputGate = inputGatePtr + (t * batchSize + b) * gateLength + d * 3 * numUnits;
+            for (int j = start; j < start + w; ++j) {
+                float z = sigmoid(inputGate[j] + temp[j - start]);
+                float r = sigmoid(inputGate[numUnits + j] + temp[w + j - start]);
+                if (linearBeforeReset) {
+                    float candidate = inputGate[2 * numUnits + j] + r * (temp[2 * w + j - start] + recurrentHiddenBias[j]);
+                    updateHidden(d, t, b, j, z, candidate, hPrev, hNext);
+                } else {
+                    gatePtr[(d * batchSize + b) * numUnits + j]    = z;
+                    resetHtPtr[(d * batchSize + b) * numUnits + j] = r * hPrev[b * numUnits + j];
                 }
             }
-            if ((mKeepAllOutputs && outputSize > 1) || !mKeepAllOutputs) {
-                ::memcpy(outputYhPtr, hiddenStatePtr, hiddenStateDataSize);
-                outputYhPtr += mNumUnits;
+        }
+    };
+    // h_t' = tanh(x_t * W_h + (r_t (.) h_t-1) * R_h + Rb_h + Wb_h)
+    auto candidateFunction = [&](int tId, int step) {
+        int d      = tId / slabNumber;
+        int start  = (tId % slabNumber) * slabUnit;
+        int w      = ALIMIN(slabUnit, numUnits - start);
+        int t      = d == 0 ? step : inputSequenceLength - 1 - step;
+        auto hPrev = hiddenStatePtr + (d * 2 + step % 2) * batchSize * numUnits;
+        auto hNext = hiddenStatePtr + (d * 2 + (step + 1) % 2) * batchSize * numUnits;
+        auto hSlab = recurrentWeight + d * 3 * numUnits * numUnits + numUnits * 3 * start + numUnits * 2 * w;
+        auto temp  = tempPtr + tId * 3 * slabUnit;
+        MatMulParam param;
+        param.e            = 1;
+        param.l            = numUnits;
+        param.h            = w;
+        param.numberThread = 1;
+        param.ATranspose   = false;
+        param.BTranspose   = false;
+        for (int b = 0; b < batchSize; ++b) {
+            core->MNNComputeMatMulForE_1(resetHtPtr + (d * batchSize + b) * numUnits, hSlab, temp, nullptr, &param, 0);
+            auto inputGate = inputGatePtr + (t * batchSize + b) * gateLength + d * 3 * numUnits;
+            for (int j = start; j < start + w; ++j) {
+                float candidate = inputGate[2 * numUnits + j] + temp[j - start];
+                updateHidden(d, t, b, j, gatePtr[(d * batchSize + b) * numUnits + j], candidate, hPrev, hNext);
+            }
+        }
+    };
+    for (int i = 0; i < inputSequenceLength; ++i) {
+        if (taskNumber > 1) {
+            MNN_CONCURRENCY_BEGIN(tId, taskNumber) {
+                gateFunction((int)tId, i);
+            }
+            MNN_CONCURRENCY_END();
+        } else {
+            gateFunction(0, i);
+        }
+        if (linearBeforeReset) {
+            continue;
+        }
+        if (taskNumber > 1) {
+            MNN_CONCURRENCY_BEGIN(tId, taskNumber) {
+                candidateFunction((int)tId, i);
             }
+            MNN_CONCURRENCY_END();
+        } else {
+            candidateFunction(0, i);
+        }
+    }
+    if (needYh) {
+        for (int d = 0; d < direction; ++d) {
+            ::memcpy(outputYhPtr + d * batchSize * numUnits, hiddenStatePtr + (d * 2 + inputSequenceLength % 2) * batchSize * numUnits,
+                     batchSize * numUnits * sizeof(float));
         }
     }
 
@@ -10,9 +10,15 @@
 #define CPURNNSequenceGRU_hpp
 
 #include "core/Execution.hpp"
+#include "backend/cpu/CPUMatMul.hpp"
 
 namespace MNN {
 
+/**
+ The input projection of all steps and directions is computed by one GEMM before the recurrence:
+ [seq * batch, input] x [input, direction * 3 * units]. The recurrent weight is packed into slabs of units,
+ each slab is contiguous and evaluated by one task every step, and the directions run in the same tasks.
+ */
 class CPURNNSequenceGRU : public Execution {
 public:
     CPURNNSequenceGRU(const Op *op, Backend *backend);
@@ -26,10 +32,26 @@ private:
     bool mlinearBeforeReset;
     int mNumUnits;
 
+    std::shared_ptr<CPUMatMul> mInputProjection;
+    // The weights below are static and packed on the first execute if all the weight inputs are constant
+    bool mConstantWeight = false;
+    bool mWeightPacked   = false;
+    // [input, direction * 3 * units]: W_z, W_r, W_h of each direction
+    std::shared_ptr<Tensor> mInputWeight;
+    std::shared_ptr<Tensor> mInputBias;
+    // [seq * batch, direction * 3 * units]
+    std::shared_ptr<Tensor> mInputGate;
+    // [direction, units * 3 * units], see _packRecurrentWeight
+    std::shared_ptr<Tensor> mRecurrentWeight;
+    // [direction, 2, batch, units], read one and write the other in each step
     std::shared_ptr<Tensor> mHiddenState;
-    std::shared_ptr<Tensor> mInputAndState;
+    // [direction, batch, units] update gate and r_t * h_t-1, only for linearBeforeReset = false
     std::shared_ptr<Tensor> mGate;
     std::shared_ptr<Tensor> mResetHt;
+    // [direction * slabNumber, 3 * slabUnit]
+    std::shared_ptr<Tensor> mTemp;
+    int mSlabNumber = 1;
+    int mSlabUnit   = 0;
 };
 
 } // namespace MNN
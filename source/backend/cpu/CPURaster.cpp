@@ -21,6 +21,124 @@
 using Vec4 = MNN::Math::Vec<float, 4>;
 namespace MNN {
 
+static int _regionVolume(const Tensor::InsideDescribe::Region& region) {
+    return region.size[0] * region.size[1] * region.size[2];
+}
+
+// Split region into at most number parts along the outer most dimension that don't reduce, offset is counted by offsetUnit
+static void _splitRegion(const Tensor::InsideDescribe::Region& region, int number, int offsetUnit, std::vector<Tensor::InsideDescribe::Region>& dst) {
+    int pos = -1;
+    for (int i = 0; i < 3; ++i) {
+        if (region.size[i] > 1) {
+            // Split reduce dimension will make threads write the same dst
+            if (region.dst.stride[i] != 0) {
+                pos = i;
+            }
+            break;
+        }
+    }
+    if (-1 == pos || number <= 1) {
+        dst.emplace_back(region);
+        return;
+    }
+    int divSize = UP_DIV(region.size[pos], number);
+    for (int sta = 0; sta < region.size[pos]; sta += divSize) {
+        auto cacheReg = region;
+        cacheReg.size[pos] = std::min(divSize, region.size[pos] - sta);
+        cacheReg.src.offset = region.src.offset + sta * region.src.stride[pos] * offsetUnit;
+        cacheReg.dst.offset = region.dst.offset + sta * region.dst.stride[pos] * offsetUnit;
+        dst.emplace_back(cacheReg);
+    }
+}
+
+// Split large regions so that each thread has similar work
+static void _splitForThreads(std::vector<Tensor::InsideDescribe::Region>& regions, int threadNumber, int offsetUnit) {
+    const int thredHold = 100;//TODO: Find better way to determine it
+    if (threadNumber <= 1) {
+        return;
+    }
+    size_t totalSize = 0;
+    for (auto& region : regions) {
+        totalSize += _regionVolume(region);
+    }
+    auto unitSize = std::max((size_t)thredHold, totalSize / threadNumber);
+    std::vector<Tensor::InsideDescribe::Region> result;
+    for (auto& region : regions) {
+        auto volume = (size_t)_regionVolume(region);
+        _splitRegion(region, (int)std::min((size_t)threadNumber, volume / unitSize), offsetUnit, result);
+    }
+    regions = std::move(result);
+}
+
+// Assign regions to threads, larger first to the thread with least work
+static void _balanceRegions(const std::vector<int>& volumes, int threadNumber, std::vector<std::vector<int>>& tasks) {
+    threadNumber = std::max(1, std::min(threadNumber, (int)volumes.size()));
+    tasks.clear();
+    tasks.resize(threadNumber);
+    std::vector<int> order(volumes.size());
+    for (int i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&volumes](int a, int b) {
+        return volumes[a] > volumes[b];
+    });
+    std::vector<size_t> loads(threadNumber, 0);
+    for (auto index : order) {
+        auto least = std::min_element(loads.begin(), loads.end()) - loads.begin();
+        loads[least] += volumes[index];
+        tasks[least].emplace_back(index);
+    }
+    // Keep the origin order in each thread for memory locality
+    for (auto& t : tasks) {
+        std::sort(t.begin(), t.end());
+    }
+}
+
+// Merge neighbour regions reading the same source by the same shape with uniform offset step, as the outer dimension
+static bool _canCoalesce(const Tensor::InsideDescribe::Region& a, const Tensor::InsideDescribe::Region& b) {
+    if (a.size[0] != 1 || b.size[0] != 1) {
+        return false;
+    }
+    for (int i = 1; i < 3; ++i) {
+        if (a.size[i] != b.size[i] || a.src.stride[i] != b.src.stride[i] || a.dst.stride[i] != b.dst.stride[i]) {
+            return false;
+        }
+    }
+    return b.dst.offset != a.dst.offset;
+}
+
+static void _coalesceRegions(std::vector<std::pair<void*, Tensor::InsideDescribe::Region*>>& copies, std::vector<std::shared_ptr<Tensor::InsideDescribe::Region>>& cache) {
+    std::vector<std::pair<void*, Tensor::InsideDescribe::Region*>> result;
+    for (int i = 0; i < copies.size();) {
+        auto& first = *copies[i].second;
+        int end = i + 1;
+        if (end < copies.size() && copies[end].first == copies[i].first && _canCoalesce(first, *copies[end].second)) {
+            int srcStep = copies[end].second->src.offset - first.src.offset;
+            int dstStep = copies[end].second->dst.offset - first.dst.offset;
+            end++;
+            while (end < copies.size() && copies[end].first == copies[i].first && _canCoalesce(first, *copies[end].second)
+                   && copies[end].second->src.offset - copies[end - 1].second->src.offset == srcStep
+                   && copies[end].second->dst.offset - copies[end - 1].second->dst.offset == dstStep) {
+                end++;
+            }
+        }
+        if (end - i <= 1) {
+            result.emplace_back(copies[i]);
+            i++;
+            continue;
+        }
+        std::shared_ptr<Tensor::InsideDescribe::Region> merged(new Tensor::InsideDescribe::Region);
+        *merged = first;
+        merged->size[0] = end - i;
+        merged->src.stride[0] = copies[i + 1].second->src.offset - first.src.offset;
+        merged->dst.stride[0] = copies[i + 1].second->dst.offset - first.dst.offset;
+        result.emplace_back(std::make_pair(copies[i].first, merged.get()));
+        cache.emplace_back(merged);
+        i = end;
+    }
+    copies = std::move(result);
+}
+
 ErrorCode CPURaster::onResize(const std::vector<Tensor *> &____inputs, const std::vector<Tensor *> &outputs) {
     MNN_ASSERT(outputs.size() == 1);
     auto output = outputs[0];
@@ -45,6 +163,8 @@ ErrorCode CPURaster::onResize(const std::vector<Tensor *> &____inputs, const std
     mOutputPtr = output->host<void>();
     mFast = false;
     auto core = static_cast<CPUBackend*>(backend())->functions();
+    auto threadNumber = static_cast<CPUBackend*>(backend())->threadNumber();
+    mThreadTasks.clear();
     mSingleConvert.type = 0;
     // all_srcFormat == dstFormat == NC4HW4 : Fast Exe
     if (outputDes->dimensionFormat == MNN_DATA_FORMAT_NC4HW4) {
@@ -68,8 +188,17 @@ ErrorCode CPURaster::onResize(const std::vector<Tensor *> &____inputs, const std
                 }
                 Tensor::InsideDescribe::Region newRegion;
                 OpCommonUtils::turnToPackRegion(slice, newRegion, output, core->pack, true);
-                mFastBlit.emplace_back(std::make_pair(slice.origin->host<void>(), std::move(newRegion)));
+                std::vector<Tensor::InsideDescribe::Region> splits = {newRegion};
+                _splitForThreads(splits, threadNumber, core->pack);
+                for (auto& r : splits) {
+                    mFastBlit.emplace_back(std::make_pair(slice.origin->host<void>(), r));
+                }
+            }
+            std::vector<int> volumes(mFastBlit.size());
+            for (int i = 0; i < mFastBlit.size(); ++i) {
+                volumes[i] = _regionVolume(mFastBlit[i].second);
             }
+            _balanceRegions(volumes, threadNumber, mThreadTasks);
             return NO_ERROR;
         }
     }
@@ -167,58 +296,52 @@ ErrorCode CPURaster::onResize(const std::vector<Tensor *> &____inputs, const std
     if (nullptr != mTempOutput) {
         backend()->onReleaseBuffer(mTempOutput.get(), Backend::DYNAMIC);
     }
-    auto threadNumber = static_cast<CPUBackend*>(backend())->threadNumber();
-    if (mTempInputCopy.size() == 1 && threadNumber > 1) {
-        // Split to multi region
-        auto region = mTempInputCopy[0].second;
-        const int thredHold = 100;//TODO: Find better way to determine it
-        if (region->size[0] * region->size[1] * region->size[2] < thredHold) {
-            return NO_ERROR;
-        }
-        auto ptr = mTempInputCopy[0].first;
-        int pos = -1;
-        for (int i=0; i<3; ++i) {
-            if (region->size[i] > 1) {
-                pos = i;
-                break;
-            }
-        }
-        if (-1 == pos) {
-            // Don't need divide
-            return NO_ERROR;
-        }
-        mTempInputCopy.clear();
-        int divSize = UP_DIV(region->size[pos], threadNumber);
-        for (int i=0; i<threadNumber; ++i) {
-            std::shared_ptr<Tensor::InsideDescribe::Region> cacheRegPtr(new Tensor::InsideDescribe::Region);
-            auto& cacheReg = *cacheRegPtr;
-            int sta = i * divSize;
-            int fin = sta + divSize;
-            fin = std::min(fin, region->size[pos]);
-            if (fin <= sta) {
-                break;
-            }
-            for (int v=0; v<3; ++v) {
-                cacheReg.src.stride[v] = region->src.stride[v];
-                cacheReg.dst.stride[v] = region->dst.stride[v];
-            }
-            int curSize = fin - sta;
-            for (int v=0; v<pos; ++v) {
-                cacheReg.size[v] = region->size[v];
+    _coalesceRegions(mTempInputCopy, mCacheRegions);
+    if (threadNumber > 1) {
+        // Split large regions, keep small ones as origin
+        std::vector<std::pair<void*, Tensor::InsideDescribe::Region*>> copies;
+        for (auto& iter : mTempInputCopy) {
+            std::vector<Tensor::InsideDescribe::Region> splits = {*iter.second};
+            _splitForThreads(splits, threadNumber, 1);
+            if (splits.size() == 1) {
+                copies.emplace_back(iter);
+                continue;
             }
-            cacheReg.size[pos] = curSize;
-            cacheReg.src.offset = region->src.offset + sta * region->src.stride[pos];
-            cacheReg.dst.offset = region->dst.offset + sta * region->dst.stride[pos];
-            for (int v=pos+1; v<3; ++v) {
-                cacheReg.size[v] = region->size[v];
+            for (auto& r : splits) {
+                std::shared_ptr<Tensor::InsideDescribe::Region> cacheRegPtr(new Tensor::InsideDescribe::Region);
+                *cacheRegPtr = r;
+                copies.emplace_back(std::make_pair(iter.first, cacheRegPtr.get()));
+                mCacheRegions.emplace_back(cacheRegPtr);
             }
-            mTempInputCopy.emplace_back(std::make_pair(ptr, cacheRegPtr.get()));
-            mCacheRegions.emplace_back(cacheRegPtr);
         }
+        mTempInputCopy = std::move(copies);
+    }
+    std::vector<int> volumes(mTempInputCopy.size());
+    for (int i = 0; i < mTempInputCopy.size(); ++i) {
+        volumes[i] = _regionVolume(*mTempInputCopy[i].second);
     }
+    _balanceRegions(volumes, threadNumber, mThreadTasks);
     return NO_ERROR;
 }
-static void _transpose4Bit(int32_t* dstO, const int32_t* srcO, const Tensor::InsideDescribe::Region& region) {
+// Tile size for transpose, make the source and dest lines of a tile stay in cache
+#define RASTER_TRANSPOSE_TILE 32
+template <typename T>
+static void _transposeUnit(T* dstO, const T* srcO, int32_t* dim) {
+    int w = dim[0];
+    int h = dim[1];
+    int srcStride = dim[2];
+    int dstStride = dim[3];
+    for (int i=0; i<h; ++i) {
+        auto si = srcO + i;
+        auto di = dstO + i * dstStride;
+        for (int j=0; j<w; ++j) {
+            di[j] = si[j * srcStride];
+        }
+    }
+}
+
+template <typename T>
+static void _transposeBlock(T* dstO, const T* srcO, const Tensor::InsideDescribe::Region& region, void(*proc)(T*, const T*, int32_t*)) {
     int dims[4], keepDim = -1;
     for (int i = 0; i < 3; i++) {
         if (region.src.stride[i] == 1 && region.size[i] != 1) {
@@ -231,10 +354,17 @@ static void _transpose4Bit(int32_t* dstO, const int32_t* srcO, const Tensor::Ins
             keepDim = i;
         }
     }
+    int w = dims[0];
+    int h = dims[1];
     for (int z=0; z<region.size[keepDim]; ++z) {
         auto srcZ = srcO + region.src.stride[keepDim] * z;
         auto dstZ = dstO + region.dst.stride[keepDim] * z;
-        MNNTranspose32Bit(dstZ, srcZ, dims);
+        for (int hi = 0; hi < h; hi += RASTER_TRANSPOSE_TILE) {
+            for (int wi = 0; wi < w; wi += RASTER_TRANSPOSE_TILE) {
+                int tileDims[4] = {std::min(RASTER_TRANSPOSE_TILE, w - wi), std::min(RASTER_TRANSPOSE_TILE, h - hi), dims[2], dims[3]};
+                proc(dstZ + hi * dims[3] + wi, srcZ + wi * dims[2] + hi, tileDims);
+            }
+        }
     }
 }
 typedef void (*BlitProc)(uint8_t* dstO, const uint8_t* srcO, int size, int stride, int ds);
@@ -313,8 +443,9 @@ void CPURaster::executeFaster(const std::vector<Tensor *> &inputs, const std::ve
             C4proc = core->MNNSelectBlitFunction(byteC4);
             break;
     }
+    threadNum = (int)mThreadTasks.size();
     MNN_CONCURRENCY_BEGIN(tId, threadNum) {
-        for (int u=(int)tId; u<mFastBlit.size(); u+=threadNum) {
+        for (auto u : mThreadTasks[tId]) {
             auto& iter = mFastBlit[u];
             auto& slice = iter.second;
             //Offset use byte
@@ -495,9 +626,20 @@ static void _blit(const Tensor::InsideDescribe::Region& slice, int bytes, const
         return;
     }
     int srcOne, dstOne;
-    if (OpCommonUtils::isTranspose(slice, srcOne, dstOne) && 4 == bytes) {
-        _transpose4Bit((int32_t*)dstPtr, (const int32_t*)srcPtr, slice);
-        return;
+    if (OpCommonUtils::isTranspose(slice, srcOne, dstOne)) {
+        switch (bytes) {
+            case 4:
+                _transposeBlock<int32_t>((int32_t*)dstPtr, (const int32_t*)srcPtr, slice, MNNTranspose32Bit);
+                return;
+            case 2:
+                _transposeBlock<int16_t>((int16_t*)dstPtr, (const int16_t*)srcPtr, slice, _transposeUnit<int16_t>);
+                return;
+            case 1:
+                _transposeBlock<int8_t>((int8_t*)dstPtr, (const int8_t*)srcPtr, slice, _transposeUnit<int8_t>);
+                return;
+            default:
+                break;
+        }
     }
     if (1 == slice.src.stride[2] && 1 == slice.dst.stride[2]) {
         for (int z=0; z<slice.size[0]; ++z) {
@@ -602,9 +744,9 @@ ErrorCode CPURaster::onExecute(const std::vector<Tensor *> &____inputs, const st
         tensorConvert(iter.first, iter.second, bytes);
     }
     auto proc = _selectUnitProc(bytes);
-    threadNum = ALIMIN(threadNum, (int)mTempInputCopy.size());
+    threadNum = (int)mThreadTasks.size();
     MNN_CONCURRENCY_BEGIN(tId, threadNum) {
-        for (int u=tId; u<mTempInputCopy.size(); u+=threadNum) {
+        for (auto u : mThreadTasks[tId]) {
             auto& iter = mTempInputCopy[u];
             auto& slice = *(iter.second);
             auto srcPtr = (uint8_t*)iter.first + slice.src.offset * bytes;
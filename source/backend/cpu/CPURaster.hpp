@@ -36,6 +36,8 @@ private:
     bool mFast = false;
     OpCommonUtils::TensorConvertParameter mSingleConvert;
     std::vector<std::shared_ptr<Tensor::InsideDescribe::Region>> mCacheRegions;
+    // Index of mTempInputCopy / mFastBlit for each thread
+    std::vector<std::vector<int>> mThreadTasks;
     int32_t mZeroPoint = 0;
 };
 }
@@ -43,11 +43,17 @@
 
 #include <MNN/MNNDefine.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <algorithm>
 #include <vector>
 #include "backend/cpu/CPURuntime.hpp"
 
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 #if defined (__linux__) && defined (__aarch64__)
 #include <sys/auxv.h>
 
@@ -353,6 +359,74 @@ int MNNSetCPUThreadsMode(MNNCPUThreadsMode mode) {
     return -1;
 #endif // arch
 }
+#define MNN_MAX_NUMA_NODE 64
+
+std::vector<int> MNNGetNUMANodeCPUs(int node) {
+    std::vector<int> cpuIds;
+#if defined(__linux__)
+    if (node < 0) {
+        return cpuIds;
+    }
+    char path[256];
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+    FILE* fp = fopen(path, "rb");
+    if (!fp) {
+        return cpuIds;
+    }
+    // Such as "0-23,48-71"
+    char buffer[1024];
+    if (nullptr != fgets(buffer, sizeof(buffer), fp)) {
+        char* cursor = buffer;
+        while (*cursor >= '0' && *cursor <= '9') {
+            int begin = (int)strtol(cursor, &cursor, 10);
+            int end   = begin;
+            if (*cursor == '-') {
+                end = (int)strtol(cursor + 1, &cursor, 10);
+            }
+            for (int i = begin; i <= end; ++i) {
+                cpuIds.emplace_back(i);
+            }
+            if (*cursor == ',') {
+                cursor++;
+            }
+        }
+    }
+    fclose(fp);
+#endif
+    return cpuIds;
+}
+
+int MNNGetCPUNUMANode(int cpuId) {
+    for (int node = 0; node < MNN_MAX_NUMA_NODE; ++node) {
+        auto cpuIds = MNNGetNUMANodeCPUs(node);
+        if (std::find(cpuIds.begin(), cpuIds.end(), cpuId) != cpuIds.end()) {
+            return node;
+        }
+    }
+    return -1;
+}
+
+bool MNNSetThreadAffinity(const std::vector<int>& cpuIds) {
+#if defined(__linux__) && defined(__NR_sched_setaffinity)
+    const int bits = 8 * sizeof(unsigned long);
+    int maxId      = 0;
+    for (auto id : cpuIds) {
+        if (id < 0) {
+            return false;
+        }
+        maxId = std::max(maxId, id);
+    }
+    std::vector<unsigned long> mask(maxId / bits + 1, 0);
+    for (auto id : cpuIds) {
+        mask[id / bits] |= 1UL << (id % bits);
+    }
+    // pid 0 is the calling thread
+    return 0 == syscall(__NR_sched_setaffinity, 0, mask.size() * sizeof(unsigned long), mask.data());
+#else
+    return false;
+#endif
+}
+
 float MNNGetCPUFlops(uint32_t number) {
     float flops = 2048.0f;
 #ifdef __ANDROID__
@@ -8,7 +8,9 @@
 #ifndef CPURuntime_hpp
 #define CPURuntime_hpp
 
+#include <stddef.h>
 #include <stdint.h>
+#include <vector>
 #include "core/Macro.h"
 struct cpuinfo_arm_isa {
     bool fp16arith;
@@ -32,6 +34,16 @@ typedef enum {
 } MNNCPUThreadsMode;
 int MNNSetCPUThreadsMode(MNNCPUThreadsMode mode);
 
+/*
+ NUMA topology and binding for the CPU runtime on servers, only effective on Linux
+ */
+// CPUs of the NUMA node in ascending order, empty if the node doesn't exist
+MNN_PUBLIC std::vector<int> MNNGetNUMANodeCPUs(int node);
+// NUMA node of the CPU, -1 if unknown
+MNN_PUBLIC int MNNGetCPUNUMANode(int cpuId);
+// Bind the calling thread to the CPUs
+MNN_PUBLIC bool MNNSetThreadAffinity(const std::vector<int>& cpuIds);
+
 float MNNGetCPUFlops(uint32_t number);
 void cpuinfo_arm_init(struct cpuinfo_arm_isa* cpuinfo_isa);
 
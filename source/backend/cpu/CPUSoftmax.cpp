@@ -8,6 +8,7 @@
 
 #include <math.h>
 #include "backend/cpu/CPUSoftmax.hpp"
+#include "backend/cpu/CPUSoftmaxInt8.hpp"
 #include "backend/cpu/CPUBackend.hpp"
 #include "backend/cpu/compute/CommonOptFunction.h"
 #include "core/Concurrency.h"
@@ -225,6 +226,9 @@ class CPUSoftmaxCreator : public CPUBackend::Creator {
 public:
     virtual Execution *onCreate(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs,
                                 const MNN::Op *op, Backend *backend) const override {
+        if (CPUBackend::getDataType(outputs[0]) == DataType_DT_INT8) {
+            return new CPUSoftmaxInt8(backend, op->main_as_Axis()->axis());
+        }
         return CPUSoftmax::create(op, backend);
     }
 };
@@ -0,0 +1,97 @@
+//
+//  CPUSoftmaxInt8.cpp
+//  MNN
+//
+//  Created by MNN on 2022/01/10.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <cmath>
+#include "backend/cpu/CPUSoftmaxInt8.hpp"
+#include "backend/cpu/CPUBackend.hpp"
+#include "core/Concurrency.h"
+#include "core/Macro.h"
+#include "core/TensorUtils.hpp"
+
+namespace MNN {
+#ifdef MNN_USE_SSE
+// Int8 tensors are stored as uint8 with offset 128 on x86
+typedef uint8_t StorageType;
+static const int kStorageOffset = 128;
+#else
+typedef int8_t StorageType;
+static const int kStorageOffset = 0;
+#endif
+static const int kExpBits = 20;
+
+CPUSoftmaxInt8::CPUSoftmaxInt8(Backend *b, int axis) : MNN::Execution(b), mAxis(axis) {
+    // nothing to do
+}
+
+ErrorCode CPUSoftmaxInt8::onResize(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) {
+    auto input       = inputs[0];
+    auto inputQuant  = TensorUtils::getDescribe(input)->quantAttr.get();
+    auto outputQuant = TensorUtils::getDescribe(outputs[0])->quantAttr.get();
+    if (nullptr == inputQuant || nullptr == outputQuant) {
+        return NOT_SUPPORT;
+    }
+    const int dims = input->dimensions();
+    int axis = mAxis;
+    if (axis < 0) {
+        axis += dims;
+    }
+    mOutside = 1;
+    mInside  = 1;
+    for (int i = 0; i < axis; ++i) {
+        mOutside *= input->length(i);
+    }
+    mChannel = input->length(axis);
+    for (int i = axis + 1; i < dims; ++i) {
+        mInside *= input->length(i);
+    }
+    for (int d = 0; d < 256; ++d) {
+        mExpTable[d] = (int32_t)roundf(expf(-(float)d * inputQuant->scale) * (float)(1 << kExpBits));
+    }
+    mOutputScale = outputQuant->scale == 0.f ? 0.f : 1.0f / outputQuant->scale;
+    mOutputZero  = outputQuant->zero;
+    mOutputMin   = outputQuant->min;
+    mOutputMax   = outputQuant->max;
+    return NO_ERROR;
+}
+
+ErrorCode CPUSoftmaxInt8::onExecute(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) {
+    auto src        = inputs[0]->host<StorageType>();
+    auto dst        = outputs[0]->host<StorageType>();
+    auto expTable   = mExpTable;
+    const int inside  = mInside;
+    const int channel = mChannel;
+    const int total   = mOutside * mInside;
+    int threadNumber  = std::max(1, std::min(static_cast<CPUBackend*>(backend())->threadNumber(), total));
+    MNN_CONCURRENCY_BEGIN(tId, threadNumber) {
+        for (int r = (int)tId; r < total; r += threadNumber) {
+            int o = r / inside;
+            int i = r % inside;
+            auto srcRow = src + o * channel * inside + i;
+            auto dstRow = dst + o * channel * inside + i;
+            // max - x doesn't depend on the zero point and the storage offset
+            int maxValue = srcRow[0];
+            for (int c = 1; c < channel; ++c) {
+                maxValue = std::max(maxValue, (int)srcRow[c * inside]);
+            }
+            int64_t sum = 0;
+            for (int c = 0; c < channel; ++c) {
+                sum += expTable[maxValue - srcRow[c * inside]];
+            }
+            // The max contributes 1 << kExpBits, so sum is never zero
+            float multiplier = mOutputScale / (float)sum;
+            for (int c = 0; c < channel; ++c) {
+                float value = roundf((float)expTable[maxValue - srcRow[c * inside]] * multiplier) + mOutputZero;
+                value = std::min(std::max(value, mOutputMin), mOutputMax);
+                dstRow[c * inside] = (StorageType)((int)value + kStorageOffset);
+            }
+        }
+    }
+    MNN_CONCURRENCY_END();
+    return NO_ERROR;
+}
+} // namespace MNN
@@ -0,0 +1,41 @@
+//
+//  CPUSoftmaxInt8.hpp
+//  MNN
+//
+//  Created by MNN on 2022/01/10.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#ifndef CPUSoftmaxInt8_hpp
+#define CPUSoftmaxInt8_hpp
+
+#include "core/Execution.hpp"
+
+namespace MNN {
+/**
+ Int8 in / int8 out softmax for the tensors not in NC4HW4. The max of each row is found on the int8 values, so
+ exp(x - max) only depends on max - x, which is in [0, 255] and looked up from a fixed point table, the sum is
+ accumulated in integer and the result is requantized to the output scale.
+ */
+class CPUSoftmaxInt8 : public Execution {
+public:
+    CPUSoftmaxInt8(Backend *b, int axis);
+    virtual ~CPUSoftmaxInt8() = default;
+    virtual ErrorCode onResize(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
+    virtual ErrorCode onExecute(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
+
+private:
+    int mAxis;
+    int mInside  = 1;
+    int mOutside = 1;
+    int mChannel = 1;
+    // exp(-d * inputScale) in Q(kExpBits) for d = max - x
+    int32_t mExpTable[256];
+    float mOutputScale;
+    float mOutputZero;
+    float mOutputMin;
+    float mOutputMax;
+};
+} // namespace MNN
+
+#endif /* CPUSoftmaxInt8_hpp */
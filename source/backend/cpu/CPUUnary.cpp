@@ -7,6 +7,7 @@
 //
 
 #include "backend/cpu/CPUUnary.hpp"
+#include "backend/cpu/CPUUnaryInt8.hpp"
 #include "UnaryUtils.hpp"
 #include "backend/cpu/CPUBackend.hpp"
 #include "core/Macro.h"
@@ -187,6 +188,13 @@ public:
         auto precision = static_cast<CPUBackend*>(backend)->precisionMode();
         auto type = inputs[0]->getType();
         MNNUnaryExecute proc = nullptr;
+        if (CPUBackend::getDataType(outputs[0]) == DataType_DT_INT8) {
+            proc = CPUUnary::selectForFloat(op->main_as_UnaryOp()->opType(), BackendConfig::Precision_High);
+            if (nullptr == proc) {
+                return nullptr;
+            }
+            return new CPUUnaryInt8(backend, proc);
+        }
         if (type.code == halide_type_int) {
             proc = selectForInt(op->main_as_UnaryOp()->opType());
         } else if (type.code == halide_type_float) {
@@ -0,0 +1,69 @@
+//
+//  CPUUnaryInt8.cpp
+//  MNN
+//
+//  Created by MNN on 2022/01/10.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <cmath>
+#include "backend/cpu/CPUUnaryInt8.hpp"
+#include "backend/cpu/CPUBackend.hpp"
+#include "core/Concurrency.h"
+#include "core/Macro.h"
+#include "core/TensorUtils.hpp"
+
+namespace MNN {
+#ifdef MNN_USE_SSE
+// Int8 tensors are stored as uint8 with offset 128 on x86
+static const int kStorageOffset = 128;
+#else
+static const int kStorageOffset = 0;
+#endif
+
+CPUUnaryInt8::CPUUnaryInt8(Backend *b, MNNUnaryExecute proc) : MNN::Execution(b), mProc(proc) {
+    // nothing to do
+}
+
+ErrorCode CPUUnaryInt8::onResize(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) {
+    auto inputQuant  = TensorUtils::getDescribe(inputs[0])->quantAttr.get();
+    auto outputQuant = TensorUtils::getDescribe(outputs[0])->quantAttr.get();
+    if (nullptr == inputQuant || nullptr == outputQuant) {
+        return NOT_SUPPORT;
+    }
+    float src[256];
+    float dst[256];
+    for (int i = 0; i < 256; ++i) {
+        int value = kStorageOffset > 0 ? i - kStorageOffset : (int)(int8_t)i;
+        src[i] = ((float)value - inputQuant->zero) * inputQuant->scale;
+    }
+    mProc(dst, src, 256);
+    float outputScale = outputQuant->scale == 0.f ? 0.f : 1.0f / outputQuant->scale;
+    for (int i = 0; i < 256; ++i) {
+        float value = roundf(dst[i] * outputScale) + outputQuant->zero;
+        value = std::min(std::max(value, outputQuant->min), outputQuant->max);
+        mTable[i] = (uint8_t)((int)value + kStorageOffset);
+    }
+    return NO_ERROR;
+}
+
+ErrorCode CPUUnaryInt8::onExecute(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) {
+    auto size     = static_cast<CPUBackend*>(backend())->getTensorSize(inputs[0]);
+    auto schedule = static_cast<CPUBackend*>(backend())->multiThreadDivide(size);
+    auto inputPtr  = inputs[0]->host<uint8_t>();
+    auto outputPtr = outputs[0]->host<uint8_t>();
+    auto table     = mTable;
+    MNN_CONCURRENCY_BEGIN(tId, schedule.second) {
+        int start = schedule.first * (int)tId;
+        int end   = std::min(start + schedule.first, size);
+        if (tId == schedule.second - 1) {
+            end = size;
+        }
+        for (int i = start; i < end; ++i) {
+            outputPtr[i] = table[inputPtr[i]];
+        }
+    }
+    MNN_CONCURRENCY_END();
+    return NO_ERROR;
+}
+} // namespace MNN
@@ -0,0 +1,31 @@
+//
+//  CPUUnaryInt8.hpp
+//  MNN
+//
+//  Created by MNN on 2022/01/10.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#ifndef CPUUnaryInt8_hpp
+#define CPUUnaryInt8_hpp
+
+#include "core/Execution.hpp"
+#include "compute/CommonOptFunction.h"
+
+namespace MNN {
+// Int8 in / int8 out unary op, such as GELU, computed by a table of the 256 input values
+class CPUUnaryInt8 : public Execution {
+public:
+    CPUUnaryInt8(Backend *b, MNNUnaryExecute proc);
+    virtual ~CPUUnaryInt8() = default;
+    virtual ErrorCode onResize(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
+    virtual ErrorCode onExecute(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
+
+private:
+    // Float function used to build the table
+    MNNUnaryExecute mProc;
+    // Stored output of each stored input
+    uint8_t mTable[256];
+};
+} // namespace MNN
+#endif /* CPUUnaryInt8_hpp */
@@ -0,0 +1,191 @@
+//
+//  CPUWeightCache.cpp
+//  MNN
+//
+//  Created by MNN on 2021/12/08.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include "backend/cpu/CPUWeightCache.hpp"
+#include <string.h>
+#include "backend/cpu/compute/CommonOptFunction.h"
+#ifdef MNN_USE_SSE
+#include "backend/cpu/x86_x64/cpu_id.h"
+#endif
+
+#define MNN_WEIGHT_CACHE_MAGIC 0x574E4E4D // "MNNW"
+#define MNN_WEIGHT_CACHE_VERSION 1
+#define MNN_WEIGHT_CACHE_ALIGN 64
+
+namespace MNN {
+namespace {
+struct CacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t signature;
+    uint64_t number;
+};
+struct CacheEntry {
+    uint64_t hash;
+    uint64_t size;
+    uint64_t offset;
+};
+static const uint64_t gFNVPrime  = 1099511628211ULL;
+static const uint64_t gFNVOffset = 14695981039346656037ULL;
+
+static uint64_t _hashBytes(uint64_t hash, const void* data, size_t size) {
+    auto src         = (const uint8_t*)data;
+    size_t wordCount = size / sizeof(uint64_t);
+    for (size_t i = 0; i < wordCount; ++i) {
+        uint64_t word;
+        ::memcpy(&word, src + i * sizeof(uint64_t), sizeof(uint64_t));
+        hash = (hash ^ word) * gFNVPrime;
+    }
+    for (size_t i = wordCount * sizeof(uint64_t); i < size; ++i) {
+        hash = (hash ^ src[i]) * gFNVPrime;
+    }
+    return hash;
+}
+} // namespace
+
+uint64_t CPUWeightCache::cpuSignature() {
+    auto core       = MNNGetCoreFunctions();
+    uint64_t result = gFNVOffset;
+    int features[]  = {core->pack, core->bytes, core->supportFp16arith, core->supportSDot, core->supportI8mm};
+    result          = _hashBytes(result, features, sizeof(features));
+#ifdef MNN_USE_SSE
+    int cpuFlags = libyuv::InitCpuFlags();
+    result       = _hashBytes(result, &cpuFlags, sizeof(cpuFlags));
+#endif
+    return result;
+}
+
+CPUWeightCache::Key CPUWeightCache::makeKey(const void* source, size_t sourceSize, const std::vector<int>& layout, size_t dstSize) {
+    Key key;
+    key.hash = _hashBytes(gFNVOffset, layout.data(), layout.size() * sizeof(int));
+    key.hash = _hashBytes(key.hash, &sourceSize, sizeof(sourceSize));
+    key.hash = _hashBytes(key.hash, source, sourceSize);
+    key.size = dstSize;
+    return key;
+}
+
+bool CPUWeightCache::load(const Key& key, void* dst) const {
+    std::lock_guard<std::mutex> _l(mLock);
+    if (!mEnabled) {
+        return false;
+    }
+    auto iter = mEntries.find(key);
+    if (iter != mEntries.end()) {
+        ::memcpy(dst, iter->second, key.size);
+        return true;
+    }
+    auto newIter = mNewEntries.find(key);
+    if (newIter != mNewEntries.end()) {
+        ::memcpy(dst, newIter->second.data(), key.size);
+        return true;
+    }
+    return false;
+}
+
+void CPUWeightCache::store(const Key& key, const void* src) {
+    std::lock_guard<std::mutex> _l(mLock);
+    if (!mEnabled || mEntries.find(key) != mEntries.end() || mNewEntries.find(key) != mNewEntries.end()) {
+        return;
+    }
+    std::vector<uint8_t> data(key.size);
+    ::memcpy(data.data(), src, key.size);
+    mNewEntries.insert(std::make_pair(key, std::move(data)));
+}
+
+bool CPUWeightCache::setCache(const void* buffer, size_t size) {
+    std::lock_guard<std::mutex> _l(mLock);
+    mEnabled = mRecord;
+    mEntries.clear();
+    mNewEntries.clear();
+    mSerialized.clear();
+    if (nullptr == buffer) {
+        return false;
+    }
+    if (size < sizeof(CacheHeader)) {
+        return false;
+    }
+    CacheHeader header;
+    ::memcpy(&header, buffer, sizeof(CacheHeader));
+    if (header.magic != MNN_WEIGHT_CACHE_MAGIC || header.version != MNN_WEIGHT_CACHE_VERSION ||
+        header.signature != cpuSignature()) {
+        return false;
+    }
+    auto src = (const uint8_t*)buffer;
+    if (header.number > (size - sizeof(CacheHeader)) / sizeof(CacheEntry)) {
+        return false;
+    }
+    for (uint64_t i = 0; i < header.number; ++i) {
+        CacheEntry entry;
+        ::memcpy(&entry, src + sizeof(CacheHeader) + i * sizeof(CacheEntry), sizeof(CacheEntry));
+        if (entry.offset > size || entry.size > size - entry.offset) {
+            mEntries.clear();
+            return false;
+        }
+        Key key;
+        key.hash = entry.hash;
+        key.size = entry.size;
+        mEntries[key] = src + entry.offset;
+    }
+    mEnabled = true;
+    return true;
+}
+
+void CPUWeightCache::setRecord(bool record) {
+    std::lock_guard<std::mutex> _l(mLock);
+    mRecord = record;
+    if (!record) {
+        mNewEntries.clear();
+        mEnabled = !mEntries.empty();
+    }
+}
+
+std::pair<const void*, size_t> CPUWeightCache::getCache() {
+    std::lock_guard<std::mutex> _l(mLock);
+    if (!mEnabled || (mEntries.empty() && mNewEntries.empty())) {
+        return std::make_pair(nullptr, 0);
+    }
+    std::vector<std::pair<Key, const uint8_t*>> allEntries;
+    for (auto& iter : mEntries) {
+        allEntries.emplace_back(iter.first, iter.second);
+    }
+    for (auto& iter : mNewEntries) {
+        allEntries.emplace_back(iter.first, iter.second.data());
+    }
+    size_t offset = sizeof(CacheHeader) + allEntries.size() * sizeof(CacheEntry);
+    std::vector<CacheEntry> table(allEntries.size());
+    for (int i = 0; i < allEntries.size(); ++i) {
+        offset          = UP_DIV(offset, MNN_WEIGHT_CACHE_ALIGN) * MNN_WEIGHT_CACHE_ALIGN;
+        table[i].hash   = allEntries[i].first.hash;
+        table[i].size   = allEntries[i].first.size;
+        table[i].offset = offset;
+        offset += table[i].size;
+    }
+    std::vector<uint8_t> serialized(offset, 0);
+    CacheHeader header;
+    header.magic     = MNN_WEIGHT_CACHE_MAGIC;
+    header.version   = MNN_WEIGHT_CACHE_VERSION;
+    header.signature = cpuSignature();
+    header.number    = allEntries.size();
+    ::memcpy(serialized.data(), &header, sizeof(CacheHeader));
+    if (!table.empty()) {
+        ::memcpy(serialized.data() + sizeof(CacheHeader), table.data(), table.size() * sizeof(CacheEntry));
+    }
+    for (int i = 0; i < allEntries.size(); ++i) {
+        ::memcpy(serialized.data() + table[i].offset, allEntries[i].second, table[i].size);
+    }
+    // Entries now live in the serialized buffer, drop the other copies
+    mSerialized.swap(serialized);
+    mNewEntries.clear();
+    mEntries.clear();
+    for (int i = 0; i < table.size(); ++i) {
+        mEntries[allEntries[i].first] = mSerialized.data() + table[i].offset;
+    }
+    return std::make_pair(mSerialized.data(), mSerialized.size());
+}
+
+} // namespace MNN
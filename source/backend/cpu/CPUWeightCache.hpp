@@ -0,0 +1,83 @@
+//
+//  CPUWeightCache.hpp
+//  MNN
+//
+//  Created by MNN on 2021/12/08.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#ifndef CPUWeightCache_hpp
+#define CPUWeightCache_hpp
+
+#include <stdint.h>
+#include <map>
+#include <mutex>
+#include <vector>
+#include "core/Macro.h"
+
+namespace MNN {
+/**
+ Cache of packed / transformed weights for cpu executions, serialized through Runtime::onGetCache / onSetCache,
+ so that sessions created later (or in other processes) copy the packed result instead of repacking.
+ Entries are keyed by the content of the origin weight and the packed layout, the cache header records the cpu
+ feature set, so a cache made on another machine is rejected.
+ */
+class MNN_PUBLIC CPUWeightCache {
+public:
+    // Put in front of layout, so the same weight packed by different executions don't conflict
+    enum Kind {
+        CONV_TILED = 0,
+        CONV_1x1_STRASSEN,
+        CONV_WINOGRAD,
+    };
+    struct Key {
+        uint64_t hash = 0;
+        uint64_t size = 0;
+        bool operator<(const Key& other) const {
+            return hash < other.hash || (hash == other.hash && size < other.size);
+        }
+    };
+    CPUWeightCache()  = default;
+    ~CPUWeightCache() = default;
+
+    /**
+     @brief make key for packed weight
+     @param source      origin weight
+     @param sourceSize  bytes of origin weight
+     @param layout      everything decide the packed result beside origin weight, such as pack / unit / kernel size
+     @param dstSize     bytes of packed weight
+     */
+    static Key makeKey(const void* source, size_t sourceSize, const std::vector<int>& layout, size_t dstSize);
+
+    // Return false if cache is disabled or don't contain key
+    bool load(const Key& key, void* dst) const;
+    // Do nothing if cache is disabled
+    void store(const Key& key, const void* src);
+
+    // Use entries in buffer if it's valid, the buffer must be kept until next call.
+    // If buffer is nullptr, clear all entries. The cache is disabled after it unless recording
+    bool setCache(const void* buffer, size_t size);
+    // Record the packed weights for getCache, only set when a cache file is set, as it keeps a copy of the weights.
+    // Stop recording drop the entries not serialized
+    void setRecord(bool record);
+    // Serialize all entries, the result is valid until next setCache / getCache
+    std::pair<const void*, size_t> getCache();
+
+    bool enabled() const {
+        return mEnabled;
+    }
+
+private:
+    static uint64_t cpuSignature();
+    mutable std::mutex mLock;
+    bool mEnabled = false;
+    bool mRecord  = false;
+    // Entries point to loaded cache buffer or mSerialized
+    std::map<Key, const uint8_t*> mEntries;
+    // Entries stored after last serialize
+    std::map<Key, std::vector<uint8_t>> mNewEntries;
+    std::vector<uint8_t> mSerialized;
+};
+} // namespace MNN
+
+#endif /* CPUWeightCache_hpp */
@@ -8,7 +8,11 @@
 #ifdef MNN_USE_THREAD_POOL
 #include "backend/cpu/ThreadPool.hpp"
 #include <string.h>
+#include <algorithm>
+#include <map>
 #include <MNN/MNNDefine.h>
+#include "backend/cpu/CPURuntime.hpp"
+#include "core/Tracer.hpp"
 
 //#define MNN_THREAD_LOCK_CPU
 
@@ -19,7 +23,8 @@
 #include <algorithm>
 #endif
 
-#define MNN_THREAD_POOL_MAX_TASKS 2
+// Max items one task is split into per thread, more items give better balance when sessions share workers
+#define MNN_THREAD_POOL_ITEMS_PER_THREAD 2
 namespace MNN {
 ThreadPool* ThreadPool::gInstance = nullptr;
 static std::mutex gInitMutex;
@@ -45,6 +50,25 @@ void ThreadPool::destroy() {
         gInstance = nullptr;
     }
 }
+
+std::shared_ptr<ThreadPool> ThreadPool::createBound(const std::vector<int>& cpuIds) {
+    static std::map<std::vector<int>, std::weak_ptr<ThreadPool>> gBoundPools;
+    std::lock_guard<std::mutex> _l(gInitMutex);
+    // Remove the pools released by their runtimes
+    for (auto iter = gBoundPools.begin(); iter != gBoundPools.end();) {
+        if (iter->second.expired()) {
+            iter = gBoundPools.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+    auto pool = gBoundPools[cpuIds].lock();
+    if (nullptr == pool) {
+        pool.reset(new ThreadPool((int)cpuIds.size(), cpuIds), [](ThreadPool* p) { delete p; });
+        gBoundPools[cpuIds] = pool;
+    }
+    return pool;
+}
 #ifdef MNN_THREAD_LOCK_CPU
 static int getNumberOfCPU() {
     FILE* fp = fopen("/proc/cpuinfo", "rb");
@@ -151,37 +175,40 @@ static int setSchedAffinity(const std::vector<int>& cpuIDs) {
 }
 
 #endif // arch
-ThreadPool::ThreadPool(int numberThread) {
+ThreadPool::ThreadPool(int numberThread, const std::vector<int>& cpuIds) {
     mNumberThread = numberThread;
     mActiveCount  = 0;
-    mTaskAvailable.resize(MNN_THREAD_POOL_MAX_TASKS);
-    mTasks.resize(MNN_THREAD_POOL_MAX_TASKS);
-    for (int t = 0; t < mTasks.size(); ++t) {
-        mTaskAvailable[t] = true;
-        for (int i = 0; i < mNumberThread; ++i) {
-            mTasks[t].second.emplace_back(new std::atomic_bool{false});
-        }
+    mQueueCursor  = 0;
+    for (int i = 0; i < mNumberThread; ++i) {
+        mQueues.emplace_back(new WorkQueue);
     }
 #ifdef MNN_THREAD_LOCK_CPU
     std::vector<int> sortedCPUIDs = sortCPUIDByMaxFrequency(numberThread);
 #endif
     for (int i = 1; i < mNumberThread; ++i) {
         int threadIndex = i;
+        int boundCPU    = threadIndex < (int)cpuIds.size() ? cpuIds[threadIndex] : -1;
 #ifdef MNN_THREAD_LOCK_CPU
-        mWorkers.emplace_back([this, sortedCPUIDs, threadIndex]() {
+        mWorkers.emplace_back([this, sortedCPUIDs, threadIndex, boundCPU]() {
 #else
-        mWorkers.emplace_back([this, threadIndex]() {
+        mWorkers.emplace_back([this, threadIndex, boundCPU]() {
 #endif
+            if (boundCPU >= 0) {
+                if (!MNNSetThreadAffinity({boundCPU})) {
+                    MNN_PRINT("Can't bind worker %d to CPU %d\n", threadIndex, boundCPU);
+                }
+            } else {
 #ifdef MNN_THREAD_LOCK_CPU
-            int res = setSchedAffinity(sortedCPUIDs);
+                setSchedAffinity(sortedCPUIDs);
 #endif
+            }
+            Tracer::setThreadName("MNN Worker " + std::to_string(threadIndex));
+            WorkItem item;
             while (!mStop) {
                 while (mActiveCount > 0) {
-                    for (int i = 0; i < MNN_THREAD_POOL_MAX_TASKS; ++i) {
-                        if (*mTasks[i].second[threadIndex]) {
-                            mTasks[i].first.first(threadIndex);
-                            { *mTasks[i].second[threadIndex] = false; }
-                        }
+                    if (popLocal(threadIndex, item) || steal(threadIndex, item, nullptr)) {
+                        runItem(item);
+                        continue;
                     }
                     std::this_thread::yield();
                 }
@@ -201,64 +228,118 @@ ThreadPool::~ThreadPool() {
     for (auto& worker : mWorkers) {
         worker.join();
     }
-    for (auto& task : mTasks) {
-        for (auto c : task.second) {
-            delete c;
-        }
-    }
 }
 
-int ThreadPool::acquireWorkIndex() {
-    if (nullptr == gInstance) {
+int ThreadPool::acquireWorkIndex(ThreadPool* pool) {
+    auto instance = nullptr != pool ? pool : gInstance;
+    if (nullptr == instance) {
         return -1;
     }
-    std::lock_guard<std::mutex> _l(gInstance->mQueueMutex);
-    for (int i = 0; i < MNN_THREAD_POOL_MAX_TASKS; ++i) {
-        if (gInstance->mTaskAvailable[i]) {
-            gInstance->mTaskAvailable[i] = false;
+    // Work index only identify a task group owner, so there is no limit for concurrent groups
+    std::lock_guard<std::mutex> _l(instance->mQueueMutex);
+    for (int i = 0; i < instance->mTaskAvailable.size(); ++i) {
+        if (instance->mTaskAvailable[i]) {
+            instance->mTaskAvailable[i] = false;
             return i;
         }
     }
-    return -1;
+    instance->mTaskAvailable.push_back(false);
+    return (int)instance->mTaskAvailable.size() - 1;
 }
-void ThreadPool::releaseWorkIndex(int index) {
-    if (nullptr == gInstance) {
+void ThreadPool::releaseWorkIndex(int index, ThreadPool* pool) {
+    auto instance = nullptr != pool ? pool : gInstance;
+    if (nullptr == instance) {
         return;
     }
-    if (index < 0 || index >= MNN_THREAD_POOL_MAX_TASKS) {
+    std::lock_guard<std::mutex> _l(instance->mQueueMutex);
+    if (index < 0 || index >= instance->mTaskAvailable.size()) {
         return;
     }
-    std::lock_guard<std::mutex> _l(gInstance->mQueueMutex);
-    gInstance->mTaskAvailable[index] = true;
+    instance->mTaskAvailable[index] = true;
 }
 
-void ThreadPool::active() {
-    if (nullptr == gInstance) {
+void ThreadPool::active(ThreadPool* pool) {
+    auto instance = nullptr != pool ? pool : gInstance;
+    if (nullptr == instance) {
         return;
     }
     {
-        std::lock_guard<std::mutex> _l(gInstance->mQueueMutex);
-        gInstance->mActiveCount++;
+        std::lock_guard<std::mutex> _l(instance->mQueueMutex);
+        instance->mActiveCount++;
     }
-    gInstance->mCondition.notify_all();
+    instance->mCondition.notify_all();
 }
-void ThreadPool::deactive() {
-    if (nullptr == gInstance) {
+void ThreadPool::deactive(ThreadPool* pool) {
+    auto instance = nullptr != pool ? pool : gInstance;
+    if (nullptr == instance) {
         return;
     }
-    gInstance->mActiveCount--;
+    instance->mActiveCount--;
 }
 
-void ThreadPool::enqueue(TASK&& task, int index) {
+void ThreadPool::enqueue(TASK&& task, int index, ThreadPool* pool) {
     if (1 >= task.second || 0 > index) {
         for (int i = 0; i < task.second; ++i) {
             task.first(i);
         }
         return;
     }
-    MNN_ASSERT(nullptr != gInstance);
-    gInstance->enqueueInternal(std::move(task), index);
+    auto instance = nullptr != pool ? pool : gInstance;
+    MNN_ASSERT(nullptr != instance);
+    instance->enqueueInternal(std::move(task), index);
 }
+
+bool ThreadPool::popLocal(int queueIndex, WorkItem& item) {
+    auto queue = mQueues[queueIndex].get();
+    std::lock_guard<std::mutex> _l(queue->lock);
+    if (queue->items.empty()) {
+        return false;
+    }
+    item = queue->items.front();
+    queue->items.pop_front();
+    return true;
+}
+
+bool ThreadPool::steal(int thiefIndex, WorkItem& item, const TaskGroup* onlyGroup) {
+    const int queueNumber = (int)mQueues.size();
+    for (int i = 1; i <= queueNumber; ++i) {
+        auto queue = mQueues[(thiefIndex + i) % queueNumber].get();
+        std::lock_guard<std::mutex> _l(queue->lock);
+        if (queue->items.empty()) {
+            continue;
+        }
+        if (nullptr == onlyGroup) {
+            item = queue->items.back();
+            queue->items.pop_back();
+            return true;
+        }
+        for (auto iter = queue->items.rbegin(); iter != queue->items.rend(); ++iter) {
+            if (iter->group == onlyGroup) {
+                item = *iter;
+                queue->items.erase(std::next(iter).base());
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void ThreadPool::runItem(const WorkItem& item) {
+    auto& function = *item.group->function;
+    bool trace     = item.group->trace;
+    Tracer::Guard _trace(trace);
+    double traceBegin = trace ? Tracer::now() : 0.0;
+    for (int v = item.begin; v < item.end; ++v) {
+        function(v);
+    }
+    if (trace) {
+        Tracer::span("threadpool", "task", traceBegin, Tracer::now(),
+                     "\"begin\":" + std::to_string(item.begin) + ",\"end\":" + std::to_string(item.end));
+    }
+    // The group may be released by its owner once remain reach zero, don't touch it after that
+    item.group->remain--;
+}
+
 void ThreadPool::enqueueInternal(TASK&& task, int index) {
     if (mActiveCount == 0) {
         for (int i = 0; i < task.second; ++i) {
@@ -266,37 +347,43 @@ void ThreadPool::enqueueInternal(TASK&& task, int index) {
         }
         return;
     }
-    int workSize = task.second;
-    if (workSize > mNumberThread) {
-        mTasks[index].first = std::make_pair(
-            [workSize, &task, this](int tId) {
-                for (int v = tId; v < workSize; v += mNumberThread) {
-                    task.first(v);
-                }
-            },
-            mNumberThread);
-        workSize = mNumberThread;
-    } else {
-        mTasks[index].first = std::move(task);
-    }
-    {
-        for (int i = 1; i < workSize; ++i) {
-            *mTasks[index].second[i] = true;
-        }
+    int workSize  = task.second;
+    int itemSize  = std::min(workSize, mNumberThread * MNN_THREAD_POOL_ITEMS_PER_THREAD);
+    int unit      = (workSize + itemSize - 1) / itemSize;
+    itemSize      = (workSize + unit - 1) / unit;
+    TaskGroup group;
+    group.function = &task.first;
+    group.remain   = itemSize;
+    group.trace    = Tracer::enabled();
+
+    // The first item is run by caller, the others are spread over worker queues from a rotating cursor,
+    // so that concurrent sessions don't all start on the same worker
+    const int queueNumber = (int)mQueues.size();
+    unsigned int cursor   = (unsigned int)mQueueCursor.fetch_add(itemSize - 1);
+    for (int i = 1; i < itemSize; ++i) {
+        WorkItem item;
+        item.group = &group;
+        item.begin = i * unit;
+        item.end   = std::min(workSize, item.begin + unit);
+        auto queue = mQueues[(cursor + i) % queueNumber].get();
+        std::lock_guard<std::mutex> _l(queue->lock);
+        queue->items.push_back(item);
     }
-    mTasks[index].first.first(0);
-    bool complete = true;
-    do {
-        complete = true;
-        for (int i = 1; i < workSize; ++i) {
-            if (*mTasks[index].second[i]) {
-                complete = false;
-                break;
-            }
+    WorkItem item;
+    item.group = &group;
+    item.begin = 0;
+    item.end   = std::min(workSize, unit);
+    runItem(item);
+
+    // Help finishing own group, then wait for the items stolen by workers
+    const int thiefIndex = (int)((cursor + 1) % queueNumber);
+    while (group.remain > 0) {
+        if (steal(thiefIndex, item, &group)) {
+            runItem(item);
+            continue;
         }
         std::this_thread::yield();
-        // FUNC_PRINT(notComplete);
-    } while (!complete);
+    }
 }
 } // namespace MNN
 #endif
@@ -10,7 +10,9 @@
 #define CPU_INTHREADPOOL_H
 #ifdef MNN_USE_THREAD_POOL
 #include <condition_variable>
+#include <deque>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <thread>
 #include <vector>
@@ -25,34 +27,64 @@ public:
     int number() const {
         return mNumberThread;
     }
-    static void enqueue(TASK&& task, int index);
+    // pool is the one returned by createBound, nullptr for the shared pool created by init
+    static void enqueue(TASK&& task, int index, ThreadPool* pool = nullptr);
 
-    static void active();
-    static void deactive();
+    static void active(ThreadPool* pool = nullptr);
+    static void deactive(ThreadPool* pool = nullptr);
 
-    static int acquireWorkIndex();
-    static void releaseWorkIndex(int index);
+    static int acquireWorkIndex(ThreadPool* pool = nullptr);
+    static void releaseWorkIndex(int index, ThreadPool* pool = nullptr);
 
     static int init(int number);
     static void destroy();
 
+    /**
+     Get the pool of cpuIds.size() threads whose workers are bound to the CPUs one by one, the thread calling
+     enqueue takes the place of the first CPU. Runtimes with the same CPUs share the pool, it's destroyed with the
+     last of them.
+     */
+    static std::shared_ptr<ThreadPool> createBound(const std::vector<int>& cpuIds);
+
 private:
+    // A group is one enqueue call, it lives on the caller's stack until all of its items are done
+    struct TaskGroup {
+        const std::function<void(int)>* function = nullptr;
+        std::atomic_int remain = {0};
+        // The caller is recording trace, record the items on workers as well
+        bool trace = false;
+    };
+    // An item is a contiguous range [begin, end) of task indexes in one group
+    struct WorkItem {
+        TaskGroup* group = nullptr;
+        int begin        = 0;
+        int end          = 0;
+    };
+    // Owner pops from front, thieves steal from back
+    struct WorkQueue {
+        std::mutex lock;
+        std::deque<WorkItem> items;
+    };
     void enqueueInternal(TASK&& task, int index);
+    bool popLocal(int queueIndex, WorkItem& item);
+    bool steal(int thiefIndex, WorkItem& item, const TaskGroup* onlyGroup);
+    static void runItem(const WorkItem& item);
 
     static ThreadPool* gInstance;
-    ThreadPool(int number = 0);
+    ThreadPool(int number = 0, const std::vector<int>& cpuIds = {});
     ~ThreadPool();
 
     std::vector<std::thread> mWorkers;
     std::vector<bool> mTaskAvailable;
     std::atomic<bool> mStop = {false};
 
-    std::vector<std::pair<TASK, std::vector<std::atomic_bool*>>> mTasks;
+    std::vector<std::unique_ptr<WorkQueue>> mQueues;
     std::condition_variable mCondition;
     std::mutex mQueueMutex;
 
     int mNumberThread            = 0;
     std::atomic_int mActiveCount = {0};
+    std::atomic_int mQueueCursor = {0};
 };
 } // namespace MNN
 #endif
@@ -2,6 +2,7 @@
 #include "../compute/CommonOptFunction.h"
 #ifdef MNN_USE_NEON
 #include <arm_neon.h>
+#include <string.h>
 #include "./FunctionSummary.hpp"
 #include "common/MemoryFormater.h"
 
@@ -951,4 +952,53 @@ void MNNPackForMatMul_B(float* dest, const float* source, size_t h, size_t l, bo
 #endif
 
 
+static inline void _MNNGemmWeightUnitCompute(float32x4_t* sum, const float* A, float32x4_t w0, float32x4_t w1) {
+    auto a = vld1q_f32(A);
+    sum[0] = vmlaq_n_f32(sum[0], w0, vgetq_lane_f32(a, 0));
+    sum[1] = vmlaq_n_f32(sum[1], w1, vgetq_lane_f32(a, 0));
+    sum[2] = vmlaq_n_f32(sum[2], w0, vgetq_lane_f32(a, 1));
+    sum[3] = vmlaq_n_f32(sum[3], w1, vgetq_lane_f32(a, 1));
+    sum[4] = vmlaq_n_f32(sum[4], w0, vgetq_lane_f32(a, 2));
+    sum[5] = vmlaq_n_f32(sum[5], w1, vgetq_lane_f32(a, 2));
+    sum[6] = vmlaq_n_f32(sum[6], w0, vgetq_lane_f32(a, 3));
+    sum[7] = vmlaq_n_f32(sum[7], w1, vgetq_lane_f32(a, 3));
+}
+
+void MNNGemmInt8WeightUnit(float* C, const float* A, const int8_t* B, size_t l) {
+    float32x4_t sum[8];
+    for (int i = 0; i < 8; ++i) {
+        sum[i] = vdupq_n_f32(0.0f);
+    }
+    for (int x = 0; x < l; ++x) {
+        auto b  = vmovl_s8(vld1_s8(B + 8 * x));
+        auto w0 = vcvtq_f32_s32(vmovl_s16(vget_low_s16(b)));
+        auto w1 = vcvtq_f32_s32(vmovl_s16(vget_high_s16(b)));
+        _MNNGemmWeightUnitCompute(sum, A + 4 * x, w0, w1);
+    }
+    for (int i = 0; i < 8; ++i) {
+        vst1q_f32(C + 4 * i, sum[i]);
+    }
+}
+
+void MNNGemmInt4WeightUnit(float* C, const float* A, const uint8_t* B, size_t l) {
+    float32x4_t sum[8];
+    for (int i = 0; i < 8; ++i) {
+        sum[i] = vdupq_n_f32(0.0f);
+    }
+    auto mask = vdup_n_u8(0x0F);
+    for (int x = 0; x < l; ++x) {
+        uint32_t packed;
+        ::memcpy(&packed, B + 4 * x, sizeof(uint32_t));
+        auto v  = vreinterpret_u8_u32(vdup_n_u32(packed));
+        // Low nibble is the even channel, high nibble is the odd one
+        auto b  = vmovl_u8(vzip_u8(vand_u8(v, mask), vshr_n_u8(v, 4)).val[0]);
+        auto w0 = vcvtq_f32_u32(vmovl_u16(vget_low_u16(b)));
+        auto w1 = vcvtq_f32_u32(vmovl_u16(vget_high_u16(b)));
+        _MNNGemmWeightUnitCompute(sum, A + 4 * x, w0, w1);
+    }
+    for (int i = 0; i < 8; ++i) {
+        vst1q_f32(C + 4 * i, sum[i]);
+    }
+}
+
 #endif
@@ -1656,6 +1656,32 @@ void MNNNorm(float *dst, const float *src, const float *gamma, const float *beta
         }
     }
 }
+
+float MNNVectorDot(const float* a, const float* b, size_t size) {
+    size_t sizeC4 = size / 4;
+    Vec4 sum(0.0f);
+    for (size_t i = 0; i < sizeC4; ++i) {
+        sum = Vec4::fma(sum, Vec4::load(a + 4 * i), Vec4::load(b + 4 * i));
+    }
+    float res = sum[0] + sum[1] + sum[2] + sum[3];
+    for (size_t i = sizeC4 * 4; i < size; ++i) {
+        res += a[i] * b[i];
+    }
+    return res;
+}
+
+void MNNVectorScaleAdd(float* dst, const float* src, float alpha, float beta, size_t size) {
+    size_t sizeC4 = size / 4;
+    auto alphaV   = Vec4(alpha);
+    auto betaV    = Vec4(beta);
+    for (size_t i = 0; i < sizeC4; ++i) {
+        auto d = Vec4::load(dst + 4 * i) * alphaV;
+        Vec4::save(dst + 4 * i, Vec4::fma(d, Vec4::load(src + 4 * i), betaV));
+    }
+    for (size_t i = sizeC4 * 4; i < size; ++i) {
+        dst[i] = dst[i] * alpha + src[i] * beta;
+    }
+}
 #endif
 
 size_t MNNGridSampleComputeOffset(int h, int w, int height, int width, bool padMode) {
@@ -2398,6 +2424,37 @@ void MNNVectorTop1Int32(int32_t* input, int32_t* maxValue, int32_t* maxIndex, si
 
 #endif
 
+#ifndef MNN_USE_NEON
+void MNNGemmInt8WeightUnit(float* C, const float* A, const int8_t* B, size_t l) {
+    float sum[4][8] = {0.0f};
+    for (int x = 0; x < l; ++x) {
+        auto a = A + 4 * x;
+        auto b = B + 8 * x;
+        for (int i = 0; i < 4; ++i) {
+            for (int j = 0; j < 8; ++j) {
+                sum[i][j] += a[i] * (float)b[j];
+            }
+        }
+    }
+    ::memcpy(C, sum, sizeof(sum));
+}
+
+void MNNGemmInt4WeightUnit(float* C, const float* A, const uint8_t* B, size_t l) {
+    float sum[4][8] = {0.0f};
+    for (int x = 0; x < l; ++x) {
+        auto a = A + 4 * x;
+        auto b = B + 4 * x;
+        for (int i = 0; i < 4; ++i) {
+            for (int j = 0; j < 4; ++j) {
+                sum[i][2 * j + 0] += a[i] * (float)(b[j] & 0x0F);
+                sum[i][2 * j + 1] += a[i] * (float)(b[j] >> 4);
+            }
+        }
+    }
+    ::memcpy(C, sum, sizeof(sum));
+}
+#endif
+
 void MNNComputeMatMulForE_1(const float* A, const float* B, float* C, const float* biasPtr, const MatMulParam* param, size_t tId) {
     auto l = param->l;
     auto h = param->h;
@@ -2881,6 +2938,8 @@ void MNNCoreFunctionInit() {
 
     gCoreFunction->MNNComputeMatMulForE_1 = MNNComputeMatMulForE_1;
     gCoreFunction->MNNComputeMatMulForH_1 = MNNComputeMatMulForH_1;
+    gCoreFunction->MNNGemmInt8WeightUnit = MNNGemmInt8WeightUnit;
+    gCoreFunction->MNNGemmInt4WeightUnit = MNNGemmInt4WeightUnit;
 
 
     // Lowp
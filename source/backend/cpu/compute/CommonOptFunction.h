@@ -85,12 +85,20 @@ void MNNGeluCommon(float* dst, const float* src, size_t size);
 void MNNGeluStandardCommon(float* dst, const float* src, size_t size);
 void MNNSoftmax(float* dest, const float* source, size_t size);
 void MNNNorm(float* dest, const float* source, const float *gamma, const float *beta, float epsilon, size_t size);
+// Return sum(a[i] * b[i])
+float MNNVectorDot(const float* a, const float* b, size_t size);
+// dst = dst * alpha + src * beta
+void MNNVectorScaleAdd(float* dst, const float* src, float alpha, float beta, size_t size);
 
 // Get Pack for MatMul's e , l , h , the pack number must be 1 or 4 * n
 void MNNGetMatMulPackMode(int* eP, int *lP, int* hP);
 
 void MNNGetSparseMatMulPackMode(int* eP, int *lP, int* hP);
 
+// Weight only quant: C[4][8] = A[l][4]^T x dequant(B[l][8]), B is int8 or int4 (two channels in one byte, stored as q + 8)
+void MNNGemmInt8WeightUnit(float* C, const float* A, const int8_t* B, size_t l);
+void MNNGemmInt4WeightUnit(float* C, const float* A, const uint8_t* B, size_t l);
+
 /**
  int number = info[0];
  int eSrcStride = info[1];
@@ -186,6 +194,9 @@ struct CoreFunctions {
     void(*MNNPackedMatMulRemain)(float* C, const float* A, const float* B, size_t eSize, const size_t* parameter, const float* postParameters, const float* bias);
     void(*MNNComputeMatMulForH_1)(const float* A, const float* B, float* C, const float* biasPtr, const MatMulParam* param, size_t tId);
     void(*MNNComputeMatMulForE_1)(const float* A, const float* B, float* C, const float* biasPtr, const MatMulParam* param, size_t tId);
+    // Weight only quant GEMM, weight is dequantized to float in register, see ConvolutionWeightQuant
+    void(*MNNGemmInt8WeightUnit)(float* C, const float* A, const int8_t* B, size_t l);
+    void(*MNNGemmInt4WeightUnit)(float* C, const float* A, const uint8_t* B, size_t l);
 
 
     typedef void(*MNNPackedMatMulKernel)(float* C, const float* A, const float* B, const size_t* parameter, const float* postParameters, const float* bias);
@@ -10,6 +10,7 @@
 #include <string.h>
 #include "core/BufferAllocator.hpp"
 #include "backend/cpu/CPUBackend.hpp"
+#include "backend/cpu/CPUWeightCache.hpp"
 #include "core/Concurrency.h"
 #include "ConvOpt.h"
 #include "core/Macro.h"
@@ -37,6 +38,18 @@ Convolution1x1Strassen::Convolution1x1Strassen(const Convolution2DCommon *common
         MNN_ERROR("Not Enough Memory\n");
         return;
     }
+    auto weightCache = static_cast<CPUBackend*>(b)->getWeightCache();
+    // Hashing the weight is not cheap, skip it if the cache is disabled
+    bool useCache = weightCache->enabled();
+    CPUWeightCache::Key key;
+    if (useCache) {
+        key = CPUWeightCache::makeKey(originWeight, originWeightSize * sizeof(float),
+                                      {CPUWeightCache::CONV_1x1_STRASSEN, core->bytes, core->pack, ePack, lPack, hPack, outputCount, mSrcCount},
+                                      mResource->mWeight->size());
+        if (weightCache->load(key, mResource->mWeight->host<void>())) {
+            return;
+        }
+    }
     if (core->bytes < 4) {
         AutoRelease<Tensor> tempTensor(Tensor::createDevice<float>({outputCount * mSrcCount}));
         mValid = b->onAcquireBuffer(tempTensor.get(), Backend::STATIC);
@@ -50,6 +63,9 @@ Convolution1x1Strassen::Convolution1x1Strassen(const Convolution2DCommon *common
     } else {
         core->MNNPackForMatMul_B(mResource->mWeight->host<float>(), originWeight, outputCount, mSrcCount, true);
     }
+    if (useCache) {
+        weightCache->store(key, mResource->mWeight->host<void>());
+    }
 }
 Convolution1x1Strassen::Convolution1x1Strassen(std::shared_ptr<CPUConvolution::Resource> resource, const Convolution2DCommon *common, Backend* b) : CPUConvolution(common, b) {
     mResource = resource;
@@ -0,0 +1,248 @@
+//
+//  Convolution1x1WeightQuant.cpp
+//  MNN
+//
+//  Created by MNN on 2021/12/20.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include "Convolution1x1WeightQuant.hpp"
+#include <math.h>
+#include <string.h>
+#include "backend/cpu/CPUBackend.hpp"
+#include "CommonOptFunction.h"
+#include "core/Concurrency.h"
+#include "core/Macro.h"
+
+#define WEIGHT_QUANT_UNIT_E 4
+#define WEIGHT_QUANT_UNIT_H 8
+
+namespace MNN {
+bool Convolution1x1WeightQuant::canUse(const Convolution2D* conv2d, const Tensor* input, const Tensor* output, Backend* backend) {
+    auto quan = conv2d->quanParameter();
+    if (nullptr == quan || nullptr == conv2d->bias() || backend->type() != MNN_FORWARD_CPU) {
+        return false;
+    }
+    // fp16 weight is decoded to float, scaleInt means int8 compute
+    if (3 == quan->type() || quan->has_scaleInt()) {
+        return false;
+    }
+    auto cpuBackend = static_cast<CPUBackend*>(backend);
+    if (cpuBackend->memoryMode() != BackendConfig::Memory_Low || cpuBackend->functions()->bytes != 4) {
+        return false;
+    }
+    auto common = conv2d->common();
+    if (common->inputCount() > 0 && common->inputCount() != input->channel()) {
+        // Group convolution
+        return false;
+    }
+    return common->kernelY() == 1 && common->kernelX() == 1 && output->width() == input->width() &&
+           output->height() == input->height() && common->strideX() == 1 && common->strideY() == 1;
+}
+
+Convolution1x1WeightQuant::Convolution1x1WeightQuant(const Convolution2DCommon* common, Backend* b,
+                                                     const ConvolutionCommon::Int8Common* quanCommon, const float* bias,
+                                                     size_t biasSize)
+    : CPUConvolution(common, b) {
+    auto core        = static_cast<CPUBackend*>(b)->functions();
+    auto quan        = quanCommon->quan;
+    int outputCount  = (int)biasSize;
+    int weightLength = (int)quanCommon->weight.size();
+    if (outputCount <= 0 || weightLength % outputCount != 0) {
+        mValid = false;
+        return;
+    }
+    int l      = weightLength / outputCount;
+    int hAlign = ROUND_UP(ROUND_UP(outputCount, core->pack), WEIGHT_QUANT_UNIT_H);
+    int hU     = hAlign / WEIGHT_QUANT_UNIT_H;
+
+    // Same as ConvolutionCommon::load
+    bool oldType4     = (quan->type() == 4 && quan->aMin() == 0 && fabsf(quan->quantScale()) < 1e-6f);
+    float extraFactor = oldType4 ? 1.0f : quan->quantScale();
+    bool asymmetric   = quan->readType() != 0 || oldType4;
+    if (asymmetric && quanCommon->alpha.size() != 2 * outputCount) {
+        asymmetric = false;
+    }
+    if (!asymmetric && quanCommon->alpha.size() != outputCount) {
+        MNN_ERROR("Invalid alpha size for weight quant convolution\n");
+        mValid = false;
+        return;
+    }
+    float clampMin = quan->aMin() == 0 ? -128.0f : (float)quan->aMin();
+    auto weightSrc = quanCommon->weight.get();
+    bool int4      = true;
+    for (int i = 0; i < weightLength; ++i) {
+        if (weightSrc[i] < -8 || weightSrc[i] > 7) {
+            int4 = false;
+            break;
+        }
+    }
+
+    mResource.reset(new Resource);
+    mResource->backend = b;
+    mResource->mInt4   = int4;
+    int hUnitBytes     = int4 ? WEIGHT_QUANT_UNIT_H / 2 : WEIGHT_QUANT_UNIT_H;
+    mResource->mWeight.reset(Tensor::createDevice<int8_t>({hU, l, hUnitBytes}));
+    mResource->mScaleOffsetBias.reset(Tensor::createDevice<float>({3, hAlign}));
+    mValid = b->onAcquireBuffer(mResource->mWeight.get(), Backend::STATIC) &&
+             b->onAcquireBuffer(mResource->mScaleOffsetBias.get(), Backend::STATIC);
+    if (!mValid) {
+        MNN_ERROR("Not Enough Memory\n");
+        return;
+    }
+    auto scale  = mResource->mScaleOffsetBias->host<float>();
+    auto offset = scale + hAlign;
+    auto biasDst = offset + hAlign;
+    ::memset(scale, 0, 3 * hAlign * sizeof(float));
+    ::memcpy(biasDst, bias, outputCount * sizeof(float));
+    auto alpha = quanCommon->alpha.get();
+    for (int o = 0; o < outputCount; ++o) {
+        // W = ((Q - clampMin) * alpha + min) * extraFactor = Q * scale + offset
+        if (asymmetric) {
+            scale[o]  = alpha[2 * o + 1] * extraFactor;
+            offset[o] = (alpha[2 * o] - clampMin * alpha[2 * o + 1]) * extraFactor;
+        } else {
+            scale[o] = alpha[o] * extraFactor;
+        }
+        if (int4) {
+            // Int4 is stored as Q + 8
+            offset[o] -= 8.0f * scale[o];
+        }
+    }
+
+    auto weightDst = mResource->mWeight->host<int8_t>();
+    ::memset(weightDst, 0, mResource->mWeight->size());
+    for (int o = 0; o < outputCount; ++o) {
+        int hIndex = o / WEIGHT_QUANT_UNIT_H;
+        int hRemain = o % WEIGHT_QUANT_UNIT_H;
+        auto src   = weightSrc + o * l;
+        auto dst   = weightDst + hIndex * l * hUnitBytes;
+        if (int4) {
+            auto dstU = (uint8_t*)dst;
+            int shift = (hRemain % 2) * 4;
+            for (int x = 0; x < l; ++x) {
+                dstU[x * hUnitBytes + hRemain / 2] |= (uint8_t)((src[x] + 8) << shift);
+            }
+        } else {
+            for (int x = 0; x < l; ++x) {
+                dst[x * hUnitBytes + hRemain] = src[x];
+            }
+        }
+    }
+}
+
+Convolution1x1WeightQuant::Convolution1x1WeightQuant(std::shared_ptr<Resource> resource, const Convolution2DCommon* common, Backend* b)
+    : CPUConvolution(common, b) {
+    mResource = resource;
+}
+
+bool Convolution1x1WeightQuant::onClone(Backend* bn, const Op* op, Execution** dst) {
+    if (!mValid) {
+        return false;
+    }
+    if (nullptr == dst) {
+        return true;
+    }
+    *dst = new Convolution1x1WeightQuant(mResource, op->main_as_Convolution2D()->common(), bn);
+    return true;
+}
+
+ErrorCode Convolution1x1WeightQuant::onResize(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs) {
+    CPUConvolution::onResize(inputs, outputs);
+    auto input  = inputs[0];
+    auto output = outputs[0];
+    int e       = output->batch() * output->height() * output->width();
+    int l       = input->channel();
+    if (l != mResource->mWeight->length(1)) {
+        return NOT_SUPPORT;
+    }
+    int eU   = UP_DIV(e, WEIGHT_QUANT_UNIT_E);
+    mTempInput.reset(Tensor::createDevice<float>({eU * WEIGHT_QUANT_UNIT_E * (l + 1)}));
+    bool success = backend()->onAcquireBuffer(mTempInput.get(), Backend::DYNAMIC);
+    if (!success) {
+        return OUT_OF_MEMORY;
+    }
+    backend()->onReleaseBuffer(mTempInput.get(), Backend::DYNAMIC);
+    mThreadNumber = static_cast<CPUBackend*>(backend())->threadNumber();
+    return NO_ERROR;
+}
+
+ErrorCode Convolution1x1WeightQuant::onExecute(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs) {
+    auto core   = static_cast<CPUBackend*>(backend())->functions();
+    auto input  = inputs[0];
+    auto output = outputs[0];
+    int pack    = core->pack;
+    int e       = output->batch() * output->height() * output->width();
+    int l       = input->channel();
+    int eU      = UP_DIV(e, WEIGHT_QUANT_UNIT_E);
+    int hU      = mResource->mWeight->length(0);
+    int hAlign  = hU * WEIGHT_QUANT_UNIT_H;
+    int hValid  = UP_DIV(output->channel(), pack) * pack;
+    auto srcPtr = input->host<float>();
+    auto dstPtr = output->host<float>();
+    auto packA  = mTempInput->host<float>();
+    auto sumA   = packA + eU * WEIGHT_QUANT_UNIT_E * l;
+    int threadNumber = mThreadNumber;
+
+    // Pack input from [l / pack, e, pack] to [eU, l, 4] and sum it for the offset of weight
+    MNN_CONCURRENCY_BEGIN(tId, threadNumber) {
+        for (int t = (int)tId; t < eU; t += threadNumber) {
+            auto dst  = packA + t * l * WEIGHT_QUANT_UNIT_E;
+            int eSize = ALIMIN(WEIGHT_QUANT_UNIT_E, e - t * WEIGHT_QUANT_UNIT_E);
+            float sum[WEIGHT_QUANT_UNIT_E] = {0.0f};
+            for (int x = 0; x < l; ++x) {
+                auto src = srcPtr + (x / pack) * e * pack + t * WEIGHT_QUANT_UNIT_E * pack + (x % pack);
+                for (int i = 0; i < WEIGHT_QUANT_UNIT_E; ++i) {
+                    float value = i < eSize ? src[i * pack] : 0.0f;
+                    dst[x * WEIGHT_QUANT_UNIT_E + i] = value;
+                    sum[i] += value;
+                }
+            }
+            ::memcpy(sumA + t * WEIGHT_QUANT_UNIT_E, sum, sizeof(sum));
+        }
+    }
+    MNN_CONCURRENCY_END();
+
+    auto postParameters = getPostParameters();
+    float minValue  = postParameters[2];
+    float maxValue  = postParameters[3];
+    auto scale      = mResource->mScaleOffsetBias->host<float>();
+    auto offset     = scale + hAlign;
+    auto bias       = offset + hAlign;
+    auto weightPtr  = mResource->mWeight->host<int8_t>();
+    bool int4       = mResource->mInt4;
+    int hUnitBytes  = int4 ? WEIGHT_QUANT_UNIT_H / 2 : WEIGHT_QUANT_UNIT_H;
+    // Divide by output channel if possible, so that each thread only read part of weight
+    bool divideH    = hU >= threadNumber || hU >= eU;
+    MNN_CONCURRENCY_BEGIN(tId, threadNumber) {
+        float C[WEIGHT_QUANT_UNIT_E * WEIGHT_QUANT_UNIT_H];
+        int hStart = divideH ? (int)tId : 0;
+        int hStep  = divideH ? threadNumber : 1;
+        int eStart = divideH ? 0 : (int)tId;
+        int eStep  = divideH ? 1 : threadNumber;
+        for (int hb = hStart; hb < hU; hb += hStep) {
+            auto weight = weightPtr + hb * l * hUnitBytes;
+            for (int t = eStart; t < eU; t += eStep) {
+                auto A = packA + t * l * WEIGHT_QUANT_UNIT_E;
+                if (int4) {
+                    core->MNNGemmInt4WeightUnit(C, A, (const uint8_t*)weight, l);
+                } else {
+                    core->MNNGemmInt8WeightUnit(C, A, weight, l);
+                }
+                int eSize = ALIMIN(WEIGHT_QUANT_UNIT_E, e - t * WEIGHT_QUANT_UNIT_E);
+                int hSize = ALIMIN(WEIGHT_QUANT_UNIT_H, hValid - hb * WEIGHT_QUANT_UNIT_H);
+                for (int j = 0; j < hSize; ++j) {
+                    int c    = hb * WEIGHT_QUANT_UNIT_H + j;
+                    auto dst = dstPtr + (c / pack) * e * pack + t * WEIGHT_QUANT_UNIT_E * pack + (c % pack);
+                    for (int i = 0; i < eSize; ++i) {
+                        float value  = C[i * WEIGHT_QUANT_UNIT_H + j] * scale[c] + sumA[t * WEIGHT_QUANT_UNIT_E + i] * offset[c] + bias[c];
+                        dst[i * pack] = ALIMIN(ALIMAX(value, minValue), maxValue);
+                    }
+                }
+            }
+        }
+    }
+    MNN_CONCURRENCY_END();
+    return NO_ERROR;
+}
+} // namespace MNN
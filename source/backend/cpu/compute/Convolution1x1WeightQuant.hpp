@@ -0,0 +1,58 @@
+//
+//  Convolution1x1WeightQuant.hpp
+//  MNN
+//
+//  Created by MNN on 2021/12/20.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#ifndef Convolution1x1WeightQuant_hpp
+#define Convolution1x1WeightQuant_hpp
+
+#include "backend/cpu/CPUConvolution.hpp"
+#include "core/ConvolutionCommon.hpp"
+namespace MNN {
+/**
+ 1x1 Convolution (InnerProduct / MatMul with const weight) for weight only quant model in Memory_Low mode.
+ The weight is kept as int8, or int4 if all quant value is in [-8, 7], and dequantized in register:
+ C = (A x Q) * scale + sum(A) * offset + bias, where W = Q * scale + offset for each output channel.
+ */
+class Convolution1x1WeightQuant : public CPUConvolution {
+public:
+    struct Resource {
+        // [UP_DIV(h, 8), l, 8] int8 or [UP_DIV(h, 8), l, 4] uint8 for int4
+        std::shared_ptr<Tensor> mWeight;
+        // [3, UP_DIV(h, 8) * 8]: scale, offset, bias
+        std::shared_ptr<Tensor> mScaleOffsetBias;
+        bool mInt4 = false;
+        Backend* backend;
+        ~Resource() {
+            if (nullptr != mWeight) {
+                backend->onReleaseBuffer(mWeight.get(), Backend::STATIC);
+            }
+            if (nullptr != mScaleOffsetBias) {
+                backend->onReleaseBuffer(mScaleOffsetBias.get(), Backend::STATIC);
+            }
+        }
+    };
+    // Return false if the convolution should use float weight
+    static bool canUse(const Convolution2D* conv2d, const Tensor* input, const Tensor* output, Backend* backend);
+
+    Convolution1x1WeightQuant(const Convolution2DCommon* common, Backend* b, const ConvolutionCommon::Int8Common* quanCommon,
+                              const float* bias, size_t biasSize);
+    Convolution1x1WeightQuant(std::shared_ptr<Resource> resource, const Convolution2DCommon* common, Backend* b);
+    virtual ~Convolution1x1WeightQuant() = default;
+
+    virtual ErrorCode onResize(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs) override;
+    virtual ErrorCode onExecute(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs) override;
+    virtual bool onClone(Backend* bn, const Op* op, Execution** dst) override;
+
+private:
+    std::shared_ptr<Resource> mResource;
+    // [UP_DIV(e, 4), l, 4] input and [UP_DIV(e, 4) * 4] sum of input
+    std::shared_ptr<Tensor> mTempInput;
+    int mThreadNumber = 1;
+};
+} // namespace MNN
+
+#endif /* Convolution1x1WeightQuant_hpp */
@@ -10,6 +10,7 @@
 #include "backend/cpu/CPUConvolutionDepthwise.hpp"
 #include "backend/cpu/compute/ConvOpt.h"
 #include "backend/cpu/compute/Convolution1x1Strassen.hpp"
+#include "backend/cpu/compute/Convolution1x1WeightQuant.hpp"
 #include "backend/cpu/compute/ConvolutionGroup.hpp"
 #include "backend/cpu/compute/ConvolutionIntFactory.hpp"
 
@@ -84,6 +85,17 @@ Execution* ConvolutionFloatFactory::create(const std::vector<Tensor*>& inputs, c
     int originBiasSize     = 0;
     std::shared_ptr<ConvolutionCommon::Int8Common> quanCommon;
     std::unique_ptr<Tensor> externalWeightTensor, externalBiasTensor;
+    if (nullptr != conv2d->quanParameter() && Convolution1x1WeightQuant::canUse(conv2d, inputs[0], outputs[0], backend)) {
+        // Keep int8 / int4 weight for low memory
+        quanCommon = ConvolutionCommon::load(conv2d->quanParameter(), false, true);
+        if (nullptr != quanCommon) {
+            std::unique_ptr<Execution> exe(new Convolution1x1WeightQuant(conv2d->common(), backend, quanCommon.get(),
+                                                                         conv2d->bias()->data(), conv2d->bias()->size()));
+            if (exe->valid()) {
+                return exe.release();
+            }
+        }
+    }
     if (nullptr != conv2d->quanParameter()) {
         quanCommon = ConvolutionCommon::load(conv2d->quanParameter());
         if (nullptr == quanCommon) {
@@ -9,6 +9,7 @@
 #include "backend/cpu/compute/ConvolutionPackWinograd.hpp"
 #include <math.h>
 #include "backend/cpu/compute/CommonOptFunction.h"
+#include "backend/cpu/CPUWeightCache.hpp"
 #include "core/Concurrency.h"
 #include "backend/cpu/compute/ConvOpt.h"
 #include "core/Macro.h"
@@ -80,23 +81,37 @@ ConvolutionPackWinograd::ConvolutionPackWinograd(const Convolution2DCommon *conv
     // replace Tensor::createDevice by Tensor::create and allocTransformWeight's alloc=true to avoid malloc by onAcquireBuffer
     std::shared_ptr<Tensor> sourceWeight(Tensor::create<float>(
         std::vector<int>{outputCount, srcCount, kernelSize, kernelSize}, (void *)originWeight, Tensor::CAFFE));
-    auto tempWeight = generator.allocTransformWeight(sourceWeight.get(), lPack, hPack, true);
-
-    auto shape = tempWeight->shape();
+    auto shape = generator.allocTransformWeight(sourceWeight.get(), lPack, hPack, false)->shape();
     shape.push_back(bytes);
     mResource->mWeight.reset(Tensor::createDevice<uint8_t>(shape));
     mValid = backend()->onAcquireBuffer(mResource->mWeight.get(), Backend::STATIC);
     if (!mValid) {
         return;
     }
+    mPostParameters = getPostParameters();
+    // The transformed weight is the most costly one to compute, try the weight cache first
+    auto weightCache = static_cast<CPUBackend*>(b)->getWeightCache();
+    // Hashing the weight is not cheap, skip it if the cache is disabled
+    bool useCache = weightCache->enabled();
+    CPUWeightCache::Key key;
+    if (useCache) {
+        key = CPUWeightCache::makeKey(originWeight, originWeightSize * sizeof(float),
+                                      {CPUWeightCache::CONV_WINOGRAD, bytes, pack, ePack, lPack, hPack, unit, kernelSize, outputCount, srcCount},
+                                      mResource->mWeight->size());
+        if (weightCache->load(key, mResource->mWeight->host<void>())) {
+            return;
+        }
+    }
+    auto tempWeight = generator.allocTransformWeight(sourceWeight.get(), lPack, hPack, true);
     generator.transformWeight(tempWeight.get(), sourceWeight.get(), true);
     if (bytes != 4) {
         core->MNNFp32ToLowp(tempWeight->host<float>(), mResource->mWeight->host<int16_t>(), tempWeight->elementSize());
     } else {
         ::memcpy(mResource->mWeight->host<float>(), tempWeight->host<float>(), tempWeight->size());
     }
-
-    mPostParameters = getPostParameters();
+    if (useCache) {
+        weightCache->store(key, mResource->mWeight->host<void>());
+    }
 }
 ConvolutionPackWinograd::~ConvolutionPackWinograd() {
     // Do nothing
@@ -9,6 +9,7 @@
 #include "DenseConvolutionTiledExecutor.hpp"
 #include <MNN/AutoTime.hpp>
 #include "backend/cpu/CPUBackend.hpp"
+#include "backend/cpu/CPUWeightCache.hpp"
 #include "CommonOptFunction.h"
 #include "core/Concurrency.h"
 #include "ConvOpt.h"
@@ -43,10 +44,25 @@ DenseConvolutionTiledExecutor::DenseConvolutionTiledExecutor(const Convolution2D
     auto lSize = srcCount * common->kernelX() * common->kernelY();
     mResource->mWeight.reset(Tensor::createDevice<uint8_t>(
         {UP_DIV(outputCount, hP) * UP_DIV(lSize, lP) * hP * lP * bytes}));
-    std::shared_ptr<Tensor> cache(Tensor::createDevice<uint8_t>({outputCount * srcCount * common->kernelX() * common->kernelY() * (int)sizeof(float)})); // cache must be float
-
     mValid = mValid && backend()->onAcquireBuffer(mResource->mWeight.get(), Backend::STATIC);
-    mValid = mValid && backend()->onAcquireBuffer(cache.get(), Backend::STATIC);
+    if (!mValid) {
+        return;
+    }
+    mProxy.reset(new DenseConvolutionTiledImpl(common, b));
+    auto weightCache = static_cast<CPUBackend*>(b)->getWeightCache();
+    // Hashing the weight is not cheap, skip it if the cache is disabled
+    bool useCache = weightCache->enabled();
+    CPUWeightCache::Key key;
+    if (useCache) {
+        key = CPUWeightCache::makeKey(originWeight, originWeightSize * sizeof(float),
+                                      {CPUWeightCache::CONV_TILED, bytes, core->pack, eP, lP, hP, outputCount, srcCount, common->kernelX(), common->kernelY()},
+                                      mResource->mWeight->size());
+        if (weightCache->load(key, mResource->mWeight->host<void>())) {
+            return;
+        }
+    }
+    std::shared_ptr<Tensor> cache(Tensor::createDevice<uint8_t>({outputCount * srcCount * common->kernelX() * common->kernelY() * (int)sizeof(float)})); // cache must be float
+    mValid = backend()->onAcquireBuffer(cache.get(), Backend::STATIC);
     if (!mValid) {
         return;
     }
@@ -54,7 +70,9 @@ DenseConvolutionTiledExecutor::DenseConvolutionTiledExecutor(const Convolution2D
     // MNN_PRINT("srcCount:%d, outputCount:%d, dense weight matrix tile:", srcCount, outputCount);
     // formatMatrix(mResource->mWeight->host<float>(), {UP_DIV(outputCount, hP), lSize, hP});
     backend()->onReleaseBuffer(cache.get(), Backend::STATIC);
-    mProxy.reset(new DenseConvolutionTiledImpl(common, b));
+    if (useCache) {
+        weightCache->store(key, mResource->mWeight->host<void>());
+    }
 }
 
 DenseConvolutionTiledExecutor::DenseConvolutionTiledExecutor(std::shared_ptr<CPUConvolution::Resource> res, const Convolution2DCommon* common, Backend* b) : ConvolutionTiledExecutor(res, b) {
@@ -320,7 +320,8 @@ static void _CopyC8ToC4_int8(float* dstPtr, const float* srcPtr, int channelC4,
 
 Execution* AVX2Backend::onCreate(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs,
                                   const MNN::Op* op) {
-    if (op->type() == OpType_ImageProcess) {
+    // Fused kernels compute the linear buffer, so any pack is fine
+    if (op->type() == OpType_ImageProcess || op->type() == OpType_Extra) {
         return CPUBackend::onCreate(inputs, outputs, op);
     }
     for (auto t : outputs) {
@@ -332,6 +333,9 @@ Execution* AVX2Backend::onCreate(const std::vector<Tensor*>& inputs, const std::
         }
     }
     bool originCreate = OpCommonUtils::opCompabilityForLowp(op);
+    if (op->type() == OpType_LayerNorm && outputs.size() == 1 && CPUBackend::getDataType(outputs[0]) == DataType_DT_INT8) {
+        return CPUBackend::onCreate(inputs, outputs, op);
+    }
     if (originCreate || op->type() == OpType_Softmax || op->type() == OpType_Reduction || op->type() == OpType_ConvInt8 || op->type() == OpType_DepthwiseConvInt8 || op->type() == OpType_FloatToInt8 || op->type() == OpType_Int8ToFloat) {
         return CPUBackend::onCreate(inputs, outputs, op);
     }
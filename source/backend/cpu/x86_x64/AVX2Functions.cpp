@@ -43,6 +43,9 @@ bool AVX2Functions::init(int cpuFlags) {
     coreFunction->MNNPackForMatMul_B    = _AVX_MNNPackForMatMul_B;
     coreFunction->MNNComputeMatMulForE_1 = _AVX_MNNComputeMatMulForE_1;
     coreFunction->MNNComputeMatMulForH_1 = _AVX_MNNComputeMatMulForH_1;
+    // AVX512 keeps the 8 channel weight only quant kernels
+    coreFunction->MNNGemmInt8WeightUnit = _AVX_MNNGemmInt8WeightUnit;
+    coreFunction->MNNGemmInt4WeightUnit = _AVX_MNNGemmInt4WeightUnit;
 
     // For Packed Functions
     coreFunction->pack = 8;
@@ -54,6 +57,8 @@ bool AVX2Functions::init(int cpuFlags) {
         coreFunction->MNNPackedMatMulRemain = _AVX_MNNPackedMatMulRemainFMA;
         coreFunction->MNNComputeMatMulForE_1 = _AVX_MNNComputeMatMulForE_1FMA;
         coreFunction->MNNComputeMatMulForH_1 = _AVX_MNNComputeMatMulForH_1FMA;
+        coreFunction->MNNGemmInt8WeightUnit = _AVX_MNNGemmInt8WeightUnitFMA;
+        coreFunction->MNNGemmInt4WeightUnit = _AVX_MNNGemmInt4WeightUnitFMA;
         _AVX_ExtraInitFMA(coreFunction);
     }
     // For ImageProcess Functions
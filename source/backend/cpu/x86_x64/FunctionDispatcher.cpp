@@ -34,6 +34,8 @@ struct FunctionGroup {
     void (*MNNHardSwish)(float* dst, const float* src, size_t size) = _SSE_MNNHardSwish;
     void (*MNNGelu)(float* dst, const float* src, size_t size, float* parameters) = _SSE_MNNGelu;
     void (*MNNNorm)(float *dst, const float *src, const float *gamma, const float *beta, float epsilon, size_t size) = _SSE_MNNNorm;
+    float (*MNNVectorDot)(const float* a, const float* b, size_t size) = _SSE_MNNVectorDot;
+    void (*MNNVectorScaleAdd)(float* dst, const float* src, float alpha, float beta, size_t size) = _SSE_MNNVectorScaleAdd;
 };
 
 static FunctionGroup gFunc;
@@ -63,6 +65,8 @@ void MNNFunctionInit() {
             gFunc.MNNExpC8 = _AVX_MNNExpC8FMA;
         }
         gFunc.MNNNorm = _AVX_MNNNorm;
+        gFunc.MNNVectorDot = _AVX_MNNVectorDot;
+        gFunc.MNNVectorScaleAdd = _AVX_MNNVectorScaleAdd;
     }
 }
 
@@ -167,3 +171,11 @@ void MNNSoftmax(float* dest, const float* source, size_t size) {
 void MNNNorm(float* dest, const float* source, const float *gamma, const float *beta, float epsilon, size_t size) {
     gFunc.MNNNorm(dest, source, gamma, beta, epsilon, size);
 }
+
+float MNNVectorDot(const float* a, const float* b, size_t size) {
+    return gFunc.MNNVectorDot(a, b, size);
+}
+
+void MNNVectorScaleAdd(float* dst, const float* src, float alpha, float beta, size_t size) {
+    gFunc.MNNVectorScaleAdd(dst, src, alpha, beta, size);
+}
@@ -793,3 +793,50 @@ static void _AVX_MNNPackednMatMulRemainCommon(TYPE* C, const TYPE* A, const TYPE
         STORE_4(dst, sum);
     }
 }
+
+// Weight only quant: the int8 / int4 weight of 8 output channels is expanded to float in register
+static void _AVX_MNNGemmInt8WeightUnit_Main(float* C, const float* A, const int8_t* B, size_t l) {
+    auto sum0 = _mm256_setzero_ps();
+    auto sum1 = _mm256_setzero_ps();
+    auto sum2 = _mm256_setzero_ps();
+    auto sum3 = _mm256_setzero_ps();
+    for (int x = 0; x < l; ++x) {
+        auto w = _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i*)(B + 8 * x))));
+        auto a = A + 4 * x;
+        sum0   = MNNAVXFMA(BROAD_LOAD(a + 0), w, sum0);
+        sum1   = MNNAVXFMA(BROAD_LOAD(a + 1), w, sum1);
+        sum2   = MNNAVXFMA(BROAD_LOAD(a + 2), w, sum2);
+        sum3   = MNNAVXFMA(BROAD_LOAD(a + 3), w, sum3);
+    }
+    STORE_8(C + 0, sum0);
+    STORE_8(C + 8, sum1);
+    STORE_8(C + 16, sum2);
+    STORE_8(C + 24, sum3);
+}
+
+static void _AVX_MNNGemmInt4WeightUnit_Main(float* C, const float* A, const uint8_t* B, size_t l) {
+    auto sum0 = _mm256_setzero_ps();
+    auto sum1 = _mm256_setzero_ps();
+    auto sum2 = _mm256_setzero_ps();
+    auto sum3 = _mm256_setzero_ps();
+    auto mask = _mm_set1_epi32(0x0F);
+    for (int x = 0; x < l; ++x) {
+        int32_t packed;
+        ::memcpy(&packed, B + 4 * x, sizeof(int32_t));
+        auto v  = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(packed));
+        // Low nibble is the even channel, high nibble is the odd one
+        auto lo = _mm_and_si128(v, mask);
+        auto hi = _mm_srli_epi32(v, 4);
+        auto wi = _mm256_insertf128_si256(_mm256_castsi128_si256(_mm_unpacklo_epi32(lo, hi)), _mm_unpackhi_epi32(lo, hi), 1);
+        auto w  = _mm256_cvtepi32_ps(wi);
+        auto a  = A + 4 * x;
+        sum0    = MNNAVXFMA(BROAD_LOAD(a + 0), w, sum0);
+        sum1    = MNNAVXFMA(BROAD_LOAD(a + 1), w, sum1);
+        sum2    = MNNAVXFMA(BROAD_LOAD(a + 2), w, sum2);
+        sum3    = MNNAVXFMA(BROAD_LOAD(a + 3), w, sum3);
+    }
+    STORE_8(C + 0, sum0);
+    STORE_8(C + 8, sum1);
+    STORE_8(C + 16, sum2);
+    STORE_8(C + 24, sum3);
+}
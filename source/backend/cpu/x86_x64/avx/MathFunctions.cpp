@@ -264,3 +264,36 @@ void _AVX_MNNNorm(float *dst, const float *src, const float *gamma, const float
         }
     }
 }
+
+float _AVX_MNNVectorDot(const float* a, const float* b, size_t size) {
+    float tmpfloat8[8];
+    int count  = size / 8;
+    int remain = count * 8;
+    auto sumVal = _mm256_set1_ps(0.f);
+    for (int i = 0; i < count; ++i) {
+        sumVal = _mm256_add_ps(sumVal, _mm256_mul_ps(_mm256_loadu_ps(a + i * 8), _mm256_loadu_ps(b + i * 8)));
+    }
+    _mm256_storeu_ps(tmpfloat8, sumVal);
+    float sum = 0.f;
+    for (int i = 0; i < 8; ++i) {
+        sum += tmpfloat8[i];
+    }
+    for (int i = remain; i < size; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+void _AVX_MNNVectorScaleAdd(float* dst, const float* src, float alpha, float beta, size_t size) {
+    int count   = size / 8;
+    int remain  = count * 8;
+    auto alphaV = _mm256_set1_ps(alpha);
+    auto betaV  = _mm256_set1_ps(beta);
+    for (int i = 0; i < count; ++i) {
+        auto d = _mm256_mul_ps(_mm256_loadu_ps(dst + i * 8), alphaV);
+        _mm256_storeu_ps(dst + i * 8, _mm256_add_ps(d, _mm256_mul_ps(_mm256_loadu_ps(src + i * 8), betaV)));
+    }
+    for (int i = remain; i < size; ++i) {
+        dst[i] = dst[i] * alpha + src[i] * beta;
+    }
+}
@@ -38,6 +38,8 @@ void _AVX_MNNPackedMatMulFMA(float* C, const float* A, const float* B, const siz
                              const float* postParameters, const float* bias);
 void _AVX_MNNPackedMatMulRemainFMA(float* C, const float* A, const float* B, size_t eSize, const size_t* parameter, const float* postParameters, const float* bias);
 void _AVX_MNNComputeMatMulForE_1FMA(const float* A, const float* B, float* C, const float* biasPtr, const MatMulParam* param, size_t tId);
+void _AVX_MNNGemmInt8WeightUnitFMA(float* C, const float* A, const int8_t* B, size_t l);
+void _AVX_MNNGemmInt4WeightUnitFMA(float* C, const float* A, const uint8_t* B, size_t l);
 void _AVX_MNNPackedMatMulFMA_BF16(float* C, const float* A, const float* B, const size_t* parameter,
                                   const float* postParameters, const float* bias);
 void _AVX_MNNPackedMatMulRemainFMA_BF16(float* C, const float* A, const float* B, size_t eSize, const size_t* parameter, const float* postParameters, const float* bias);
@@ -59,6 +59,14 @@ void _AVX_MNNPackedMatMulRemainFMA(float* C, const float* A, const float* B, siz
     AVX2GemmPostTreat(C, eSize, parameter, postParameters, bias);
 }
 
+void _AVX_MNNGemmInt8WeightUnitFMA(float* C, const float* A, const int8_t* B, size_t l) {
+    _AVX_MNNGemmInt8WeightUnit_Main(C, A, B, l);
+}
+
+void _AVX_MNNGemmInt4WeightUnitFMA(float* C, const float* A, const uint8_t* B, size_t l) {
+    _AVX_MNNGemmInt4WeightUnit_Main(C, A, B, l);
+}
+
 void _AVX_MNNComputeMatMulForE_1FMA(const float* A, const float* B, float* C, const float* biasPtr, const MatMulParam* param, size_t tId) {
     auto l = param->l;
     auto h = param->h;
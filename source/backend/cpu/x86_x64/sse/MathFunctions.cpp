@@ -270,3 +270,33 @@ void _SSE_MNNNorm(float *dst, const float *src, const float *gamma, const float
         }
     }
 }
+
+float _SSE_MNNVectorDot(const float* a, const float* b, size_t size) {
+    float tmpfloat4[4];
+    int count  = size / 4;
+    int remain = count * 4;
+    auto sumVal = _mm_set1_ps(0.f);
+    for (int i = 0; i < count; ++i) {
+        sumVal = _mm_add_ps(sumVal, _mm_mul_ps(_mm_loadu_ps(a + i * 4), _mm_loadu_ps(b + i * 4)));
+    }
+    _mm_storeu_ps(tmpfloat4, sumVal);
+    float sum = tmpfloat4[0] + tmpfloat4[1] + tmpfloat4[2] + tmpfloat4[3];
+    for (int i = remain; i < size; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+void _SSE_MNNVectorScaleAdd(float* dst, const float* src, float alpha, float beta, size_t size) {
+    int count   = size / 4;
+    int remain  = count * 4;
+    auto alphaV = _mm_set1_ps(alpha);
+    auto betaV  = _mm_set1_ps(beta);
+    for (int i = 0; i < count; ++i) {
+        auto d = _mm_mul_ps(_mm_loadu_ps(dst + i * 4), alphaV);
+        _mm_storeu_ps(dst + i * 4, _mm_add_ps(d, _mm_mul_ps(_mm_loadu_ps(src + i * 4), betaV)));
+    }
+    for (int i = remain; i < size; ++i) {
+        dst[i] = dst[i] * alpha + src[i] * beta;
+    }
+}
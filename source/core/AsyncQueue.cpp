@@ -0,0 +1,135 @@
+//
+//  AsyncQueue.cpp
+//  MNN
+//
+//  Created by MNN on 2021/12/24.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include "core/AsyncQueue.hpp"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace MNN {
+
+// Bounded FIFO pool, never destroyed so that requests posted near exit don't race with static destruction
+class AsyncPool {
+public:
+    AsyncPool(int number) {
+        for (int i = 0; i < number; ++i) {
+            mWorkers.emplace_back([this]() {
+                while (true) {
+                    std::function<void()> task;
+                    {
+                        std::unique_lock<std::mutex> _l(mLock);
+                        mCondition.wait(_l, [this]() { return !mTasks.empty(); });
+                        task = std::move(mTasks.front());
+                        mTasks.pop_front();
+                    }
+                    task();
+                }
+            });
+            mWorkers.back().detach();
+        }
+    }
+    void enqueue(std::function<void()>&& task) {
+        {
+            std::lock_guard<std::mutex> _l(mLock);
+            mTasks.emplace_back(std::move(task));
+        }
+        mCondition.notify_one();
+    }
+    int size() const {
+        return (int)mWorkers.size();
+    }
+
+private:
+    std::vector<std::thread> mWorkers;
+    std::mutex mLock;
+    std::condition_variable mCondition;
+    std::deque<std::function<void()>> mTasks;
+};
+
+static AsyncPool* _getPool() {
+    static AsyncPool* gPool = new AsyncPool(std::min(std::max((int)std::thread::hardware_concurrency(), 2), 8));
+    return gPool;
+}
+
+static double _nowMs() {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct AsyncQueue::Request {
+    std::function<void()> run;
+    std::function<void()> finish;
+    double postMs = 0.0;
+};
+
+AsyncQueue::~AsyncQueue() {
+    wait();
+}
+
+int AsyncQueue::workerNumber() {
+    return _getPool()->size();
+}
+
+void AsyncQueue::post(std::function<void()> run, std::function<void()> finish) {
+    std::shared_ptr<Request> request(new Request);
+    request->run    = std::move(run);
+    request->finish = std::move(finish);
+    request->postMs = _nowMs();
+    std::lock_guard<std::mutex> _l(mLock);
+    mInFlight++;
+    mRequests.emplace_back(request);
+    _schedule();
+}
+
+void AsyncQueue::_schedule() {
+    if (mRunning || mRequests.empty()) {
+        return;
+    }
+    mRunning = true;
+    _getPool()->enqueue([this]() {
+        _runHead();
+    });
+}
+
+void AsyncQueue::_runHead() {
+    std::shared_ptr<Request> request;
+    {
+        std::lock_guard<std::mutex> _l(mLock);
+        request = mRequests.front();
+        mRequests.pop_front();
+    }
+    auto queueMs = _nowMs() - request->postMs;
+    request->run();
+    // The next run may write the outputs read by finish, schedule it after finish
+    if (nullptr != request->finish) {
+        request->finish();
+    }
+    std::lock_guard<std::mutex> _l(mLock);
+    mRunning = false;
+    _schedule();
+    mInFlight--;
+    mFinished++;
+    mTotalMs += queueMs;
+    mMaxMs = std::max(mMaxMs, queueMs);
+    mCondition.notify_all();
+}
+
+void AsyncQueue::wait() {
+    std::unique_lock<std::mutex> _l(mLock);
+    mCondition.wait(_l, [this]() { return 0 == mInFlight; });
+}
+
+void AsyncQueue::getInfo(float* info) const {
+    std::lock_guard<std::mutex> _l(mLock);
+    info[0] = (float)workerNumber();
+    info[1] = (float)mInFlight;
+    info[2] = mFinished > 0 ? (float)(mTotalMs / mFinished) : 0.0f;
+    info[3] = (float)mMaxMs;
+}
+
+} // namespace MNN
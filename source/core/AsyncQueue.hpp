@@ -0,0 +1,58 @@
+//
+//  AsyncQueue.hpp
+//  MNN
+//
+//  Created by MNN on 2021/12/24.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#ifndef AsyncQueue_hpp
+#define AsyncQueue_hpp
+#include <MNN/MNNDefine.h>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace MNN {
+/**
+ Serial queue of asynchronous requests for one session or module, run by a process wide pool of workerNumber() threads.
+ The runs are called in the order of post, each one after the previous request is finished. The next run is scheduled
+ after calling finish of the request, so that finish can read the outputs shared by the requests. Requests of
+ different queues run concurrently.
+ */
+class MNN_PUBLIC AsyncQueue {
+public:
+    AsyncQueue() = default;
+    // Wait for posted requests
+    ~AsyncQueue();
+    // finish can be nullptr
+    void post(std::function<void()> run, std::function<void()> finish);
+    // Block until all posted requests are finished
+    void wait();
+    /**
+     info[0]: max requests run concurrently by the pool
+     info[1]: requests of this queue in flight, posted but not finished
+     info[2], info[3]: average / max time in ms from post to run of finished requests
+     */
+    void getInfo(float* info) const;
+    static int workerNumber();
+
+private:
+    struct Request;
+    // Called with mLock, post the head to pool if no run is in progress
+    void _schedule();
+    void _runHead();
+
+    mutable std::mutex mLock;
+    std::condition_variable mCondition;
+    std::deque<std::shared_ptr<Request>> mRequests;
+    bool mRunning    = false;
+    int mInFlight    = 0;
+    int mFinished    = 0;
+    double mTotalMs  = 0.0;
+    double mMaxMs    = 0.0;
+};
+} // namespace MNN
+#endif
@@ -11,9 +11,11 @@
 
 #include <stdint.h>
 #include <string.h>
+#include <memory>
 #include "MNNMemoryUtils.h"
 
 namespace MNN {
+class FileLoader;
 template <typename T>
 
 /** self-managed memory storage */
@@ -226,13 +228,15 @@ struct BufferStorage {
         return storage + offset;
     }
     ~ BufferStorage() {
-        if (nullptr != storage) {
+        if (nullptr != storage && nullptr == mapFile.get()) {
             delete [] storage;
         }
     }
     size_t allocated_size;
     size_t offset;
     uint8_t* storage = nullptr;
+    /** Set when storage point to a mapped file, the storage is not owned then */
+    std::shared_ptr<FileLoader> mapFile;
 };
 
 } // namespace MNN
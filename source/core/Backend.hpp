@@ -112,6 +112,38 @@ public:
     virtual void onResizeEnd() {
         // nothing to do
     }
+    /**
+     * @brief record the live range of dynamic buffers in next resize for onPlanMemory, default false.
+     */
+    virtual void onRecordMemory(bool record) {
+        // nothing to do
+    }
+    /**
+     * @brief plan the dynamic memory of last resize by the live range of buffers.
+     * @param bind  if true, the next resize places the dynamic buffers at the planned offsets of one arena.
+     * @return dynamic memory size allocated in last resize and the planned peak size, in bytes. (0, 0) if not support.
+     */
+    virtual std::pair<size_t, size_t> onPlanMemory(bool bind) {
+        return std::make_pair(0, 0);
+    }
+    /**
+     * @brief resize commands which will execute concurrently.
+     * The dynamic memory freed by one group is not reused by other groups until the barrier ends.
+     * @param begin true for begin, false for end.
+     */
+    virtual void onResizeBarrier(bool begin) {
+        // nothing to do
+    }
+    virtual void onResizeGroup(bool begin) {
+        // nothing to do
+    }
+    /**
+     * @brief run task(0) ... task(number - 1) concurrently, the task may use the backend's parallel compute inside.
+     * @return false if not support, the caller should run them in sequence.
+     */
+    virtual bool onConcurrentRun(const std::function<void(int)>& task, int number) const {
+        return false;
+    }
 
     /**
      * @brief callback before executing ops.
@@ -253,6 +285,11 @@ public:
     virtual std::pair<const void*, size_t> onGetCache() {
         return std::make_pair(nullptr, 0);
     }
+
+    // Set when the user give a cache file to write, the runtime may record extra content for onGetCache only if it's set
+    virtual void onSetCacheRecord(bool record) {
+        // Do nothing
+    }
     virtual int onGetRuntimeStatus(RuntimeStatus statusEnum) const {
         return 0;
     }
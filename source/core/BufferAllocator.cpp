@@ -7,7 +7,16 @@
 //
 
 #include "core/BufferAllocator.hpp"
+#include <algorithm>
+#include <climits>
+#include <stdio.h>
 #include "core/Macro.h"
+#include "core/Tracer.hpp"
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 //#define DUMP_USAGE
 //#define MNN_DEBUG_MEMORY
@@ -46,6 +55,192 @@ private:
     BufferAllocator* mParent;
 };
 
+#if defined(__linux__)
+#define MNN_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+// Regions smaller than it are rounded up, so that small buffers share the huge pages
+#define MNN_HUGE_PAGE_REGION_SIZE (32 * 1024 * 1024)
+// Place the pages of the mapped region on the node when they are first touched
+static bool _bindToNUMANode(void* base, size_t size, int node) {
+#ifdef __NR_mbind
+    const int maxNode = 64;
+    if (node >= maxNode) {
+        return false;
+    }
+    const int mpolPreferred = 1;
+    unsigned long nodeMask  = 1UL << node;
+    // Preferred instead of bind, so that allocation falls back to other nodes if this one is full
+    return 0 == syscall(__NR_mbind, base, size, mpolPreferred, &nodeMask, (unsigned long)maxNode + 1, 0);
+#else
+    return false;
+#endif
+}
+// Sub-allocate from mapped regions, which are bound to the NUMA node before any page is touched
+class MappedAllocator : public BufferAllocator::Allocator {
+public:
+    MappedAllocator(int numaNode, bool hugePage) : mNumaNode(numaNode), mHugePage(hugePage) {
+        // Do nothing
+    }
+    virtual ~ MappedAllocator() {
+        for (auto& region : mRegions) {
+            munmap(region->base, region->size);
+        }
+    }
+    virtual std::pair<void*, size_t> onAlloc(size_t size, size_t align) override {
+        align = std::max(align, (size_t)MNN_MEMORY_ALIGN_DEFAULT);
+        size  = UP_DIV(size, MNN_MEMORY_ALIGN_DEFAULT) * MNN_MEMORY_ALIGN_DEFAULT;
+        // Blocks are aligned to MNN_MEMORY_ALIGN_DEFAULT, pad them for larger align
+        auto blockSize = size + align - MNN_MEMORY_ALIGN_DEFAULT;
+        for (auto& region : mRegions) {
+            auto offset = allocFrom(region.get(), blockSize, align);
+            if (offset >= 0) {
+                return std::make_pair(region->base, (size_t)offset);
+            }
+        }
+        std::shared_ptr<Region> region(mapRegion(std::max(blockSize, (size_t)MNN_HUGE_PAGE_REGION_SIZE)));
+        if (nullptr == region) {
+            return std::make_pair(nullptr, 0);
+        }
+        mRegions.emplace_back(region);
+        auto offset = allocFrom(region.get(), blockSize, align);
+        return std::make_pair(region->base, (size_t)offset);
+    }
+    virtual void onRelease(std::pair<void*, size_t> ptr) override {
+        for (auto iter = mRegions.begin(); iter != mRegions.end(); ++iter) {
+            auto region = iter->get();
+            if (region->base != ptr.first) {
+                continue;
+            }
+            auto used = region->used.find(ptr.second);
+            MNN_ASSERT(used != region->used.end());
+            auto offset = used->second.first;
+            auto size   = used->second.second;
+            region->used.erase(used);
+            // Merge with the neighbours
+            auto next = region->free.lower_bound(offset);
+            if (next != region->free.end() && next->first == offset + size) {
+                size += next->second;
+                next = region->free.erase(next);
+            }
+            if (next != region->free.begin()) {
+                auto prev = std::prev(next);
+                if (prev->first + prev->second == offset) {
+                    offset = prev->first;
+                    size += prev->second;
+                    region->free.erase(prev);
+                }
+            }
+            region->free.insert(std::make_pair(offset, size));
+            if (region->used.empty()) {
+                munmap(region->base, region->size);
+                mRegions.erase(iter);
+            }
+            return;
+        }
+        MNN_ASSERT(false);
+    }
+
+private:
+    struct Region {
+        uint8_t* base = nullptr;
+        size_t size   = 0;
+        // offset -> size of free blocks
+        std::map<size_t, size_t> free;
+        // returned offset -> block offset, block size
+        std::map<size_t, std::pair<size_t, size_t>> used;
+    };
+    // First fit, return -1 if no block is large enough
+    static int64_t allocFrom(Region* region, size_t blockSize, size_t align) {
+        for (auto iter = region->free.begin(); iter != region->free.end(); ++iter) {
+            if (iter->second < blockSize) {
+                continue;
+            }
+            auto offset = iter->first;
+            auto remain = iter->second - blockSize;
+            region->free.erase(iter);
+            if (remain > 0) {
+                region->free.insert(std::make_pair(offset + blockSize, remain));
+            }
+            auto aligned = UP_DIV(offset, align) * align;
+            region->used.insert(std::make_pair(aligned, std::make_pair(offset, blockSize)));
+            return (int64_t)aligned;
+        }
+        return -1;
+    }
+    Region* mapRegion(size_t size) {
+        size = UP_DIV(size, MNN_HUGE_PAGE_SIZE) * MNN_HUGE_PAGE_SIZE;
+        uint8_t* base = nullptr;
+        if (!mHugePage) {
+            auto ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (MAP_FAILED == ptr) {
+                MNN_ERROR("Can't map %lu bytes for NUMA allocator\n", (unsigned long)size);
+                return nullptr;
+            }
+            base = (uint8_t*)ptr;
+        }
+#ifdef MAP_HUGETLB
+        if (nullptr == base) {
+            // Explicit huge pages, only succeed if enough pages are reserved in /proc/sys/vm/nr_hugepages
+            auto ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (MAP_FAILED != ptr) {
+                base = (uint8_t*)ptr;
+            }
+        }
+#endif
+        if (nullptr == base) {
+            // Align the region to huge page so that transparent huge pages can back all of it
+            auto ptr = mmap(nullptr, size + MNN_HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (MAP_FAILED == ptr) {
+                MNN_ERROR("Can't map %lu bytes for huge page allocator\n", (unsigned long)size);
+                return nullptr;
+            }
+            auto origin  = (uint8_t*)ptr;
+            base         = (uint8_t*)(UP_DIV((size_t)origin, MNN_HUGE_PAGE_SIZE) * MNN_HUGE_PAGE_SIZE);
+            auto tail    = origin + size + MNN_HUGE_PAGE_SIZE - (base + size);
+            if (base > origin) {
+                munmap(origin, base - origin);
+            }
+            if (tail > 0) {
+                munmap(base + size, tail);
+            }
+#ifdef MADV_HUGEPAGE
+            madvise(base, size, MADV_HUGEPAGE);
+#endif
+        }
+        if (mNumaNode >= 0) {
+            _bindToNUMANode(base, size, mNumaNode);
+        }
+        auto region  = new Region;
+        region->base = base;
+        region->size = size;
+        region->free.insert(std::make_pair((size_t)0, size));
+        return region;
+    }
+    std::vector<std::shared_ptr<Region>> mRegions;
+    int mNumaNode;
+    bool mHugePage;
+};
+#endif
+
+std::shared_ptr<BufferAllocator::Allocator> BufferAllocator::Allocator::createHugePage(int numaNode) {
+    std::shared_ptr<BufferAllocator::Allocator> _res;
+#if defined(__linux__)
+    _res.reset(new MappedAllocator(numaNode, true));
+#else
+    _res.reset(new DefaultAllocator);
+#endif
+    return _res;
+}
+
+std::shared_ptr<BufferAllocator::Allocator> BufferAllocator::Allocator::createNUMA(int numaNode) {
+    std::shared_ptr<BufferAllocator::Allocator> _res;
+#if defined(__linux__)
+    _res.reset(new MappedAllocator(numaNode, false));
+#else
+    _res.reset(new DefaultAllocator);
+#endif
+    return _res;
+}
+
 std::shared_ptr<BufferAllocator::Allocator> BufferAllocator::Allocator::createDefault() {
     std::shared_ptr<BufferAllocator::Allocator> _res;
     _res.reset(new DefaultAllocator);
@@ -57,25 +252,54 @@ std::shared_ptr<BufferAllocator::Allocator> BufferAllocator::Allocator::createRe
     return _res;
 }
 
+static void _traceTotalSize(const BufferAllocator* allocator, size_t size) {
+    if (Tracer::enabled()) {
+        char name[64];
+        snprintf(name, sizeof(name), "BufferAllocator %p", allocator);
+        Tracer::counter(name, "size", (double)size);
+    }
+}
+
 BufferAllocator::Node::~Node() {
     if (nullptr == parent.get()) {
         outside->onRelease(pointer);
     }
 }
 std::pair<void*, size_t> BufferAllocator::alloc(size_t size, bool separate, size_t align) {
+    if (0 == align) {
+        align = mAlign;
+    }
+    std::pair<void*, size_t> pointer;
+    if (mReplaying) {
+        pointer = replayAlloc(size, separate, align);
+    }
+    if (nullptr == pointer.first) {
+        pointer = allocInside(size, separate, align);
+    }
+    if (mRecording && nullptr != pointer.first) {
+        recordEvent(pointer, size, separate, align);
+    }
+    return pointer;
+}
+
+std::pair<void*, size_t> BufferAllocator::allocInside(size_t size, bool separate, size_t align) {
 #ifdef DUMP_USAGE
     auto memoryUsed = size / 1024.0f / 1024.0f;
     MNN_PRINT("Alloc: %f\n", memoryUsed);
 #endif
-    if (0 == align) {
-        align = mAlign;
-    }
     std::pair<void*, size_t> pointer;
     // reuse if possible
     if (!separate) {
         if (nullptr != mCurrentFreeList) {
             pointer = getFromFreeList(mCurrentFreeList, size, false, align);
         }
+        // The memory freed by outer groups before the barrier can be used by every inner group
+        for (int i = (int)mBarriers.size() - 1; i >= 0 && nullptr == pointer.first; --i) {
+            auto outer = mBarriers[i].outerFreeList;
+            if (nullptr != outer && outer != mCurrentFreeList) {
+                pointer = getFromFreeList(outer, size, false, align);
+            }
+        }
         if (nullptr != pointer.first) {
             return pointer;
         }
@@ -91,6 +315,7 @@ std::pair<void*, size_t> BufferAllocator::alloc(size_t size, bool separate, size
         return pointer;
     }
     mTotalSize += size;
+    _traceTotalSize(this, mTotalSize);
 
     // save node
     SharedPtr<Node> node(new Node);
@@ -139,6 +364,36 @@ void BufferAllocator::returnMemory(FREELIST* listP, SharedPtr<Node> node, bool p
 }
 
 bool BufferAllocator::free(std::pair<void*, size_t> pointer) {
+    if (mRecording) {
+        auto r = mRecordLive.find(pointer);
+        if (r != mRecordLive.end()) {
+            auto index = r->second;
+            mRecordLive.erase(r);
+            if (!mBarriers.empty()) {
+                // Other groups may still use the memory until barrierEnd
+                mBarrierFree.emplace_back(index);
+            } else {
+                mRecord.buffers[index].end = (int)mRecord.events.size();
+            }
+            mRecord.events.emplace_back(-index - 1);
+        }
+    }
+    if (!mReplayLive.empty()) {
+        auto r = mReplayLive.find(pointer);
+        if (r != mReplayLive.end()) {
+            // The memory belongs to arena, nothing to return
+            auto index = r->second;
+            mReplayLive.erase(r);
+            if (mReplaying) {
+                if (mReplayPos < mPlan.events.size() && mPlan.events[mReplayPos] == -index - 1) {
+                    mReplayPos++;
+                } else {
+                    mReplaying = false;
+                }
+            }
+            return true;
+        }
+    }
     // get node
     auto x = mUsedList.find(pointer);
     if (x == mUsedList.end()) {
@@ -162,11 +417,17 @@ bool BufferAllocator::free(std::pair<void*, size_t> pointer) {
 }
 
 void BufferAllocator::release(bool allRelease) {
-    MNN_ASSERT(mGroups.empty());
+    MNN_ASSERT(mBarriers.empty());
     if (allRelease) {
         mUsedList.clear();
         mFreeList.clear();
         mTotalSize = 0;
+        // Keep the plan for next replay
+        mArena     = nullptr;
+        mReplaying = false;
+        mReplayLive.clear();
+        mRecordLive.clear();
+        _traceTotalSize(this, mTotalSize);
         return;
     }
     for (auto f : mFreeList) {
@@ -176,30 +437,47 @@ void BufferAllocator::release(bool allRelease) {
         }
     }
     mFreeList.clear();
+    _traceTotalSize(this, mTotalSize);
 }
 
 void BufferAllocator::barrierBegin() {
-    MNN_ASSERT(mGroups.empty());
+    Barrier barrier;
+    barrier.outerFreeList = mCurrentFreeList;
+    mBarriers.emplace_back(std::move(barrier));
 }
 
 void BufferAllocator::barrierEnd() {
-    for (auto& freeGroup : mGroups) {
+    MNN_ASSERT(!mBarriers.empty());
+    auto barrier = std::move(mBarriers.back());
+    mBarriers.pop_back();
+    mCurrentFreeList = barrier.outerFreeList;
+    if (mBarriers.empty()) {
+        for (auto index : mBarrierFree) {
+            mRecord.buffers[index].end = (int)mRecord.events.size();
+        }
+        mBarrierFree.clear();
+    }
+    for (auto& freeGroup : barrier.groups) {
         auto freeList = *freeGroup;
         for (auto& iter : freeList) {
-            returnMemory(&mFreeList, iter.second);
+            if (nullptr != barrier.outerFreeList) {
+                returnMemory(barrier.outerFreeList, iter.second, false);
+            } else {
+                returnMemory(&mFreeList, iter.second);
+            }
         }
     }
-    mGroups.clear();
 }
 
 void BufferAllocator::beginGroup() {
+    MNN_ASSERT(!mBarriers.empty());
     std::shared_ptr<FREELIST> newFreeList(new FREELIST);
     mCurrentFreeList = newFreeList.get();
-    mGroups.emplace_back(newFreeList);
+    mBarriers.back().groups.emplace_back(newFreeList);
 }
 
 void BufferAllocator::endGroup() {
-    mCurrentFreeList = nullptr;
+    mCurrentFreeList = mBarriers.back().outerFreeList;
 }
 
 std::pair<void*, size_t> BufferAllocator::getFromFreeList(FREELIST* list, size_t size, bool permiteSplit, size_t align) {
@@ -255,4 +533,136 @@ std::pair<void*, size_t> BufferAllocator::getFromFreeList(FREELIST* list, size_t
     MNN_ASSERT(pointer.second % align == 0);
     return pointer;
 }
+
+void BufferAllocator::recordEvent(std::pair<void*, size_t> pointer, size_t size, bool separate, size_t align) {
+    PlanBuffer buffer;
+    buffer.size   = std::max((size_t)1, UP_DIV(size, mAlign)) * mAlign;
+    buffer.align  = align;
+    // Separate memory can't reuse the memory freed before, make it live from the beginning
+    buffer.begin  = separate ? 0 : (int)mRecord.events.size();
+    buffer.end    = INT_MAX;
+    buffer.offset = 0;
+    int index = (int)mRecord.buffers.size();
+    mRecord.buffers.emplace_back(buffer);
+    mRecord.events.emplace_back(index);
+    mRecordLive[pointer] = index;
+}
+
+void BufferAllocator::beginRecord() {
+    mRecord = MemoryPlan();
+    mRecordLive.clear();
+    mBarrierFree.clear();
+    mRecording = true;
+}
+
+size_t BufferAllocator::endRecord() {
+    mRecording = false;
+    mRecordLive.clear();
+    mPlan       = std::move(mRecord);
+    mRecord     = MemoryPlan();
+    mPlan.align = mAlign;
+    for (auto& buffer : mPlan.buffers) {
+        mPlan.align = std::max(mPlan.align, buffer.align);
+    }
+    mPlan.size = computePlan(mPlan.buffers);
+    return mPlan.size;
+}
+
+size_t BufferAllocator::computePlan(std::vector<PlanBuffer>& buffers) {
+    // Greedy by size: place larger buffer first, use the smallest gap that fits among the placed buffers live at the same time
+    std::vector<int> order(buffers.size());
+    for (int i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&buffers](int a, int b) {
+        return buffers[a].size > buffers[b].size;
+    });
+    std::vector<int> placed;
+    std::vector<std::pair<size_t, size_t>> used;
+    size_t totalSize = 0;
+    for (auto index : order) {
+        auto& buffer = buffers[index];
+        used.clear();
+        for (auto p : placed) {
+            auto& other = buffers[p];
+            if (other.begin < buffer.end && buffer.begin < other.end) {
+                used.emplace_back(std::make_pair(other.offset, other.offset + other.size));
+            }
+        }
+        std::sort(used.begin(), used.end());
+        size_t bestOffset = 0;
+        size_t bestGap    = 0;
+        bool find         = false;
+        size_t current    = 0;
+        for (auto& u : used) {
+            auto offset = UP_DIV(current, buffer.align) * buffer.align;
+            if (u.first > offset && u.first - offset >= buffer.size) {
+                auto gap = u.first - offset;
+                if (!find || gap < bestGap) {
+                    find       = true;
+                    bestGap    = gap;
+                    bestOffset = offset;
+                }
+            }
+            current = std::max(current, u.second);
+        }
+        if (!find) {
+            bestOffset = UP_DIV(current, buffer.align) * buffer.align;
+        }
+        buffer.offset = bestOffset;
+        totalSize     = std::max(totalSize, bestOffset + buffer.size);
+        placed.emplace_back(index);
+    }
+    return totalSize;
+}
+
+bool BufferAllocator::beginReplay() {
+    if (mPlan.buffers.empty() || !mReplayLive.empty()) {
+        return false;
+    }
+    if (nullptr != mArena.get() && mArena->size < mPlan.size) {
+        mTotalSize -= mArena->size;
+        mArena = nullptr;
+    }
+    mReplaying   = true;
+    mReplayPos   = 0;
+    mReplayAlloc = 0;
+    return true;
+}
+
+bool BufferAllocator::endReplay() {
+    bool complete = mReplaying && mReplayPos == mPlan.events.size();
+    mReplaying    = false;
+    return complete;
+}
+
+std::pair<void*, size_t> BufferAllocator::replayAlloc(size_t size, bool separate, size_t align) {
+    // Any difference from the recorded sequence make the rest plan invalid
+    mReplaying = false;
+    if (mReplayPos >= mPlan.events.size() || mPlan.events[mReplayPos] != mReplayAlloc) {
+        return std::make_pair(nullptr, 0);
+    }
+    auto& buffer = mPlan.buffers[mReplayAlloc];
+    if (size > buffer.size || buffer.offset % align != 0 || (separate && buffer.begin != 0)) {
+        return std::make_pair(nullptr, 0);
+    }
+    if (nullptr == mArena.get()) {
+        auto pointer = mAllocator->onAlloc(mPlan.size, mPlan.align);
+        if (nullptr == pointer.first) {
+            return pointer;
+        }
+        mTotalSize += mPlan.size;
+        _traceTotalSize(this, mTotalSize);
+        mArena = new Node;
+        mArena->size    = mPlan.size;
+        mArena->pointer = pointer;
+        mArena->outside = mAllocator.get();
+    }
+    mReplaying = true;
+    auto pointer = std::make_pair(mArena->pointer.first, mArena->pointer.second + buffer.offset);
+    mReplayLive[pointer] = mReplayAlloc;
+    mReplayAlloc++;
+    mReplayPos++;
+    return pointer;
+}
 } // namespace MNN
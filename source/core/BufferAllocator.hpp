@@ -29,6 +29,17 @@ public:
         virtual void onRelease(std::pair<void*, size_t> ptr) = 0;
         static std::shared_ptr<Allocator> createDefault();
         static std::shared_ptr<Allocator> createRecurse(BufferAllocator* parent);
+        /**
+         Reserve regions backed by 2MB huge pages and sub-allocate from them, the explicit huge pages are used if
+         the system has reserved them, otherwise transparent huge pages are advised. The pages are placed on
+         numaNode if it's not negative. Fall back to the default allocator on systems other than Linux.
+         */
+        static std::shared_ptr<Allocator> createHugePage(int numaNode = -1);
+        /**
+         Sub-allocate from mapped regions whose pages are placed on numaNode, the regions are bound before they are
+         touched. Fall back to the default allocator on systems other than Linux.
+         */
+        static std::shared_ptr<Allocator> createNUMA(int numaNode);
     };
     /**
      * @brief init buffer allocator with pointer alignment.
@@ -85,13 +96,26 @@ public:
      begin barrier / end barrier means enter the alloc for multi-thread
      begin group / end group means the memory allocated belong to one thread
      different group must use different memory,
-     but the origin freelist can be used by every group
+     but the origin freelist can be used by every group.
+     Barriers can be nested inside a group, the memory freed by inner groups returns to the outer group at barrierEnd
      */
     void barrierBegin();
     void barrierEnd();
     void beginGroup();
     void endGroup();
 
+    /*
+     Lifetime based memory plan.
+     Between beginRecord / endRecord, every alloc / free is recorded as a buffer with its live range,
+     endRecord packs the buffers by live range (greedy by size, best fit) and returns the planned peak size.
+     After beginReplay, allocs replay the plan as offsets in one arena, if the alloc / free sequence differs
+     from the recorded one, the rest allocs turn back to the free list. endReplay returns whether the plan is used totally.
+     */
+    void beginRecord();
+    size_t endRecord();
+    bool beginReplay();
+    bool endReplay();
+
 private:
     class Node : public RefCount {
     public:
@@ -108,12 +132,48 @@ private:
     static void returnMemory(FREELIST* list, SharedPtr<Node> node, bool permitMerge = true);
     std::pair<void*, size_t> getFromFreeList(FREELIST* list, size_t size, bool permiteSplit, size_t align);
 
+    struct PlanBuffer {
+        size_t size;
+        size_t align;
+        int begin;
+        int end;
+        size_t offset;
+    };
+    struct MemoryPlan {
+        std::vector<PlanBuffer> buffers;
+        // Alloc as buffer index, free as -(buffer index) - 1
+        std::vector<int> events;
+        size_t size = 0;
+        size_t align = 0;
+    };
+    std::pair<void*, size_t> allocInside(size_t size, bool separate, size_t align);
+    static size_t computePlan(std::vector<PlanBuffer>& buffers);
+    std::pair<void*, size_t> replayAlloc(size_t size, bool separate, size_t align);
+    void recordEvent(std::pair<void*, size_t> pointer, size_t size, bool separate, size_t align);
+
+    bool mRecording = false;
+    MemoryPlan mRecord;
+    std::map<std::pair<void*, size_t>, int> mRecordLive;
+    std::vector<int> mBarrierFree;
+
+    bool mReplaying = false;
+    int mReplayPos = 0;
+    int mReplayAlloc = 0;
+    MemoryPlan mPlan;
+    SharedPtr<Node> mArena;
+    std::map<std::pair<void*, size_t>, int> mReplayLive;
+
     std::map<std::pair<void*, size_t>, SharedPtr<Node>> mUsedList;
     FREELIST mFreeList;
     size_t mTotalSize   = 0;
 
+    struct Barrier {
+        // Free list of the group which begins the barrier, nullptr for the outermost barrier
+        FREELIST* outerFreeList = nullptr;
+        std::vector<std::shared_ptr<FREELIST>> groups;
+    };
     FREELIST* mCurrentFreeList = nullptr;
-    std::vector<std::shared_ptr<FREELIST>> mGroups;
+    std::vector<Barrier> mBarriers;
     std::shared_ptr<Allocator> mAllocator;
     size_t mAlign;
 };
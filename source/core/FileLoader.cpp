@@ -9,6 +9,9 @@
 #include "core/FileLoader.hpp"
 #if defined(_MSC_VER)
 #include "Windows.h"
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
 #endif
 namespace MNN {
 FileLoader::FileLoader(const char* file) {
@@ -33,6 +36,11 @@ FileLoader::FileLoader(const char* file) {
 }
 
 FileLoader::~FileLoader() {
+#if !defined(_MSC_VER)
+    if (nullptr != mMapData) {
+        munmap(mMapData, mTotalSize);
+    }
+#endif
     if (nullptr != mFile) {
         fclose(mFile);
     }
@@ -73,6 +81,33 @@ bool FileLoader::read() {
     return true;
 }
 
+bool FileLoader::map() {
+#if defined(_MSC_VER)
+    return false;
+#else
+    if (nullptr != mMapData) {
+        return true;
+    }
+    if (nullptr == mFile) {
+        return false;
+    }
+    auto fd = fileno(mFile);
+    struct stat fileStat;
+    if (0 != fstat(fd, &fileStat) || fileStat.st_size <= 0) {
+        return false;
+    }
+    auto size = (size_t)fileStat.st_size;
+    auto ptr  = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if (MAP_FAILED == ptr) {
+        MNN_PRINT("Map file %s failed\n", mFilePath);
+        return false;
+    }
+    mMapData   = (uint8_t*)ptr;
+    mTotalSize = size;
+    return true;
+#endif
+}
+
 bool FileLoader::write(const char* filePath, std::pair<const void*, size_t> cacheInfo) {
     FILE* f = fopen(filePath, "wb");
     if (nullptr == f) {
@@ -105,6 +140,10 @@ bool FileLoader::merge(AutoStorage<uint8_t>& buffer) {
         MNN_PRINT("Memory Alloc Failed\n");
         return false;
     }
+    if (nullptr != mMapData) {
+        ::memcpy(buffer.get(), mMapData, mTotalSize);
+        return true;
+    }
     auto dst   = buffer.get();
     int offset = 0;
     for (auto iter : mBlocks) {
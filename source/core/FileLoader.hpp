@@ -17,7 +17,18 @@ public:
     ~FileLoader();
 
     bool read();
-    
+
+    /**
+     * @brief map the whole file to memory instead of reading it. Pages are loaded on demand and shared with other
+     * processes mapping the same file, writes are private copy-on-write.
+     * @return false if the platform don't support it, use read() instead then
+     */
+    bool map();
+
+    inline uint8_t* mapData() const {
+        return mMapData;
+    }
+
     static bool write(const char* filePath, std::pair<const void*, size_t> cacheInfo);
 
     bool valid() const {
@@ -38,5 +49,6 @@ private:
     static const int gCacheSize = 4096;
     size_t mTotalSize           = 0;
     const char* mFilePath       = nullptr;
+    uint8_t* mMapData           = nullptr;
 };
 } // namespace MNN
@@ -18,6 +18,7 @@
 #include "core/Pipeline.hpp"
 #include "core/RuntimeFactory.hpp"
 #include "core/Session.hpp"
+#include "core/Tracer.hpp"
 #include <MNN/AutoTime.hpp>
 #include "backend/cpu/CPUBackend.hpp"
 
@@ -30,6 +31,8 @@ namespace MNN {
 
 struct Content {
     AutoStorage<uint8_t> buffer;
+    // Set when the model file is mapped, buffer is empty then
+    std::unique_ptr<FileLoader> mapLoader;
     const Net* net = nullptr;
     std::vector<std::unique_ptr<Session>> sessions;
     std::map<Tensor*, const Session*> tensorMap;
@@ -46,6 +49,18 @@ struct Content {
     std::map<std::string, std::string> basicLogginData;
     std::map<const Session*, std::tuple<int, int>> sessionInfo;
 #endif
+    const uint8_t* modelBuffer() const {
+        if (nullptr != mapLoader.get()) {
+            return mapLoader->mapData();
+        }
+        return buffer.get();
+    }
+    size_t modelSize() const {
+        if (nullptr != mapLoader.get()) {
+            return mapLoader->size();
+        }
+        return buffer.size();
+    }
 };
 
 const char* getVersion() {
@@ -60,7 +75,7 @@ static void writeCacheFile(const Content *net, std::pair<const void*, size_t> bu
     }
 }
 
-static Content* loadModelFile(const char* file) {
+static Content* loadModelFile(const char* file, bool mapFile) {
     if (nullptr == file) {
         MNN_PRINT("NULL file for create interpreter\n");
         return nullptr;
@@ -70,6 +85,11 @@ static Content* loadModelFile(const char* file) {
         MNN_PRINT("Create interpreter failed, open %s error\n", file);
         return nullptr;
     }
+    if (mapFile && loader->map()) {
+        auto net       = new Content;
+        net->mapLoader = std::move(loader);
+        return net;
+    }
     bool result = loader->read();
     if (!result) {
         MNN_PRINT("Read file error\n");
@@ -89,7 +109,10 @@ static Content* loadModelFile(const char* file) {
 }
 
 Interpreter* Interpreter::createFromFile(const char* file) {
-    Content* net = loadModelFile(file);
+    return createFromFile(file, false);
+}
+Interpreter* Interpreter::createFromFile(const char* file, bool mapFile) {
+    Content* net = loadModelFile(file, mapFile);
     if (nullptr == net) {
         return nullptr;
     }
@@ -118,14 +141,14 @@ Interpreter* Interpreter::createFromBufferInternal(Content* net, bool enforceAut
         return nullptr;
     }
 #ifndef MNN_BUILD_MINI
-    flatbuffers::Verifier verify((const uint8_t*)(net->buffer.get()), net->buffer.size());
+    flatbuffers::Verifier verify(net->modelBuffer(), net->modelSize());
     if (false == VerifyNetBuffer(verify)) {
         MNN_PRINT("Invalidate buffer to create interpreter\n");
         delete net;
         return nullptr;
     }
 #endif
-    net->net = GetNet(net->buffer.get());
+    net->net = GetNet(net->modelBuffer());
     if (nullptr == net->net->oplists()) {
         MNN_ERROR("Model has no oplist\n");
         delete net;
@@ -144,11 +167,27 @@ Interpreter* Interpreter::createFromBufferInternal(Content* net, bool enforceAut
     return new Interpreter(net);
 }
 
+bool Interpreter::dumpTrace(const char* fileName) {
+    return Tracer::dump(fileName);
+}
+
 void Interpreter::setSessionHint(HintMode mode, int hint) {
     switch (mode) {
         case MAX_TUNING_NUMBER:
             mNet->modes.maxTuningNumber = hint;
             break;
+        case MEMORY_PLAN:
+            mNet->modes.memoryPlan = hint > 0;
+            break;
+        case TRACE:
+            mNet->modes.trace->store(hint > 0);
+            break;
+        case INTER_OP_PARALLEL:
+            mNet->modes.interOpParallel = hint > 0;
+            break;
+        case RESIZE_CACHE_SIZE:
+            MNN_ERROR("RESIZE_CACHE_SIZE is only used by Module, set it by Executor::RuntimeManager::setHint\n");
+            break;
         default:
             break;
     }
@@ -169,7 +208,7 @@ void Interpreter::setSessionMode(SessionMode mode) {
 }
 
 void Interpreter::setCacheFile(const char* cacheFile, size_t keySize) {
-    if (nullptr == cacheFile || nullptr == mNet->buffer.get()) {
+    if (nullptr == cacheFile || nullptr == mNet->modelBuffer()) {
         MNN_ERROR("Empty cacheFile or the interpreter invalid\n");
         return;
     }
@@ -204,6 +243,7 @@ ErrorCode Interpreter::updateCacheFile(Session *session, int flag) {
 
     // Backend_Auto and no Async work, then don't need updateCache
     if(mNet->modes.backendMode == Session_Backend_Auto && !(session->hasAsyncWork())) {
+        session->setCacheRecord(false);
         return NO_ERROR;
     }
     
@@ -218,6 +258,7 @@ ErrorCode Interpreter::updateCacheFile(Session *session, int flag) {
     }
     // Reset cache
     session->loadCache(nullptr, 0);
+    session->setCacheRecord(false);
     return NO_ERROR;
 }
 
@@ -234,6 +275,10 @@ Interpreter::Interpreter(Content* net) {
 }
 
 Interpreter::~Interpreter() {
+    // Async runs take the lock, finish them before
+    for (auto& session : mNet->sessions) {
+        session->asyncQueue()->wait();
+    }
     {
         // If the session is running, we must not delete session
         std::unique_lock<std::mutex> _l(mNet->lock);
@@ -254,7 +299,7 @@ Session* Interpreter::createMultiPathSession(const std::vector<ScheduleConfig>&
 }
 
 Session* Interpreter::createMultiPathSession(const std::vector<ScheduleConfig>& configs, const RuntimeInfo& runtime) {
-    if (nullptr == mNet->buffer.get()) {
+    if (nullptr == mNet->modelBuffer()) {
         MNN_ERROR("The model buffer has been released. Can't create session\n");
         return nullptr;
     }
@@ -268,6 +313,8 @@ Session* Interpreter::createMultiPathSession(const std::vector<ScheduleConfig>&
 #endif
     int cacheMode = 0; // No cache
     Schedule::ScheduleInfo info;
+    // The mapped model is kept until the interpreter is destroyed, so const data can be used in place
+    info.referenceConstData = nullptr != mNet->mapLoader.get();
     auto success = Schedule::schedule(info, mNet->net, configs, runtime);
     if (!success) {
         return nullptr;
@@ -280,6 +327,9 @@ Session* Interpreter::createMultiPathSession(const std::vector<ScheduleConfig>&
     }
     RuntimeInfo rt = runtime;
     bool valid  = false;
+    for (auto iter : rt.first) {
+        iter.second->onSetCacheRecord(!mNet->cacheFile.empty());
+    }
     if (mNet->cacheBuffer.get() != nullptr) {
         for (auto iter : rt.first) {
             valid = iter.second->onSetCache(mNet->cacheBuffer.get(),
@@ -295,6 +345,11 @@ Session* Interpreter::createMultiPathSession(const std::vector<ScheduleConfig>&
             mNet->lastCacheSize = mNet->cacheBuffer.size();
             cacheMode = cacheMode | 1; // READ cache
         }
+    } else if (!mNet->cacheFile.empty()) {
+        // No cache yet, reset the runtimes so that they record cache for writing
+        for (auto iter : rt.first) {
+            iter.second->onSetCache(nullptr, 0);
+        }
     }
 
     auto newSession =
@@ -305,8 +360,10 @@ Session* Interpreter::createMultiPathSession(const std::vector<ScheduleConfig>&
     }
     auto result = newSession.get();
     auto validForResize = info.validForResize;
+    bool resized = false;
     if (validForResize && mNet->modes.inputMode == Session_Input_Inside && mNet->modes.resizeMode == Session_Resize_Direct) {
         result->resize();
+        resized = true;
     }
 
     if ((!mNet->cacheFile.empty()) && (!valid) && mNet->modes.backendMode == Session_Backend_Fix) {
@@ -322,6 +379,10 @@ Session* Interpreter::createMultiPathSession(const std::vector<ScheduleConfig>&
     }
     // Reset cache
     result->loadCache(nullptr, 0);
+    if (resized) {
+        // The cache has been written, stop recording
+        result->setCacheRecord(false);
+    }
 
     mNet->sessions.emplace_back(std::move(newSession));
 
@@ -341,7 +402,7 @@ Session* Interpreter::createMultiPathSession(const std::vector<ScheduleConfig>&
         metrics.emplace("Mode", std::to_string(mode));
         metrics.emplace("Cache", std::to_string(cacheMode));
         metrics.emplace("CacheSize", std::to_string((float)(mNet->lastCacheSize / 1024.0f)));
-        metrics.emplace("ModelSize", std::to_string ((float)mNet->buffer.size() / 1024.0f / 1024.0f));
+        metrics.emplace("ModelSize", std::to_string ((float)mNet->modelSize() / 1024.0f / 1024.0f));
         metrics.emplace("Usage", std::to_string((int) mNet->net->usage()));
         metrics.emplace("API", "Interpreter::createMultiPathSession");
         logAsync(metrics);
@@ -360,6 +421,9 @@ Session* Interpreter::createSession(const ScheduleConfig& config, const RuntimeI
 }
 
 bool Interpreter::releaseSession(Session* session) {
+    if (nullptr != session) {
+        session->asyncQueue()->wait();
+    }
     std::unique_lock<std::mutex> _l(mNet->lock);
     for (auto iter = mNet->sessions.begin(); iter != mNet->sessions.end(); iter++) {
         // TODO Delete tensormap
@@ -421,6 +485,31 @@ ErrorCode Interpreter::runSession(Session* session) const {
     return errorcode;
 }
 
+void Interpreter::runSessionAsync(Session* session, std::function<void(ErrorCode)> callback) const {
+    std::shared_ptr<ErrorCode> code(new ErrorCode(NO_ERROR));
+    auto run = [this, session, code]() {
+        std::unique_lock<std::mutex> _l(mNet->lock);
+        *code = session->run();
+        waitSessionFinish(session);
+    };
+    std::function<void()> finish;
+    if (nullptr != callback) {
+        finish = [callback, code]() {
+            callback(*code);
+        };
+    }
+    session->asyncQueue()->post(std::move(run), std::move(finish));
+}
+
+std::future<ErrorCode> Interpreter::runSessionAsync(Session* session) const {
+    std::shared_ptr<std::promise<ErrorCode>> promise(new std::promise<ErrorCode>);
+    auto future = promise->get_future();
+    runSessionAsync(session, [promise](ErrorCode code) {
+        promise->set_value(code);
+    });
+    return future;
+}
+
 Tensor* Interpreter::getSessionInput(const Session* session, const char* name) {
     if (session == nullptr) {
         return nullptr;
@@ -464,7 +553,7 @@ void Interpreter::resizeSession(Session* session) {
 
 void Interpreter::resizeSession(Session* session, int needRelloc) {
     std::unique_lock<std::mutex> _l(mNet->lock);
-    if (mNet->buffer.get() == nullptr) {
+    if (mNet->modelBuffer() == nullptr) {
         MNN_ERROR("The model buffer has been released. Can't resize session\n");
         return;
     }
@@ -524,6 +613,7 @@ void Interpreter::releaseModel() {
     for (auto& session : mNet->sessions) {
         session->waitAsyncResize();
     }
+    // Mapped model is shared page cache and const tensors may reference it, don't release it
     if (mNet->buffer.get() != nullptr && mNet->net->usage() != Usage_INFERENCE_STATIC) {
         mNet->buffer.release();
     }
@@ -576,11 +666,11 @@ const char* Interpreter::uuid() const {
 }
 
 std::pair<const void*, size_t> Interpreter::getModelBuffer() const {
-    return std::make_pair(mNet->buffer.get(), mNet->buffer.size());
+    return std::make_pair(mNet->modelBuffer(), mNet->modelSize());
 }
 ErrorCode Interpreter::updateSessionToModel(Session* session) {
     std::unique_lock<std::mutex> _l(mNet->lock);
-    if (mNet->buffer.get() == nullptr) {
+    if (mNet->modelBuffer() == nullptr) {
         MNN_ERROR("Can't updateSessionToModel because you called releaseModel before\n");
         return INPUT_DATA_ERROR;
     }
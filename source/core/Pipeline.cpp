@@ -15,6 +15,7 @@
 #include "geometry/GeometryComputerUtils.hpp"
 #include "shape/SizeComputer.hpp"
 #include "core/OpCommonUtils.hpp"
+#include "core/Tracer.hpp"
 
 // TODO: Find better way for debug
 //#define MNN_OP_SEPERATE
@@ -76,7 +77,28 @@ static bool _supportQuant(const Op* op, const std::vector<Tensor*>& inputs, cons
             }
         case OpType_BinaryOp:
             return type == MNN_FORWARD_NN;
-            return false;
+        // int8 kernels of cpu compute along the rows of the linear layout
+        case OpType_LayerNorm:
+        case OpType_Softmax:
+            if (type != MNN_FORWARD_CPU && type != MNN_FORWARD_CPU_EXTENSION) {
+                return false;
+            }
+            return inputs.size() == 1 && TensorUtils::getDescribe(inputs[0])->dimensionFormat != MNN_DATA_FORMAT_NC4HW4;
+        case OpType_UnaryOp:
+            if (type != MNN_FORWARD_CPU && type != MNN_FORWARD_CPU_EXTENSION) {
+                return false;
+            }
+            // computed by a table of the 256 input values
+            switch (op->main_as_UnaryOp()->opType()) {
+                case UnaryOpOperation_GELU:
+                case UnaryOpOperation_GELU_STANDARD:
+                case UnaryOpOperation_SIGMOID:
+                case UnaryOpOperation_TANH:
+                case UnaryOpOperation_HARDSWISH:
+                    return true;
+                default:
+                    return false;
+            }
     }
     return false;
 }
@@ -184,7 +206,7 @@ void Pipeline::UnitInfo::setUp(const Command& command, int index, const Op* orig
 #endif
 }
 
-Pipeline::Pipeline(Schedule::PipelineInfo&& info, bool allocInput, bool outputStatic, const TuningAttr& tune, const Runtime* rt, const Runtime* cpuRt)
+Pipeline::Pipeline(Schedule::PipelineInfo&& info, bool allocInput, bool outputStatic, bool planMemory, bool interOpParallel, const TuningAttr& tune, const Runtime* rt, const Runtime* cpuRt)
 #ifndef MNN_BUILD_MINI
     : mContext(info.first.cache.second, info.first.cache.first->type()), mUseGeometry(rt->onGetCompilerType()) {
 #else
@@ -195,6 +217,8 @@ Pipeline::Pipeline(Schedule::PipelineInfo&& info, bool allocInput, bool outputSt
     mTuneAttr = tune;
     mAllocInput    = allocInput;
     mOutputStatic  = outputStatic;
+    mPlanMemory    = planMemory;
+    mInterOpParallel = interOpParallel;
     mInfo          = std::move(info);
     mIsQuantModel = false;
     for (auto& iter : mInfo.second) {
@@ -873,7 +897,198 @@ ErrorCode Pipeline::allocMemory(bool firstMalloc) {
         }
     }
     /* Insert Wrap End*/
+    _buildStages();
+
+    auto code = _allocAndResize();
+    if (NO_ERROR != code) {
+        return code;
+    }
+    mMemoryPlan = mBackend->onPlanMemory(mPlanMemory);
+    if (mPlanMemory && mMemoryPlan.second < mMemoryPlan.first) {
+        // Resize again to place the dynamic buffers by the plan
+        mBackend->onClearBuffer();
+        mBackupBackend->onClearBuffer();
+        code = _allocAndResize();
+        if (NO_ERROR != code) {
+            return code;
+        }
+        mMemoryPlan.first = mBackend->onPlanMemory(false).first;
+    }
+    return NO_ERROR;
+}
+
+void Pipeline::_buildStages() {
+    mStages.clear();
+    if (!mInterOpParallel) {
+        return;
+    }
+    std::vector<Command*> commands;
+    for (auto& info : mInfo.second) {
+        for (auto& cmdP : info.executeBuffer.command) {
+            commands.emplace_back(cmdP.get());
+        }
+    }
+    // Dependency by tensor usage: read after write, write after read / write. Tensors sharing describe share memory.
+    // Commands sharing one execution also depend on each other
+    typedef const Tensor::InsideDescribe::NativeInsideDescribe* TensorKey;
+    std::map<TensorKey, int> lastWriter;
+    std::map<TensorKey, std::vector<int>> readers;
+    std::map<const Execution*, int> lastUser;
+    std::vector<std::set<int>> depends(commands.size());
+    std::vector<int> consumerNumber(commands.size(), 0);
+    for (int i = 0; i < commands.size(); ++i) {
+        auto cmd = commands[i];
+        auto& dep = depends[i];
+        for (auto t : cmd->workInputs) {
+            auto key    = TensorUtils::getDescribe(t);
+            auto writer = lastWriter.find(key);
+            if (writer != lastWriter.end()) {
+                dep.insert(writer->second);
+            }
+            readers[key].emplace_back(i);
+        }
+        for (auto t : cmd->workOutputs) {
+            auto key    = TensorUtils::getDescribe(t);
+            auto writer = lastWriter.find(key);
+            if (writer != lastWriter.end()) {
+                dep.insert(writer->second);
+            }
+            auto& tReaders = readers[key];
+            for (auto r : tReaders) {
+                if (r != i) {
+                    dep.insert(r);
+                }
+            }
+            tReaders.clear();
+            lastWriter[key] = i;
+        }
+        auto exe = cmd->execution.get();
+        auto user = lastUser.find(exe);
+        if (user != lastUser.end()) {
+            dep.insert(user->second);
+        }
+        lastUser[exe] = i;
+        for (auto d : dep) {
+            consumerNumber[d]++;
+        }
+    }
+
+    // Split commands into stages. In one stage, a command joins the branch of its dependencies or starts a new one,
+    // a command depending on several branches ends the stage, and a fork on the only branch ends it too so that
+    // its consumers start new branches
+    int stageBegin = 0;
+    std::vector<int> branchOf(commands.size(), -1);
+    std::vector<std::vector<int>> branches;
+    bool hasConcurrent = false;
+    auto finishStage = [&]() {
+        if (branches.empty()) {
+            return;
+        }
+        Stage stage;
+        std::map<TensorKey, int> readBranch;
+        for (int b = 0; b < branches.size(); ++b) {
+            std::vector<Command*> branch;
+            for (auto index : branches[b]) {
+                branch.emplace_back(commands[index]);
+                for (auto t : commands[index]->workInputs) {
+                    auto key  = TensorUtils::getDescribe(t);
+                    auto iter = readBranch.find(key);
+                    if (iter == readBranch.end()) {
+                        readBranch.insert(std::make_pair(key, b));
+                    } else if (iter->second != b) {
+                        stage.sharedInputs.insert(key);
+                    }
+                }
+            }
+            stage.branches.emplace_back(std::move(branch));
+        }
+        hasConcurrent = hasConcurrent || stage.branches.size() > 1;
+        mStages.emplace_back(std::move(stage));
+        branches.clear();
+    };
+    for (int i = 0; i < commands.size(); ++i) {
+        std::set<int> innerBranch;
+        for (auto d : depends[i]) {
+            if (d >= stageBegin) {
+                innerBranch.insert(branchOf[d]);
+            }
+        }
+        if (innerBranch.size() > 1) {
+            finishStage();
+            stageBegin = i;
+            innerBranch.clear();
+        }
+        if (innerBranch.empty()) {
+            branchOf[i] = (int)branches.size();
+            branches.emplace_back(std::vector<int>{i});
+        } else {
+            branchOf[i] = *innerBranch.begin();
+            branches[branchOf[i]].emplace_back(i);
+        }
+        if (branches.size() == 1 && consumerNumber[i] > 1) {
+            finishStage();
+            stageBegin = i + 1;
+        }
+    }
+    finishStage();
+    if (!hasConcurrent) {
+        mStages.clear();
+    }
+#ifdef MNN_PIPELINE_DEBUG
+    MNN_PRINT("Inter-op stages: %d, commands: %d\n", (int)mStages.size(), (int)commands.size());
+#endif
+}
+
+ErrorCode Pipeline::_resizeCommand(Command& iter, const Stage* stage, std::vector<Tensor*>& sharedRelease) {
+#ifdef MNN_PIPELINE_DEBUG
+    auto memory = const_cast<Runtime*>(mRuntime)->onGetMemoryInMB();
+    if (iter.op->name() != nullptr) {
+        MNN_PRINT("%f, before Resize: %s - %s\n", memory, iter.op->name()->c_str(), EnumNameOpType(iter.op->type()));
+    } else {
+        MNN_PRINT("%f, before Resize: %s\n", memory, EnumNameOpType(iter.op->type()));
+    }
+#endif
+
+    // MNN_PRINT("before Resize: optype:%s, name:%s, input0:%p, output0:%p, mAllocInput:%d\n", EnumNameOpType(iter.op->type()), iter.info->name().c_str(), iter.inputs[0], iter.outputs[0], mAllocInput);
+    // Alloc for Tensors
+    auto curBackend = iter.execution->backend();
+    if (mAllocInput) {
+        for (auto t : iter.workInputs) {
+            auto allocRes = _allocTensor(t, curBackend, mOutputStatic);
+            if (!allocRes) {
+                return OUT_OF_MEMORY;
+            }
+        }
+    }
+    {
+        for (auto t : iter.workOutputs) {
+            auto res = _allocTensor(t, curBackend, mOutputStatic);
+            if (!res) {
+                return OUT_OF_MEMORY;
+            }
+        }
+    }
+     // MNN_PRINT("before Resize 2, calling: %s \n", iter.info->name().c_str());
+    auto code = iter.execution->onResize(iter.workInputs, iter.workOutputs);
+    if (NO_ERROR != code && (!iter.info.get())) {
+        MNN_ERROR("Resize error for type = %s, name = %s \n", iter.info->type().c_str(), iter.info->name().c_str());
+        return code;
+    }
+    // Free mid tensor
+    for (auto t : iter.workInputs) {
+        if (nullptr != stage && stage->sharedInputs.find(TensorUtils::getDescribe(t)) != stage->sharedInputs.end()) {
+            // Other branches may still read it when running concurrently
+            sharedRelease.emplace_back(t);
+            continue;
+        }
+        _releaseTensor(t, mAllocInput);
+    }
+    return NO_ERROR;
+}
 
+ErrorCode Pipeline::_allocAndResize() {
+    auto& mBackend = mInfo.first.cache.first;
+    auto& mBackupBackend = mInfo.first.cache.second;
     // Compute RefCount Begin
     for (auto& info : mInfo.second) {
         auto& buffer = info.executeBuffer;
@@ -899,50 +1114,66 @@ ErrorCode Pipeline::allocMemory(bool firstMalloc) {
     // Compute RefCount End
 
     // Alloc tensor
+    mBackend->onRecordMemory(mPlanMemory);
     mBackend->onResizeBegin();
-    for (auto& info : mInfo.second) {
-        auto& buffer = info.executeBuffer;
-        for (auto iterP = buffer.command.begin(); iterP != buffer.command.end(); ++iterP) {
-            auto& iter = **iterP;
-#ifdef MNN_PIPELINE_DEBUG
-            auto memory = const_cast<Runtime*>(mRuntime)->onGetMemoryInMB();
-            if (iter.op->name() != nullptr) {
-                MNN_PRINT("%f, before Resize: %s - %s\n", memory, iter.op->name()->c_str(), EnumNameOpType(iter.op->type()));
-            } else {
-                MNN_PRINT("%f, before Resize: %s\n", memory, EnumNameOpType(iter.op->type()));
+    std::vector<Tensor*> sharedRelease;
+    if (mStages.empty()) {
+        for (auto& info : mInfo.second) {
+            auto& buffer = info.executeBuffer;
+            for (auto& iterP : buffer.command) {
+                auto code = _resizeCommand(*iterP, nullptr, sharedRelease);
+                if (NO_ERROR != code) {
+                    return code;
+                }
             }
-#endif
-
-            // MNN_PRINT("before Resize: optype:%s, name:%s, input0:%p, output0:%p, mAllocInput:%d\n", EnumNameOpType(iter.op->type()), iter.info->name().c_str(), iter.inputs[0], iter.outputs[0], mAllocInput);
-            // Alloc for Tensors
-            auto curBackend = iter.execution->backend();
-            if (mAllocInput) {
-                for (auto t : iter.workInputs) {
-                    auto allocRes = _allocTensor(t, curBackend, mOutputStatic);
-                    if (!allocRes) {
-                        return OUT_OF_MEMORY;
-                    }
+        }
+    }
+    for (auto& stage : mStages) {
+        if (stage.branches.size() == 1) {
+            for (auto cmd : stage.branches[0]) {
+                auto code = _resizeCommand(*cmd, nullptr, sharedRelease);
+                if (NO_ERROR != code) {
+                    return code;
                 }
             }
-            {
-                for (auto t : iter.workOutputs) {
-                    auto res = _allocTensor(t, curBackend, mOutputStatic);
-                    if (!res) {
-                        return OUT_OF_MEMORY;
-                    }
+            continue;
+        }
+        // Memory freed in one branch can only be reused by the same branch until all branches are resized
+        std::vector<Backend*> backends = {mBackend.get()};
+        if (mBackupBackend.get() != mBackend.get()) {
+            backends.emplace_back(mBackupBackend.get());
+        }
+        auto code = NO_ERROR;
+        for (auto bn : backends) {
+            bn->onResizeBarrier(true);
+        }
+        for (auto& branch : stage.branches) {
+            for (auto bn : backends) {
+                bn->onResizeGroup(true);
+            }
+            for (auto cmd : branch) {
+                code = _resizeCommand(*cmd, &stage, sharedRelease);
+                if (NO_ERROR != code) {
+                    break;
                 }
             }
-             // MNN_PRINT("before Resize 2, calling: %s \n", iter.info->name().c_str());
-            auto code = iter.execution->onResize(iter.workInputs, iter.workOutputs);
-            if (NO_ERROR != code && (!iter.info.get())) {
-                MNN_ERROR("Resize error for type = %s, name = %s \n", iter.info->type().c_str(), iter.info->name().c_str());
-                return code;
+            for (auto bn : backends) {
+                bn->onResizeGroup(false);
             }
-            // Free mid tensor
-            for (auto t : iter.workInputs) {
-                _releaseTensor(t, mAllocInput);
+            if (NO_ERROR != code) {
+                break;
             }
         }
+        for (auto bn : backends) {
+            bn->onResizeBarrier(false);
+        }
+        if (NO_ERROR != code) {
+            return code;
+        }
+        for (auto t : sharedRelease) {
+            _releaseTensor(t, mAllocInput);
+        }
+        sharedRelease.clear();
     }
     // Recycle All Dynamic Tensor
     for (auto& info : mInfo.second) {
@@ -973,16 +1204,81 @@ void Pipeline::_copyInputs() {
         std::get<3>(tensorCache) = false;
     }
 }
+static void _traceCommand(const Command& cmd, double traceBegin) {
+    auto traceEnd = Tracer::now();
+    std::string type = EnumNameOpType(cmd.op->type());
+    std::string name = type;
+    if (nullptr != cmd.info.get()) {
+        name = cmd.info->name();
+    } else if (nullptr != cmd.op->name()) {
+        name = cmd.op->name()->str();
+    }
+    Tracer::span("op", name, traceBegin, traceEnd, "\"type\":\"" + type + "\"");
+}
+
+ErrorCode Pipeline::_executeStages() {
+    auto& mBackend = mInfo.first.cache.first;
+    bool trace = Tracer::enabled();
+    auto runBranch = [trace](const std::vector<Command*>& branch) {
+        for (auto cmd : branch) {
+            double traceBegin = trace ? Tracer::now() : 0.0;
+            auto code = cmd->execution->onExecute(cmd->workInputs, cmd->workOutputs);
+            if (trace) {
+                _traceCommand(*cmd, traceBegin);
+            }
+            if (NO_ERROR != code) {
+                return code;
+            }
+        }
+        return NO_ERROR;
+    };
+    for (auto& stage : mStages) {
+        auto& branches = stage.branches;
+        if (branches.size() == 1) {
+            auto code = runBranch(branches[0]);
+            if (NO_ERROR != code) {
+                return code;
+            }
+            continue;
+        }
+        std::vector<ErrorCode> codes(branches.size(), NO_ERROR);
+        std::function<void(int)> task = [&](int b) {
+            codes[b] = runBranch(branches[b]);
+        };
+        if (!mBackend->onConcurrentRun(task, (int)branches.size())) {
+            for (int b = 0; b < branches.size(); ++b) {
+                task(b);
+            }
+        }
+        for (auto code : codes) {
+            if (NO_ERROR != code) {
+                return code;
+            }
+        }
+    }
+    return NO_ERROR;
+}
+
 ErrorCode Pipeline::execute() {
     _copyInputs();
     auto& mBackend = mInfo.first.cache.first;
     auto& mBackupBackend = mInfo.first.cache.second;
     mBackend->onExecuteBegin();
+    if (!mStages.empty()) {
+        auto code = _executeStages();
+        mBackend->onExecuteEnd();
+        return code;
+    }
+    bool trace = Tracer::enabled();
     for (auto& info : mInfo.second) {
         auto& buffer = info.executeBuffer;
         for (auto& cmdP : buffer.command) {
             auto& cmd = *cmdP;
+            double traceBegin = trace ? Tracer::now() : 0.0;
             auto code = cmd.execution->onExecute(cmd.workInputs, cmd.workOutputs);
+            if (trace) {
+                _traceCommand(cmd, traceBegin);
+            }
             if (NO_ERROR != code) {
                 mBackend->onExecuteEnd();
                 return code;
@@ -1013,7 +1309,11 @@ ErrorCode Pipeline::executeCallBack(const TensorCallBackWithInfo& before, const
             }
             auto run   = before(cmd.inputs, cmd.info.get());
             if (run) {
+                double traceBegin = Tracer::enabled() ? Tracer::now() : 0.0;
                 auto code = cmd.execution->onExecute(cmd.workInputs, cmd.workOutputs);
+                if (Tracer::enabled()) {
+                    _traceCommand(cmd, traceBegin);
+                }
                 if (NO_ERROR != code) {
                     mBackend->onExecuteEnd();
                     return code;
@@ -9,6 +9,7 @@
 #ifndef Pipeline_hpp
 #define Pipeline_hpp
 
+#include <set>
 #include "Schedule.hpp"
 #include "core/Execution.hpp"
 #include "geometry/GeometryComputer.hpp"
@@ -27,7 +28,7 @@ public:
         bool autoSetOpType;
         int maxTuningNumber;
     };
-    Pipeline(Schedule::PipelineInfo&& info, bool allocInput, bool outputStatic, const TuningAttr& tune, const Runtime* rt, const Runtime* cpuRt);
+    Pipeline(Schedule::PipelineInfo&& info, bool allocInput, bool outputStatic, bool planMemory, bool interOpParallel, const TuningAttr& tune, const Runtime* rt, const Runtime* cpuRt);
     ~Pipeline();
     class UnitInfo : public OperatorInfo {
     public:
@@ -60,12 +61,29 @@ public:
         return mInfo.first.cache.first->type();
     }
 private:
+    /** Commands of one stage, branches are independent and run concurrently, commands in one branch run in sequence */
+    struct Stage {
+        std::vector<std::vector<Command*>> branches;
+        // Inputs read by more than one branch, released after all branches of the stage are resized
+        std::set<const Tensor::InsideDescribe::NativeInsideDescribe*> sharedInputs;
+    };
     void _copyInputs();
     void _pushTuningTask(std::vector<Schedule::OpCacheInfo>&& initInfos);
     void _recycleDynamicMemory(Command* command);
+    void _buildStages();
+    ErrorCode _resizeCommand(Command& cmd, const Stage* stage, std::vector<Tensor*>& sharedRelease);
+    ErrorCode _allocAndResize();
+    ErrorCode _executeStages();
     Schedule::PipelineInfo mInfo;
     bool mAllocInput;
     bool mOutputStatic;
+    // Bind the dynamic buffers by lifetime based memory plan or not
+    bool mPlanMemory;
+    // Dynamic memory used and the planned peak in bytes, see Backend::onPlanMemory
+    std::pair<size_t, size_t> mMemoryPlan = std::make_pair(0, 0);
+    // Run independent branches of the graph concurrently or not, mStages is empty if there is no branch to overlap
+    bool mInterOpParallel;
+    std::vector<Stage> mStages;
     TuningAttr mTuneAttr;
     float mFlops = 0.0f;
     bool mIsQuantModel = false;
@@ -212,7 +212,7 @@ bool Schedule::schedule(ScheduleInfo& scheduleInfo, const Net* net, const std::v
         defaultConfig.flags = 4;
         scheduleInfo.defaultBackend.reset(runtimeInfo.second->onCreate(&defaultConfig));
         ErrorCode code = NO_ERROR;
-        initConstTensors(scheduleInfo.allTensors, net, scheduleInfo.defaultBackend.get(), code);
+        initConstTensors(scheduleInfo.allTensors, net, scheduleInfo.defaultBackend.get(), code, scheduleInfo.referenceConstData);
         if (NO_ERROR != code) {
             MNN_ERROR("Schedule Const init errorcode = %d\n", code);
             return false;
@@ -81,6 +81,10 @@ public:
         std::shared_ptr<Backend> defaultBackend;
         /** size need input's content*/
         bool needInputContentForShape = false;
+        /** const tensors reference data in the mapped model instead of copy it*/
+        bool referenceConstData = false;
+        /** keep the mapped model alive while const tensors reference it*/
+        std::shared_ptr<BufferStorage> constDataStorage;
     };
 
     /**
@@ -16,6 +16,7 @@
 #include "core/AutoStorage.h"
 #include "core/RuntimeFactory.hpp"
 #include "core/TensorUtils.hpp"
+#include "core/Tracer.hpp"
 #include "utils/InitNet.hpp"
 
 using namespace std;
@@ -47,6 +48,7 @@ static void _createPipelineBackend(Schedule::PipelineInfo& iter, RuntimeInfo& ru
 Session::Session(Schedule::ScheduleInfo&& info, const ModeGroup& mode, RuntimeInfo&& runtime) {
     mMode = mode;
     mRuntime = std::move(runtime);
+    mAsyncQueue.reset(new AsyncQueue);
     if (info.pipelineInfo.empty()) {
         mValid = false;
         return;
@@ -59,13 +61,14 @@ Session::Session(Schedule::ScheduleInfo&& info, const ModeGroup& mode, RuntimeIn
         attr.autoSetOpType = mode.backendMode == Interpreter::Session_Backend_Auto;
         auto rt    = mRuntime.first.find(iter.first.info.type)->second.get();
         auto cpuRuntime = mRuntime.second;
-        std::shared_ptr<Pipeline> newPipeline(new Pipeline(std::move(iter), mode.inputMode == Interpreter::Session_Input_Inside, mode.outputMode == Interpreter::Session_Output_User, attr, rt, cpuRuntime.get()));
+        std::shared_ptr<Pipeline> newPipeline(new Pipeline(std::move(iter), mode.inputMode == Interpreter::Session_Input_Inside, mode.outputMode == Interpreter::Session_Output_User, mode.memoryPlan, mode.interOpParallel, attr, rt, cpuRuntime.get()));
         mPipelines.emplace_back(std::move(newPipeline));
     }
     mCallBackMode = mode.callBackMode;
 }
 
 Session::~Session() {
+    mAsyncQueue->wait();
     for (auto& iter : mRuntime.first) {
         iter.second->mCancelled = true;
     }
@@ -90,6 +93,11 @@ bool Session::loadCache(const void* buffer, size_t size) {
     }
     return false;
 }
+void Session::setCacheRecord(bool record) {
+    for (auto iter : mRuntime.first) {
+        iter.second->onSetCacheRecord(record);
+    }
+}
 void Session::waitAsyncResize() {
     for (auto& iter : mRuntime.first) {
         iter.second->waitAsyncWork();
@@ -114,13 +122,21 @@ std::pair<const void*, size_t> Session::getCache() {
     }
     waitAsyncResize();
     
+    // The packed weights of cpu are only used when other runtimes has no cache, so that the cpu don't shadow the cache
+    // of main backend, such as the tuning result of gpu
+    std::pair<const void*, size_t> cpuCache(nullptr, 0);
     for (auto iter : mRuntime.first) {
         auto res = iter.second->onGetCache();
-        if (res.first != nullptr) {
-            return res;
+        if (res.first == nullptr) {
+            continue;
         }
+        if (iter.first == MNN_FORWARD_CPU) {
+            cpuCache = res;
+            continue;
+        }
+        return res;
     }
-    return std::make_pair(nullptr, 0);
+    return cpuCache;
 }
 
 ErrorCode Session::run() const {
@@ -128,6 +144,8 @@ ErrorCode Session::run() const {
         MNN_ERROR("Can't run session because not resized\n");
         return COMPUTE_SIZE_ERROR;
     }
+    Tracer::Guard _trace(mMode.trace->load());
+    Tracer::Scope _scope("session", "run");
     for (auto& iter : mPipelines) {
         auto error = iter->execute();
         if (NO_ERROR != error) {
@@ -143,6 +161,8 @@ ErrorCode Session::runWithCallBack(const TensorCallBackWithInfo& before, const T
         MNN_ERROR("Can't run session because not resized\n");
         return COMPUTE_SIZE_ERROR;
     }
+    Tracer::Guard _trace(mMode.trace->load());
+    Tracer::Scope _scope("session", "runWithCallBack");
     for (auto& iter : mPipelines) {
         auto error = iter->executeCallBack(before, end);
         if (NO_ERROR != error) {
@@ -171,6 +191,8 @@ ErrorCode Session::resize() {
         MNN_PRINT("\n");
     }
 #endif
+    Tracer::Guard _trace(mMode.trace->load());
+    Tracer::Scope _scope("session", "resize");
     bool firstMalloc = false;
     if (mNeedResize) {
         bool debug = mCallBackMode == Interpreter::Session_Debug;
@@ -235,6 +257,16 @@ bool Session::getInfo(Interpreter::SessionInfoCode code, void* ptr) const {
             *dst = summer;
             return true;
         } break;
+        case Interpreter::PLANNED_MEMORY: {
+            float summer = 0.0f;
+            getInfo(Interpreter::MEMORY, &summer);
+            for (auto& iter : mPipelines) {
+                auto& plan = iter->mMemoryPlan;
+                summer -= ((float)plan.first - (float)plan.second) / 1024.0f / 1024.0f;
+            }
+            *(float*)ptr = summer;
+            return true;
+        } break;
         case Interpreter::BACKENDS: {
             int pos = 0;
             auto res = (int32_t*)ptr;
@@ -263,6 +295,19 @@ bool Session::getInfo(Interpreter::SessionInfoCode code, void* ptr) const {
                 *dst = 0;
             }
         } break;
+        case Interpreter::RESIZE_CACHE: {
+            if (nullptr == mMode.resizeCacheInfo) {
+                return false;
+            }
+            auto dst = (int*)ptr;
+            dst[0]   = mMode.resizeCacheInfo->hit.load();
+            dst[1]   = mMode.resizeCacheInfo->miss.load();
+            return true;
+        } break;
+        case Interpreter::ASYNC_QUEUE: {
+            mAsyncQueue->getInfo((float*)ptr);
+            return true;
+        } break;
         // TODO: Support other debug info
         default:
             break;
@@ -10,9 +10,11 @@
 #define Session_hpp
 
 #include <MNN/Tensor.hpp>
+#include <atomic>
 #include <map>
 #include <memory>
 #include <vector>
+#include "AsyncQueue.hpp"
 #include "Pipeline.hpp"
 #include "Schedule.hpp"
 #include "core/Backend.hpp"
@@ -25,6 +27,11 @@ struct Net;
 /** infer unit. multiple sessions could share one net. */
 class MNN_PUBLIC Session {
 public:
+    // Hit / miss number of the shape keyed resize cache, shared by the sessions created from the same mode
+    struct ResizeCacheInfo {
+        std::atomic_int hit  = {0};
+        std::atomic_int miss = {0};
+    };
     struct ModeGroup {
         Interpreter::SessionMode callBackMode = Interpreter::Session_Debug;
         Interpreter::SessionMode inputMode = Interpreter::Session_Input_Inside;
@@ -32,6 +39,13 @@ public:
         Interpreter::SessionMode backendMode = Interpreter::Session_Backend_Fix;
         Interpreter::SessionMode resizeMode = Interpreter::Session_Resize_Direct;
         int maxTuningNumber = MNN_DEFAULT_TUNING_NUMBER;
+        bool memoryPlan = false;
+        // Shared by the sessions created from the same mode and read in each run, so the hint can be changed after
+        // creating session
+        std::shared_ptr<std::atomic_bool> trace = std::make_shared<std::atomic_bool>(false);
+        bool interOpParallel = false;
+        int resizeCacheSize = 0;
+        std::shared_ptr<ResizeCacheInfo> resizeCacheInfo;
     };
     Session(Schedule::ScheduleInfo&& info, const ModeGroup& mode,
             RuntimeInfo&& runtime);
@@ -79,6 +93,10 @@ public:
         return mRuntime.second.get();
     }
 
+    const RuntimeInfo& getRuntime() const {
+        return mRuntime;
+    }
+
 public:
     /**
      * @brief get backend that create the tensor.
@@ -125,10 +143,15 @@ public:
     void waitAsyncResize();
     bool hasAsyncWork();
     bool loadCache(const void* buffer, size_t size);
+    void setCacheRecord(bool record);
     std::pair<const void*, size_t> getCache();
 
     Tensor* getTensor(int index) const;
     Schedule::PipelineInfo& getPipelineInfo(int index) const;
+    // Serial queue of runSessionAsync
+    AsyncQueue* asyncQueue() const {
+        return mAsyncQueue.get();
+    }
 protected:
     const std::vector<std::shared_ptr<Pipeline>>& getPipelines() const {
         return this->mPipelines;
@@ -147,6 +170,7 @@ private:
     Interpreter::SessionMode mCallBackMode;
     Schedule::ScheduleInfo mInfo;
     ModeGroup mMode;
+    std::unique_ptr<AsyncQueue> mAsyncQueue;
 };
 } // namespace MNN
 
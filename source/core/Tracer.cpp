@@ -0,0 +1,189 @@
+//
+//  Tracer.cpp
+//  MNN
+//
+//  Created by MNN on 2021/12/15.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include "core/Tracer.hpp"
+#include <stdio.h>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Events kept for each thread, the oldest ones are overwritten after it
+#define MNN_TRACE_MAX_EVENTS_PER_THREAD (1 << 16)
+
+namespace MNN {
+static thread_local int gDepth = 0;
+
+namespace {
+struct TraceEvent {
+    char phase;
+    const char* category;
+    std::string name;
+    double ts;
+    double dur;
+    std::string args;
+};
+struct ThreadBuffer {
+    std::mutex lock;
+    int tid = 0;
+    std::string threadName;
+    std::vector<TraceEvent> events;
+    // Position to overwrite once events is full, it's also the oldest event
+    size_t next = 0;
+    void push(TraceEvent&& event) {
+        if (events.size() < MNN_TRACE_MAX_EVENTS_PER_THREAD) {
+            events.emplace_back(std::move(event));
+            return;
+        }
+        events[next] = std::move(event);
+        next         = (next + 1) % events.size();
+    }
+    void clear() {
+        events.clear();
+        next = 0;
+    }
+};
+struct TraceContext {
+    std::mutex lock;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+};
+} // namespace
+
+static TraceContext& _context() {
+    static TraceContext gContext;
+    return gContext;
+}
+
+static ThreadBuffer* _threadBuffer() {
+    thread_local std::shared_ptr<ThreadBuffer> gBuffer;
+    if (nullptr == gBuffer) {
+        gBuffer.reset(new ThreadBuffer);
+        auto& context = _context();
+        std::lock_guard<std::mutex> _l(context.lock);
+        gBuffer->tid = (int)context.buffers.size();
+        context.buffers.emplace_back(gBuffer);
+    }
+    return gBuffer.get();
+}
+
+static std::string _escape(const std::string& src) {
+    std::string dst;
+    dst.reserve(src.size());
+    for (auto c : src) {
+        if (c == '"' || c == '\\') {
+            dst.push_back('\\');
+            dst.push_back(c);
+        } else if ((unsigned char)c < 0x20) {
+            dst.push_back(' ');
+        } else {
+            dst.push_back(c);
+        }
+    }
+    return dst;
+}
+
+void Tracer::begin() {
+    // Make sure start time is fixed before any event
+    _context();
+    gDepth++;
+}
+
+void Tracer::end() {
+    gDepth--;
+}
+
+bool Tracer::enabled() {
+    return gDepth > 0;
+}
+
+double Tracer::now() {
+    auto duration = std::chrono::steady_clock::now() - _context().start;
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count() / 1000.0;
+}
+
+void Tracer::span(const char* category, const std::string& name, double beginUs, double endUs, const std::string& args) {
+    if (!enabled()) {
+        return;
+    }
+    auto buffer = _threadBuffer();
+    std::lock_guard<std::mutex> _l(buffer->lock);
+    buffer->push(TraceEvent{'X', category, name, beginUs, endUs - beginUs, args});
+}
+
+void Tracer::counter(const std::string& name, const std::string& series, double value) {
+    if (!enabled()) {
+        return;
+    }
+    char args[64];
+    snprintf(args, sizeof(args), "%.0f", value);
+    auto buffer = _threadBuffer();
+    std::lock_guard<std::mutex> _l(buffer->lock);
+    buffer->push(TraceEvent{'C', "memory", name, now(), 0.0, "\"" + _escape(series) + "\":" + args});
+}
+
+void Tracer::setThreadName(const std::string& name) {
+    auto buffer = _threadBuffer();
+    std::lock_guard<std::mutex> _l(buffer->lock);
+    buffer->threadName = name;
+}
+
+void Tracer::clear() {
+    auto& context = _context();
+    std::lock_guard<std::mutex> _l(context.lock);
+    for (auto& buffer : context.buffers) {
+        std::lock_guard<std::mutex> _bl(buffer->lock);
+        buffer->clear();
+    }
+}
+
+bool Tracer::dump(const char* fileName) {
+    FILE* f = fopen(fileName, "wb");
+    if (nullptr == f) {
+        MNN_ERROR("Open %s for trace failed\n", fileName);
+        return false;
+    }
+    auto& context = _context();
+    std::lock_guard<std::mutex> _l(context.lock);
+    fprintf(f, "{\"traceEvents\":[\n");
+    bool first = true;
+    auto separate = [&first, f]() {
+        if (!first) {
+            fprintf(f, ",\n");
+        }
+        first = false;
+    };
+    for (auto& buffer : context.buffers) {
+        std::lock_guard<std::mutex> _bl(buffer->lock);
+        if (buffer->events.empty()) {
+            continue;
+        }
+        if (!buffer->threadName.empty()) {
+            separate();
+            fprintf(f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                    buffer->tid, _escape(buffer->threadName).c_str());
+        }
+        auto size = buffer->events.size();
+        for (size_t i = 0; i < size; ++i) {
+            auto& e = buffer->events[(buffer->next + i) % size];
+            separate();
+            if (e.phase == 'X') {
+                fprintf(f, "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":0,\"tid\":%d,\"args\":{%s}}",
+                        _escape(e.name).c_str(), e.category, e.ts, e.dur, buffer->tid, e.args.c_str());
+            } else {
+                fprintf(f, "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":0,\"tid\":%d,\"args\":{%s}}",
+                        _escape(e.name).c_str(), e.category, e.ts, buffer->tid, e.args.c_str());
+            }
+        }
+        buffer->clear();
+    }
+    fprintf(f, "\n],\"displayTimeUnit\":\"ms\"}\n");
+    fclose(f);
+    return true;
+}
+} // namespace MNN
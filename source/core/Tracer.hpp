@@ -0,0 +1,85 @@
+//
+//  Tracer.hpp
+//  MNN
+//
+//  Created by MNN on 2021/12/15.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#ifndef Tracer_hpp
+#define Tracer_hpp
+#include <MNN/MNNDefine.h>
+#include <stdint.h>
+#include <string>
+
+namespace MNN {
+/**
+ Process wide event recorder, exported as Chrome trace JSON (chrome://tracing or Perfetto).
+ Events are only recorded on the threads between begin() / end() pairs, such as the thread running a session with
+ Interpreter::TRACE hint, so sessions without the hint are not recorded. Thread pool tasks are recorded if the thread
+ enqueued them is recording.
+ Each thread writes into its own ring buffer, so recording don't contend with other threads and only the latest
+ events are kept.
+ */
+class MNN_PUBLIC Tracer {
+public:
+    static void begin();
+    static void end();
+    // Whether current thread is recording
+    static bool enabled();
+    // Time in us from the first use of tracer
+    static double now();
+
+    // Complete event with a duration, args is the body of a JSON object like "\"type\":\"Convolution\"", can be empty
+    static void span(const char* category, const std::string& name, double beginUs, double endUs, const std::string& args = "");
+    // Counter event, such as memory size
+    static void counter(const std::string& name, const std::string& series, double value);
+    // Name shown for current thread
+    static void setThreadName(const std::string& name);
+
+    // Write all recorded events to file and clear them
+    static bool dump(const char* fileName);
+    static void clear();
+
+    // Enable recording from construction to destruction if need
+    class Guard {
+    public:
+        Guard(bool enable) : mEnable(enable) {
+            if (mEnable) {
+                Tracer::begin();
+            }
+        }
+        ~Guard() {
+            if (mEnable) {
+                Tracer::end();
+            }
+        }
+
+    private:
+        bool mEnable;
+    };
+    // Record a span from construction to destruction
+    class Scope {
+    public:
+        Scope(const char* category, const char* name) {
+            if (Tracer::enabled()) {
+                mCategory = category;
+                mName     = name;
+                mBegin    = Tracer::now();
+            }
+        }
+        ~Scope() {
+            if (nullptr != mCategory) {
+                Tracer::span(mCategory, mName, mBegin, Tracer::now());
+            }
+        }
+
+    private:
+        const char* mCategory = nullptr;
+        const char* mName     = nullptr;
+        double mBegin         = 0.0;
+    };
+};
+} // namespace MNN
+
+#endif /* Tracer_hpp */
@@ -166,7 +166,7 @@ ErrorCode ImageProcess::convert(const uint8_t* source, int iw, int ih, int strid
         });
         dest = tempTensor.get();
     }
-    else if (MNN_DATA_FORMAT_NCHW == dimensionFormat) {
+    else if (MNN_DATA_FORMAT_NCHW == dimensionFormat && dest->getType().code != halide_type_float) {
         tempTensor.reset(Tensor::create(dest->shape(), dest->getType(), nullptr, Tensor::CAFFE_C4), [destOrigin](void* p) {
             auto hostTensor = (Tensor*)p;
             CPUTensorConverter::convert(hostTensor, destOrigin);
@@ -175,6 +175,19 @@ ErrorCode ImageProcess::convert(const uint8_t* source, int iw, int ih, int strid
         dest = tempTensor.get();
     }
     dimensionFormat = TensorUtils::getDescribe(dest)->dimensionFormat;
+    if (dest->getType().code == halide_type_float && MNN_DATA_FORMAT_NHWC != dimensionFormat) {
+        // Write the NCHW / NC4HW4 planes tile by tile, instead of a full interleaved image and a conversion pass
+        std::unique_ptr<Tensor> input(createImageTensor(halide_type_of<uint8_t>(), iw, ih, _getBpp(mInside->config.sourceFormat), (void*)source));
+        std::vector<Tensor*> ins  = {input.get()};
+        std::vector<Tensor*> outs = {dest};
+        mInside->execution->setPadVal(this->mPaddingValue);
+        mInside->execution->setStride(stride);
+        auto code = mInside->execution->onResize(ins, outs);
+        if (NO_ERROR != code) {
+            return code;
+        }
+        return mInside->execution->onExecute(ins, outs);
+    }
     if (dimensionFormat == MNN_DATA_FORMAT_NC4HW4) {
         bpp = 4;
     }
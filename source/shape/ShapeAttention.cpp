@@ -0,0 +1,69 @@
+//
+//  ShapeAttention.cpp
+//  MNN
+//
+//  Created by MNN on 2021/12/10.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include "shape/SizeComputer.hpp"
+#include "core/Macro.h"
+#include "core/TensorUtils.hpp"
+
+namespace MNN {
+class AttentionSizeComputer : public SizeComputer {
+    virtual bool onComputeSize(const MNN::Op *op, const std::vector<Tensor *> &inputs,
+                               const std::vector<Tensor *> &outputs) const override {
+        // inputs: query, key, value, [mask]
+        MNN_ASSERT(inputs.size() >= 3);
+        MNN_ASSERT(1 == outputs.size());
+        auto query = inputs[0];
+        auto key   = inputs[1];
+        auto value = inputs[2];
+        auto dims  = query->dimensions();
+        if (dims < 2 || key->dimensions() != dims || value->dimensions() != dims) {
+            return false;
+        }
+        for (int i = 0; i < dims - 2; ++i) {
+            if (key->length(i) != query->length(i) || value->length(i) != query->length(i)) {
+                return false;
+            }
+        }
+        bool keyTransposed = false;
+        if (nullptr != op->main_as_AttentionParam()) {
+            keyTransposed = op->main_as_AttentionParam()->keyTransposed();
+        }
+        int dim  = keyTransposed ? key->length(dims - 2) : key->length(dims - 1);
+        int seqK = keyTransposed ? key->length(dims - 1) : key->length(dims - 2);
+        if (dim != query->length(dims - 1) || seqK != value->length(dims - 2)) {
+            return false;
+        }
+        if (inputs.size() > 3 && inputs[3]->dimensions() > dims) {
+            return false;
+        }
+        auto &ob      = outputs[0]->buffer();
+        ob.dimensions = dims;
+        for (int i = 0; i < dims - 1; ++i) {
+            ob.dim[i].extent = query->length(i);
+        }
+        ob.dim[dims - 1].extent = value->length(dims - 1);
+        ob.type = query->buffer().type;
+        TensorUtils::getDescribe(outputs[0])->dimensionFormat = TensorUtils::getDescribe(query)->dimensionFormat;
+        return true;
+    }
+
+    virtual float onComputeFlops(const MNN::Op *op, const std::vector<Tensor *> &inputs,
+                                 const std::vector<Tensor *> &outputs) const override {
+        auto query = inputs[0];
+        auto value = inputs[2];
+        auto dims  = query->dimensions();
+        auto seqK  = value->length(dims - 2);
+        // query * key^T and score * value
+        float flops = (float)query->elementSize() * seqK + (float)outputs[0]->elementSize() * seqK;
+        return flops / 1024.0f / 1024.0f;
+    }
+};
+
+REGISTER_SHAPE(AttentionSizeComputer, OpType_Attention);
+
+} // namespace MNN
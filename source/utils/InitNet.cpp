@@ -9,6 +9,7 @@
 #include "core/TensorUtils.hpp"
 #include <unordered_map>
 #include "core/OpCommonUtils.hpp"
+#include "backend/cpu/CPUBackend.hpp"
 #include "half.hpp"
 
 namespace MNN {
@@ -18,7 +19,61 @@ bool needComputeOp(const Op* op) {
     }
     return false;
 }
-bool initConstTensors(std::vector<std::shared_ptr<Tensor>>& tensors, const Net* net, Backend* defaultBackend, ErrorCode& code) {
+static const void* _getBlobData(const Blob* parameter, size_t& size) {
+    switch (parameter->dataType()) {
+        case DataType_DT_FLOAT:
+            if (nullptr != parameter->float32s()) {
+                size = parameter->float32s()->size() * sizeof(float);
+                return parameter->float32s()->Data();
+            }
+            break;
+        case DataType_DT_INT32:
+            if (nullptr != parameter->int32s()) {
+                size = parameter->int32s()->size() * sizeof(int32_t);
+                return parameter->int32s()->Data();
+            }
+            break;
+        case DataType_DT_QUINT8:
+        case DataType_DT_UINT8:
+            if (nullptr != parameter->uint8s()) {
+                size = parameter->uint8s()->size();
+                return parameter->uint8s()->Data();
+            }
+            break;
+        case DataType_DT_INT8:
+            if (nullptr != parameter->int8s()) {
+                size = parameter->int8s()->size();
+                return parameter->int8s()->Data();
+            }
+            break;
+        default:
+            break;
+    }
+    return nullptr;
+}
+
+// Let const tensor use blob data in net directly, return false if it can't
+static bool _referenceBlobData(Tensor* output, const Blob* parameter, Backend* defaultBackend) {
+    if (defaultBackend->type() != MNN_FORWARD_CPU || USE_EXTERNAL_DATA(parameter)) {
+        return false;
+    }
+    auto des = TensorUtils::getDescribe(output);
+    if (des->usage != Tensor::InsideDescribe::CONSTANT || des->dimensionFormat == MNN_DATA_FORMAT_NC4HW4) {
+        return false;
+    }
+    size_t blobSize = 0;
+    auto data       = _getBlobData(parameter, blobSize);
+    auto needSize   = static_cast<CPUBackend*>(defaultBackend)->getTensorSize(output, true);
+    if (nullptr == data || needSize <= 0 || blobSize < (size_t)needSize) {
+        return false;
+    }
+    des->mem.reset(CPUBackend::createReferenceMemObj(needSize));
+    output->buffer().host = (uint8_t*)data;
+    des->extra.offset     = 0;
+    return true;
+}
+
+bool initConstTensors(std::vector<std::shared_ptr<Tensor>>& tensors, const Net* net, Backend* defaultBackend, ErrorCode& code, bool referenceData) {
     bool valid    = true;
     tensors.resize(net->tensorName()->size());
     // Set up const
@@ -60,6 +115,9 @@ bool initConstTensors(std::vector<std::shared_ptr<Tensor>>& tensors, const Net*
             if (zeroShape) {
                 continue;
             }
+            if (referenceData && parameter->dataType() != DataType_DT_HALF && _referenceBlobData(output, parameter, defaultBackend)) {
+                continue;
+            }
             auto res = defaultBackend->onAcquireBuffer(output, Backend::STATIC);
             if (!res) {
                 code = OUT_OF_MEMORY;
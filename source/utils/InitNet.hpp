@@ -13,7 +13,8 @@
 
 namespace MNN {
 MNN_PUBLIC bool needComputeOp(const Op* op);
-MNN_PUBLIC bool initConstTensors(std::vector<std::shared_ptr<Tensor>>& tensors, const Net* net, Backend* defaultBackend, ErrorCode& code);
+// if referenceData is true, const tensors on cpu reference the blob data in net instead of copy it, the net must outlive them
+MNN_PUBLIC bool initConstTensors(std::vector<std::shared_ptr<Tensor>>& tensors, const Net* net, Backend* defaultBackend, ErrorCode& code, bool referenceData = false);
 // init Tensors by net
 MNN_PUBLIC bool initTensors(std::vector<std::shared_ptr<Tensor>>& allTensors, const Net* net);
 // init Pipeline Infos by oplist and tensors
@@ -6,11 +6,17 @@
 //  Copyright © 2018, Alibaba Group Holding Limited
 //
 
+#include <MNN/Interpreter.hpp>
+#include <MNN/expr/ExprCreator.hpp>
+#include <math.h>
+#include <string.h>
+#include <MNN/expr/ExecutorScope.hpp>
 #include "MNNTestSuite.h"
 #include "core/BufferAllocator.hpp"
 #include "core/MNNMemoryUtils.h"
 
 using namespace MNN;
+using namespace MNN::Express;
 #ifndef _MSC_VER
 class BufferAllocatorTest : public MNNTestCase {
 public:
@@ -56,4 +62,185 @@ public:
     }
 };
 MNNTestSuiteRegister(BufferAllocatorTest, "core/buffer_allocator");
+
+class BufferAllocatorHugePageTest : public MNNTestCase {
+public:
+    virtual ~BufferAllocatorHugePageTest() = default;
+    virtual bool run(int precision) {
+        // The NUMA allocator maps the regions in the same way without huge pages
+        std::vector<std::shared_ptr<BufferAllocator::Allocator>> allocators = {BufferAllocator::Allocator::createHugePage(), BufferAllocator::Allocator::createNUMA(0)};
+        for (auto hugePage : allocators) {
+            // Sub-allocate from one region, with a larger align and a block larger than the region
+            std::vector<std::pair<size_t, size_t>> sizeAligns = {{5, 64}, {1000, 64}, {3000, 4096}, {70, 64}, {40 * 1024 * 1024, 64}};
+            std::vector<std::pair<void*, size_t>> pointers;
+            for (auto& sa : sizeAligns) {
+                auto p = hugePage->onAlloc(sa.first, sa.second);
+                if (nullptr == p.first || ((size_t)p.first + p.second) % sa.second != 0) {
+                    MNN_ERROR("Huge page allocator returns invalid pointer for size %lu\n", (unsigned long)sa.first);
+                    return false;
+                }
+                ::memset((uint8_t*)p.first + p.second, (int)pointers.size() + 1, sa.first);
+                pointers.emplace_back(p);
+            }
+            for (int i = 0; i < pointers.size(); ++i) {
+                auto ptr = (uint8_t*)pointers[i].first + pointers[i].second;
+                if (ptr[0] != i + 1 || ptr[sizeAligns[i].first - 1] != i + 1) {
+                    MNN_ERROR("Huge page allocator blocks overlap at %d\n", i);
+                    return false;
+                }
+            }
+#ifdef __linux__
+            MNNTEST_ASSERT(pointers[0].first == pointers[1].first);
+            // The freed block is merged and reused
+            hugePage->onRelease(pointers[1]);
+            hugePage->onRelease(pointers[3]);
+            auto p = hugePage->onAlloc(1000, 64);
+            MNNTEST_ASSERT(p == pointers[1]);
+            pointers[3] = p;
+            for (int i : {0, 2, 3, 4}) {
+                hugePage->onRelease(pointers[i]);
+            }
+#else
+            for (auto& p : pointers) {
+                hugePage->onRelease(p);
+            }
+#endif
+        }
+
+        // Used by the runtime
+        BackendConfig config;
+        config.hugePage = true;
+        auto compute = [](std::shared_ptr<Executor> executor) {
+            ExecutorScope scope(executor);
+            auto x   = _Input({1, 16, 32, 32}, NCHW, halide_type_of<float>());
+            auto ptr = x->writeMap<float>();
+            for (int i = 0; i < 16 * 32 * 32; ++i) {
+                ptr[i] = (float)(i % 13) * 0.1f - 0.6f;
+            }
+            auto y = _Conv(0.01f, 0.2f, _Convert(x, NC4HW4), {16, 32}, {3, 3}, SAME, {1, 1}, {1, 1}, 1);
+            y      = _Convert(_Relu(y), NCHW);
+            auto yPtr = y->readMap<float>();
+            return std::vector<float>(yPtr, yPtr + y->getInfo()->size);
+        };
+        auto result    = compute(std::shared_ptr<Executor>(Executor::newExecutor(MNN_FORWARD_CPU, config, 2)));
+        auto reference = compute(std::shared_ptr<Executor>(Executor::newExecutor(MNN_FORWARD_CPU, BackendConfig(), 2)));
+        if (result.size() != reference.size() || result.empty()) {
+            return false;
+        }
+        for (int i = 0; i < result.size(); ++i) {
+            if (fabsf(result[i] - reference[i]) > 1e-5f) {
+                MNN_ERROR("Huge page runtime output mismatch at %d: %f - %f\n", i, result[i], reference[i]);
+                return false;
+            }
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(BufferAllocatorHugePageTest, "core/buffer_allocator_huge_page");
+
+static std::vector<float> _runWithPlan(const std::vector<int8_t>& buffer, bool plan, float& memory, float& planned) {
+    std::shared_ptr<Interpreter> net(Interpreter::createFromBuffer(buffer.data(), buffer.size()));
+    net->setSessionHint(Interpreter::MEMORY_PLAN, plan ? 1 : 0);
+    ScheduleConfig config;
+    config.numThread = 1;
+    auto session     = net->createSession(config);
+    auto input       = net->getSessionInput(session, nullptr);
+    std::shared_ptr<Tensor> inputHost(new Tensor(input, Tensor::CAFFE));
+    for (int i = 0; i < inputHost->elementSize(); ++i) {
+        inputHost->host<float>()[i] = (float)(i % 19) * 0.1f - 0.9f;
+    }
+    input->copyFromHostTensor(inputHost.get());
+    net->runSession(session);
+    net->getSessionInfo(session, Interpreter::MEMORY, &memory);
+    net->getSessionInfo(session, Interpreter::PLANNED_MEMORY, &planned);
+    auto output = net->getSessionOutput(session, nullptr);
+    std::shared_ptr<Tensor> outputHost(new Tensor(output, Tensor::CAFFE));
+    output->copyToHostTensor(outputHost.get());
+    return std::vector<float>(outputHost->host<float>(), outputHost->host<float>() + outputHost->elementSize());
+}
+
+class BufferAllocatorPlanTest : public MNNTestCase {
+public:
+    virtual ~BufferAllocatorPlanTest() = default;
+    virtual bool run(int precision) {
+        auto alignment = MNN_MEMORY_ALIGN_DEFAULT;
+        BufferAllocator allocator(BufferAllocator::Allocator::createDefault());
+        // Free list can't put c into the memory of a, but the plan can
+        allocator.beginRecord();
+        auto a = allocator.alloc(100);
+        auto b = allocator.alloc(200);
+        allocator.free(a);
+        auto c = allocator.alloc(300);
+        auto planSize = allocator.endRecord();
+        MNNTEST_ASSERT(allocator.totalSize() == 600);
+        MNNTEST_ASSERT(planSize == UP_DIV(200, alignment) * alignment + UP_DIV(300, alignment) * alignment);
+        allocator.free(b);
+        allocator.free(c);
+        allocator.release();
+
+        // Replay the same sequence in one arena
+        MNNTEST_ASSERT(allocator.beginReplay());
+        a = allocator.alloc(100);
+        b = allocator.alloc(200);
+        allocator.free(a);
+        c = allocator.alloc(300);
+        MNNTEST_ASSERT(allocator.endReplay());
+        MNNTEST_ASSERT(allocator.totalSize() == planSize);
+        MNNTEST_ASSERT(a.first == b.first && b.first == c.first);
+        MNNTEST_ASSERT(b.second % alignment == 0 && c.second % alignment == 0);
+        // b and c are live at the same time
+        MNNTEST_ASSERT(b.second + 200 <= c.second || c.second + 300 <= b.second);
+        MNNTEST_ASSERT(allocator.free(b));
+        MNNTEST_ASSERT(allocator.free(c));
+        allocator.release();
+
+        // Different sequence turns back to free list
+        MNNTEST_ASSERT(allocator.beginReplay());
+        a = allocator.alloc(100);
+        b = allocator.alloc(1000);
+        MNNTEST_ASSERT(!allocator.endReplay());
+        MNNTEST_ASSERT(allocator.totalSize() == planSize + 1000);
+        allocator.free(a);
+        allocator.free(b);
+        allocator.release();
+
+        // Session placed by plan must compute the same result
+        auto x = _Input({1, 8, 32, 32}, NCHW, halide_type_of<float>());
+        x->setName("x");
+        auto y = _Convert(x, NC4HW4);
+        std::vector<float> weight(8 * 8 * 3 * 3);
+        for (int i = 0; i < weight.size(); ++i) {
+            weight[i] = (float)(i % 11) * 0.01f - 0.05f;
+        }
+        for (int i = 0; i < 4; ++i) {
+            auto z = _Relu(_Conv(std::vector<float>(weight), std::vector<float>(8, 0.1f), y, {8, 8}, {3, 3}, SAME));
+            y      = y + _Conv(std::vector<float>(weight), std::vector<float>(8, 0.0f), z, {8, 8}, {3, 3}, SAME);
+        }
+        y = _Convert(y, NCHW);
+        y->setName("y");
+        auto buffer = Variable::save({y});
+        float memory = 0.0f, planned = 0.0f;
+        auto origin  = _runWithPlan(buffer, false, memory, planned);
+        // The plan is not recorded without the hint
+        if (planned != memory) {
+            MNN_ERROR("Memory plan should not be recorded without hint\n");
+            return false;
+        }
+        MNN_PRINT("Memory: %f MB\n", memory);
+        auto bind = _runWithPlan(buffer, true, memory, planned);
+        MNN_PRINT("Memory placed by plan: %f MB, planned: %f MB\n", memory, planned);
+        if (origin.size() != bind.size() || origin.empty()) {
+            MNN_ERROR("Memory plan session output size error\n");
+            return false;
+        }
+        for (int i = 0; i < origin.size(); ++i) {
+            if (fabsf(origin[i] - bind[i]) > 1e-6f) {
+                MNN_ERROR("Memory plan session output mismatch at %d: %f - %f\n", i, origin[i], bind[i]);
+                return false;
+            }
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(BufferAllocatorPlanTest, "core/buffer_allocator_plan");
 #endif
\ No newline at end of file
@@ -0,0 +1,140 @@
+//
+//  InterOpParallelTest.cpp
+//  MNNTests
+//
+//  Created by MNN on 2021/12/17.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <MNN/Interpreter.hpp>
+#include <MNN/expr/ExprCreator.hpp>
+#include <math.h>
+#include "MNNTestSuite.h"
+#include "core/BufferAllocator.hpp"
+
+using namespace MNN;
+using namespace MNN::Express;
+
+static VARP _branchConv(VARP x, int ic, int oc, int kernel, int seed) {
+    std::vector<float> weight(oc * ic * kernel * kernel);
+    for (int i = 0; i < weight.size(); ++i) {
+        weight[i] = (float)((i + seed) % 13) * 0.01f - 0.06f;
+    }
+    std::vector<float> bias(oc, 0.01f * seed);
+    return _Relu(_Conv(std::move(weight), std::move(bias), x, {ic, oc}, {kernel, kernel}, SAME));
+}
+
+// Inception like block: four branches of different depth joined by concat
+static VARP _inceptionBlock(VARP x, int channel, int seed) {
+    auto b0 = _branchConv(x, channel, 4, 1, seed);
+    auto b1 = _branchConv(_branchConv(x, channel, 4, 1, seed + 1), 4, 4, 3, seed + 2);
+    auto b2 = _branchConv(_branchConv(_branchConv(x, channel, 4, 1, seed + 3), 4, 4, 3, seed + 4), 4, 4, 3, seed + 5);
+    auto b3 = _branchConv(_MaxPool(x, {3, 3}, {1, 1}, SAME), channel, 4, 1, seed + 6);
+    return _Concat({b0, b1, b2, b3}, 1);
+}
+
+static std::vector<float> _runSession(const std::vector<int8_t>& buffer, bool interOp, bool plan) {
+    std::shared_ptr<Interpreter> net(Interpreter::createFromBuffer(buffer.data(), buffer.size()));
+    net->setSessionHint(Interpreter::INTER_OP_PARALLEL, interOp ? 1 : 0);
+    net->setSessionHint(Interpreter::MEMORY_PLAN, plan ? 1 : 0);
+    ScheduleConfig config;
+    config.numThread = 4;
+    auto session     = net->createSession(config);
+    auto input       = net->getSessionInput(session, nullptr);
+    std::shared_ptr<Tensor> inputHost(new Tensor(input, Tensor::CAFFE));
+    for (int i = 0; i < inputHost->elementSize(); ++i) {
+        inputHost->host<float>()[i] = (float)(i % 23) * 0.05f - 0.5f;
+    }
+    std::vector<float> result;
+    // Run twice to check the memory isn't overwritten by other branches
+    for (int loop = 0; loop < 2; ++loop) {
+        input->copyFromHostTensor(inputHost.get());
+        net->runSession(session);
+        auto output = net->getSessionOutput(session, nullptr);
+        std::shared_ptr<Tensor> outputHost(new Tensor(output, Tensor::CAFFE));
+        output->copyToHostTensor(outputHost.get());
+        result.assign(outputHost->host<float>(), outputHost->host<float>() + outputHost->elementSize());
+    }
+    return result;
+}
+
+static bool _checkInterOp(const std::vector<int8_t>& buffer) {
+    auto origin = _runSession(buffer, false, false);
+    for (bool plan : {false, true}) {
+        auto result = _runSession(buffer, true, plan);
+        if (origin.size() != result.size() || origin.empty()) {
+            MNN_ERROR("Inter-op parallel output size error\n");
+            return false;
+        }
+        for (int i = 0; i < origin.size(); ++i) {
+            if (fabsf(origin[i] - result[i]) > 1e-5f) {
+                MNN_ERROR("Inter-op parallel (plan = %d) output mismatch at %d: %f - %f\n", plan, i, origin[i], result[i]);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+class InterOpParallelTest : public MNNTestCase {
+public:
+    virtual ~InterOpParallelTest() = default;
+    virtual bool run(int precision) {
+        // Memory freed by a group before a nested barrier can be used by the inner groups, but not by other outer groups
+        {
+            BufferAllocator allocator(BufferAllocator::Allocator::createDefault());
+            allocator.barrierBegin();
+            allocator.beginGroup();
+            auto a = allocator.alloc(1024);
+            allocator.free(a);
+            allocator.barrierBegin();
+            allocator.beginGroup();
+            auto b = allocator.alloc(1024);
+            MNNTEST_ASSERT(a == b);
+            allocator.free(b);
+            allocator.endGroup();
+            allocator.barrierEnd();
+            auto c = allocator.alloc(1024);
+            MNNTEST_ASSERT(a == c);
+            allocator.endGroup();
+            allocator.beginGroup();
+            auto d = allocator.alloc(1024);
+            MNNTEST_ASSERT(!(a == d));
+            allocator.free(d);
+            allocator.endGroup();
+            allocator.free(c);
+            allocator.barrierEnd();
+            MNNTEST_ASSERT(allocator.totalSize() == 2048);
+            allocator.release();
+        }
+        auto x = _Input({1, 8, 24, 24}, NCHW, halide_type_of<float>());
+        x->setName("x");
+        auto y = _Convert(x, NC4HW4);
+        y = _inceptionBlock(y, 8, 1);
+        y = _inceptionBlock(y, 16, 7);
+        y = _Convert(y, NCHW);
+        y->setName("y");
+        if (!_checkInterOp(Variable::save({y}))) {
+            return false;
+        }
+        // Two branches of rasters reading the same NC4HW4 tensor (batch 2 can't fuse the convert into the raster), the
+        // branch converting it to the temp tensor runs the convolutions first, the other branch can't use the temp
+        x = _Input({2, 6, 8, 8}, NCHW, halide_type_of<float>());
+        x->setName("x");
+        y      = _Relu(_Convert(x, NC4HW4));
+        auto a = _branchConv(_branchConv(_branchConv(y, 6, 6, 3, 1), 6, 6, 3, 2), 6, 5, 3, 3);
+        a      = _Concat({_Convert(y, NCHW), _Convert(a, NCHW)}, 1);
+        auto b = _Concat({_Convert(y, NCHW), x}, 1);
+        y      = _Concat({a, b}, 1);
+        y->setName("y");
+        auto buffer = Variable::save({y});
+        // The branches race, check several times
+        for (int i = 0; i < 4; ++i) {
+            if (!_checkInterOp(buffer)) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(InterOpParallelTest, "core/inter_op_parallel");
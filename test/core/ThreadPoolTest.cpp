@@ -8,8 +8,15 @@
 
 #ifdef MNN_USE_THREAD_POOL
 #include <MNN/MNNDefine.h>
+#include <MNN/expr/ExecutorScope.hpp>
+#include <MNN/expr/ExprCreator.hpp>
+#include <math.h>
 #include "MNNTestSuite.h"
+#include "backend/cpu/CPURuntime.hpp"
 #include "backend/cpu/ThreadPool.hpp"
+#ifdef __linux__
+#include <sched.h>
+#endif
 
 using namespace MNN;
 
@@ -18,18 +25,31 @@ public:
     virtual ~ThreadPoolTest() = default;
     virtual bool run(int precision) {
         std::vector<std::thread> threads;
+        std::atomic_int errorCount = {0};
         for (int i = 0; i < 10; ++i) {
-            threads.emplace_back([i]() {
+            threads.emplace_back([i, &errorCount]() {
                 MNN::ThreadPool::init(10 - i);
                 // initializer
                 auto workIndex = ThreadPool::acquireWorkIndex();
                 FUNC_PRINT(workIndex);
                 ThreadPool::active();
-                auto func = [](int index) {
-                    FUNC_PRINT(index);
-                    std::this_thread::yield();
-                };
-                ThreadPool::enqueue(std::make_pair(std::move(func), 10), workIndex);
+                for (int size : {3, 10, 47}) {
+                    std::vector<std::atomic_int> counter(size);
+                    for (auto& c : counter) {
+                        c = 0;
+                    }
+                    auto func = [&counter](int index) {
+                        counter[index]++;
+                        std::this_thread::yield();
+                    };
+                    ThreadPool::enqueue(std::make_pair(std::move(func), size), workIndex);
+                    // Every index must be run exactly once before enqueue return
+                    for (auto& c : counter) {
+                        if (c != 1) {
+                            errorCount++;
+                        }
+                    }
+                }
                 ThreadPool::deactive();
                 ThreadPool::releaseWorkIndex(workIndex);
             });
@@ -38,9 +58,97 @@ public:
             t.join();
         }
         MNN::ThreadPool::destroy();
+        if (errorCount > 0) {
+            MNN_ERROR("ThreadPool run task index error count: %d\n", errorCount.load());
+            return false;
+        }
         return true;
     }
 };
 
 MNNTestSuiteRegister(ThreadPoolTest, "core/threadpool");
+
+class ThreadPoolBoundTest : public MNNTestCase {
+public:
+    virtual ~ThreadPoolBoundTest() = default;
+    virtual bool run(int precision) {
+        auto nodeCPUs = MNNGetNUMANodeCPUs(0);
+#ifdef __linux__
+        if (nodeCPUs.empty() || MNNGetCPUNUMANode(nodeCPUs[0]) != 0) {
+            MNN_ERROR("Can't get the CPUs of NUMA node 0\n");
+            return false;
+        }
+#endif
+        int cpuId = nodeCPUs.empty() ? 0 : nodeCPUs[0];
+        std::vector<int> cpuIds(3, cpuId);
+        auto pool = ThreadPool::createBound(cpuIds);
+        if (pool != ThreadPool::createBound(cpuIds) || pool->number() != 3) {
+            MNN_ERROR("Runtimes with the same CPUs should share the bound pool\n");
+            return false;
+        }
+        auto workIndex = ThreadPool::acquireWorkIndex(pool.get());
+        ThreadPool::active(pool.get());
+        std::vector<std::atomic_int> counter(20);
+        std::atomic_int wrongCPU = {0};
+        for (auto& c : counter) {
+            c = 0;
+        }
+        auto caller = std::this_thread::get_id();
+        auto func   = [&](int index) {
+            counter[index]++;
+#ifdef __linux__
+            // The workers are bound, the caller is not
+            if (std::this_thread::get_id() != caller && sched_getcpu() != cpuId) {
+                wrongCPU++;
+            }
+#endif
+            std::this_thread::yield();
+        };
+        ThreadPool::enqueue(std::make_pair(std::move(func), (int)counter.size()), workIndex, pool.get());
+        ThreadPool::deactive(pool.get());
+        ThreadPool::releaseWorkIndex(workIndex, pool.get());
+        for (auto& c : counter) {
+            if (c != 1) {
+                MNN_ERROR("Bound pool run task index error\n");
+                return false;
+            }
+        }
+        if (wrongCPU > 0) {
+            MNN_ERROR("%d tasks run by workers out of CPU %d\n", wrongCPU.load(), cpuId);
+            return false;
+        }
+
+        // The runtime bound to node 0 computes the same result as the default one
+        using namespace MNN::Express;
+        auto compute = [](std::shared_ptr<Executor> executor) {
+            ExecutorScope scope(executor);
+            auto x   = _Input({1, 8, 16, 16}, NCHW, halide_type_of<float>());
+            auto ptr = x->writeMap<float>();
+            for (int i = 0; i < 8 * 16 * 16; ++i) {
+                ptr[i] = (float)(i % 11) * 0.1f - 0.5f;
+            }
+            auto y = _Conv(0.02f, 0.1f, _Convert(x, NC4HW4), {8, 16}, {3, 3}, SAME, {1, 1}, {1, 1}, 1);
+            y      = _Convert(y, NCHW);
+            auto size = y->getInfo()->size;
+            auto yPtr = y->readMap<float>();
+            return std::vector<float>(yPtr, yPtr + size);
+        };
+        BackendConfig config;
+        config.numaNode = 0;
+        auto bound      = compute(std::shared_ptr<Executor>(Executor::newExecutor(MNN_FORWARD_CPU, config, 4)));
+        auto reference  = compute(std::shared_ptr<Executor>(Executor::newExecutor(MNN_FORWARD_CPU, BackendConfig(), 1)));
+        if (bound.size() != reference.size()) {
+            return false;
+        }
+        for (int i = 0; i < bound.size(); ++i) {
+            if (fabsf(bound[i] - reference[i]) > 0.001f) {
+                MNN_ERROR("The runtime bound to NUMA node 0 computes wrong result at %d\n", i);
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+MNNTestSuiteRegister(ThreadPoolBoundTest, "core/threadpool_bound");
 #endif
@@ -0,0 +1,98 @@
+//
+//  TraceTest.cpp
+//  MNNTests
+//
+//  Created by MNN on 2021/12/15.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <MNN/Interpreter.hpp>
+#include <MNN/expr/ExprCreator.hpp>
+#include <stdio.h>
+#include <string.h>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include "MNNTestSuite.h"
+#include "core/Tracer.hpp"
+
+using namespace MNN;
+using namespace MNN::Express;
+
+class TraceTest : public MNNTestCase {
+public:
+    virtual ~TraceTest() = default;
+    virtual bool run(int precision) {
+        auto x = _Input({1, 4, 16, 16}, NCHW, halide_type_of<float>());
+        x->setName("x");
+        auto y = _Convert(x, NC4HW4);
+        y      = _Conv(std::vector<float>(8 * 4 * 3 * 3, 0.1f), std::vector<float>(8, 0.0f), y, {4, 8}, {3, 3}, SAME);
+        y->setName("traced_conv");
+        y = _Convert(_Relu(y), NCHW);
+        y->setName("y");
+        auto buffer = Variable::save({y});
+
+        // Nothing is recorded without the hint
+        Tracer::clear();
+        Tracer::span("test", "not_recorded", 0.0, 1.0);
+        std::shared_ptr<Interpreter> net(Interpreter::createFromBuffer(buffer.data(), buffer.size()));
+        net->setSessionHint(Interpreter::TRACE, 1);
+        ScheduleConfig config;
+        config.numThread = 2;
+        auto session     = net->createSession(config);
+        auto input       = net->getSessionInput(session, nullptr);
+        ::memset(input->host<float>(), 0, input->size());
+        net->runSession(session);
+        MNNTEST_ASSERT(!Tracer::enabled());
+
+        const char* fileName = "trace_test.json";
+        MNNTEST_ASSERT(Interpreter::dumpTrace(fileName));
+        std::ifstream file(fileName);
+        std::stringstream content;
+        content << file.rdbuf();
+        file.close();
+        ::remove(fileName);
+        auto text = content.str();
+        if (text.find("\"traceEvents\"") == std::string::npos) {
+            MNN_ERROR("Trace file doesn't contain traceEvents\n");
+            return false;
+        }
+        if (text.find("\"name\":\"traced_conv\"") == std::string::npos) {
+            MNN_ERROR("Trace file doesn't contain the span of op\n");
+            return false;
+        }
+        if (text.find("\"name\":\"resize\"") == std::string::npos || text.find("\"name\":\"run\"") == std::string::npos) {
+            MNN_ERROR("Trace file doesn't contain the span of session\n");
+            return false;
+        }
+        if (text.find("not_recorded") != std::string::npos) {
+            MNN_ERROR("Trace recorded event outside session\n");
+            return false;
+        }
+
+        // The hint is read in each run
+        net->setSessionHint(Interpreter::TRACE, 0);
+        net->runSession(session);
+        MNNTEST_ASSERT(Interpreter::dumpTrace(fileName));
+        std::ifstream fileOff(fileName);
+        std::stringstream contentOff;
+        contentOff << fileOff.rdbuf();
+        fileOff.close();
+        ::remove(fileName);
+        if (contentOff.str().find("\"name\":\"run\"") != std::string::npos) {
+            MNN_ERROR("Trace recorded session run after the hint is closed\n");
+            return false;
+        }
+
+        // Recording is per thread, other threads such as other sessions are not recorded
+        Tracer::begin();
+        bool otherEnabled = true;
+        std::thread other([&otherEnabled]() { otherEnabled = Tracer::enabled(); });
+        other.join();
+        MNNTEST_ASSERT(Tracer::enabled());
+        Tracer::end();
+        MNNTEST_ASSERT(!otherEnabled);
+        return true;
+    }
+};
+MNNTestSuiteRegister(TraceTest, "core/trace");
@@ -0,0 +1,135 @@
+//
+//  WeightCacheTest.cpp
+//  MNNTests
+//
+//  Created by MNN on 2021/12/08.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <MNN/Interpreter.hpp>
+#include <MNN/expr/ExprCreator.hpp>
+#include <stdio.h>
+#include <string.h>
+#include "MNNTestSuite.h"
+#include "MNN_generated.h"
+#include "backend/cpu/CPUWeightCache.hpp"
+
+using namespace MNN;
+using namespace MNN::Express;
+
+static std::vector<float> _runWithCache(const void* buffer, size_t size, const char* cacheFile) {
+    std::shared_ptr<Interpreter> net(Interpreter::createFromBuffer(buffer, size));
+    net->setCacheFile(cacheFile);
+    ScheduleConfig config;
+    config.numThread = 1;
+    auto session     = net->createSession(config);
+    auto input       = net->getSessionInput(session, nullptr);
+    std::shared_ptr<Tensor> inputHost(new Tensor(input, Tensor::CAFFE));
+    for (int i = 0; i < inputHost->elementSize(); ++i) {
+        inputHost->host<float>()[i] = (float)(i % 17) * 0.1f - 0.8f;
+    }
+    input->copyFromHostTensor(inputHost.get());
+    net->runSession(session);
+    auto output = net->getSessionOutput(session, nullptr);
+    std::shared_ptr<Tensor> outputHost(new Tensor(output, Tensor::CAFFE));
+    output->copyToHostTensor(outputHost.get());
+    return std::vector<float>(outputHost->host<float>(), outputHost->host<float>() + outputHost->elementSize());
+}
+
+class WeightCacheTest : public MNNTestCase {
+public:
+    virtual ~WeightCacheTest() = default;
+    virtual bool run(int precision) {
+        // Serialize and load entries
+        {
+            std::vector<float> weight(100);
+            std::vector<float> packed(64);
+            for (int i = 0; i < weight.size(); ++i) {
+                weight[i] = (float)i;
+            }
+            for (int i = 0; i < packed.size(); ++i) {
+                packed[i] = (float)i * 2.0f;
+            }
+            auto key = CPUWeightCache::makeKey(weight.data(), weight.size() * sizeof(float), {0, 4}, packed.size() * sizeof(float));
+            CPUWeightCache writer;
+            writer.store(key, packed.data());
+            if (writer.getCache().first != nullptr) {
+                MNN_ERROR("Weight cache should be disabled before setCache\n");
+                return false;
+            }
+            // Reset don't enable recording, it must be asked explicitly
+            writer.setCache(nullptr, 0);
+            if (writer.enabled()) {
+                MNN_ERROR("Weight cache should not record without setRecord\n");
+                return false;
+            }
+            writer.setRecord(true);
+            writer.setCache(nullptr, 0);
+            writer.store(key, packed.data());
+            auto buffer = writer.getCache();
+            std::vector<uint8_t> saved((const uint8_t*)buffer.first, (const uint8_t*)buffer.first + buffer.second);
+
+            CPUWeightCache reader;
+            if (!reader.setCache(saved.data(), saved.size())) {
+                MNN_ERROR("Weight cache load serialized buffer failed\n");
+                return false;
+            }
+            std::vector<float> loaded(packed.size(), 0.0f);
+            if (!reader.load(key, loaded.data()) || 0 != ::memcmp(loaded.data(), packed.data(), packed.size() * sizeof(float))) {
+                MNN_ERROR("Weight cache load entry error\n");
+                return false;
+            }
+            auto otherKey = CPUWeightCache::makeKey(weight.data(), weight.size() * sizeof(float), {1, 4}, packed.size() * sizeof(float));
+            if (reader.load(otherKey, loaded.data())) {
+                MNN_ERROR("Weight cache should not contain key of other layout\n");
+                return false;
+            }
+            // Stop recording drop the entries not serialized
+            writer.store(otherKey, packed.data());
+            writer.setRecord(false);
+            if (writer.load(otherKey, loaded.data())) {
+                MNN_ERROR("Weight cache should drop new entries after recording\n");
+                return false;
+            }
+            saved[0] = 0;
+            if (reader.setCache(saved.data(), saved.size())) {
+                MNN_ERROR("Weight cache should reject invalid buffer\n");
+                return false;
+            }
+        }
+        // Session created from cache file must compute the same result
+        {
+            auto x = _Input({1, 8, 16, 16}, NCHW, halide_type_of<float>());
+            std::vector<float> weight3x3(16 * 8 * 3 * 3), weight1x1(16 * 16);
+            for (int i = 0; i < weight3x3.size(); ++i) {
+                weight3x3[i] = (float)(i % 13) * 0.01f - 0.05f;
+            }
+            for (int i = 0; i < weight1x1.size(); ++i) {
+                weight1x1[i] = (float)(i % 7) * 0.02f - 0.06f;
+            }
+            auto y = _Conv(std::move(weight3x3), std::vector<float>(16, 0.1f), x, {8, 16}, {3, 3}, SAME);
+            y      = _Conv(std::move(weight1x1), std::vector<float>(16, 0.0f), y, {16, 16}, {1, 1}, VALID);
+            std::unique_ptr<NetT> net(new NetT);
+            Variable::save({y}, net.get());
+            flatbuffers::FlatBufferBuilder builder(1024);
+            builder.Finish(Net::Pack(builder, net.get()));
+            const char* cacheFile = "WeightCacheTest.cache";
+            ::remove(cacheFile);
+            auto first  = _runWithCache(builder.GetBufferPointer(), builder.GetSize(), cacheFile);
+            auto second = _runWithCache(builder.GetBufferPointer(), builder.GetSize(), cacheFile);
+            ::remove(cacheFile);
+            if (first.size() != second.size() || first.empty()) {
+                MNN_ERROR("Weight cache session output size error\n");
+                return false;
+            }
+            for (int i = 0; i < first.size(); ++i) {
+                if (fabsf(first[i] - second[i]) > 1e-6f) {
+                    MNN_ERROR("Weight cache session output mismatch at %d: %f - %f\n", i, first[i], second[i]);
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(WeightCacheTest, "core/weight_cache");
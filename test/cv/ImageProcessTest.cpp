@@ -616,6 +616,51 @@ public:
 };
 MNNTestSuiteRegister(ImageProcessGrayToGrayFloatBlitterTest, "cv/image_process/gray_to_gray_blitter");
 
+// Float NCHW / NC4HW4 tensors are written plane by plane, compare them with the NHWC result
+class ImageProcessBGRToPlanarFloatBlitterTest : public MNNTestCase {
+public:
+    virtual ~ImageProcessBGRToPlanarFloatBlitterTest() = default;
+    virtual bool run(int precision) {
+        // Wider than one tile of the image process
+        int w = 300, h = 7, size = w * h;
+        auto integers = genSourceData(h, w, 3);
+        ImageProcess::Config config;
+        config.sourceFormat = BGR;
+        config.destFormat   = RGB;
+        config.filterType   = BILINEAR;
+        const float means[3]   = {127.5f, 120.0f, 110.0f};
+        const float normals[3] = {2.0f / 255.0f, 1.0f / 255.0f, 0.5f / 255.0f};
+        memcpy(config.mean, means, sizeof(means));
+        memcpy(config.normal, normals, sizeof(normals));
+        std::shared_ptr<ImageProcess> process(ImageProcess::create(config));
+        Matrix matrix;
+        matrix.setScale(0.9f, 0.8f);
+        matrix.postTranslate(3.0f, 1.0f);
+        process->setMatrix(matrix);
+
+        std::shared_ptr<Tensor> nhwc(Tensor::create<float>(std::vector<int>{1, h, w, 3}, nullptr, Tensor::TENSORFLOW));
+        std::shared_ptr<Tensor> nchw(Tensor::create<float>(std::vector<int>{1, 3, h, w}, nullptr, Tensor::CAFFE));
+        std::shared_ptr<Tensor> nc4hw4(Tensor::create<float>(std::vector<int>{1, 3, h, w}, nullptr, Tensor::CAFFE_C4));
+        process->convert(integers.data(), w, h, 0, nhwc.get());
+        process->convert(integers.data(), w, h, 0, nchw.get());
+        process->convert(integers.data(), w, h, 0, nc4hw4.get());
+        auto right = nhwc->host<float>();
+        for (int i = 0; i < size; ++i) {
+            for (int c = 0; c < 4; ++c) {
+                float planar = c < 3 ? nchw->host<float>()[c * size + i] : 0.0f;
+                float packed = nc4hw4->host<float>()[4 * i + c];
+                float expect = c < 3 ? right[3 * i + c] : 0.0f;
+                if (fabsf(planar - expect) > 1e-6f || fabsf(packed - expect) > 1e-6f) {
+                    MNN_ERROR("Error for planar blitter at %d, %d: %f, %f, right: %f\n", i, c, planar, packed, expect);
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(ImageProcessBGRToPlanarFloatBlitterTest, "cv/image_process/bgr_to_planar_blitter");
+
 class ImageProcessYUVTestCommmon : public MNNTestCase {
 protected:
     virtual ~ImageProcessYUVTestCommmon() = default;
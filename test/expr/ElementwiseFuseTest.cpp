@@ -0,0 +1,83 @@
+//
+//  ElementwiseFuseTest.cpp
+//  MNNTests
+//
+//  Created by MNN on 2023/02/20.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <math.h>
+#include <MNN/expr/ExprCreator.hpp>
+#include <MNN/expr/Module.hpp>
+#include "MNN_generated.h"
+#include "MNNTestSuite.h"
+
+using namespace MNN::Express;
+using namespace MNN;
+
+// Chains of elementwise ops, which are fused into one kernel when codegen is enabled
+class ElementwiseFuseTest : public MNNTestCase {
+public:
+    virtual bool run(int precision) {
+        const int batch = 2, channel = 5, height = 7, width = 9;
+        const int size = batch * channel * height * width;
+        auto x = _Input({batch, channel, height, width}, NCHW, halide_type_of<float>());
+        x->setName("x");
+        auto b = _Input({batch, channel, height, width}, NCHW, halide_type_of<float>());
+        b->setName("b");
+        // Scalar constant inputs, relu6 and several outputs of the same kernel
+        auto y0 = _Sigmoid(_Relu6(x * _Scalar<float>(2.0f) + _Scalar<float>(1.0f)) - b) * x;
+        y0->setName("y0");
+        // The intermediate tensor is also an output, so it can't be fused into the gelu
+        auto t = x + b;
+        t->setName("t");
+        auto y1 = _Gelu(t);
+        y1->setName("y1");
+        // Packed layout
+        auto c  = _Convert(x, NC4HW4);
+        auto y2 = _Convert(_Relu(c * c - _Scalar<float>(1.0f), 0.1f), NCHW);
+        y2->setName("y2");
+        std::unique_ptr<NetT> net(new NetT);
+        Variable::save({y0, t, y1, y2}, net.get());
+        flatbuffers::FlatBufferBuilder builder(1024);
+        builder.Finish(Net::Pack(builder, net.get()));
+        std::shared_ptr<Module> module(Module::load({"x", "b"}, {"y0", "t", "y1", "y2"}, builder.GetBufferPointer(), builder.GetSize()), Module::destroy);
+
+        auto xValue = _Input({batch, channel, height, width}, NCHW, halide_type_of<float>());
+        auto bValue = _Input({batch, channel, height, width}, NCHW, halide_type_of<float>());
+        auto xPtr   = xValue->writeMap<float>();
+        auto bPtr   = bValue->writeMap<float>();
+        for (int i = 0; i < size; ++i) {
+            xPtr[i] = (float)((i * 7) % 23) / 11.0f - 1.0f;
+            bPtr[i] = (float)((i * 3) % 17) / 8.0f - 1.0f;
+        }
+        auto outputs = module->onForward({xValue, bValue});
+        if (outputs.size() != 4) {
+            return false;
+        }
+        std::vector<const float*> results;
+        for (auto& output : outputs) {
+            results.emplace_back(output->readMap<float>());
+        }
+        for (int i = 0; i < size; ++i) {
+            float xv = xPtr[i], bv = bPtr[i];
+            float relu6 = fminf(fmaxf(xv * 2.0f + 1.0f, 0.0f), 6.0f);
+            float sq    = xv * xv - 1.0f;
+            float tv    = xv + bv;
+            float expects[4] = {
+                1.0f / (1.0f + expf(-(relu6 - bv))) * xv,
+                tv,
+                0.5f * tv * (1.0f + tanhf(0.7978845608f * (tv + 0.044715f * tv * tv * tv))),
+                sq > 0.0f ? sq : sq * 0.1f
+            };
+            for (int j = 0; j < 4; ++j) {
+                if (fabsf(results[j][i] - expects[j]) > 0.01f) {
+                    MNN_ERROR("Output %d error at %d: %f - %f\n", j, i, results[j][i], expects[j]);
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(ElementwiseFuseTest, "expr/ElementwiseFuse");
@@ -8,8 +8,11 @@
 
 #include <MNN/expr/Module.hpp>
 #include <MNN/expr/ExprCreator.hpp>
+#include <atomic>
+#include <future>
 #include <thread>
 #include "MNNTestSuite.h"
+#include "core/AsyncQueue.hpp"
 #include "core/Backend.hpp"
 #include "RuntimeAttr.hpp"
 #include <MNN/expr/Executor.hpp>
@@ -446,6 +449,568 @@ public:
 };
 MNNTestSuiteRegister(ModuleReleaseTest, "expr/ModuleReleaseTest");
 
+class ModuleMapFileTest : public MNNTestCase {
+public:
+    virtual bool run(int precision) {
+        const char* fileName = "ModuleMapFileTest.mnn";
+        {
+            auto x = _Input({1, 4}, NCHW, halide_type_of<float>());
+            x->setName("x");
+            auto w = _Const(std::vector<float>{1.0f, 2.0f, 3.0f, 4.0f}.data(), {1, 4}, NCHW);
+            auto b = _Const(std::vector<float>{-1.0f, 0.0f, 1.0f, 2.0f}.data(), {1, 4}, NCHW);
+            auto y = _Add(_Multiply(x, w), b);
+            y->setName("y");
+            Variable::save({y}, fileName);
+        }
+        const float inputData[] = {0.5f, 1.0f, 2.0f, -1.0f};
+        const float expect[] = {-0.5f, 2.0f, 7.0f, -2.0f};
+        auto check = [&](const float* outputPtr) {
+            for (int i = 0; i < 4; ++i) {
+                if (fabsf(outputPtr[i] - expect[i]) > 0.001f) {
+                    MNN_ERROR("Map file result error: %d, %f - %f\n", i, outputPtr[i], expect[i]);
+                    return false;
+                }
+            }
+            return true;
+        };
+        bool res = true;
+        {
+            Module::Config config;
+            config.mapFile = true;
+            std::shared_ptr<Module> m(Module::load({"x"}, {"y"}, fileName, &config), Module::destroy);
+            if (nullptr == m) {
+                MNN_ERROR("Load mapped module failed\n");
+                res = false;
+            } else {
+                auto x = _Input({1, 4}, NCHW, halide_type_of<float>());
+                ::memcpy(x->writeMap<float>(), inputData, sizeof(inputData));
+                auto y = m->onForward({x})[0];
+                res = res && check(y->readMap<float>());
+            }
+        }
+        {
+            std::shared_ptr<Interpreter> net(Interpreter::createFromFile(fileName, true), Interpreter::destroy);
+            if (nullptr == net) {
+                MNN_ERROR("Create mapped interpreter failed\n");
+                res = false;
+            } else {
+                ScheduleConfig config;
+                auto session = net->createSession(config);
+                auto input = net->getSessionInput(session, "x");
+                ::memcpy(input->host<float>(), inputData, sizeof(inputData));
+                net->runSession(session);
+                auto output = net->getSessionOutput(session, "y");
+                std::shared_ptr<Tensor> hostOutput(Tensor::createHostTensorFromDevice(output, true));
+                res = res && check(hostOutput->host<float>());
+            }
+        }
+        remove(fileName);
+        return res;
+    }
+};
+MNNTestSuiteRegister(ModuleMapFileTest, "expr/ModuleMapFileTest");
+
+class ModuleBatchingTest : public MNNTestCase {
+public:
+    virtual bool run(int precision) {
+        std::vector<int8_t> buffer;
+        {
+            auto x = _Input({1, 4}, NCHW, halide_type_of<float>());
+            x->setName("x");
+            auto w = _Const(std::vector<float>{1.0f, 2.0f, 3.0f, 4.0f}.data(), {1, 4}, NCHW);
+            auto b = _Const(std::vector<float>{-1.0f, 0.0f, 1.0f, 2.0f}.data(), {1, 4}, NCHW);
+            auto y = _Add(_Multiply(x, w), b);
+            y->setName("y");
+            buffer = Variable::save({y});
+        }
+        std::shared_ptr<Module> origin(Module::load({"x"}, {"y"}, (const uint8_t*)buffer.data(), buffer.size()), Module::destroy);
+        Module::BatchConfig batchConfig;
+        batchConfig.maxBatch  = 4;
+        batchConfig.maxWaitUs = 10000;
+        std::shared_ptr<Module> batching(Module::createBatching(origin, batchConfig), Module::destroy);
+        int threadNumber = 6;
+        std::vector<int> result(threadNumber, 0);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < threadNumber; ++t) {
+            threads.emplace_back([t, batching, &result]() {
+                // Request t use batch (t % 2 + 1)
+                int batch = t % 2 + 1;
+                auto x    = _Input({batch, 4}, NCHW, halide_type_of<float>());
+                auto ptr  = x->writeMap<float>();
+                for (int i = 0; i < batch * 4; ++i) {
+                    ptr[i] = (float)(t + i);
+                }
+                auto outputs = batching->onForward({x});
+                if (outputs.size() != 1 || outputs[0]->getInfo()->dim[0] != batch) {
+                    return;
+                }
+                const float w[] = {1.0f, 2.0f, 3.0f, 4.0f};
+                const float b[] = {-1.0f, 0.0f, 1.0f, 2.0f};
+                auto y = outputs[0]->readMap<float>();
+                for (int i = 0; i < batch * 4; ++i) {
+                    if (fabsf(y[i] - ((float)(t + i) * w[i % 4] + b[i % 4])) > 0.001f) {
+                        return;
+                    }
+                }
+                result[t] = 1;
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        for (int t = 0; t < threadNumber; ++t) {
+            if (!result[t]) {
+                MNN_ERROR("Batching module result error for request %d\n", t);
+                return false;
+            }
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(ModuleBatchingTest, "expr/ModuleBatchingTest");
+
+class ModulePoolTest : public MNNTestCase {
+public:
+    virtual bool run(int precision) {
+        std::vector<int8_t> buffer;
+        {
+            auto x = _Input({1, 4}, NCHW, halide_type_of<float>());
+            x->setName("x");
+            auto w = _Const(std::vector<float>{1.0f, 2.0f, 3.0f, 4.0f}.data(), {1, 4}, NCHW);
+            auto y = _Multiply(x, w);
+            y->setName("y");
+            buffer = Variable::save({y});
+        }
+        std::shared_ptr<Module> origin(Module::load({"x"}, {"y"}, (const uint8_t*)buffer.data(), buffer.size()), Module::destroy);
+        ModulePool::Config poolConfig;
+        poolConfig.maxInstance = 3;
+        std::shared_ptr<ModulePool> pool(ModulePool::create(origin, poolConfig), ModulePool::destroy);
+        int threadNumber = 6;
+        std::vector<int> result(threadNumber, 0);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < threadNumber; ++t) {
+            threads.emplace_back([t, pool, &result]() {
+                for (int r = 0; r < 10; ++r) {
+                    auto instance = pool->acquire();
+                    if (nullptr == instance) {
+                        return;
+                    }
+                    auto x   = _Input({1, 4}, NCHW, halide_type_of<float>());
+                    auto ptr = x->writeMap<float>();
+                    for (int i = 0; i < 4; ++i) {
+                        ptr[i] = (float)(t * 10 + r + i);
+                    }
+                    auto y = instance->onForward({x})[0]->readMap<float>();
+                    for (int i = 0; i < 4; ++i) {
+                        if (fabsf(y[i] - (float)(t * 10 + r + i) * (float)(i + 1)) > 0.001f) {
+                            return;
+                        }
+                    }
+                }
+                result[t] = 1;
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        for (int t = 0; t < threadNumber; ++t) {
+            if (!result[t]) {
+                MNN_ERROR("Module pool result error for thread %d\n", t);
+                return false;
+            }
+        }
+        if (pool->size() < 1 || pool->size() > poolConfig.maxInstance) {
+            MNN_ERROR("Module pool creates %d instances, max is %d\n", pool->size(), poolConfig.maxInstance);
+            return false;
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(ModulePoolTest, "expr/ModulePoolTest");
+
+class ModuleResizeCacheTest : public MNNTestCase {
+public:
+    virtual bool run(int precision) {
+        std::vector<int8_t> buffer;
+        {
+            auto x = _Input({1, 3, -1, -1}, NCHW, halide_type_of<float>());
+            x->setName("x");
+            std::vector<float> weight(8 * 3 * 3 * 3);
+            for (int i = 0; i < weight.size(); ++i) {
+                weight[i] = (float)(i % 7) * 0.1f - 0.3f;
+            }
+            auto y = _Relu(_Conv(std::move(weight), std::vector<float>(8, 0.1f), _Convert(x, NC4HW4), {3, 8}, {3, 3}, SAME));
+            y      = _Convert(y, NCHW);
+            y->setName("y");
+            buffer = Variable::save({y});
+        }
+        MNN::ScheduleConfig sconfig;
+        std::shared_ptr<Executor::RuntimeManager> rtMgr(Executor::RuntimeManager::createRuntimeManager(sconfig), Executor::RuntimeManager::destroy);
+        rtMgr->setHint(Interpreter::RESIZE_CACHE_SIZE, 3);
+        std::shared_ptr<Module> cached(Module::load({"x"}, {"y"}, (const uint8_t*)buffer.data(), buffer.size(), rtMgr), Module::destroy);
+        std::shared_ptr<Module> origin(Module::load({"x"}, {"y"}, (const uint8_t*)buffer.data(), buffer.size()), Module::destroy);
+        // Keep 3 shapes: A, B, A (hit), C, B (hit), A (hit), D (evict C), C (evict B), C (new variable of current shape)
+        std::vector<int> sizes = {8, 12, 8, 5, 12, 8, 9, 5, 5};
+        for (int i = 0; i < sizes.size(); ++i) {
+            int size = sizes[i];
+            auto x   = _Input({1, 3, size, size + 1}, NCHW, halide_type_of<float>());
+            auto ptr = x->writeMap<float>();
+            for (int j = 0; j < 3 * size * (size + 1); ++j) {
+                ptr[j] = (float)((j + i) % 11) * 0.1f;
+            }
+            auto y0 = origin->onForward({x})[0];
+            auto y1 = cached->onForward({x})[0];
+            if (y0->getInfo()->size != y1->getInfo()->size) {
+                MNN_ERROR("Resize cache output size error at %d\n", i);
+                return false;
+            }
+            auto p0 = y0->readMap<float>();
+            auto p1 = y1->readMap<float>();
+            for (int j = 0; j < y0->getInfo()->size; ++j) {
+                if (fabsf(p0[j] - p1[j]) > 0.001f) {
+                    MNN_ERROR("Resize cache output error at %d: %f - %f\n", i, p0[j], p1[j]);
+                    return false;
+                }
+            }
+        }
+        int hitMiss[2] = {0, 0};
+        if (!rtMgr->getInfo(Interpreter::RESIZE_CACHE, hitMiss)) {
+            return false;
+        }
+        if (hitMiss[0] != 3 || hitMiss[1] != 4) {
+            MNN_ERROR("Resize cache hit %d, miss %d, expect 3, 4\n", hitMiss[0], hitMiss[1]);
+            return false;
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(ModuleResizeCacheTest, "expr/ModuleResizeCacheTest");
+
+// Single head attention step: key / value cache are [seq, hidden], or key cache is [hidden, seq] for keyInner
+static std::vector<int8_t> _saveDecoderStep(int hidden, bool keyInner = false) {
+    auto x     = _Input({-1, hidden}, NCHW, halide_type_of<float>());
+    auto pastK = keyInner ? _Input({hidden, -1}, NCHW, halide_type_of<float>()) : _Input({-1, hidden}, NCHW, halide_type_of<float>());
+    auto pastV = _Input({-1, hidden}, NCHW, halide_type_of<float>());
+    x->setName("x");
+    pastK->setName("past_k");
+    pastV->setName("past_v");
+    std::vector<VARP> weights;
+    for (int w = 0; w < 3; ++w) {
+        std::vector<float> weight(hidden * hidden);
+        for (int i = 0; i < weight.size(); ++i) {
+            weight[i] = (float)((i * (w + 3)) % 13) * 0.02f - 0.12f;
+        }
+        weights.emplace_back(_Const(weight.data(), {hidden, hidden}, NCHW));
+    }
+    auto q        = _MatMul(x, weights[0]);
+    auto presentK = _MatMul(x, weights[1]);
+    auto presentV = _MatMul(x, weights[2]);
+    if (keyInner) {
+        presentK = _Transpose(presentK, {1, 0});
+    }
+    presentK->setName("present_k");
+    presentV->setName("present_v");
+    auto k = _Concat({pastK, presentK}, keyInner ? 1 : 0);
+    auto v = _Concat({pastV, presentV}, 0);
+    auto s = _Softmax(_MatMul(q, k, false, !keyInner) * _Scalar<float>(1.0f / sqrtf((float)hidden)), -1);
+    auto y = _MatMul(s, v) + x;
+    y->setName("y");
+    return Variable::save({y, presentK, presentV});
+}
+
+class ModuleStateTest : public MNNTestCase {
+public:
+    virtual bool run(int precision) {
+        const int hidden = 8, steps = 12;
+        auto buffer = _saveDecoderStep(hidden);
+        std::shared_ptr<Module> origin(Module::load({"x", "past_k", "past_v"}, {"y", "present_k", "present_v"}, (const uint8_t*)buffer.data(), buffer.size()), Module::destroy);
+        std::shared_ptr<Module> stateOrigin(Module::load({"x", "past_k", "past_v"}, {"y", "present_k", "present_v"}, (const uint8_t*)buffer.data(), buffer.size()), Module::destroy);
+        Module::StateConfig config;
+        config.states.resize(2);
+        config.states[0].input  = "past_k";
+        config.states[0].output = "present_k";
+        config.states[1].input  = "past_v";
+        config.states[1].output = "present_v";
+        config.capacity = 4;
+        std::shared_ptr<Module> stateful(Module::createStateful(stateOrigin, config), Module::destroy);
+        if (nullptr == stateful) {
+            return false;
+        }
+        {
+            // The state axis must be outermost, otherwise the past can't be referenced without copy
+            auto innerBuffer = _saveDecoderStep(hidden, true);
+            std::shared_ptr<Module> inner(Module::load({"x", "past_k", "past_v"}, {"y", "present_k", "present_v"}, (const uint8_t*)innerBuffer.data(), innerBuffer.size()), Module::destroy);
+            auto innerConfig = config;
+            innerConfig.states[0].axis = -1;
+            std::shared_ptr<Module> innerStateful(Module::createStateful(inner, innerConfig), Module::destroy);
+            if (nullptr != innerStateful) {
+                MNN_ERROR("Stateful module should reject the state whose axis isn't outermost\n");
+                return false;
+            }
+        }
+        std::vector<float> cacheK, cacheV;
+        std::vector<std::vector<float>> expects;
+        for (int round = 0; round < 2; ++round) {
+            // The second round checks clearCache begins a new sequence
+            int stepNumber = round == 0 ? steps : 3;
+            for (int i = 0; i < stepNumber; ++i) {
+                auto x   = _Input({1, hidden}, NCHW, halide_type_of<float>());
+                auto ptr = x->writeMap<float>();
+                for (int j = 0; j < hidden; ++j) {
+                    ptr[j] = (float)((i * 5 + j) % 9) * 0.1f - 0.4f;
+                }
+                if (round == 0) {
+                    int length = (int)cacheV.size() / hidden;
+                    auto pastK = _Input({length, hidden}, NCHW, halide_type_of<float>());
+                    auto pastV = _Input({length, hidden}, NCHW, halide_type_of<float>());
+                    if (length > 0) {
+                        ::memcpy(pastK->writeMap<float>(), cacheK.data(), cacheK.size() * sizeof(float));
+                        ::memcpy(pastV->writeMap<float>(), cacheV.data(), cacheV.size() * sizeof(float));
+                    }
+                    auto outputs = origin->onForward({x, pastK, pastV});
+                    auto y       = outputs[0]->readMap<float>();
+                    auto k       = outputs[1]->readMap<float>();
+                    auto v       = outputs[2]->readMap<float>();
+                    expects.emplace_back(y, y + hidden);
+                    cacheK.insert(cacheK.end(), k, k + hidden);
+                    cacheV.insert(cacheV.end(), v, v + hidden);
+                }
+                auto outputs = stateful->onForward({x});
+                if (outputs.size() != 1) {
+                    MNN_ERROR("Stateful module output number error\n");
+                    return false;
+                }
+                auto y = outputs[0]->readMap<float>();
+                for (int j = 0; j < hidden; ++j) {
+                    if (fabsf(y[j] - expects[i][j]) > 0.001f) {
+                        MNN_ERROR("Stateful module error at round %d step %d: %f - %f\n", round, i, y[j], expects[i][j]);
+                        return false;
+                    }
+                }
+            }
+            stateful->clearCache();
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(ModuleStateTest, "expr/ModuleStateTest");
+
+static std::vector<float> _tileWeight(int size, int seed) {
+    std::vector<float> weight(size);
+    for (int i = 0; i < size; ++i) {
+        weight[i] = (float)((i * seed) % 11) * 0.02f - 0.1f;
+    }
+    return weight;
+}
+
+// Fully convolutional net with an output at stride 2 and an output upsampled to twice of the input
+static std::vector<int8_t> _saveTileNet(bool globalPool) {
+    auto x = _Input({1, 3, 64, 64}, NCHW, halide_type_of<float>());
+    x->setName("x");
+    auto y = _Convert(x, NC4HW4);
+    y = _Conv(_tileWeight(8 * 3 * 9, 3), _tileWeight(8, 5), y, {3, 8}, {3, 3}, CAFFE, {1, 1}, {1, 1}, 1, {1, 1}, true);
+    auto half = _MaxPool(y, {2, 2}, {2, 2});
+    y = _Conv(_tileWeight(8 * 8 * 9, 7), _tileWeight(8, 3), half, {8, 8}, {3, 3}, CAFFE, {1, 1}, {2, 2}, 1, {2, 2});
+    if (globalPool) {
+        y = y + _AvePool(y, {-1, -1});
+    }
+    y = _Deconv(_tileWeight(8 * 4 * 16, 5), _tileWeight(4, 7), y, {8, 4}, {4, 4}, CAFFE, {2, 2}, {1, 1}, 1, {1, 1});
+    y = _Interp({y}, 2.0f, 2.0f, 0, 0, 2, false);
+    y = _Convert(y, NCHW);
+    y->setName("y");
+    half = _Convert(half, NCHW);
+    half->setName("half");
+    return Variable::save({y, half});
+}
+
+class ModuleTiledTest : public MNNTestCase {
+public:
+    virtual bool run(int precision) {
+        auto buffer = _saveTileNet(false);
+        std::shared_ptr<Module> origin(Module::load({"x"}, {"y", "half"}, (const uint8_t*)buffer.data(), buffer.size()), Module::destroy);
+        Module::TileConfig config;
+        config.tileHeight = 16;
+        config.tileWidth  = 20;
+        config.parallel   = 2;
+        // The clones for the parallel tiles are created from the runtime of the module if it has one
+        ScheduleConfig scheduleConfig;
+        scheduleConfig.numThread = 2;
+        std::shared_ptr<Executor::RuntimeManager> rtMgr(Executor::RuntimeManager::createRuntimeManager(scheduleConfig));
+        std::vector<std::shared_ptr<Module>> tileds;
+        tileds.emplace_back(Module::loadTiled({"x"}, {"y", "half"}, (const uint8_t*)buffer.data(), buffer.size(), config), Module::destroy);
+        tileds.emplace_back(Module::loadTiled({"x"}, {"y", "half"}, (const uint8_t*)buffer.data(), buffer.size(), config, rtMgr), Module::destroy);
+        if (nullptr == origin || nullptr == tileds[0] || nullptr == tileds[1]) {
+            MNN_ERROR("Load tiled module failed\n");
+            return false;
+        }
+        // Not a multiple of the tiles, and too small for tiling
+        std::vector<std::vector<int>> shapes = {{72, 90}, {36, 24}};
+        for (int k = 0; k < shapes.size() * tileds.size(); ++k) {
+            auto& shape = shapes[k % shapes.size()];
+            auto tiled  = tileds[k / shapes.size()];
+            auto x   = _Input({1, 3, shape[0], shape[1]}, NCHW, halide_type_of<float>());
+            auto ptr = x->writeMap<float>();
+            for (int i = 0; i < 3 * shape[0] * shape[1]; ++i) {
+                ptr[i] = (float)((i * 7) % 23) * 0.05f - 0.5f;
+            }
+            auto expects = origin->onForward({x});
+            auto outputs = tiled->onForward({x});
+            if (outputs.size() != expects.size()) {
+                MNN_ERROR("Tiled module output number error\n");
+                return false;
+            }
+            for (int i = 0; i < outputs.size(); ++i) {
+                auto expectInfo = expects[i]->getInfo();
+                auto info       = outputs[i]->getInfo();
+                if (info->dim != expectInfo->dim) {
+                    MNN_ERROR("Tiled module output %d shape error\n", i);
+                    return false;
+                }
+                auto expect = expects[i]->readMap<float>();
+                auto result = outputs[i]->readMap<float>();
+                for (int j = 0; j < info->size; ++j) {
+                    if (fabsf(expect[j] - result[j]) > 0.001f) {
+                        MNN_ERROR("Tiled module output %d error at %d: %f - %f\n", i, j, result[j], expect[j]);
+                        return false;
+                    }
+                }
+            }
+        }
+        // Global pooling mixes all positions
+        buffer = _saveTileNet(true);
+        std::shared_ptr<Module> invalid(Module::loadTiled({"x"}, {"y", "half"}, (const uint8_t*)buffer.data(), buffer.size(), config), Module::destroy);
+        return nullptr == invalid;
+    }
+};
+MNNTestSuiteRegister(ModuleTiledTest, "expr/ModuleTiledTest");
+
+class ModuleAsyncTest : public MNNTestCase {
+public:
+    virtual bool run(int precision) {
+        std::vector<int8_t> buffer;
+        {
+            auto x = _Input({1, 4}, NCHW, halide_type_of<float>());
+            x->setName("x");
+            auto w = _Const(std::vector<float>{1.0f, 2.0f, 3.0f, 4.0f}.data(), {1, 4}, NCHW);
+            auto b = _Const(std::vector<float>{-1.0f, 0.0f, 1.0f, 2.0f}.data(), {1, 4}, NCHW);
+            auto y = _Add(_Multiply(x, w), b);
+            y->setName("y");
+            buffer = Variable::save({y});
+        }
+        auto check = [](const float* y, int r) {
+            for (int i = 0; i < 4; ++i) {
+                if (fabsf(y[i] - ((float)(r + i) * (float)(i + 1) + (float)(i - 1))) > 0.001f) {
+                    return false;
+                }
+            }
+            return true;
+        };
+        std::shared_ptr<Module> module(Module::load({"x"}, {"y"}, (const uint8_t*)buffer.data(), buffer.size()), Module::destroy);
+        int requestNumber = 8;
+        std::vector<std::future<std::vector<VARP>>> futures;
+        for (int r = 0; r < requestNumber; ++r) {
+            auto x   = _Input({1, 4}, NCHW, halide_type_of<float>());
+            auto ptr = x->writeMap<float>();
+            for (int i = 0; i < 4; ++i) {
+                ptr[i] = (float)(r + i);
+            }
+            futures.emplace_back(module->forwardAsync({x}));
+        }
+        // The outputs are copied, so all of them are still valid after later requests
+        std::vector<std::vector<VARP>> results;
+        for (auto& f : futures) {
+            results.emplace_back(f.get());
+        }
+        for (int r = 0; r < requestNumber; ++r) {
+            if (results[r].size() != 1 || !check(results[r][0]->readMap<float>(), r)) {
+                MNN_ERROR("Module forwardAsync result error for request %d\n", r);
+                return false;
+            }
+        }
+        std::atomic<int> correct(0);
+        for (int r = 0; r < requestNumber; ++r) {
+            auto x   = _Input({1, 4}, NCHW, halide_type_of<float>());
+            auto ptr = x->writeMap<float>();
+            for (int i = 0; i < 4; ++i) {
+                ptr[i] = (float)(r + i);
+            }
+            module->forwardAsync({x}, [r, &correct, check](std::vector<VARP> outputs) {
+                if (outputs.size() == 1 && check(outputs[0]->readMap<float>(), r)) {
+                    correct++;
+                }
+            });
+        }
+        module.reset();
+        if (correct.load() != requestNumber) {
+            MNN_ERROR("Module forwardAsync callback is correct for %d of %d requests\n", correct.load(), requestNumber);
+            return false;
+        }
+
+        std::shared_ptr<Interpreter> net(Interpreter::createFromBuffer(buffer.data(), buffer.size()), Interpreter::destroy);
+        ScheduleConfig config;
+        auto session = net->createSession(config);
+        auto input   = net->getSessionInput(session, "x");
+        auto output  = net->getSessionOutput(session, "y");
+        for (int r = 0; r < requestNumber; ++r) {
+            for (int i = 0; i < 4; ++i) {
+                input->host<float>()[i] = (float)(r + i);
+            }
+            if (r % 2 == 0) {
+                if (NO_ERROR != net->runSessionAsync(session).get()) {
+                    return false;
+                }
+            } else {
+                std::promise<bool> done;
+                net->runSessionAsync(session, [&done, output, r, check](ErrorCode code) {
+                    done.set_value(NO_ERROR == code && check(output->host<float>(), r));
+                });
+                if (!done.get_future().get()) {
+                    return false;
+                }
+            }
+            if (!check(output->host<float>(), r)) {
+                MNN_ERROR("Interpreter runSessionAsync result error for request %d\n", r);
+                return false;
+            }
+        }
+        float info[4];
+        // The request is in flight until its callback returns, which may be after the promise is set
+        for (int i = 0; i < 1000; ++i) {
+            net->getSessionInfo(session, Interpreter::ASYNC_QUEUE, info);
+            if (0.0f == info[1]) {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        if (info[0] < 1.0f || info[1] != 0.0f || info[2] < 0.0f || info[3] < info[2]) {
+            MNN_ERROR("Invalid async queue info: %f, %f, %f, %f\n", info[0], info[1], info[2], info[3]);
+            return false;
+        }
+        // The next run of a queue starts after the finish of the last request, which may read the shared outputs
+        std::atomic<int> finished(0);
+        std::atomic<bool> ordered(true);
+        {
+            AsyncQueue queue;
+            for (int r = 0; r < 4; ++r) {
+                queue.post([r, &finished, &ordered]() {
+                    if (finished.load() != r) {
+                        ordered = false;
+                    }
+                }, [&finished]() {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                    finished++;
+                });
+            }
+        }
+        if (!ordered.load()) {
+            MNN_ERROR("Async queue runs the next request before finish\n");
+            return false;
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(ModuleAsyncTest, "expr/ModuleAsyncTest");
+
 
 class ModuleTestSpeed : public MNNTestCase {
 public:
@@ -0,0 +1,127 @@
+//
+//  CheckpointTest.cpp
+//  MNNTests
+//
+//  Created by MNN on 2023/03/13.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <math.h>
+#include <MNN/expr/ExprCreator.hpp>
+#include <MNN/expr/Module.hpp>
+#include "../tools/train/source/grad/OpGrad.hpp"
+#include "../tools/train/source/nn/NN.hpp"
+#include "../tools/train/source/nn/RandomGenerator.hpp"
+#include "MNNTestSuite.h"
+using namespace MNN;
+using namespace MNN::Express;
+
+// Conv + BatchNorm + Relu6 + Dropout with shortcut
+class CheckpointBlock : public Module {
+public:
+    CheckpointBlock(int channel, int seed) {
+        std::vector<float> weight(channel * channel * 9);
+        for (int i = 0; i < weight.size(); ++i) {
+            weight[i] = (float)((i * 17 + seed * 5) % 23) / 23.0f - 0.5f;
+        }
+        mWeight = _TrainableParam(weight.data(), {channel, channel, 3, 3}, NCHW);
+        mBias   = _TrainableParam(0.1f * seed, {channel}, NCHW);
+        addParameter(mWeight);
+        addParameter(mBias);
+        mBn.reset(NN::BatchNorm(channel));
+        mDropout.reset(NN::Dropout(0.2f));
+        registerModel({mBn, mDropout});
+    }
+    virtual std::vector<VARP> onForward(const std::vector<VARP>& inputs) override {
+        auto x = _Conv(mWeight, mBias, inputs[0], SAME);
+        x      = _Relu6(mBn->forward(x));
+        // Dropout copies the generator, advance it so that each forward uses a different mask
+        RandomGenerator::generator().discard(1);
+        x      = mDropout->forward(x);
+        return {x + inputs[0]};
+    }
+
+private:
+    VARP mWeight;
+    VARP mBias;
+    std::shared_ptr<Module> mBn;
+    std::shared_ptr<Module> mDropout;
+};
+
+class CheckpointTest : public MNNTestCase {
+public:
+    virtual bool run(int precision) {
+        const int channel = 4, size = 6;
+        std::vector<float> gradValues[2];
+        std::vector<float> stateValues[2];
+        for (int checkpoint = 0; checkpoint < 2; ++checkpoint) {
+            RandomGenerator::generator().seed(17);
+            std::vector<std::shared_ptr<Module>> blocks;
+            for (int i = 0; i < 3; ++i) {
+                std::shared_ptr<Module> block(new CheckpointBlock(channel, i + 1));
+                // The adjacent checkpoints share the outputs, the last block is not checkpointed
+                if (checkpoint && i != 2) {
+                    block.reset(NN::Checkpoint(block));
+                }
+                block->setIsTraining(true);
+                blocks.emplace_back(block);
+            }
+            auto input = _Input({1, channel, size, size}, NCHW);
+            auto ptr   = input->writeMap<float>();
+            for (int i = 0; i < channel * size * size; ++i) {
+                ptr[i] = (float)((i * 7) % 13) / 13.0f - 0.3f;
+            }
+            auto x = _Convert(input, NC4HW4);
+            for (auto& block : blocks) {
+                x = block->forward(x);
+            }
+            auto loss = _ReduceMean(_Square(_Convert(x, NCHW)), {});
+            std::set<VARP> trainable;
+            std::vector<VARP> parameters;
+            for (auto& block : blocks) {
+                for (auto p : block->parameters()) {
+                    parameters.emplace_back(p);
+                    if (nullptr == p->expr().first->get() && VARP::TRAINABLE == p->expr().first->inputType()) {
+                        trainable.insert(p);
+                    }
+                }
+            }
+            auto grads = OpGrad::grad(loss, trainable);
+            if (grads.size() != trainable.size()) {
+                MNN_ERROR("Checkpoint grad number error: %d\n", (int)grads.size());
+                return false;
+            }
+            // The recompute in backward must not update the states again
+            parameters.clear();
+            for (auto& block : blocks) {
+                auto blockParameters = block->parameters();
+                parameters.insert(parameters.end(), blockParameters.begin(), blockParameters.end());
+            }
+            for (auto p : parameters) {
+                auto iter = grads.find(p);
+                auto var  = iter != grads.end() ? iter->second : p;
+                auto size = var->getInfo()->size;
+                auto data = var->readMap<float>();
+                auto& dst = iter != grads.end() ? gradValues[checkpoint] : stateValues[checkpoint];
+                dst.insert(dst.end(), data, data + size);
+            }
+        }
+        // The grads and the running mean / variance updated by forward are the same as without checkpoint
+        for (int k = 0; k < 2; ++k) {
+            auto& values0 = k == 0 ? gradValues[0] : stateValues[0];
+            auto& values1 = k == 0 ? gradValues[1] : stateValues[1];
+            if (values0.size() != values1.size() || values0.empty()) {
+                MNN_ERROR("Checkpoint value number error\n");
+                return false;
+            }
+            for (int i = 0; i < values0.size(); ++i) {
+                if (fabsf(values0[i] - values1[i]) > 1e-4f + 1e-3f * fabsf(values0[i])) {
+                    MNN_ERROR("Checkpoint %s error at %d: %f - %f\n", k == 0 ? "grad" : "state", i, values0[i], values1[i]);
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(CheckpointTest, "nn/Checkpoint");
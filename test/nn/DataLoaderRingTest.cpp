@@ -0,0 +1,86 @@
+//
+//  DataLoaderRingTest.cpp
+//  MNNTests
+//
+//  Created by MNN on 2023/03/15.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <MNN/expr/ExprCreator.hpp>
+#include <algorithm>
+#include <memory>
+#include "../tools/train/source/data/DataLoader.hpp"
+#include "../tools/train/source/data/Dataset.hpp"
+#include "MNNTestSuite.h"
+using namespace MNN;
+using namespace MNN::Express;
+using namespace MNN::Train;
+
+class RingTestDataset : public Dataset {
+public:
+    Example get(size_t index) override {
+        auto data = _Input({2, 3}, NCHW, halide_type_of<float>());
+        auto ptr  = data->writeMap<float>();
+        for (int i = 0; i < 6; ++i) {
+            ptr[i] = (float)(index * 10 + i);
+        }
+        auto label = _Input({}, NCHW, halide_type_of<int32_t>());
+        label->writeMap<int32_t>()[0] = (int32_t)index;
+        return {{data}, {label}};
+    }
+    size_t size() override {
+        return 10;
+    }
+};
+
+class DataLoaderRingTest : public MNNTestCase {
+public:
+    virtual bool run(int precision) {
+        const int batchSize = 4;
+        for (int numWorkers = 0; numWorkers <= 2; numWorkers += 2) {
+            std::shared_ptr<BatchDataset> dataset(new RingTestDataset);
+            std::shared_ptr<DataLoader> loader(DataLoader::makeDataLoader(dataset, batchSize, true, false, numWorkers, 2));
+            // Run two epochs to check reset
+            for (int epoch = 0; epoch < 2; ++epoch) {
+                std::vector<int> indices;
+                for (int iter = 0; iter < loader->iterNumber(); ++iter) {
+                    auto example = loader->next()[0];
+                    auto dataInfo  = example.first[0]->getInfo();
+                    auto labelInfo = example.second[0]->getInfo();
+                    // The workers may finish the batches out of order
+                    auto number = labelInfo->dim[0];
+                    if (dataInfo->dim != std::vector<int>{number, 2, 3} || labelInfo->dim.size() != 1 ||
+                        (number != batchSize && number != 2)) {
+                        MNN_ERROR("DataLoader ring shape error\n");
+                        return false;
+                    }
+                    auto data  = example.first[0]->readMap<float>();
+                    auto label = example.second[0]->readMap<int32_t>();
+                    for (int i = 0; i < number; ++i) {
+                        for (int j = 0; j < 6; ++j) {
+                            if (data[i * 6 + j] != (float)(label[i] * 10 + j)) {
+                                MNN_ERROR("DataLoader ring error for %d workers: %f - %d\n", numWorkers, data[i * 6 + j], label[i] * 10 + j);
+                                return false;
+                            }
+                        }
+                        indices.emplace_back(label[i]);
+                    }
+                }
+                std::sort(indices.begin(), indices.end());
+                for (int i = 0; i < indices.size(); ++i) {
+                    if (indices[i] != i) {
+                        MNN_ERROR("DataLoader ring index error\n");
+                        return false;
+                    }
+                }
+                if (indices.size() != dataset->size()) {
+                    MNN_ERROR("DataLoader ring size error\n");
+                    return false;
+                }
+                loader->reset();
+            }
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(DataLoaderRingTest, "nn/DataLoaderRing");
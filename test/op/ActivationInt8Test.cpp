@@ -0,0 +1,124 @@
+//
+//  ActivationInt8Test.cpp
+//  MNNTests
+//
+//  Created by MNN on 2022/01/10.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <math.h>
+#include <MNN/expr/ExprCreator.hpp>
+#include <MNN/expr/Module.hpp>
+#include "MNN_generated.h"
+#include "MNNTestSuite.h"
+
+using namespace MNN::Express;
+using namespace MNN;
+
+static VARP _LayerNormForTest(VARP x, int size) {
+    std::unique_ptr<OpT> op(new OpT);
+    op->type       = OpType_LayerNorm;
+    op->main.type  = OpParameter_LayerNorm;
+    auto param     = new LayerNormT;
+    param->axis    = {-1};
+    param->epsilon = 0.00001f;
+    param->gamma.resize(size);
+    param->beta.resize(size);
+    for (int i = 0; i < size; ++i) {
+        param->gamma[i] = 0.5f + (float)(i % 5) * 0.25f;
+        param->beta[i]  = (float)(i % 3) * 0.2f - 0.2f;
+    }
+    op->main.value = param;
+    return Variable::create(Expr::create(op.get(), {x}));
+}
+
+// LayerNorm, Softmax and GELU on int8 input and output, compared with the float model
+class ActivationInt8Test : public MNNTestCase {
+public:
+    virtual bool run(int precision) {
+        const int batch = 4, seq = 8, hidden = 32;
+        auto x = _Input({batch, seq, hidden}, NCHW, halide_type_of<float>());
+        x->setName("x");
+        // The binary op runs in float, so the int8 ops take a cast input and give a cast output
+        auto xq = x * _Scalar<float>(1.0f);
+        xq->setName("xq");
+        std::vector<VARP> activations = {_LayerNormForTest(xq, hidden), _Softmax(xq, -1), _Softmax(xq, 1), _Gelu(xq)};
+        std::vector<std::string> names = {"layernorm", "softmax_last", "softmax_mid", "gelu"};
+        std::vector<VARP> outputs;
+        std::vector<std::string> outputNames;
+        for (int i = 0; i < activations.size(); ++i) {
+            activations[i]->setName(names[i]);
+            auto y = activations[i] * _Scalar<float>(1.0f);
+            y->setName(names[i] + "_out");
+            outputs.emplace_back(y);
+            outputNames.emplace_back(names[i] + "_out");
+        }
+        std::unique_ptr<NetT> net(new NetT);
+        Variable::save(outputs, net.get());
+        auto floatBuffer = _pack(net.get());
+
+        auto input = _Input({batch, seq, hidden}, NCHW, halide_type_of<float>());
+        auto ptr   = input->writeMap<float>();
+        for (int i = 0; i < batch * seq * hidden; ++i) {
+            ptr[i] = (float)((i * 13) % 61) / 60.0f * 8.0f - 4.0f;
+        }
+        std::shared_ptr<Module> floatModule(Module::load({"x"}, outputNames, floatBuffer.data(), floatBuffer.size()), Module::destroy);
+        auto expects = floatModule->onForward({input});
+
+        // Quant the activations by their range in the float model
+        std::vector<float> outputScales(names.size());
+        for (int i = 0; i < names.size(); ++i) {
+            auto info    = expects[i]->getInfo();
+            auto expect  = expects[i]->readMap<float>();
+            float maxAbs = 0.0f;
+            for (int j = 0; j < info->size; ++j) {
+                maxAbs = fmaxf(maxAbs, fabsf(expect[j]));
+            }
+            outputScales[i] = maxAbs / 127.0f;
+            _addQuantInfo(net.get(), names[i], outputScales[i]);
+        }
+        const float inputScale = 4.0f / 127.0f;
+        _addQuantInfo(net.get(), "xq", inputScale);
+        auto quantBuffer = _pack(net.get());
+        std::shared_ptr<Module> quantModule(Module::load({"x"}, outputNames, quantBuffer.data(), quantBuffer.size()), Module::destroy);
+        auto results = quantModule->onForward({input});
+        for (int i = 0; i < names.size(); ++i) {
+            auto info   = results[i]->getInfo();
+            auto result = results[i]->readMap<float>();
+            auto expect = expects[i]->readMap<float>();
+            for (int j = 0; j < info->size; ++j) {
+                // The output rounding and the input quant error, which is relative for softmax
+                float tolerance = 2.0f * outputScales[i] + fabsf(expect[j]) * inputScale;
+                if (fabsf(result[j] - expect[j]) > tolerance) {
+                    MNN_ERROR("%s int8 error at %d: %f - %f\n", names[i].c_str(), j, result[j], expect[j]);
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+private:
+    static std::vector<uint8_t> _pack(const NetT* net) {
+        flatbuffers::FlatBufferBuilder builder(1024);
+        builder.Finish(Net::Pack(builder, net));
+        return std::vector<uint8_t>(builder.GetBufferPointer(), builder.GetBufferPointer() + builder.GetSize());
+    }
+    static void _addQuantInfo(NetT* net, const std::string& name, float scale) {
+        for (int i = 0; i < net->tensorName.size(); ++i) {
+            if (net->tensorName[i] != name) {
+                continue;
+            }
+            std::unique_ptr<TensorDescribeT> describe(new TensorDescribeT);
+            describe->index = i;
+            describe->quantInfo.reset(new TensorQuantInfoT);
+            describe->quantInfo->scale = scale;
+            describe->quantInfo->zero  = 0.0f;
+            describe->quantInfo->min   = -127.0f;
+            describe->quantInfo->max   = 127.0f;
+            describe->quantInfo->type  = DataType_DT_INT8;
+            net->extraTensorDescribe.emplace_back(std::move(describe));
+        }
+    }
+};
+MNNTestSuiteRegister(ActivationInt8Test, "op/ActivationInt8");
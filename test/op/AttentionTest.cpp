@@ -0,0 +1,83 @@
+//
+//  AttentionTest.cpp
+//  MNNTests
+//
+//  Created by MNN on 2021/12/10.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <MNN/expr/Expr.hpp>
+#include <MNN/expr/ExprCreator.hpp>
+#include "MNNTestSuite.h"
+#include "TestUtils.h"
+
+using namespace MNN::Express;
+
+static VARP _randomInput(std::vector<int> shape, int seed) {
+    int size = 1;
+    for (auto s : shape) {
+        size *= s;
+    }
+    std::vector<float> data(size);
+    for (int i = 0; i < size; ++i) {
+        data[i] = (float)((i * 7 + seed * 13) % 23) / 23.0f - 0.5f;
+    }
+    return _Const(data.data(), shape, NCHW, halide_type_of<float>());
+}
+
+class AttentionTest : public MNNTestCase {
+public:
+    virtual ~AttentionTest() = default;
+    virtual bool run(int precision) {
+        // batch, head, seqQ, seqK, dim, dimV
+        std::vector<std::vector<int>> cases = {
+            {1, 1, 1, 1, 4, 4},
+            {1, 2, 5, 7, 3, 5},
+            {2, 3, 70, 130, 20, 16},
+        };
+        for (auto& c : cases) {
+            int batch = c[0], head = c[1], seqQ = c[2], seqK = c[3], dim = c[4], dimV = c[5];
+            float scale = 1.0f / sqrtf((float)dim);
+            auto query  = _randomInput({batch, head, seqQ, dim}, 0);
+            auto key    = _randomInput({batch, head, seqK, dim}, 1);
+            auto value  = _randomInput({batch, head, seqK, dimV}, 2);
+            auto mask   = _randomInput({1, 1, seqQ, seqK}, 3);
+            auto keyT   = _Transpose(key, {0, 1, 3, 2});
+            for (int useMask = 0; useMask < 2; ++useMask) {
+                auto scores = _MatMul(query, key, false, true) * _Scalar<float>(scale);
+                if (useMask) {
+                    scores = scores + mask;
+                }
+                auto expected = _MatMul(_Softmax(scores, -1), value);
+                auto outputs  = {
+                    _Attention(query, key, value, useMask ? mask : nullptr, scale, false),
+                    _Attention(query, keyT, value, useMask ? mask : nullptr, scale, true),
+                };
+                auto size = batch * head * seqQ * dimV;
+                for (auto output : outputs) {
+                    auto info = output->getInfo();
+                    if (nullptr == info || info->size != size) {
+                        MNN_ERROR("AttentionTest shape error\n");
+                        return false;
+                    }
+                    if (!checkVectorByRelativeError<float>(output->readMap<float>(), expected->readMap<float>(), size, 0.001f)) {
+                        MNN_ERROR("AttentionTest error for seqQ=%d, seqK=%d, dim=%d, mask=%d\n", seqQ, seqK, dim, useMask);
+                        return false;
+                    }
+                }
+            }
+        }
+        // Only float mask is supported, other types must not be computed as float
+        {
+            auto query  = _randomInput({1, 1, 2, 4}, 0);
+            auto mask   = _Cast<int32_t>(_randomInput({1, 1, 2, 2}, 3));
+            auto output = _Attention(query, query, query, mask, 1.0f, false);
+            if (nullptr != output->readMap<float>()) {
+                MNN_ERROR("AttentionTest should reject int mask\n");
+                return false;
+            }
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(AttentionTest, "op/attention");
@@ -37,6 +37,53 @@ public:
             MNN_ERROR("RasterTest slice test failed!\n");
             return false;
         }
+        // transpose larger than one tile
+        {
+            const int b = 3, h = 70, w = 45;
+            auto input1 = _Input({b, h, w}, NCHW);
+            auto ptr    = input1->writeMap<float>();
+            for (int i = 0; i < b * h * w; ++i) {
+                ptr[i] = (float)i;
+            }
+            auto output1 = _Raster({input1}, {0, h * w, 1, w, 0, h * w, h, 1, b, w, h}, {b, w, h});
+            auto got     = output1->readMap<float>();
+            for (int z = 0; z < b; ++z) {
+                for (int y = 0; y < w; ++y) {
+                    for (int x = 0; x < h; ++x) {
+                        if (got[z * h * w + y * h + x] != (float)(z * h * w + x * w + y)) {
+                            MNN_ERROR("RasterTest large transpose test failed!\n");
+                            return false;
+                        }
+                    }
+                }
+            }
+        }
+        // rows copied by multi region from the same input
+        {
+            const int h = 16, w = 20;
+            auto input2 = _Input({h, w}, NCHW);
+            auto ptr    = input2->writeMap<float>();
+            for (int i = 0; i < h * w; ++i) {
+                ptr[i] = (float)i;
+            }
+            std::vector<VARP> inputs;
+            std::vector<int> regions;
+            for (int i = 0; i < h; ++i) {
+                inputs.emplace_back(input2);
+                std::vector<int> region = {i * w, 0, 0, 1, (h - 1 - i) * w, 0, 0, 1, 1, 1, w};
+                regions.insert(regions.end(), region.begin(), region.end());
+            }
+            auto output2 = _Raster(inputs, regions, {h, w});
+            auto got     = output2->readMap<float>();
+            for (int y = 0; y < h; ++y) {
+                for (int x = 0; x < w; ++x) {
+                    if (got[y * w + x] != (float)((h - 1 - y) * w + x)) {
+                        MNN_ERROR("RasterTest multi region test failed!\n");
+                        return false;
+                    }
+                }
+            }
+        }
         return true;
     }
     virtual bool run(int precision) {
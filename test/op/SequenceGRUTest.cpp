@@ -8,6 +8,10 @@
 //
 #include <MNN/expr/Expr.hpp>
 #include <MNN/expr/ExprCreator.hpp>
+#include <MNN/expr/Executor.hpp>
+#include <MNN/expr/ExecutorScope.hpp>
+#include <MNN/expr/Module.hpp>
+#include <math.h>
 #include "common/MemoryFormater.h"
 #include "MNNTestSuite.h"
 #include "TestUtils.h"
@@ -346,3 +350,144 @@ public:
 };
 
 MNNTestSuiteRegister(SequenceGRUTest, "op/rnn/SequenceGRU");
+
+// Compare with a reference of ONNX GRU for large units which are divided into slabs for multiple threads
+class SequenceGRUMultiThreadTest : public MNNTestCase {
+public:
+    virtual ~SequenceGRUMultiThreadTest() = default;
+    virtual bool run(int precision) {
+        BackendConfig config;
+        auto exe = Executor::newExecutor(MNN_FORWARD_CPU, config, 4);
+        ExecutorScope scope(exe);
+        for (int direction : {0, 1}) {
+            for (int linearBeforeReset : {0, 1}) {
+                for (int constWeight : {0, 1}) {
+                    if (!_test(direction, linearBeforeReset, constWeight, precision)) {
+                        MNN_ERROR("SequenceGRUMultiThreadTest failed: direction = %d, linear_before_reset = %d, const = %d\n", direction, linearBeforeReset, constWeight);
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+private:
+    static float _sigmoid(float x) {
+        return 1.0f / (1.0f + expf(-x));
+    }
+    // The constant weights are packed once by the first forward of the module and reused by the second one
+    bool _test(int direction, int linearBeforeReset, int constWeight, int precision) {
+        const int seq = 5, batch = 2, inputSize = 19, hidden = 70, gates = 3;
+        const int numDirections = direction + 1;
+        auto makeInput = [constWeight](std::vector<int> dims, int seed, float scale) {
+            auto var  = _Input(dims, NCHW, halide_type_of<float>());
+            auto ptr  = var->writeMap<float>();
+            auto size = var->getInfo()->size;
+            for (int i = 0; i < size; ++i) {
+                ptr[i] = (float)((i * seed + 7) % 23 - 11) * scale;
+            }
+            if (constWeight) {
+                return _Const(var->readMap<float>(), dims, NCHW);
+            }
+            return var;
+        };
+        auto X     = _Input({seq, batch, inputSize}, NCHW, halide_type_of<float>());
+        auto W     = makeInput({numDirections, gates * hidden, inputSize}, 3, 0.01f);
+        auto R     = makeInput({numDirections, gates * hidden, hidden}, 7, 0.01f);
+        auto B     = makeInput({numDirections, 2 * gates * hidden}, 11, 0.02f);
+        auto initH = makeInput({numDirections, batch, hidden}, 13, 0.03f);
+        auto Y     = _SequenceGRU(hidden, inputSize, direction, linearBeforeReset, X, W, R, B, initH);
+        auto Yh    = Variable::create(Y->expr().first, 1);
+        std::shared_ptr<Module> module;
+        if (constWeight) {
+            X->setName("x");
+            Y->setName("y");
+            Yh->setName("yh");
+            auto buffer = Variable::save({Y, Yh});
+            module.reset(Module::load({"x"}, {"y", "yh"}, (const uint8_t*)buffer.data(), buffer.size()), Module::destroy);
+            if (nullptr == module) {
+                return false;
+            }
+        }
+        for (int round = 0; round < 1 + constWeight; ++round) {
+            auto input = constWeight ? _Input({seq, batch, inputSize}, NCHW, halide_type_of<float>()) : X;
+            auto ptr   = input->writeMap<float>();
+            for (int i = 0; i < seq * batch * inputSize; ++i) {
+                ptr[i] = (float)((i * (5 + round * 4) + 7) % 23 - 11) * 0.05f;
+            }
+            auto y  = Y;
+            auto yh = Yh;
+            if (constWeight) {
+                auto outputs = module->onForward({input});
+                y  = outputs[0];
+                yh = outputs[1];
+            }
+            if (!_check(y->readMap<float>(), yh->readMap<float>(), input->readMap<float>(), W->readMap<float>(), R->readMap<float>(),
+                        B->readMap<float>(), initH->readMap<float>(), numDirections, linearBeforeReset, precision)) {
+                MNN_ERROR("SequenceGRUMultiThreadTest failed at round %d\n", round);
+                return false;
+            }
+        }
+        return true;
+    }
+    bool _check(const float* y, const float* yh, const float* x, const float* w, const float* r, const float* bi, const float* h0,
+                int numDirections, int linearBeforeReset, int precision) {
+        const int seq = 5, batch = 2, inputSize = 19, hidden = 70, gates = 3;
+        if (nullptr == y || nullptr == yh) {
+            return false;
+        }
+        float errorScale = precision <= MNN::BackendConfig::Precision_High ? 1 : 20;
+        for (int d = 0; d < numDirections; ++d) {
+            auto wd = w + d * gates * hidden * inputSize;
+            auto rd = r + d * gates * hidden * hidden;
+            auto wb = bi + d * 2 * gates * hidden;
+            auto rb = wb + gates * hidden;
+            for (int b = 0; b < batch; ++b) {
+                std::vector<float> h(h0 + (d * batch + b) * hidden, h0 + (d * batch + b + 1) * hidden);
+                std::vector<float> newH(hidden);
+                for (int s = 0; s < seq; ++s) {
+                    int t   = d == 0 ? s : seq - 1 - s;
+                    auto xt = x + (t * batch + b) * inputSize;
+                    auto dot = [](const float* a, const float* v, int length) {
+                        float sum = 0.0f;
+                        for (int k = 0; k < length; ++k) {
+                            sum += a[k] * v[k];
+                        }
+                        return sum;
+                    };
+                    std::vector<float> z(hidden), rt(hidden);
+                    for (int j = 0; j < hidden; ++j) {
+                        z[j]  = _sigmoid(dot(wd + j * inputSize, xt, inputSize) + dot(rd + j * hidden, h.data(), hidden) + wb[j] + rb[j]);
+                        rt[j] = _sigmoid(dot(wd + (hidden + j) * inputSize, xt, inputSize) + dot(rd + (hidden + j) * hidden, h.data(), hidden) + wb[hidden + j] + rb[hidden + j]);
+                    }
+                    for (int j = 0; j < hidden; ++j) {
+                        float c = dot(wd + (2 * hidden + j) * inputSize, xt, inputSize) + wb[2 * hidden + j];
+                        auto rh = rd + (2 * hidden + j) * hidden;
+                        if (linearBeforeReset) {
+                            c += rt[j] * (dot(rh, h.data(), hidden) + rb[2 * hidden + j]);
+                        } else {
+                            for (int k = 0; k < hidden; ++k) {
+                                c += rt[k] * h[k] * rh[k];
+                            }
+                            c += rb[2 * hidden + j];
+                        }
+                        newH[j] = (1.0f - z[j]) * tanhf(c) + z[j] * h[j];
+                    }
+                    h = newH;
+                    if (!checkVectorByRelativeError<float>(y + (t * numDirections + d) * batch * hidden + b * hidden, h.data(), hidden, 0.001 * errorScale)) {
+                        MNN_ERROR("Y error at step %d, direction %d, batch %d\n", t, d, b);
+                        return false;
+                    }
+                }
+                if (!checkVectorByRelativeError<float>(yh + (d * batch + b) * hidden, h.data(), hidden, 0.001 * errorScale)) {
+                    MNN_ERROR("Y_h error at direction %d, batch %d\n", d, b);
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+};
+
+MNNTestSuiteRegister(SequenceGRUMultiThreadTest, "op/rnn/SequenceGRUMultiThread");
@@ -0,0 +1,118 @@
+//
+//  WeightQuantConvTest.cpp
+//  MNNTests
+//
+//  Created by MNN on 2021/12/20.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <MNN/expr/Executor.hpp>
+#include <MNN/expr/ExecutorScope.hpp>
+#include <MNN/expr/ExprCreator.hpp>
+#include <math.h>
+#include "MNNTestSuite.h"
+#include "MNN_generated.h"
+
+using namespace MNN;
+using namespace MNN::Express;
+
+// 1x1 Convolution with weight only quant (IDSTQuan type 4), run in Memory_Low mode to keep the int8 / int4 weight
+class WeightQuantConvTest : public MNNTestCase {
+public:
+    virtual ~WeightQuantConvTest() = default;
+    virtual bool run(int precision) {
+        BackendConfig config;
+        config.memory = BackendConfig::Memory_Low;
+        auto exe      = Executor::newExecutor(MNN_FORWARD_CPU, config, 2);
+        ExecutorScope scope(exe);
+        for (int bits : {8, 4}) {
+            for (bool asymmetric : {false, true}) {
+                for (bool relu : {false, true}) {
+                    if (!_test(bits, asymmetric, relu)) {
+                        MNN_ERROR("Weight quant conv test failed: bits = %d, asymmetric = %d, relu = %d\n", bits, asymmetric, relu);
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+private:
+    bool _test(int bits, bool asymmetric, bool relu) {
+        const int batch = 2, ic = 67, oc = 37, h = 3, w = 5;
+        int qMin = bits == 8 ? -128 : -8;
+        int qMax = bits == 8 ? 127 : 7;
+        std::vector<int8_t> quant(oc * ic);
+        for (int i = 0; i < quant.size(); ++i) {
+            quant[i] = (int8_t)(qMin + (i * 7 + i / ic) % (qMax - qMin + 1));
+        }
+        std::vector<float> alpha;
+        for (int o = 0; o < oc; ++o) {
+            if (asymmetric) {
+                alpha.emplace_back(-0.3f + 0.01f * (o % 5));
+            }
+            alpha.emplace_back((0.5f + (o % 3)) / (float)(qMax - qMin));
+        }
+        std::vector<float> bias(oc);
+        for (int o = 0; o < oc; ++o) {
+            bias[o] = 0.1f * (o % 4) - 0.15f;
+        }
+        std::unique_ptr<OpT> convOp(new OpT);
+        convOp->type       = OpType_Convolution;
+        convOp->main.type  = OpParameter_Convolution2D;
+        convOp->main.value = new Convolution2DT;
+        auto conv2D        = convOp->main.AsConvolution2D();
+        conv2D->common.reset(new Convolution2DCommonT);
+        conv2D->common->outputCount = oc;
+        conv2D->common->inputCount  = ic;
+        conv2D->common->relu        = relu;
+        conv2D->bias                = bias;
+        conv2D->quanParameter.reset(new IDSTQuanT);
+        auto quan        = conv2D->quanParameter.get();
+        quan->type       = 4;
+        quan->buffer     = quant;
+        quan->alpha      = alpha;
+        quan->quantScale = 1.0f;
+        if (asymmetric) {
+            quan->readType = oc;
+            quan->aMin     = qMin;
+        }
+
+        auto x   = _Input({batch, ic, h, w}, NCHW, halide_type_of<float>());
+        auto ptr = x->writeMap<float>();
+        for (int i = 0; i < batch * ic * h * w; ++i) {
+            ptr[i] = (float)(i % 17) * 0.1f - 0.8f;
+        }
+        auto y      = Variable::create(Expr::create(convOp.get(), {_Convert(x, NC4HW4)}));
+        y           = _Convert(y, NCHW);
+        auto output = y->readMap<float>();
+        if (nullptr == output) {
+            return false;
+        }
+        auto input = x->readMap<float>();
+        for (int b = 0; b < batch; ++b) {
+            for (int o = 0; o < oc; ++o) {
+                float scale  = asymmetric ? alpha[2 * o + 1] : alpha[o];
+                float offset = asymmetric ? alpha[2 * o] - (float)qMin * scale : 0.0f;
+                for (int p = 0; p < h * w; ++p) {
+                    float expect = bias[o];
+                    for (int c = 0; c < ic; ++c) {
+                        float weight = quant[o * ic + c] * scale + offset;
+                        expect += weight * input[(b * ic + c) * h * w + p];
+                    }
+                    if (relu) {
+                        expect = fmaxf(expect, 0.0f);
+                    }
+                    float result = output[(b * oc + o) * h * w + p];
+                    if (fabsf(result - expect) > 1e-3f * fmaxf(1.0f, fabsf(expect))) {
+                        MNN_ERROR("%d, %d, %d: %f - %f\n", b, o, p, result, expect);
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(WeightQuantConvTest, "op/weight_quant_conv");
@@ -0,0 +1,101 @@
+//
+//  BatchModuleSpeed.cpp
+//  MNNTests
+//
+//  Created by MNN on 2021/12/13.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <MNN/expr/Module.hpp>
+#include <MNN/expr/ExprCreator.hpp>
+#include <string.h>
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#include "MNNTestSuite.h"
+using namespace MNN::Express;
+using namespace MNN;
+
+#define CLIENT_NUMBER 8
+#define REQUEST_NUMBER 20
+
+// Compare single-image requests from many clients: one module guarded by lock vs merged by batching module
+class BatchModuleSpeed : public MNNTestCase {
+public:
+    virtual bool run(int precision) {
+        auto x = _Input({1, 3, 32, 32}, NCHW, halide_type_of<float>());
+        x->setName("x");
+        auto y = _Convert(x, NC4HW4);
+        int ic = 3;
+        for (int oc : {16, 32, 64}) {
+            std::vector<float> weight(oc * ic * 3 * 3, 0.01f);
+            std::vector<float> bias(oc, 0.0f);
+            y  = _Relu(_Conv(std::move(weight), std::move(bias), y, {ic, oc}, {3, 3}, SAME, {2, 2}));
+            ic = oc;
+        }
+        y = _ReduceMean(_Convert(y, NCHW), {2, 3});
+        y->setName("y");
+        auto buffer = Variable::save({y});
+        std::shared_ptr<Module> origin(Module::load({"x"}, {"y"}, (const uint8_t*)buffer.data(), buffer.size()), Module::destroy);
+        if (nullptr == origin) {
+            return false;
+        }
+        std::mutex lock;
+        auto runLocked = [&lock, origin](VARP input) {
+            std::lock_guard<std::mutex> _l(lock);
+            auto output = origin->onForward({input})[0];
+            // Copy out before unlock, next forward may reuse the memory
+            auto info   = output->getInfo();
+            auto result = _Input(info->dim, info->order, info->type);
+            ::memcpy(result->writeMap<float>(), output->readMap<float>(), info->size * sizeof(float));
+            return result;
+        };
+        _benchmark("Lock", runLocked);
+        for (int maxBatch : {4, 8}) {
+            Module::BatchConfig config;
+            config.maxBatch  = maxBatch;
+            config.maxWaitUs = 2000;
+            std::shared_ptr<Module> batching(Module::createBatching(origin, config), Module::destroy);
+            auto runBatching = [batching](VARP input) {
+                return batching->onForward({input})[0];
+            };
+            _benchmark(std::string("Batching ") + std::to_string(maxBatch), runBatching);
+        }
+        return true;
+    }
+
+private:
+    void _benchmark(const std::string& name, std::function<VARP(VARP)> function) {
+        std::vector<std::vector<float>> costs(CLIENT_NUMBER);
+        std::vector<std::thread> threads;
+        auto timeBegin = getTimeInUs();
+        for (int c = 0; c < CLIENT_NUMBER; ++c) {
+            threads.emplace_back([c, &costs, &function]() {
+                for (int r = 0; r < REQUEST_NUMBER; ++r) {
+                    auto input = _Input({1, 3, 32, 32}, NCHW, halide_type_of<float>());
+                    auto ptr   = input->writeMap<float>();
+                    for (int i = 0; i < 3 * 32 * 32; ++i) {
+                        ptr[i] = (float)((i + c) % 255) / 255.0f;
+                    }
+                    auto t0 = getTimeInUs();
+                    function(input)->readMap<float>();
+                    costs[c].emplace_back((float)(getTimeInUs() - t0) / 1000.0f);
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        auto totalCost = (float)(getTimeInUs() - timeBegin) / 1000.0f;
+        std::vector<float> allCosts;
+        for (auto& c : costs) {
+            allCosts.insert(allCosts.end(), c.begin(), c.end());
+        }
+        std::sort(allCosts.begin(), allCosts.end());
+        auto p50 = allCosts[allCosts.size() / 2];
+        auto p99 = allCosts[std::min(allCosts.size() - 1, allCosts.size() * 99 / 100)];
+        MNN_PRINT("%s: latency p50 %.3f ms, p99 %.3f ms, throughput %.2f req/s\n", name.c_str(), p50, p99,
+                  (float)allCosts.size() * 1000.0f / totalCost);
+    }
+};
+MNNTestSuiteRegister(BatchModuleSpeed, "speed/BatchModule");
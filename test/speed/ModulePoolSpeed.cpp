@@ -0,0 +1,93 @@
+//
+//  ModulePoolSpeed.cpp
+//  MNNTests
+//
+//  Created by MNN on 2021/12/18.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <MNN/expr/Module.hpp>
+#include <MNN/expr/ExprCreator.hpp>
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#include "MNNTestSuite.h"
+using namespace MNN::Express;
+using namespace MNN;
+
+#define REQUEST_NUMBER 20
+
+// Latency of requests from many clients: one module guarded by lock vs a pool of instances sharing weights
+class ModulePoolSpeed : public MNNTestCase {
+public:
+    virtual bool run(int precision) {
+        auto x = _Input({1, 3, 64, 64}, NCHW, halide_type_of<float>());
+        x->setName("x");
+        auto y = _Convert(x, NC4HW4);
+        int ic = 3;
+        for (int oc : {16, 32, 64}) {
+            std::vector<float> weight(oc * ic * 3 * 3, 0.01f);
+            std::vector<float> bias(oc, 0.0f);
+            y  = _Relu(_Conv(std::move(weight), std::move(bias), y, {ic, oc}, {3, 3}, SAME, {2, 2}));
+            ic = oc;
+        }
+        y = _ReduceMean(_Convert(y, NCHW), {2, 3});
+        y->setName("y");
+        auto buffer = Variable::save({y});
+        std::shared_ptr<Module> origin(Module::load({"x"}, {"y"}, (const uint8_t*)buffer.data(), buffer.size()), Module::destroy);
+        if (nullptr == origin) {
+            return false;
+        }
+        std::shared_ptr<Module> single(Module::load({"x"}, {"y"}, (const uint8_t*)buffer.data(), buffer.size()), Module::destroy);
+        for (int clientNumber : {1, 2, 4, 8}) {
+            std::mutex lock;
+            _benchmark("Lock", clientNumber, [&lock, single](VARP input) {
+                std::lock_guard<std::mutex> _l(lock);
+                single->onForward({input})[0]->readMap<float>();
+            });
+            ModulePool::Config config;
+            config.maxInstance = clientNumber;
+            std::shared_ptr<ModulePool> pool(ModulePool::create(origin, config), ModulePool::destroy);
+            _benchmark("Pool", clientNumber, [pool](VARP input) {
+                auto instance = pool->acquire();
+                instance->onForward({input})[0]->readMap<float>();
+            });
+        }
+        return true;
+    }
+
+private:
+    void _benchmark(const char* name, int clientNumber, std::function<void(VARP)> function) {
+        std::vector<std::vector<float>> costs(clientNumber);
+        std::vector<std::thread> threads;
+        auto timeBegin = getTimeInUs();
+        for (int c = 0; c < clientNumber; ++c) {
+            threads.emplace_back([c, &costs, &function]() {
+                for (int r = 0; r < REQUEST_NUMBER; ++r) {
+                    auto input = _Input({1, 3, 64, 64}, NCHW, halide_type_of<float>());
+                    auto ptr   = input->writeMap<float>();
+                    for (int i = 0; i < 3 * 64 * 64; ++i) {
+                        ptr[i] = (float)((i + c) % 255) / 255.0f;
+                    }
+                    auto t0 = getTimeInUs();
+                    function(input);
+                    costs[c].emplace_back((float)(getTimeInUs() - t0) / 1000.0f);
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        auto totalCost = (float)(getTimeInUs() - timeBegin) / 1000.0f;
+        std::vector<float> allCosts;
+        for (auto& c : costs) {
+            allCosts.insert(allCosts.end(), c.begin(), c.end());
+        }
+        std::sort(allCosts.begin(), allCosts.end());
+        auto p50 = allCosts[allCosts.size() / 2];
+        auto p99 = allCosts[std::min(allCosts.size() - 1, allCosts.size() * 99 / 100)];
+        MNN_PRINT("%s, clients %d: latency p50 %.3f ms, p99 %.3f ms, throughput %.2f req/s\n", name, clientNumber, p50,
+                  p99, (float)allCosts.size() * 1000.0f / totalCost);
+    }
+};
+MNNTestSuiteRegister(ModulePoolSpeed, "speed/ModulePool");
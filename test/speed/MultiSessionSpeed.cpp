@@ -0,0 +1,77 @@
+//
+//  MultiSessionSpeed.cpp
+//  MNNTests
+//
+//  Created by MNN on 2021/12/06.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <MNN/Interpreter.hpp>
+#include <MNN/expr/ExprCreator.hpp>
+#include <thread>
+#include "MNNTestSuite.h"
+#include "MNN_generated.h"
+using namespace MNN::Express;
+using namespace MNN;
+
+#define SESSION_THREAD 4
+#define RUN_TIME 10
+
+// Measure throughput of many sessions sharing one process and one cpu thread pool
+class MultiSessionSpeed : public MNNTestCase {
+public:
+    virtual bool run(int precision) {
+        auto x = _Input({1, 16, 56, 56}, NC4HW4, halide_type_of<float>());
+        auto y = x;
+        for (int i = 0; i < 4; ++i) {
+            std::vector<float> weight(16 * 16 * 3 * 3, 0.01f);
+            std::vector<float> bias(16, 0.0f);
+            y = _Conv(std::move(weight), std::move(bias), y, {16, 16}, {3, 3}, SAME);
+            y = _Relu(y);
+        }
+        std::unique_ptr<MNN::NetT> net(new NetT);
+        Variable::save({y}, net.get());
+        flatbuffers::FlatBufferBuilder builderOutput(1024);
+        auto len = MNN::Net::Pack(builderOutput, net.get());
+        builderOutput.Finish(len);
+        int sizeOutput    = builderOutput.GetSize();
+        auto bufferOutput = builderOutput.GetBufferPointer();
+        for (int sessionNumber : {1, 2, 4, 8, 16}) {
+            ScheduleConfig config;
+            config.numThread = SESSION_THREAD;
+            // Interpreter::runSession is serialized per interpreter, so each session use its own one
+            std::vector<std::shared_ptr<Interpreter>> interps;
+            std::vector<Session*> sessions;
+            for (int i = 0; i < sessionNumber; ++i) {
+                std::shared_ptr<Interpreter> interp(Interpreter::createFromBuffer(bufferOutput, sizeOutput));
+                if (nullptr == interp) {
+                    return false;
+                }
+                sessions.emplace_back(interp->createSession(config));
+                interps.emplace_back(interp);
+            }
+            std::vector<std::thread> threads;
+            auto timeBegin = getTimeInUs();
+            for (int i = 0; i < sessionNumber; ++i) {
+                auto session = sessions[i];
+                auto interp  = interps[i];
+                threads.emplace_back([session, interp]() {
+                    for (int t = 0; t < RUN_TIME; ++t) {
+                        interp->runSession(session);
+                    }
+                });
+            }
+            for (auto& t : threads) {
+                t.join();
+            }
+            auto timeCost = (float)(getTimeInUs() - timeBegin) / 1000.0f;
+            MNN_PRINT("Sessions: %d, total %.3f ms, throughput %.2f runs/s\n", sessionNumber, timeCost,
+                      (float)(sessionNumber * RUN_TIME) * 1000.0f / timeCost);
+            for (int i = 0; i < sessionNumber; ++i) {
+                interps[i]->releaseSession(sessions[i]);
+            }
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(MultiSessionSpeed, "speed/MultiSession");
@@ -12,48 +12,45 @@
 #include "core/TensorUtils.hpp"
 #include "core/Execution.hpp"
 #include "core/Backend.hpp"
-#define MNN_OPEN_TIME_TRACE
-#include <MNN/AutoTime.hpp>
 #include "MNNTestSuite.h"
 using namespace MNN;
 #define CHANNEL 32
 #define HEIGHT 64
 #define WIDTH 128
 #define TIME 100
+typedef Tensor::InsideDescribe::Region RasterRegion;
 class RasterSpeed : public MNNTestCase {
 public:
-    void RasterTranspose_102(std::unique_ptr<Execution>& exe, std::vector<Tensor*>& inputs, std::vector<Tensor*>& outputs) {
-        AUTOTIME;
-        for (int i = 0; i < TIME; i++) {
-            exe->onExecute(inputs, outputs);
+    static RasterRegion _makeRegion(std::vector<int> size, std::vector<int> srcStride, std::vector<int> dstStride, int srcOffset = 0, int dstOffset = 0) {
+        RasterRegion region;
+        for (int i = 0; i < 3; ++i) {
+            region.size[i]       = size[i];
+            region.src.stride[i] = srcStride[i];
+            region.dst.stride[i] = dstStride[i];
         }
+        region.src.offset = srcOffset;
+        region.dst.offset = dstOffset;
+        return region;
     }
-    void RasterTranspose_021(std::unique_ptr<Execution>& exe, std::vector<Tensor*>& inputs, std::vector<Tensor*>& outputs) {
-        AUTOTIME;
-        for (int i = 0; i < TIME; i++) {
-            exe->onExecute(inputs, outputs);
+    void _benchmark(const char* name, int numberThread, Backend* backend, const Op* op, Tensor* input, Tensor* middle, Tensor* output, const std::vector<RasterRegion>& regions) {
+        auto& dstRegions = TensorUtils::getDescribe(middle)->regions;
+        dstRegions       = regions;
+        for (auto& r : dstRegions) {
+            r.origin = input;
         }
-    }
-    void RasterTranspose_210(std::unique_ptr<Execution>& exe, std::vector<Tensor*>& inputs, std::vector<Tensor*>& outputs) {
-        AUTOTIME;
+        std::vector<Tensor*> ins = {middle}, outs = {output};
+        std::unique_ptr<Execution> exe(backend->onCreate(ins, outs, op));
+        exe->onResize(ins, outs);
+        // Warm up
+        exe->onExecute(ins, outs);
+        auto t0 = getTimeInUs();
         for (int i = 0; i < TIME; i++) {
-            exe->onExecute(inputs, outputs);
+            exe->onExecute(ins, outs);
         }
+        auto cost = (float)(getTimeInUs() - t0) / 1000.0f / TIME;
+        MNN_PRINT("%s, thread %d, region %d: %f ms\n", name, numberThread, (int)regions.size(), cost);
     }
     virtual bool run(int precision) {
-        // prepare CPU backend
-        ScheduleConfig config;
-        config.type = MNN_FORWARD_CPU;
-        BackendConfig backendConfig;
-        backendConfig.precision = BackendConfig::Precision_High;
-        config.backendConfig = &backendConfig;
-        Backend::Info compute;
-        compute.type = config.type;
-        compute.numThread = config.numThread;
-        compute.user = config.backendConfig;
-        const RuntimeCreator* runtimeCreator(MNNGetExtraRuntimeCreator(compute.type));
-        std::unique_ptr<Runtime> runtime(runtimeCreator->onCreate(compute));
-        std::unique_ptr<Backend> backend(runtime->onCreate());
         // build Op
         std::unique_ptr<OpT> opt(new OpT);
         opt->type = OpType_Raster;
@@ -63,73 +60,76 @@ public:
         builder.Finish(len);
         auto buffer = builder.GetBufferPointer();
         const Op* op = flatbuffers::GetMutableRoot<Op>(buffer);
-        // build Tensors
-        std::unique_ptr<Tensor> tensors[3];
-        for (int i = 0; i < 3; i++) {
-            tensors[i].reset(new Tensor(4, Tensor::CAFFE));
-            auto tensor = tensors[i].get();
-            tensor->setType(DataType_DT_FLOAT);
-            tensor->setLength(0, 1);
-            tensor->setLength(1, CHANNEL);
-            tensor->setLength(2, HEIGHT);
-            tensor->setLength(3, WIDTH);
-            if (i == 1) {
-                auto des = TensorUtils::getDescribe(tensor);
-                des->memoryType = Tensor::InsideDescribe::MEMORY_VIRTUAL;
-                Tensor::InsideDescribe::Region region;
-                region.origin = tensors[0].get();
-                des->regions.push_back(region);
-            } else {
-                backend->onAcquireBuffer(tensor, Backend::STATIC);
-                TensorUtils::getDescribe(tensor)->backend = backend.get();
+        for (int numberThread : {1, 4}) {
+            // prepare CPU backend
+            ScheduleConfig config;
+            config.type = MNN_FORWARD_CPU;
+            config.numThread = numberThread;
+            BackendConfig backendConfig;
+            backendConfig.precision = BackendConfig::Precision_High;
+            config.backendConfig = &backendConfig;
+            Backend::Info compute;
+            compute.type = config.type;
+            compute.numThread = config.numThread;
+            compute.user = config.backendConfig;
+            const RuntimeCreator* runtimeCreator(MNNGetExtraRuntimeCreator(compute.type));
+            std::unique_ptr<Runtime> runtime(runtimeCreator->onCreate(compute));
+            std::unique_ptr<Backend> backend(runtime->onCreate());
+            // build Tensors
+            std::unique_ptr<Tensor> tensors[3];
+            for (int i = 0; i < 3; i++) {
+                tensors[i].reset(new Tensor(4, Tensor::CAFFE));
+                auto tensor = tensors[i].get();
+                tensor->setType(DataType_DT_FLOAT);
+                tensor->setLength(0, 1);
+                tensor->setLength(1, CHANNEL);
+                tensor->setLength(2, HEIGHT);
+                tensor->setLength(3, WIDTH);
+                if (i == 1) {
+                    TensorUtils::getDescribe(tensor)->memoryType = Tensor::InsideDescribe::MEMORY_VIRTUAL;
+                } else {
+                    backend->onAcquireBuffer(tensor, Backend::STATIC);
+                    TensorUtils::getDescribe(tensor)->backend = backend.get();
+                }
+            }
+            auto input  = tensors[0].get();
+            auto middle = tensors[1].get();
+            auto output = tensors[2].get();
+            const int area = HEIGHT * WIDTH;
+            _benchmark("RasterTranspose_102", numberThread, backend.get(), op, input, middle, output,
+                       {_makeRegion({HEIGHT, CHANNEL, WIDTH}, {WIDTH, area, 1}, {CHANNEL * WIDTH, WIDTH, 1})});
+            _benchmark("RasterTranspose_021", numberThread, backend.get(), op, input, middle, output,
+                       {_makeRegion({CHANNEL, WIDTH, HEIGHT}, {area, 1, WIDTH}, {area, HEIGHT, 1})});
+            _benchmark("RasterTranspose_210", numberThread, backend.get(), op, input, middle, output,
+                       {_makeRegion({WIDTH, HEIGHT, CHANNEL}, {1, WIDTH, area}, {HEIGHT * CHANNEL, CHANNEL, 1})});
+            // NCHW -> NHWC and NHWC -> NCHW
+            _benchmark("RasterNCHW2NHWC", numberThread, backend.get(), op, input, middle, output,
+                       {_makeRegion({1, area, CHANNEL}, {0, 1, area}, {0, CHANNEL, 1})});
+            _benchmark("RasterNHWC2NCHW", numberThread, backend.get(), op, input, middle, output,
+                       {_makeRegion({1, CHANNEL, area}, {0, 1, CHANNEL}, {0, area, 1})});
+            // 2D transpose
+            _benchmark("RasterTranspose2D", numberThread, backend.get(), op, input, middle, output,
+                       {_makeRegion({1, CHANNEL * HEIGHT, WIDTH}, {0, 1, CHANNEL * HEIGHT}, {0, WIDTH, 1})});
+            // Concat like: one region for each channel, can be coalesced
+            {
+                std::vector<RasterRegion> regions;
+                for (int c = 0; c < CHANNEL; ++c) {
+                    regions.emplace_back(_makeRegion({1, HEIGHT, WIDTH}, {0, WIDTH, 1}, {0, WIDTH, 1}, c * area, (CHANNEL - 1 - c) * area));
+                }
+                _benchmark("RasterMultiRegion", numberThread, backend.get(), op, input, middle, output, regions);
+            }
+            // Different size regions, need balance for threads
+            {
+                std::vector<RasterRegion> regions;
+                int offset = 0;
+                for (int c = 0; c < 8; ++c) {
+                    int channel = (c == 0) ? (CHANNEL - 7) : 1;
+                    regions.emplace_back(_makeRegion({channel, WIDTH, HEIGHT}, {area, 1, WIDTH}, {area, HEIGHT, 1}, offset * area, offset * area));
+                    offset += channel;
+                }
+                _benchmark("RasterUnbalanceRegion", numberThread, backend.get(), op, input, middle, output, regions);
             }
         }
-        auto middle = tensors[1].get();
-        auto& region = TensorUtils::getDescribe(middle)->regions[0];
-        std::vector<Tensor*> ins = {middle}, outs = {tensors[2].get()};
-        std::unique_ptr<Execution> exe(backend->onCreate(ins, outs, op));
-        // transpose(1, 0, 2)
-        region.size[0] = HEIGHT;
-        region.size[1] = CHANNEL;
-        region.size[2] = WIDTH;
-        region.src.offset = 0;
-        region.src.stride[0] = WIDTH;
-        region.src.stride[1] = HEIGHT * WIDTH;
-        region.src.stride[2] = 1;
-        region.dst.offset = 0;
-        region.dst.stride[0] = CHANNEL * WIDTH;
-        region.dst.stride[1] = WIDTH;
-        region.dst.stride[2] = 1;
-        exe->onResize(ins, outs);
-        RasterTranspose_102(exe, ins, outs);
-        // transpose(0, 2, 1)
-        region.size[0] = CHANNEL;
-        region.size[1] = WIDTH;
-        region.size[2] = HEIGHT;
-        region.src.offset = 0;
-        region.src.stride[0] = HEIGHT * WIDTH;
-        region.src.stride[1] = 1;
-        region.src.stride[2] = WIDTH;
-        region.dst.offset = 0;
-        region.dst.stride[0] = HEIGHT * WIDTH;
-        region.dst.stride[1] = HEIGHT;
-        region.dst.stride[2] = 1;
-        exe->onResize(ins, outs);
-        RasterTranspose_021(exe, ins, outs);
-        // transpose(2, 1, 0)
-        region.size[0] = WIDTH;
-        region.size[1] = HEIGHT;
-        region.size[2] = CHANNEL;
-        region.src.offset = 0;
-        region.src.stride[0] = 1;
-        region.src.stride[1] = WIDTH;
-        region.src.stride[2] = HEIGHT * WIDTH;
-        region.dst.offset = 0;
-        region.dst.stride[0] = HEIGHT * CHANNEL;
-        region.dst.stride[1] = CHANNEL;
-        region.dst.stride[2] = 1;
-        exe->onResize(ins, outs);
-        RasterTranspose_210(exe, ins, outs);
         return true;
     }
 };
@@ -0,0 +1,127 @@
+//
+//  StateModuleSpeed.cpp
+//  MNNTests
+//
+//  Created by MNN on 2021/12/22.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <MNN/expr/Module.hpp>
+#include <MNN/expr/ExprCreator.hpp>
+#include <math.h>
+#include <string.h>
+#include "MNNTestSuite.h"
+using namespace MNN::Express;
+using namespace MNN;
+
+#define HIDDEN 256
+#define LAYER_NUMBER 4
+#define TOKEN_NUMBER 512
+
+// Incremental decoder of single head attention layers, the key / value caches are [seq, hidden].
+// If fullPresent is true, the outputs are the concated caches which are fed back in next step, otherwise only the
+// key / value of the new token are output for the stateful module.
+static std::vector<int8_t> _saveDecoder(bool fullPresent, std::vector<std::string>& inputNames, std::vector<std::string>& outputNames) {
+    auto x = _Input({-1, HIDDEN}, NCHW, halide_type_of<float>());
+    x->setName("x");
+    inputNames  = {"x"};
+    outputNames = {"y"};
+    std::vector<VARP> outputs;
+    for (int l = 0; l < LAYER_NUMBER; ++l) {
+        auto pastK = _Input({-1, HIDDEN}, NCHW, halide_type_of<float>());
+        auto pastV = _Input({-1, HIDDEN}, NCHW, halide_type_of<float>());
+        pastK->setName("past_k" + std::to_string(l));
+        pastV->setName("past_v" + std::to_string(l));
+        inputNames.emplace_back(pastK->name());
+        inputNames.emplace_back(pastV->name());
+        std::vector<VARP> weights;
+        for (int w = 0; w < 3; ++w) {
+            std::vector<float> weight(HIDDEN * HIDDEN);
+            for (int i = 0; i < weight.size(); ++i) {
+                weight[i] = (float)((i * (w + l + 3)) % 13) * 0.002f - 0.012f;
+            }
+            weights.emplace_back(_Const(weight.data(), {HIDDEN, HIDDEN}, NCHW));
+        }
+        auto q    = _MatMul(x, weights[0]);
+        auto newK = _MatMul(x, weights[1]);
+        auto newV = _MatMul(x, weights[2]);
+        auto k    = _Concat({pastK, newK}, 0);
+        auto v    = _Concat({pastV, newV}, 0);
+        auto s    = _Softmax(_MatMul(q, k, false, true) * _Scalar<float>(1.0f / sqrtf((float)HIDDEN)), -1);
+        x         = _MatMul(s, v) + x;
+        auto presentK = fullPresent ? k : newK;
+        auto presentV = fullPresent ? v : newV;
+        presentK->setName("present_k" + std::to_string(l));
+        presentV->setName("present_v" + std::to_string(l));
+        outputNames.emplace_back(presentK->name());
+        outputNames.emplace_back(presentV->name());
+        outputs.emplace_back(presentK);
+        outputs.emplace_back(presentV);
+    }
+    x->setName("y");
+    outputs.insert(outputs.begin(), x);
+    return Variable::save(outputs);
+}
+
+static VARP _token(int t) {
+    auto x   = _Input({1, HIDDEN}, NCHW, halide_type_of<float>());
+    auto ptr = x->writeMap<float>();
+    for (int i = 0; i < HIDDEN; ++i) {
+        ptr[i] = (float)((t * 7 + i) % 17) * 0.05f - 0.4f;
+    }
+    return x;
+}
+
+// Tokens per second of feeding the caches back as inputs vs keeping them in a stateful module
+class StateModuleSpeed : public MNNTestCase {
+public:
+    virtual bool run(int precision) {
+        std::vector<std::string> inputNames, outputNames;
+        {
+            auto buffer = _saveDecoder(true, inputNames, outputNames);
+            std::shared_ptr<Module> module(Module::load(inputNames, outputNames, (const uint8_t*)buffer.data(), buffer.size()), Module::destroy);
+            std::vector<VARP> caches;
+            for (int l = 0; l < LAYER_NUMBER; ++l) {
+                caches.emplace_back(_Input({0, HIDDEN}, NCHW, halide_type_of<float>()));
+                caches.emplace_back(_Input({0, HIDDEN}, NCHW, halide_type_of<float>()));
+            }
+            auto timeBegin = getTimeInUs();
+            for (int t = 0; t < TOKEN_NUMBER; ++t) {
+                std::vector<VARP> inputs = {_token(t)};
+                inputs.insert(inputs.end(), caches.begin(), caches.end());
+                auto outputs = module->onForward(inputs);
+                outputs[0]->readMap<float>();
+                // The outputs may share memory with the module, copy them before next forward
+                for (int i = 0; i < caches.size(); ++i) {
+                    auto info = outputs[i + 1]->getInfo();
+                    caches[i] = _Input(info->dim, info->order, info->type);
+                    ::memcpy(caches[i]->writeMap<float>(), outputs[i + 1]->readMap<float>(), info->size * sizeof(float));
+                }
+            }
+            auto cost = (float)(getTimeInUs() - timeBegin) / 1000.0f;
+            MNN_PRINT("Feed back caches: %d tokens, %.3f ms, %.2f tokens/s\n", TOKEN_NUMBER, cost, (float)TOKEN_NUMBER * 1000.0f / cost);
+        }
+        {
+            auto buffer = _saveDecoder(false, inputNames, outputNames);
+            std::shared_ptr<Module> origin(Module::load(inputNames, outputNames, (const uint8_t*)buffer.data(), buffer.size()), Module::destroy);
+            Module::StateConfig config;
+            config.states.resize(2 * LAYER_NUMBER);
+            for (int i = 0; i < config.states.size(); ++i) {
+                config.states[i].input  = inputNames[i + 1];
+                config.states[i].output = outputNames[i + 1];
+            }
+            std::shared_ptr<Module> module(Module::createStateful(origin, config), Module::destroy);
+            if (nullptr == module) {
+                return false;
+            }
+            auto timeBegin = getTimeInUs();
+            for (int t = 0; t < TOKEN_NUMBER; ++t) {
+                module->onForward({_token(t)})[0]->readMap<float>();
+            }
+            auto cost = (float)(getTimeInUs() - timeBegin) / 1000.0f;
+            MNN_PRINT("Stateful module: %d tokens, %.3f ms, %.2f tokens/s\n", TOKEN_NUMBER, cost, (float)TOKEN_NUMBER * 1000.0f / cost);
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(StateModuleSpeed, "speed/StateModule");
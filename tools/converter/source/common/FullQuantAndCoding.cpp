@@ -14,10 +14,35 @@
 using namespace MNN;
 using namespace MNN::Express;
 
+// Ops without weight which have int8 kernels, only the quant info of their input and output is needed
+static bool _isFullQuantActivation(const MNN::OpT* op) {
+    switch (op->type) {
+        case MNN::OpType_LayerNorm:
+        case MNN::OpType_Softmax:
+            return true;
+        case MNN::OpType_UnaryOp:
+            // The same unary ops as _supportQuant in core/Pipeline.cpp, they are computed by a table
+            switch (op->main.AsUnaryOp()->opType) {
+                case MNN::UnaryOpOperation_GELU:
+                case MNN::UnaryOpOperation_GELU_STANDARD:
+                case MNN::UnaryOpOperation_SIGMOID:
+                case MNN::UnaryOpOperation_TANH:
+                case MNN::UnaryOpOperation_HARDSWISH:
+                    return true;
+                default:
+                    return false;
+            }
+        default:
+            break;
+    }
+    return false;
+}
+
 void FullQuantAndCoding(std::unique_ptr<MNN::NetT>& netT, std::unique_ptr<MNN::OpT>& op, Compression::Pipeline& proto, SubGraphProtoT* subgraph) {
     std::string outputTensorName = subgraph ? subgraph->tensors[op->outputIndexes[0]] : netT->tensorName[op->outputIndexes[0]];;
     auto opType = op->type;
-    if (opType != MNN::OpType_Convolution && opType != MNN::OpType_ConvolutionDepthwise) {
+    bool isActivation = _isFullQuantActivation(op.get());
+    if (opType != MNN::OpType_Convolution && opType != MNN::OpType_ConvolutionDepthwise && !isActivation) {
         return;
     }
     if (op->inputIndexes.size() != 1) {
@@ -43,13 +68,16 @@ void FullQuantAndCoding(std::unique_ptr<MNN::NetT>& netT, std::unique_ptr<MNN::O
     auto inputIndex = op->inputIndexes[0];
     int outputIndex = op->outputIndexes[0];
     auto quantParams = findQuantParameters(proto, outputTensorName);
-    if (quantParams.weight_size() == 0) {
+    if (isActivation) {
+        if (quantParams.input_size() == 0 || quantParams.output_size() == 0) {
+            return;
+        }
+    } else if (quantParams.weight_size() == 0) {
         return;
     }
 
     auto inputParams = quantParams.input(0);
     auto outputParams = quantParams.output(0);
-    auto weightParams = quantParams.weight(0);
     auto& tensorDescribe = subgraph ? subgraph->extraTensorDescribe : netT->extraTensorDescribe;
 
     auto findInDescribe = [&] (int index) {
@@ -86,7 +114,11 @@ void FullQuantAndCoding(std::unique_ptr<MNN::NetT>& netT, std::unique_ptr<MNN::O
         outDescribe->quantInfo = std::move(outputQuantInfo);
         tensorDescribe.emplace_back(std::move(outDescribe));
     }
+    if (isActivation) {
+        return;
+    }
 
+    auto weightParams = quantParams.weight(0);
     auto convParams  = op->main.AsConvolution2D();
     auto weightFloat = convParams->weight;
     auto biasFloat   = convParams->bias;
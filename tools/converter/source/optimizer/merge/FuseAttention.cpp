@@ -0,0 +1,195 @@
+//
+//  FuseAttention.cpp
+//  MNNConverter
+//
+//  Created by MNN on 2021/12/10.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include "../TemplateMerge.hpp"
+#include "MNN/expr/ExprCreator.hpp"
+#include "MNN_generated.h"
+#include "MergeHelpers.hpp"
+
+namespace MNN {
+namespace Express {
+
+// softmax(query * key * scale + mask) * value -> Attention
+class FuseAttention {
+public:
+    FuseAttention();
+private:
+    VARP query_;
+    VARP key_;
+    VARP value_;
+    VARP mask_;
+    float scale_        = 1.0f;
+    bool keyTransposed_ = false;
+};
+
+// Return false if expr is not MatMul / BatchMatMul, or transpose the first input
+static bool getMatMulTranspose(EXPRP expr, bool& transposeB) {
+    auto op = expr->get();
+    if (nullptr == op) {
+        return false;
+    }
+    if (op->type() == OpType_MatMul) {
+        auto param = op->main_as_MatMul();
+        if (nullptr == param) {
+            transposeB = false;
+            return true;
+        }
+        transposeB = param->transposeB();
+        return !param->transposeA();
+    }
+    if (op->type() == OpType_BatchMatMul) {
+        auto param = op->main_as_BatchMatMulParam();
+        if (nullptr == param) {
+            transposeB = false;
+            return true;
+        }
+        transposeB = param->adjY();
+        return !param->adjX();
+    }
+    return false;
+}
+
+static bool readScalar(VARP var, float& value) {
+    if (!helpers::IsConstant(var->expr().first)) {
+        return false;
+    }
+    auto info = var->getInfo();
+    if (nullptr == info || info->size != 1 || info->type.code != halide_type_float) {
+        return false;
+    }
+    value = var->readMap<float>()[0];
+    return true;
+}
+
+static bool isBinary(EXPRP expr, int opType) {
+    auto op = expr->get();
+    if (nullptr == op || op->type() != OpType_BinaryOp) {
+        return false;
+    }
+    return op->main_as_BinaryOp()->opType() == opType;
+}
+
+// Batch dimensions must be the same, fused attention don't broadcast them.
+// They must be static, an unknown dimension may be broadcasted at runtime
+static bool sameBatch(VARP a, VARP b) {
+    auto infoA = a->getInfo();
+    auto infoB = b->getInfo();
+    if (nullptr == infoA || nullptr == infoB || infoA->dim.size() != infoB->dim.size() || infoA->dim.size() < 2) {
+        return false;
+    }
+    for (int i = 0; i < (int)infoA->dim.size() - 2; ++i) {
+        if (infoA->dim[i] <= 0 || infoA->dim[i] != infoB->dim[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+FuseAttention::FuseAttention() {
+    auto match = [this](EXPRP expr) -> bool {
+        bool transposeB = false;
+        if (!getMatMulTranspose(expr, transposeB) || transposeB) {
+            return false;
+        }
+        value_ = expr->inputs().at(1);
+        // softmax on the last axis
+        auto z = expr->inputs().at(0)->expr().first;
+        if (nullptr == z->get() || z->get()->type() != OpType_Softmax) {
+            return false;
+        }
+        auto axis = z->get()->main_as_Axis();
+        auto softmaxInput = z->inputs().at(0);
+        if (nullptr != axis && axis->axis() != -1) {
+            auto info = softmaxInput->getInfo();
+            if (nullptr == info || axis->axis() != (int)info->dim.size() - 1) {
+                return false;
+            }
+        }
+        z = softmaxInput->expr().first;
+        // + mask
+        mask_ = nullptr;
+        if (isBinary(z, BinaryOpOperation_ADD)) {
+            auto x = z->inputs().at(0)->expr().first;
+            auto y = z->inputs().at(1)->expr().first;
+            bool transpose = false;
+            if (getMatMulTranspose(x, transpose) || isBinary(x, BinaryOpOperation_MUL) ||
+                isBinary(x, BinaryOpOperation_REALDIV) || isBinary(x, BinaryOpOperation_DIV)) {
+                mask_ = z->inputs().at(1);
+                z     = x;
+            } else {
+                mask_ = z->inputs().at(0);
+                z     = y;
+            }
+            auto maskInfo = mask_->getInfo();
+            if (nullptr == maskInfo || maskInfo->type.code != halide_type_float) {
+                return false;
+            }
+        }
+        // * scale or / scale
+        scale_ = 1.0f;
+        if (isBinary(z, BinaryOpOperation_MUL)) {
+            if (readScalar(z->inputs().at(1), scale_)) {
+                z = z->inputs().at(0)->expr().first;
+            } else if (readScalar(z->inputs().at(0), scale_)) {
+                z = z->inputs().at(1)->expr().first;
+            } else {
+                return false;
+            }
+        } else if (isBinary(z, BinaryOpOperation_REALDIV) || isBinary(z, BinaryOpOperation_DIV)) {
+            float div = 1.0f;
+            if (!readScalar(z->inputs().at(1), div) || 0.0f == div) {
+                return false;
+            }
+            scale_ = 1.0f / div;
+            z      = z->inputs().at(0)->expr().first;
+        }
+        // query * key
+        if (!getMatMulTranspose(z, transposeB)) {
+            return false;
+        }
+        query_         = z->inputs().at(0);
+        key_           = z->inputs().at(1);
+        keyTransposed_ = !transposeB;
+        if (!sameBatch(query_, key_) || !sameBatch(query_, value_)) {
+            return false;
+        }
+        if (nullptr != mask_ && mask_->getInfo()->dim.size() > query_->getInfo()->dim.size()) {
+            return false;
+        }
+        return true;
+    };
+
+    auto fold = [this](EXPRP expr) -> bool {
+        auto config = Global<modelConfig>::Get();
+        if (config->forTraining) {
+            // Attention don't support grad
+            return false;
+        }
+        std::unique_ptr<OpT> attention(new OpT);
+        attention->name       = expr->name();
+        attention->type       = OpType_Attention;
+        attention->main.type  = OpParameter_AttentionParam;
+        attention->main.value = new AttentionParamT;
+        attention->main.AsAttentionParam()->scale         = scale_;
+        attention->main.AsAttentionParam()->keyTransposed = keyTransposed_;
+        std::vector<VARP> inputs = {query_, key_, value_};
+        if (nullptr != mask_) {
+            inputs.emplace_back(mask_);
+        }
+        auto attentionExpr = Expr::create(attention.get(), inputs, 1);
+        attentionExpr->setName(expr->name());
+        Expr::replace(expr, attentionExpr);
+        return true /*modified*/;
+    };
+    TemplateMerge::getInstance("Merge").insertTemplate("FuseAttention", match, fold);
+}
+
+static FuseAttention g_fuse_attention;
+
+} // namespace Express
+} // namespace MNN
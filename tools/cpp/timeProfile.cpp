@@ -80,6 +80,11 @@ int main(int argc, const char* argv[]) {
     if(argc >= 8) {
         sparsity = atof(argv[7]);
     }
+    const char* traceFile = nullptr;
+    if (argc >= 9) {
+        traceFile = argv[8];
+        printf("Write Chrome trace to %s\n", traceFile);
+    }
 
 
     // revert MNN model if necessary
@@ -96,6 +101,9 @@ int main(int argc, const char* argv[]) {
     }
     revertor.reset();
     net->setSessionMode(Interpreter::Session_Debug);
+    if (nullptr != traceFile) {
+        net->setSessionHint(Interpreter::TRACE, 1);
+    }
 
     // create session
     MNN::ScheduleConfig config;
@@ -157,5 +165,8 @@ int main(int argc, const char* argv[]) {
 #endif
     profiler->printSlowOp("Convolution", 20, 0.03f);
     profiler->printTimeByType(runTime);
+    if (nullptr != traceFile) {
+        Interpreter::dumpTrace(traceFile);
+    }
     return 0;
 }
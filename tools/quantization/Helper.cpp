@@ -19,9 +19,12 @@
 #endif
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
+#include <algorithm>
+#include <atomic>
 #include <fstream>
 #include <sstream>
 #include <string>
+#include <thread>
 #include "core/TensorUtils.hpp"
 
 std::set<std::string> Helper::gNotNeedFeatureOp = { "Raster", "Pooling", "ReLU", "ReLU6", "Interp", "CropAndResize", "ROIPooling", "Gather", "GatherV2", "GatherND", "ScatterNd" };
@@ -216,3 +219,20 @@ bool Helper::stringEndWith(std::string const &fullString, std::string const &end
         return false;
     }
 }
+
+void Helper::parallelFor(int size, int threadNumber, const std::function<void(int)>& function) {
+    std::atomic<int> next(0);
+    auto run = [&]() {
+        for (int index = next++; index < size; index = next++) {
+            function(index);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int i = 1; i < std::min(threadNumber, size); ++i) {
+        threads.emplace_back(run);
+    }
+    run();
+    for (auto& t : threads) {
+        t.join();
+    }
+}
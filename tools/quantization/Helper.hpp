@@ -6,6 +6,7 @@
 //  Copyright © 2018, Alibaba Group Holding Limited
 //
 
+#include <functional>
 #include <set>
 #include <string>
 #include <MNN/ImageProcess.hpp>
@@ -41,4 +42,6 @@ public:
                                 const std::string& filename, MNN::Tensor* input, InputType inputType);
     static void invertData(float* dst, const float* src, int size);
     static bool stringEndWith(std::string const &fullString, std::string const &ending);
+    // Call function(index) for index in [0, size) on threadNumber threads, each thread takes the next index when it finishes one
+    static void parallelFor(int size, int threadNumber, const std::function<void(int)>& function);
 };
@@ -12,6 +12,10 @@
 #include <cmath>
 #include <MNN/MNNDefine.h>
 #include "logkit.h"
+#include "Helper.hpp"
+
+// Initial value of the bins, so that the KL-Divergence has no zero divisor
+static const float gDistributionInitValue = 1.0e-07f;
 
 // Given distribution P and Q, KL-Divergence is
 // Sum(P[i] * log(P[i] / Q[i]))
@@ -87,7 +91,7 @@ void TensorStatistic::resetDistribution() {
     if (mValid) {
         mInterval = (float)mBinNumber / maxValue;
     }
-    std::fill(mDistribution.begin(), mDistribution.end(), 1.0e-07);
+    std::fill(mDistribution.begin(), mDistribution.end(), gDistributionInitValue);
     // MNN_PRINT("==> %s max: %f\n", mName.c_str(),std::max(fabsf(mRangePerChannel[0].second),
     // fabsf(mRangePerChannel[0].first)));
 }
@@ -128,6 +132,18 @@ void TensorStatistic::updateDistribution() {
     }
 }
 
+void TensorStatistic::mergeRange(const TensorStatistic& other) {
+    mRange.first  = std::min(mRange.first, other.mRange.first);
+    mRange.second = std::max(mRange.second, other.mRange.second);
+}
+
+void TensorStatistic::mergeDistribution(const TensorStatistic& other) {
+    MNN_ASSERT(mInterval == other.mInterval);
+    for (int i = 0; i < mBinNumber; ++i) {
+        mDistribution[i] += other.mDistribution[i] - gDistributionInitValue;
+    }
+}
+
 void TensorStatistic::setThresholdMethod(GET_THRESHOLD_METHOD thresholdMethod) {
     mThresholdMethod = thresholdMethod;
 }
@@ -244,38 +260,52 @@ float TensorStatistic::finishAndCompute() {
     return mScale;
 }
 
-float TensorStatistic::computeScaleADMM() {
+float TensorStatistic::computeScaleADMM(int threadNumber) {
     const int count         = mOriginTensor->elementSize();
-    float max               = 0;
     const float bound       = mFeatureClampValue;
     const float* originData = mOriginTensor->host<float>();
-
-    for (int i = 0; i < count; i++) {
-        float absData = std::fabs(originData[i]);
-        if (absData > max) {
-            max = absData;
+    // Each thread computes a part of the data, and the partial results are added in order
+    threadNumber    = std::max(1, std::min(threadNumber, count / 4096));
+    const int step  = (count + threadNumber - 1) / threadNumber;
+    std::vector<float> partMax(threadNumber, 0.0f);
+    Helper::parallelFor(threadNumber, threadNumber, [&](int tId) {
+        const int end = std::min(count, (tId + 1) * step);
+        float max     = 0;
+        for (int i = tId * step; i < end; i++) {
+            max = std::max(max, std::fabs(originData[i]));
         }
-    }
+        partMax[tId] = max;
+    });
+    float max   = *std::max_element(partMax.begin(), partMax.end());
     float alpha = max / (bound * 2.5);
 
     // DLOG(INFO) << "alpha init: " << alpha;
 
     const int maxStep = 300;
-    float sum1        = 0;
-    float sum2        = 0;
-    float invAlpha;
+    std::vector<float> partSum1(threadNumber);
+    std::vector<float> partSum2(threadNumber);
 
     for (int i = 0; i < maxStep; i++) {
-        sum1     = 0;
-        sum2     = 0;
-        invAlpha = 1 / alpha;
-
-        for (int i = 0; i < count; i++) {
-            auto origin    = originData[i];
-            auto dataQuant = std::roundf(origin * invAlpha);
-            dataQuant      = std::fmin(bound, std::fmax(-bound, dataQuant));
-            sum1 += (dataQuant * origin);
-            sum2 += (dataQuant * dataQuant);
+        const float invAlpha = 1 / alpha;
+        Helper::parallelFor(threadNumber, threadNumber, [&](int tId) {
+            const int end = std::min(count, (tId + 1) * step);
+            float sum1    = 0;
+            float sum2    = 0;
+            for (int i = tId * step; i < end; i++) {
+                auto origin    = originData[i];
+                auto dataQuant = std::roundf(origin * invAlpha);
+                dataQuant      = std::fmin(bound, std::fmax(-bound, dataQuant));
+                sum1 += (dataQuant * origin);
+                sum2 += (dataQuant * dataQuant);
+            }
+            partSum1[tId] = sum1;
+            partSum2[tId] = sum2;
+        });
+        float sum1 = 0;
+        float sum2 = 0;
+        for (int tId = 0; tId < threadNumber; tId++) {
+            sum1 += partSum1[tId];
+            sum2 += partSum2[tId];
         }
 
         alpha = sum1 / sum2;
@@ -33,12 +33,16 @@ public:
     void resetDistribution();
     void updateDistribution();
 
+    // Merge the statistic of the same tensor in another session, the distributions must be reset with the same range
+    void mergeRange(const TensorStatistic& other);
+    void mergeDistribution(const TensorStatistic& other);
+
     void setThresholdMethod(GET_THRESHOLD_METHOD thresholdMethod);
 
     float finishAndCompute();
 
-    // only this one for ADMM
-    float computeScaleADMM();
+    // only this one for ADMM, the sums of each step are computed by threadNumber threads
+    float computeScaleADMM(int threadNumber = 1);
 
     std::string name() {
         return mName;
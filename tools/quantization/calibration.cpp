@@ -14,6 +14,8 @@
 #include <string>
 #include <set>
 #include <algorithm>
+#include <atomic>
+#include <mutex>
 #include <MNN/ImageProcess.hpp>
 #include "flatbuffers/util.h"
 #include "logkit.h"
@@ -41,6 +43,12 @@ using namespace MNN::CV;
 using namespace MNN::Train;
 using namespace MNN::Express;
 
+static void _printThroughput(const char* stage, int fileNumber, uint64_t timeInUs, int threadNumber) {
+    float seconds = (float)timeInUs / 1000000.0f;
+    MNN_PRINT("%s: %d files in %.2f s, %.2f files/s, %d threads\n", stage, fileNumber, seconds,
+              seconds > 0.0f ? (float)fileNumber / seconds : 0.0f, threadNumber);
+}
+
 Calibration::Calibration(MNN::NetT* model, const uint8_t* modelBuffer, const int bufferSize, const std::string& configPath, std::string originalModelFile, std::string destModelFile)
     : _originalModel(model), _originalModelFile(originalModelFile), _destModelFile(destModelFile) {
     // when the format of input image is RGB/BGR, channels equal to 3, GRAY is 1
@@ -194,6 +202,9 @@ Calibration::Calibration(MNN::NetT* model, const uint8_t* modelBuffer, const int
         if (picObj.HasMember("debug")) {
             _debug = picObj["debug"].GetBool();
         }
+        if (picObj.HasMember("thread_num")) {
+            _threadNumber = std::max(1, picObj["thread_num"].GetInt());
+        }
         _inputType = Helper::InputType::IMAGE;
         if (picObj.HasMember("input_type")) {
             std::string type = picObj["input_type"].GetString();
@@ -342,13 +353,28 @@ void Calibration::_initMNNSession(const uint8_t* modelBuffer, const int bufferSi
     }
 
     _resizeIfNeeded(_calibrationFiles[0]);
+    if (_featureQuantizeMethod == "KL" && _threadNumber > 1) {
+        _initWorkers(buffer, size);
+    }
 }
 
-void Calibration::_initMaps() {
-    _featureInfo.clear();
-    _featureInfoOrigin.clear();
-    _opInfo.clear();
-    _tensorMap.clear();
+void Calibration::_initWorkers(const uint8_t* modelBuffer, const int bufferSize) {
+    MNN::ScheduleConfig config;
+    config.numThread = 1;
+    _workers.resize(_threadNumber);
+    for (auto& worker : _workers) {
+        worker.interpreter.reset(MNN::Interpreter::createFromBuffer(modelBuffer, bufferSize));
+        worker.session         = worker.interpreter->createSession(config);
+        worker.inputTensor     = worker.interpreter->getSessionInput(worker.session, NULL);
+        worker.inputTensorDims = _inputTensorDims;
+        worker.interpreter->resizeTensor(worker.inputTensor, worker.inputTensorDims);
+        worker.interpreter->resizeSession(worker.session);
+        worker.process.reset(ImageProcess::create(_imageProcessConfig));
+    }
+}
+
+void Calibration::_initFeatureInfo(MNN::Interpreter* interpreter, MNN::Session* session,
+                                   std::map<const MNN::Tensor*, std::shared_ptr<TensorStatistic>>& featureInfo, bool recordOpInfo) {
     // run mnn once, initialize featureMap, opInfo map
     MNN::TensorCallBackWithInfo before = [&](const std::vector<MNN::Tensor*>& nTensors, const MNN::OperatorInfo* info) {
         std::string opName = info->name();
@@ -356,12 +382,14 @@ void Calibration::_initMaps() {
         if (iter != _skip_quant_ops.end()) {
             return false;
         }
-        _opInfo[opName].first = nTensors;
+        if (recordOpInfo) {
+            _opInfo[opName].first = nTensors;
+        }
         if (Helper::gNotNeedFeatureOp.find(info->type()) == Helper::gNotNeedFeatureOp.end()) {
             int i = 0;
             for (auto t : nTensors) {
-                if (_featureInfo.find(t) == _featureInfo.end() && MNN::TensorUtils::getDescribe(t)->memoryType != MNN::Tensor::InsideDescribe::MEMORY_VIRTUAL) {
-                    _featureInfo[t] = std::shared_ptr<TensorStatistic>(
+                if (featureInfo.find(t) == featureInfo.end() && MNN::TensorUtils::getDescribe(t)->memoryType != MNN::Tensor::InsideDescribe::MEMORY_VIRTUAL) {
+                    featureInfo[t] = std::shared_ptr<TensorStatistic>(
                         new TensorStatistic(t, _featureQuantizeMethod, opName + " input_tensor_" + flatbuffers::NumToString(i), _featureClampValue));
                 }
                 i++;
@@ -369,19 +397,21 @@ void Calibration::_initMaps() {
         }
         return false;
     };
-    MNN::TensorCallBackWithInfo after = [this](const std::vector<MNN::Tensor*>& nTensors,
-                                               const MNN::OperatorInfo* info) {
+    MNN::TensorCallBackWithInfo after = [&](const std::vector<MNN::Tensor*>& nTensors,
+                                            const MNN::OperatorInfo* info) {
         std::string opName = info->name();
         std::vector<std::string>::iterator iter = std::find(_skip_quant_ops.begin(), _skip_quant_ops.end(), opName);
         if (iter != _skip_quant_ops.end()) {
             return true;
         }
-        _opInfo[opName].second = nTensors;
+        if (recordOpInfo) {
+            _opInfo[opName].second = nTensors;
+        }
         if (Helper::gNotNeedFeatureOp.find(info->type()) == Helper::gNotNeedFeatureOp.end()) {
             int i = 0;
             for (auto t : nTensors) {
-                if (_featureInfo.find(t) == _featureInfo.end()) {
-                    _featureInfo[t] =
+                if (featureInfo.find(t) == featureInfo.end()) {
+                    featureInfo[t] =
                         std::shared_ptr<TensorStatistic>(new TensorStatistic(t, _featureQuantizeMethod, opName + " output_tensor_" + flatbuffers::NumToString(i), _featureClampValue));
                 }
                 i++;
@@ -389,8 +419,18 @@ void Calibration::_initMaps() {
         }
         return true;
     };
-    _interpreter->runSessionWithCallBackInfo(_session, before, after);
+    interpreter->runSessionWithCallBackInfo(session, before, after);
+}
 
+void Calibration::_initMaps() {
+    _featureInfo.clear();
+    _featureInfoOrigin.clear();
+    _opInfo.clear();
+    _tensorMap.clear();
+    _initFeatureInfo(_interpreter.get(), _session, _featureInfo, true);
+    for (auto& worker : _workers) {
+        _initFeatureInfo(worker.interpreter.get(), worker.session, worker.featureInfo, false);
+    }
 
     MNN::TensorCallBackWithInfo beforeOrigin = [&](const std::vector<MNN::Tensor*>& nTensors, const MNN::OperatorInfo* info) {
         std::string opName = info->name();
@@ -457,6 +497,7 @@ void Calibration::_initMaps() {
 void Calibration::_computeFeatureMapsRange() {
     // feed input data according to input images
     int count = 0;
+    MNN::Timer timer;
     for (const auto& file : _calibrationFiles) {
         for (auto& iter : _featureInfo) {
             iter.second->setVisited(false);
@@ -497,6 +538,7 @@ void Calibration::_computeFeatureMapsRange() {
         fflush(stdout);
     }
     MNN_PRINT("\n");
+    _printThroughput("ComputeFeatureRange", count, timer.durationInUs(), 1);
 }
 
 void Calibration::_collectFeatureMapsDistribution() {
@@ -525,6 +567,7 @@ void Calibration::_collectFeatureMapsDistribution() {
         return true;
     };
     int count = 0;
+    MNN::Timer timer;
     for (const auto& file : _calibrationFiles) {
         count++;
 
@@ -543,17 +586,119 @@ void Calibration::_collectFeatureMapsDistribution() {
         fflush(stdout);
     }
     MNN_PRINT("\n");
+    _printThroughput("CollectFeatureDistribution", count, timer.durationInUs(), 1);
+}
+
+void Calibration::_runWorkers(bool distribution) {
+    const char* stage    = distribution ? "CollectFeatureDistribution" : "ComputeFeatureRange";
+    const int fileNumber = (int)_calibrationFiles.size();
+    std::atomic<int> nextFile(0);
+    int count = 0;
+    // _getInputShape updates the members for sequence inputs
+    std::mutex shapeMutex;
+    std::mutex printMutex;
+    MNN::Timer timer;
+    Helper::parallelFor((int)_workers.size(), (int)_workers.size(), [&](int index) {
+        auto& worker      = _workers[index];
+        auto& featureInfo = worker.featureInfo;
+        MNN::TensorCallBackWithInfo callback = [&](const std::vector<MNN::Tensor*>& nTensors,
+                                                   const MNN::OperatorInfo* info) {
+            for (auto t : nTensors) {
+                auto iter = featureInfo.find(t);
+                if (iter != featureInfo.end() && iter->second->visited() == false) {
+                    if (distribution) {
+                        iter->second->updateDistribution();
+                    } else {
+                        iter->second->updateRange();
+                    }
+                }
+            }
+            return true;
+        };
+        for (int i = nextFile++; i < fileNumber; i = nextFile++) {
+            const auto& file = _calibrationFiles[i];
+            for (auto& iter : featureInfo) {
+                iter.second->setVisited(false);
+                iter.second->resetUpdatedRangeFlags();
+                iter.second->resetUpdatedDistributionFlag();
+            }
+            std::vector<int> inputShape;
+            {
+                std::lock_guard<std::mutex> _l(shapeMutex);
+                inputShape = _getInputShape(file);
+            }
+            if (inputShape != worker.inputTensorDims) {
+                worker.inputTensorDims = inputShape;
+                worker.interpreter->resizeTensor(worker.inputTensor, worker.inputTensorDims);
+                worker.interpreter->resizeSession(worker.session);
+            }
+            Helper::preprocessInput(worker.process.get(), _preprocessConfig, file, worker.inputTensor, _inputType);
+            worker.interpreter->runSessionWithCallBackInfo(worker.session, callback, callback);
+            std::lock_guard<std::mutex> _l(printMutex);
+            count++;
+            MNN_PRINT("\r%s: %.2lf %%", stage, (float)count * 100.0f / (float)_calibrationFileNum);
+            fflush(stdout);
+        }
+    });
+    MNN_PRINT("\n");
+    _printThroughput(stage, count, timer.durationInUs(), (int)_workers.size());
 }
 
 void Calibration::_computeFeatureScaleKL() {
-    _computeFeatureMapsRange();
-    _collectFeatureMapsDistribution();
+    if (_workers.empty()) {
+        _computeFeatureMapsRange();
+        _collectFeatureMapsDistribution();
+    } else {
+        std::map<std::string, std::shared_ptr<TensorStatistic>> featureByName;
+        for (auto& iter : _featureInfo) {
+            featureByName[iter.second->name()] = iter.second;
+        }
+        _runWorkers(false);
+        for (auto& worker : _workers) {
+            for (auto& iter : worker.featureInfo) {
+                auto feature = featureByName.find(iter.second->name());
+                if (feature != featureByName.end()) {
+                    feature->second->mergeRange(*iter.second);
+                }
+            }
+        }
+        // The workers use the merged range, so that their distributions have the same bins
+        for (auto& iter : _featureInfo) {
+            iter.second->resetDistribution();
+        }
+        for (auto& worker : _workers) {
+            for (auto& iter : worker.featureInfo) {
+                auto feature = featureByName.find(iter.second->name());
+                if (feature != featureByName.end()) {
+                    iter.second->mergeRange(*feature->second);
+                }
+                iter.second->resetDistribution();
+            }
+        }
+        _runWorkers(true);
+        for (auto& worker : _workers) {
+            for (auto& iter : worker.featureInfo) {
+                auto feature = featureByName.find(iter.second->name());
+                if (feature != featureByName.end()) {
+                    feature->second->mergeDistribution(*iter.second);
+                }
+            }
+        }
+    }
 
+    // The threshold search of each tensor is independent
     _scales.clear();
-    for (auto& iter : _featureInfo) {
-        AUTOTIME;
-        _scales[iter.first] = iter.second->finishAndCompute();
+    std::vector<std::pair<const MNN::Tensor*, std::shared_ptr<TensorStatistic>>> features(_featureInfo.begin(), _featureInfo.end());
+    std::vector<float> scales(features.size());
+    MNN::Timer timer;
+    Helper::parallelFor((int)features.size(), _threadNumber, [&](int index) {
+        scales[index] = features[index].second->finishAndCompute();
+    });
+    for (int i = 0; i < features.size(); ++i) {
+        _scales[features[i].first] = scales[i];
     }
+    MNN_PRINT("ComputeFeatureScaleKL: %d tensors in %.2f s, %d threads\n", (int)features.size(),
+              (float)timer.durationInUs() / 1000000.0f, _threadNumber);
     //_featureInfo.clear();//No need now
 }
 
@@ -589,7 +734,7 @@ void Calibration::_computeFeatureScaleADMM() {
             for (auto t : nTensors) {
                 if (_featureInfo.find(t) != _featureInfo.end()) {
                     if (_featureInfo[t]->visited() == false) {
-                        _scales[t] = _featureInfo[t]->computeScaleADMM();
+                        _scales[t] = _featureInfo[t]->computeScaleADMM(_threadNumber);
                         count++;
                         MNN_PRINT("\rComputeADMM: %.2lf %%", (float)count * 100.0f / (float)totalLayers);
                         fflush(stdout);
@@ -604,7 +749,7 @@ void Calibration::_computeFeatureScaleADMM() {
             for (auto t : nTensors) {
                 if (_featureInfo.find(t) != _featureInfo.end()) {
                     if (_featureInfo[t]->visited() == false) {
-                        _scales[t] = _featureInfo[t]->computeScaleADMM();
+                        _scales[t] = _featureInfo[t]->computeScaleADMM(_threadNumber);
                         count++;
                         MNN_PRINT("\rComputeADMM: %.2lf %%", (float)count * 100.0f / (float)totalLayers);
                         fflush(stdout);
@@ -43,6 +43,8 @@ private:
     int _channels;
     int _batch = 32;
     int _quant_bits = 8;
+    // Number of threads to run the calibration files and compute the scales
+    int _threadNumber = 1;
     bool _winogradOpt = false;
     Helper::PreprocessConfig _preprocessConfig;
     Helper::InputType _inputType;
@@ -74,6 +76,18 @@ private:
     MNN::Session* _sessionOrigin;
     MNN::Tensor* _inputTensorOrigin;
 
+    // Runs of an interpreter are serialized, so each calibration thread has its own interpreter of the quantized model
+    // and collects the statistics of its files, which are merged to _featureInfo by name
+    struct Worker {
+        std::shared_ptr<MNN::Interpreter> interpreter;
+        MNN::Session* session;
+        MNN::Tensor* inputTensor;
+        std::vector<int> inputTensorDims;
+        std::shared_ptr<MNN::CV::ImageProcess> process;
+        std::map<const MNN::Tensor*, std::shared_ptr<TensorStatistic>> featureInfo;
+    };
+    std::vector<Worker> _workers;
+
     std::string _featureQuantizeMethod = "KL";
     std::string _weightQuantizeMethod  = "MAX_ABS";
 
@@ -86,6 +100,11 @@ private:
     void _resizeIfNeeded(std::string filename, bool force = false);
     void _initMNNSession(const uint8_t* modelBuffer, const int bufferSize);
     void _initMaps();
+    void _initFeatureInfo(MNN::Interpreter* interpreter, MNN::Session* session,
+                          std::map<const MNN::Tensor*, std::shared_ptr<TensorStatistic>>& featureInfo, bool recordOpInfo);
+    void _initWorkers(const uint8_t* modelBuffer, const int bufferSize);
+    // Run all the calibration files on the workers, update the range or the distribution of their statistics
+    void _runWorkers(bool distribution);
 
     // compute min/max value for every Tensor
     void _computeFeatureMapsRange();
@@ -7,12 +7,14 @@
 //
 
 #include "DataLoader.hpp"
+#include <string.h>
 #include "LambdaTransform.hpp"
 #include "RandomSampler.hpp"
 #include "Sampler.hpp"
 #include "StackTransform.hpp"
 #include "Transform.hpp"
 #include "TransformDataset.hpp"
+#include "core/MNNMemoryUtils.h"
 namespace MNN {
 namespace Train {
 
@@ -21,7 +23,17 @@ DataLoader::DataLoader(std::shared_ptr<BatchDataset> dataset, std::shared_ptr<Sa
     mDataset = dataset;
     mSampler = sampler;
     mConfig  = config;
-    if (mConfig->numJobs > 0) {
+    bool ring = mConfig->ringDepth > 0 && initRing();
+    if (ring && mConfig->numWorkers > 0) {
+        // at most ringDepth jobs are waiting, and one quit job for each worker
+        mJobs      = std::make_shared<BlockingQueue<Job>>(mConfig->ringDepth + mConfig->numWorkers);
+        mDataQueue = std::make_shared<BlockingQueue<std::vector<Example>>>(1);
+        mRingQueue = std::make_shared<BlockingQueue<std::pair<int, size_t>>>(mConfig->ringDepth);
+        prefetch(mConfig->ringDepth);
+        for (int i = 0; i < mConfig->numWorkers; i++) {
+            mWorkers.emplace_back([&] { workerThread(); });
+        }
+    } else if (mConfig->numJobs > 0) {
         mJobs      = std::make_shared<BlockingQueue<Job>>(mConfig->numJobs);
         mDataQueue = std::make_shared<BlockingQueue<std::vector<Example>>>(mConfig->numJobs);
         prefetch(mConfig->numJobs);
@@ -31,7 +43,103 @@ DataLoader::DataLoader(std::shared_ptr<BatchDataset> dataset, std::shared_ptr<Sa
     }
 }
 
+bool DataLoader::initRing() {
+    // The examples are supposed to have the same layout as the first one
+    auto batch = mDataset->size() > 0 ? mDataset->getBatch({0}) : std::vector<Example>();
+    if (batch.size() != 1) {
+        MNN_ERROR("The ring of batch buffers needs a dataset of examples\n");
+        return false;
+    }
+    auto& example = batch[0];
+    mDataNumber   = example.first.size();
+    mExampleInfos.clear();
+    for (int i = 0; i < example.first.size() + example.second.size(); ++i) {
+        auto var  = i < mDataNumber ? example.first[i] : example.second[i - mDataNumber];
+        auto info = nullptr != var.get() ? var->getInfo() : nullptr;
+        if (nullptr == info || info->order == NC4HW4) {
+            MNN_ERROR("The examples can't be written into the ring of batch buffers\n");
+            mExampleInfos.clear();
+            return false;
+        }
+        mExampleInfos.emplace_back(*info);
+    }
+    mRing.resize(mConfig->ringDepth);
+    mFreeSlots.clear();
+    for (int slot = 0; slot < mRing.size(); ++slot) {
+        for (auto& info : mExampleInfos) {
+            auto bytes = info.size * info.type.bytes() * mConfig->batchSize;
+            mRing[slot].emplace_back((uint8_t*)MNNMemoryAllocAlign(bytes, MNN_MEMORY_ALIGN_DEFAULT), MNNMemoryFreeAlign);
+        }
+        mFreeSlots.emplace_back(slot);
+    }
+    std::vector<std::pair<void*, size_t>> dst(mExampleInfos.size());
+    for (int i = 0; i < dst.size(); ++i) {
+        dst[i] = std::make_pair(mRing[0][i].get(), mExampleInfos[i].size * mExampleInfos[i].type.bytes());
+    }
+    if (!mDataset->getTo(0, dst)) {
+        MNN_ERROR("The dataset can't write the examples into the ring of batch buffers\n");
+        mRing.clear();
+        mFreeSlots.clear();
+        return false;
+    }
+    return true;
+}
+
+void DataLoader::fillRing(int slot, const std::vector<size_t>& indices) {
+    std::vector<std::pair<void*, size_t>> dst(mExampleInfos.size());
+    for (int i = 0; i < indices.size(); ++i) {
+        for (int j = 0; j < dst.size(); ++j) {
+            dst[j].second = mExampleInfos[j].size * mExampleInfos[j].type.bytes();
+            dst[j].first  = mRing[slot][j].get() + i * dst[j].second;
+        }
+        if (!mDataset->getTo(indices[i], dst)) {
+            MNN_ERROR("The example %d doesn't match the batch buffer, fill zero\n", (int)indices[i]);
+            for (auto& d : dst) {
+                ::memset(d.first, 0, d.second);
+            }
+        }
+    }
+}
+
+Example DataLoader::ringExample(int slot, size_t batchSize) {
+    // The vars refer to the batch buffer, no copy or stack
+    Example example;
+    for (int i = 0; i < mExampleInfos.size(); ++i) {
+        auto info = mExampleInfos[i];
+        info.dim.insert(info.dim.begin(), (int)batchSize);
+        info.syncSize();
+        auto var = Variable::create(Expr::create(std::move(info), mRing[slot][i].get(), VARP::INPUT, Expr::REF));
+        if (i < mDataNumber) {
+            example.first.emplace_back(var);
+        } else {
+            example.second.emplace_back(var);
+        }
+    }
+    return example;
+}
+
 std::vector<Example> DataLoader::next() {
+    if (!mRing.empty()) {
+        if (mConfig->numWorkers == 0) {
+            auto batchIndices = mSampler->next(mConfig->batchSize);
+            MNN_ASSERT(batchIndices.size() != 0); // the sampler is exhausted, should reset the data loader
+            if (mConfig->dropLast && batchIndices.size() < mConfig->batchSize) {
+                MNN_ASSERT(false); // the sampler is exhausted
+            }
+            mUsingSlot = (mUsingSlot + 1) % (int)mRing.size();
+            fillRing(mUsingSlot, batchIndices);
+            return {ringExample(mUsingSlot, batchIndices.size())};
+        }
+        // The last batch is not used any more, fill it with a new job
+        if (mUsingSlot >= 0) {
+            mFreeSlots.emplace_back(mUsingSlot);
+            mUsingSlot = -1;
+            prefetch(1);
+        }
+        auto filled = mRingQueue->pop();
+        mUsingSlot  = filled.first;
+        return {ringExample(filled.first, filled.second)};
+    }
     if (mConfig->numWorkers == 0) {
         auto batchIndices = mSampler->next(mConfig->batchSize);
         MNN_ASSERT(batchIndices.size() != 0); // the sampler is exhausted, should reset the data loader
@@ -57,6 +165,11 @@ void DataLoader::prefetch(size_t nJobs) {
             if (mConfig->dropLast && batchIndices.size() < mConfig->batchSize) {
                 // drop the job
             } else {
+                if (!mRing.empty()) {
+                    MNN_ASSERT(!mFreeSlots.empty());
+                    j.slot = mFreeSlots.back();
+                    mFreeSlots.pop_back();
+                }
                 mJobs->push(std::move(j)); // the job may be empty when sampler is exhausted
             }
         }
@@ -71,6 +184,11 @@ void DataLoader::workerThread() {
         }
         // make sure there are no empty jobs, so that there are no empty batch
         MNN_ASSERT(currentJob.job.size() != 0);
+        if (currentJob.slot >= 0) {
+            fillRing(currentJob.slot, currentJob.job);
+            mRingQueue->push(std::make_pair(currentJob.slot, currentJob.job.size()));
+            continue;
+        }
         auto batch = mDataset->getBatch(currentJob.job);
         mDataQueue->push(std::move(batch));
     }
@@ -91,7 +209,7 @@ void DataLoader::reset() {
     clean();
 
     if (mConfig->numWorkers > 0) {
-        prefetch(mConfig->numJobs);
+        prefetch(!mRing.empty() ? mRing.size() : mConfig->numJobs);
         for (int i = 0; i < mConfig->numWorkers; i++) {
             mWorkers.emplace_back([&] { workerThread(); });
         }
@@ -104,7 +222,15 @@ void DataLoader::clean() {
         mWorkers.clear();
         mJobs->clear();
         mDataQueue->clear();
+        if (nullptr != mRingQueue) {
+            mRingQueue->clear();
+        }
+    }
+    mFreeSlots.clear();
+    for (int slot = 0; slot < mRing.size(); ++slot) {
+        mFreeSlots.emplace_back(slot);
     }
+    mUsingSlot = -1;
     // should reset sampler before prefetch
     mSampler->reset(mSampler->size());
 }
@@ -126,7 +252,20 @@ DataLoader* DataLoader::makeDataLoader(std::shared_ptr<BatchDataset> dataset,
                                   const int batchSize,
                                   const bool stack,
                                   const bool shuffle,
-                                       const int numWorkers) {
+                                       const int numWorkers,
+                                       const int ringDepth) {
+    if (stack && ringDepth > 0) {
+        // The examples are written into the batch buffers, so stack is not needed
+        auto sampler      = std::make_shared<RandomSampler>(dataset->size(), shuffle);
+        auto config       = std::make_shared<DataLoaderConfig>(batchSize, numWorkers);
+        config->ringDepth = ringDepth;
+        auto loader       = new DataLoader(dataset, sampler, config);
+        if (!loader->mRing.empty()) {
+            return loader;
+        }
+        MNN_PRINT("Stack the examples instead of the ring of batch buffers\n");
+        delete loader;
+    }
     std::vector<std::shared_ptr<BatchTransform>> transforms;
     if (stack) {
         transforms.emplace_back(std::shared_ptr<StackTransform>(new StackTransform));
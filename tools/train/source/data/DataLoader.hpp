@@ -9,6 +9,7 @@
 #ifndef DataLoader_hpp
 #define DataLoader_hpp
 
+#include <memory>
 #include <string>
 #include <thread>
 #include <vector>
@@ -49,11 +50,15 @@ public:
 
     size_t iterNumber() const;
     size_t size() const;
+    /* ringDepth > 0: the examples are written into a ring of ringDepth preallocated batch buffers by
+       BatchDataset::getTo instead of being stacked if stack is true and the dataset supports it.
+     */
     static DataLoader* makeDataLoader(std::shared_ptr<BatchDataset> dataset,
                                       const int batchSize,
                                       const bool stack = true,
                                       const bool shuffle = true,
-                                      const int numWorkers = 0);
+                                      const int numWorkers = 0,
+                                      const int ringDepth = 0);
     static DataLoader* makeDataLoader(std::shared_ptr<BatchDataset> dataset,
                                       std::vector<std::shared_ptr<BatchTransform>> transforms,
                                       const int batchSize,
@@ -64,13 +69,31 @@ private:
     struct Job {
         std::vector<size_t> job;
         bool quit = false;
+        // the ring buffer to write the batch, -1 if not in ring mode
+        int slot  = -1;
     };
+    bool initRing();
+    void fillRing(int slot, const std::vector<size_t>& indices);
+    Example ringExample(int slot, size_t batchSize);
+
     std::shared_ptr<BatchDataset> mDataset;
     std::shared_ptr<Sampler> mSampler;
     std::shared_ptr<DataLoaderConfig> mConfig;
     std::shared_ptr<BlockingQueue<Job>> mJobs;
     std::shared_ptr<BlockingQueue<std::vector<Example>>> mDataQueue;
     std::vector<std::thread> mWorkers;
+
+    // ring mode
+    // layout of one example, the data then the target
+    std::vector<Express::Variable::Info> mExampleInfos;
+    size_t mDataNumber = 0;
+    // mRing[slot][i] is the batch buffer of the i-th data or target
+    std::vector<std::vector<std::shared_ptr<uint8_t>>> mRing;
+    // slots not used by the workers or the returned batch, only used by the thread calling next
+    std::vector<int> mFreeSlots;
+    int mUsingSlot = -1;
+    // filled slot and the batch size
+    std::shared_ptr<BlockingQueue<std::pair<int, size_t>>> mRingQueue;
 };
 
 } // namespace Train
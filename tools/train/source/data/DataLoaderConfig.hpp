@@ -22,6 +22,9 @@ public:
     size_t numWorkers = 0;
     size_t numJobs    = numWorkers * 2;
     bool dropLast     = false;
+    // Number of the preallocated batch buffers the examples are written into directly instead of being stacked,
+    // 0 to stack the examples. The batch returned by DataLoader::next is valid until the next call
+    size_t ringDepth  = 0;
 };
 
 } // namespace Train
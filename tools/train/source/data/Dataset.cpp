@@ -7,11 +7,33 @@
 //
 
 #include "Dataset.hpp"
+#include <string.h>
 namespace MNN {
 namespace Train {
 
-DataLoader* DatasetPtr::createLoader(const int batchSize, const bool stack, const bool shuffle, const int numWorkers) {
-    return DataLoader::makeDataLoader(mDataset, batchSize, stack, shuffle, numWorkers);
+DataLoader* DatasetPtr::createLoader(const int batchSize, const bool stack, const bool shuffle, const int numWorkers, const int ringDepth) {
+    return DataLoader::makeDataLoader(mDataset, batchSize, stack, shuffle, numWorkers, ringDepth);
+}
+
+bool Dataset::getTo(size_t index, const std::vector<std::pair<void*, size_t>>& dst) {
+    auto example = get(index);
+    if (example.first.size() + example.second.size() != dst.size()) {
+        return false;
+    }
+    for (int i = 0; i < dst.size(); ++i) {
+        auto var = i < example.first.size() ? example.first[i] : example.second[i - example.first.size()];
+        // computing the var here is not safe in the worker threads
+        if (nullptr == var.get() || nullptr != var->expr().first->get()) {
+            return false;
+        }
+        auto info = var->getInfo();
+        auto ptr  = var->readMap<void>();
+        if (nullptr == info || nullptr == ptr || info->size * info->type.bytes() != dst[i].second) {
+            return false;
+        }
+        ::memcpy(dst[i].first, ptr, dst[i].second);
+    }
+    return true;
 }
 } // namespace Train
 } // namespace MNN
@@ -24,7 +24,8 @@ public:
                               const int batchSize,
                               const bool stack = true,
                               const bool shuffle = true,
-                              const int numWorkers = 0);
+                              const int numWorkers = 0,
+                              const int ringDepth = 0);
     ~ DatasetPtr() = default;
     template<typename T>
     T* get() const {
@@ -41,6 +42,13 @@ public:
 
     // size of the dataset
     virtual size_t size() = 0;
+
+    // write the example with given index into the memory of a batch buffer, dst has the address and the bytes
+    // for each data then each target. called by the workers of the data loader in ring mode, return false if
+    // not supported or the example doesn't match dst
+    virtual bool getTo(size_t index, const std::vector<std::pair<void*, size_t>>& dst) {
+        return false;
+    }
 };
 
 class MNN_PUBLIC Dataset : public BatchDataset {
@@ -48,6 +56,9 @@ public:
     // return a specific example with given index
     virtual Example get(size_t index) = 0;
 
+    // copy the result of get
+    virtual bool getTo(size_t index, const std::vector<std::pair<void*, size_t>>& dst) override;
+
     std::vector<Example> getBatch(std::vector<size_t> indices) {
         std::vector<Example> batch;
         batch.reserve(indices.size());
@@ -77,6 +77,24 @@ Example ImageDataset::get(size_t index) {
     }
 }
 
+bool ImageDataset::getTo(size_t index, const std::vector<std::pair<void*, size_t>>& dst) {
+    if (mReadAllToMemory) {
+        return Dataset::getTo(index, dst);
+    }
+    auto& labels = mAllTxtLines[index].second;
+    if (dst.size() != 2 || dst[1].second != labels.size() * sizeof(int32_t)) {
+        return false;
+    }
+    auto success = convertImageTo(mAllTxtLines[index].first, mConfig, mProcessConfig, [&](int oh, int ow, int bpp) {
+        return (size_t)oh * ow * bpp * sizeof(float) == dst[0].second ? (float*)dst[0].first : nullptr;
+    });
+    if (!success) {
+        return false;
+    }
+    ::memcpy(dst[1].first, labels.data(), dst[1].second);
+    return true;
+}
+
 size_t ImageDataset::size() {
     return mAllTxtLines.size();
 }
@@ -108,12 +126,25 @@ void ImageDataset::getAllDataAndLabelsFromTxt(const std::string pathToImages, st
 }
 
 VARP ImageDataset::convertImage(const std::string& imageName, const ImageConfig& mConfig, const MNN::CV::ImageProcess::Config& mProcessConfig) {
+    VARP data;
+    auto success = convertImageTo(imageName, mConfig, mProcessConfig, [&](int oh, int ow, int bpp) {
+        data = _Input({oh, ow, bpp}, NHWC, halide_type_of<float>());
+        return data->writeMap<float>();
+    });
+    if (!success) {
+        return nullptr;
+    }
+    return data;
+}
+
+bool ImageDataset::convertImageTo(const std::string& imageName, const ImageConfig& mConfig, const MNN::CV::ImageProcess::Config& mProcessConfig,
+                                  std::function<float*(int, int, int)> dst) {
     int originalWidth, originalHeight, comp;
     auto bitmap32bits = stbi_load(imageName.c_str(), &originalWidth, &originalHeight, &comp, 4);
     if (bitmap32bits == nullptr) {
         MNN_PRINT("can not open image: %s\n", imageName.c_str());
         MNN_ASSERT(false);
-        return nullptr;
+        return false;
     }
     
     // choose resize or crop
@@ -207,11 +238,15 @@ VARP ImageDataset::convertImage(const std::string& imageName, const ImageConfig&
         }
     }
 
-    auto data      = _Input({oh, ow, bpp}, NHWC, halide_type_of<float>());
-    process->convert(bitmap32bits, originalWidth, originalHeight, 0, data->writeMap<float>(), ow, oh, bpp, ow * bpp,
+    auto data = dst(oh, ow, bpp);
+    if (nullptr == data) {
+        stbi_image_free(bitmap32bits);
+        return false;
+    }
+    process->convert(bitmap32bits, originalWidth, originalHeight, 0, data, ow, oh, bpp, ow * bpp,
                       halide_type_of<float>());
     stbi_image_free(bitmap32bits);
-    return data;
+    return true;
 }
 
 std::pair<VARP, VARP> ImageDataset::getDataAndLabelsFrom(std::pair<std::string, std::vector<int> > dataAndLabels) {
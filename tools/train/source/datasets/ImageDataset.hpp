@@ -9,6 +9,7 @@
 #ifndef ImageDataset_hpp
 #define ImageDataset_hpp
 
+#include <functional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -66,6 +67,9 @@ public:
 
     Example get(size_t index) override;
 
+    // decode the image into dst directly
+    bool getTo(size_t index, const std::vector<std::pair<void*, size_t>>& dst) override;
+
     size_t size() override;
 
 private:
@@ -78,6 +82,9 @@ private:
 
     void getAllDataAndLabelsFromTxt(const std::string pathToImages, std::string pathToImageTxt);
     std::pair<VARP, VARP> getDataAndLabelsFrom(std::pair<std::string, std::vector<int> > dataAndLabels);
+    // dst is returned by the function of the output height, width and bpp, nullptr to skip the image
+    static bool convertImageTo(const std::string& imageName, const ImageConfig& config, const MNN::CV::ImageProcess::Config& cvConfig,
+                               std::function<float*(int, int, int)> dst);
 };
 } // namespace Train
 } // namespace MNN
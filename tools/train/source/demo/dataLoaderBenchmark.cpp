@@ -0,0 +1,96 @@
+//
+//  dataLoaderBenchmark.cpp
+//  MNN
+//
+//  Created by MNN on 2023/03/15.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <MNN/AutoTime.hpp>
+#include <MNN/expr/ExprCreator.hpp>
+#include <stdlib.h>
+#include <memory>
+#include "DataLoader.hpp"
+#include "DemoUnit.hpp"
+#include "ImageDataset.hpp"
+using namespace MNN::Express;
+using namespace MNN::Train;
+using namespace MNN;
+
+// Images of 224 x 224 x 3 in float, the decoding is replaced by computing the pixels
+class BenchmarkImageDataset : public Dataset {
+public:
+    Example get(size_t index) override {
+        auto data  = _Input({224, 224, 3}, NHWC, halide_type_of<float>());
+        auto label = _Input({1}, NHWC, halide_type_of<int32_t>());
+        fill(index, data->writeMap<float>(), label->writeMap<int32_t>());
+        return {{data}, {label}};
+    }
+    bool getTo(size_t index, const std::vector<std::pair<void*, size_t>>& dst) override {
+        if (dst.size() != 2 || dst[0].second != 224 * 224 * 3 * sizeof(float) || dst[1].second != sizeof(int32_t)) {
+            return false;
+        }
+        fill(index, (float*)dst[0].first, (int32_t*)dst[1].first);
+        return true;
+    }
+    size_t size() override {
+        return 2048;
+    }
+
+private:
+    void fill(size_t index, float* data, int32_t* label) {
+        for (int i = 0; i < 224 * 224 * 3; ++i) {
+            data[i] = (float)((i + index * 7) % 255) / 127.5f - 1.0f;
+        }
+        label[0] = (int32_t)(index % 1000);
+    }
+};
+
+// Compare the time of loading batches by stacking the examples and by writing them into the ring of batch buffers
+class DataLoaderBenchmark : public DemoUnit {
+public:
+    virtual int run(int argc, const char* argv[]) override {
+        int batchSize  = 32;
+        int numWorkers = 4;
+        int ringDepth  = 8;
+        int iterNumber = 20;
+        if (argc > 1) {
+            batchSize = atoi(argv[1]);
+        }
+        if (argc > 2) {
+            numWorkers = atoi(argv[2]);
+        }
+        if (argc > 3) {
+            ringDepth = atoi(argv[3]);
+        }
+        if (argc > 4) {
+            iterNumber = atoi(argv[4]);
+        }
+        MNN_PRINT("Usage: ./runTrainDemo.out DataLoaderBenchmark [batchSize] [numWorkers] [ringDepth] [iterNumber] [path/to/images/ path/to/image/txt]\n");
+        DatasetPtr dataset;
+        if (argc > 6) {
+            std::shared_ptr<ImageDataset::ImageConfig> config(ImageDataset::ImageConfig::create(CV::RGB, 224, 224, {1 / 127.5, 1 / 127.5, 1 / 127.5}, {127.5, 127.5, 127.5}));
+            dataset = ImageDataset::create(argv[5], argv[6], config.get(), false);
+        } else {
+            dataset.mDataset.reset(new BenchmarkImageDataset);
+        }
+        MNN_PRINT("batch: %d, workers: %d, ring depth: %d\n", batchSize, numWorkers, ringDepth);
+        for (int ring = 0; ring < 2; ++ring) {
+            std::shared_ptr<DataLoader> loader(dataset.createLoader(batchSize, true, true, numWorkers, ring ? ringDepth : 0));
+            int number = std::min(iterNumber, (int)loader->iterNumber());
+            // Read all the data of the batch as the training does
+            MNN::Timer loadTime;
+            for (int i = 0; i < number; ++i) {
+                auto example = loader->next()[0];
+                auto data    = _Convert(example.first[0], NC4HW4);
+                data->readMap<float>();
+            }
+            auto time = (float)loadTime.durationInUs() / 1000.0f;
+            MNN_PRINT("%s: %.2f ms/batch, %.1f examples/s\n", ring ? "ring" : "stack", time / number,
+                      (float)number * batchSize / time * 1000.0f);
+        }
+        return 0;
+    }
+};
+
+DemoUnitSetRegister(DataLoaderBenchmark, "DataLoaderBenchmark");
@@ -8,7 +8,9 @@
 
 #include <MNN/expr/Executor.hpp>
 #include <MNN/expr/Optimizer.hpp>
+#include <stdlib.h>
 #include <cmath>
+#include <fstream>
 #include <iostream>
 #include <sstream>
 #include <vector>
@@ -18,7 +20,9 @@
 #include "NN.hpp"
 #define MNN_OPEN_TIME_TRACE
 #include <MNN/AutoTime.hpp>
+#include "Loss.hpp"
 #include "RandomGenerator.hpp"
+#include "SGD.hpp"
 #include "Transformer.hpp"
 #include "module/PipelineModule.hpp"
 
@@ -26,6 +30,34 @@ using namespace MNN::Train;
 using namespace MNN::Express;
 using namespace MNN::Train::Model;
 
+// Memory of the process in MB read from /proc/self/status, key is VmHWM for the peak and VmRSS for the current,
+// return -1 if not supported
+static float _processMemoryMB(const char* key) {
+#if defined(__linux__) || defined(__ANDROID__)
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    std::string prefix = std::string(key) + ":";
+    while (std::getline(status, line)) {
+        if (line.compare(0, prefix.size(), prefix) == 0) {
+            return (float)atol(line.c_str() + prefix.size()) / 1024.0f;
+        }
+    }
+#endif
+    return -1.0f;
+}
+
+// Reset the peak memory to the current one, return false if not supported
+static bool _resetPeakMemory() {
+#if defined(__linux__) || defined(__ANDROID__)
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    clearRefs << "5";
+    clearRefs.flush();
+    return clearRefs.good();
+#else
+    return false;
+#endif
+}
+
 class MobilenetV2TransferModule : public Module {
 public:
     MobilenetV2TransferModule(const char* fileName) {
@@ -77,7 +109,7 @@ class MobilenetV2Train : public DemoUnit {
 public:
     virtual int run(int argc, const char* argv[]) override {
         if (argc < 5) {
-            std::cout << "usage: ./runTrainDemo.out MobilenetV2Train path/to/train/images/ path/to/train/image/txt path/to/test/images/ path/to/test/image/txt" << std::endl;
+            std::cout << "usage: ./runTrainDemo.out MobilenetV2Train path/to/train/images/ path/to/train/image/txt path/to/test/images/ path/to/test/image/txt [checkpoint]" << std::endl;
             return 0;
         }
         // global random number generator, should invoke before construct the model and dataset
@@ -88,9 +120,15 @@ public:
         std::string testImagesFolder = argv[3];
         std::string testImagesTxt = argv[4];
 
-        std::shared_ptr<Module> model(new MobilenetV2);
+        bool checkpoint = false;
+        if (argc > 5) {
+            checkpoint = atoi(argv[5]) > 0;
+        }
+
+        std::shared_ptr<Module> model(new MobilenetV2(1001, 1.0f, 8, checkpoint));
 
         MobilenetV2Utils::train(model, 1001, 1, trainImagesFolder, trainImagesTxt, testImagesFolder, testImagesTxt);
+        MNN_PRINT("Peak memory: %.1f MB\n", _processMemoryMB("VmHWM"));
 
         return 0;
     }
@@ -170,7 +208,71 @@ public:
     }
 };
 
+// Peak memory and time of the training steps with random data, with or without checkpointing the bottleneck blocks.
+// Run it once for each mode, since the memory freed by the last mode may be still kept by the process
+class MobilenetV2CheckpointMemory : public DemoUnit {
+public:
+    virtual int run(int argc, const char* argv[]) override {
+        int batch       = 16;
+        bool checkpoint = false;
+        int stepNumber  = 3;
+        int size        = 224;
+        if (argc > 1) {
+            batch = atoi(argv[1]);
+        }
+        if (argc > 2) {
+            checkpoint = atoi(argv[2]) > 0;
+        }
+        if (argc > 3) {
+            stepNumber = atoi(argv[3]);
+        }
+        if (argc > 4) {
+            size = atoi(argv[4]);
+        }
+        MNN_PRINT("Usage: ./runTrainDemo.out MobilenetV2CheckpointMemory [batch] [checkpoint] [stepNumber] [size]\n");
+        MNN_PRINT("batch: %d, checkpoint: %d, size: %d\n", batch, checkpoint, size);
+        RandomGenerator::generator(17);
+        const int numClasses = 1001;
+        std::shared_ptr<Module> model(new MobilenetV2(numClasses, 1.0f, 8, checkpoint));
+        std::shared_ptr<SGD> solver(new SGD(model));
+        solver->setMomentum(0.9f);
+        solver->setWeightDecay(0.00004f);
+        solver->setLearningRate(1e-5f);
+        model->setIsTraining(true);
+
+        auto input = _Input({batch, 3, size, size}, NCHW);
+        auto label = _Input({batch}, NCHW, halide_type_of<int32_t>());
+        auto inputPtr = input->writeMap<float>();
+        for (int i = 0; i < input->getInfo()->size; ++i) {
+            inputPtr[i] = (float)(i % 255) / 127.5f - 1.0f;
+        }
+        auto labelPtr = label->writeMap<int32_t>();
+        for (int i = 0; i < batch; ++i) {
+            labelPtr[i] = i % numClasses;
+        }
+        auto target = _OneHot(label, _Scalar<int>(numClasses), _Scalar<float>(1.0f), _Scalar<float>(0.0f));
+        target.fix(VARP::CONSTANT);
+
+        float baseMemory = _processMemoryMB("VmRSS");
+        if (!_resetPeakMemory()) {
+            MNN_PRINT("Can't reset the peak memory, it includes the memory before training\n");
+        }
+        for (int step = 0; step < stepNumber; ++step) {
+            MNN::Timer stepTime;
+            auto predict = model->forward(_Convert(input, NC4HW4));
+            auto loss    = _CrossEntropy(predict, target);
+            solver->step(loss);
+            MNN_PRINT("step %d, time: %.1f ms\n", step, (float)stepTime.durationInUs() / 1000.0f);
+        }
+        float peakMemory = _processMemoryMB("VmHWM");
+        MNN_PRINT("Memory before training: %.1f MB, peak: %.1f MB, peak increase: %.1f MB\n", baseMemory, peakMemory,
+                  peakMemory - baseMemory);
+        return 0;
+    }
+};
+
 DemoUnitSetRegister(MobilenetV2Transfer, "MobilenetV2Transfer");
 DemoUnitSetRegister(MobilenetV2Train, "MobilenetV2Train");
 DemoUnitSetRegister(MobilenetV2PostTrain, "MobilenetV2PostTrain");
 DemoUnitSetRegister(MobilenetV2TrainQuant, "MobilenetV2TrainQuant");
+DemoUnitSetRegister(MobilenetV2CheckpointMemory, "MobilenetV2CheckpointMemory");
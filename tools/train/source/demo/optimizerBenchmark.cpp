@@ -0,0 +1,96 @@
+//
+//  optimizerBenchmark.cpp
+//  MNN
+//
+//  Created by MNN on 2023/03/06.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <MNN/AutoTime.hpp>
+#include <MNN/expr/ExprCreator.hpp>
+#include <math.h>
+#include <stdlib.h>
+#include "ADAM.hpp"
+#include "DemoUnit.hpp"
+#include "SGD.hpp"
+using namespace MNN::Express;
+using namespace MNN::Train;
+using namespace MNN;
+
+// Compare the step time of the optimizers building express ops for each parameter and updating in place
+class OptimizerBenchmark : public DemoUnit {
+public:
+    virtual int run(int argc, const char* argv[]) override {
+        int paramNumber = 200;
+        int stepNumber  = 20;
+        if (argc > 1) {
+            paramNumber = atoi(argv[1]);
+        }
+        if (argc > 2) {
+            stepNumber = atoi(argv[2]);
+        }
+        MNN_PRINT("Usage: ./runTrainDemo.out OptimizerBenchmark [paramNumber] [stepNumber]\n");
+        MNN_PRINT("%d parameters, %d steps\n", paramNumber, stepNumber);
+        // Sizes of the weights and biases in a small convolution network
+        const std::vector<int> sizes = {32, 3 * 3 * 32, 64, 32 * 64, 128, 3 * 3 * 128, 256, 128 * 256};
+        std::vector<VARP> targets;
+        for (int i = 0; i < paramNumber; ++i) {
+            auto size = sizes[i % sizes.size()];
+            std::vector<float> values(size);
+            for (int j = 0; j < size; ++j) {
+                values[j] = (float)((i * 31 + j * 7) % 101) / 100.0f - 0.5f;
+            }
+            targets.emplace_back(_Const(values.data(), {size}, NCHW));
+        }
+        int code = 0;
+        for (int adam = 0; adam < 2; ++adam) {
+            std::vector<VARP> results[2];
+            float times[2];
+            for (int fused = 0; fused < 2; ++fused) {
+                std::vector<VARP> params;
+                for (int i = 0; i < paramNumber; ++i) {
+                    params.emplace_back(_TrainableParam(0.1f, {(int)sizes[i % sizes.size()]}, NCHW));
+                }
+                std::shared_ptr<Module> module(Module::createEmpty(params));
+                std::shared_ptr<SGD> opt;
+                if (adam) {
+                    opt.reset(static_cast<SGD*>(ParameterOptimizer::createADAM(module, 0.01f, 0.9f, 0.999f, 0.0005f, 1e-8f, ParameterOptimizer::L2)));
+                } else {
+                    opt.reset(static_cast<SGD*>(ParameterOptimizer::createSGD(module, 0.01f, 0.9f, 0.0005f, ParameterOptimizer::L2)));
+                }
+                opt->setFusedUpdate(fused);
+                uint64_t total = 0;
+                for (int step = 0; step < stepNumber; ++step) {
+                    VARP loss = _Scalar<float>(0.0f);
+                    for (int i = 0; i < paramNumber; ++i) {
+                        loss = loss + _ReduceMean(_Square(params[i] - targets[i]), {});
+                    }
+                    loss->readMap<float>();
+                    Timer stepTime;
+                    opt->step(loss);
+                    total += stepTime.durationInUs();
+                }
+                times[fused]   = (float)total / 1000.0f / (float)stepNumber;
+                results[fused] = params;
+            }
+            float maxDiff = 0.0f;
+            for (int i = 0; i < paramNumber; ++i) {
+                auto size = results[0][i]->getInfo()->size;
+                auto p0   = results[0][i]->readMap<float>();
+                auto p1   = results[1][i]->readMap<float>();
+                for (int j = 0; j < size; ++j) {
+                    maxDiff = fmaxf(maxDiff, fabsf(p0[j] - p1[j]));
+                }
+            }
+            MNN_PRINT("%s: express %.3f ms/step, fused %.3f ms/step, speedup %.2fx, max diff %g\n", adam ? "ADAM" : "SGD",
+                      times[0], times[1], times[1] > 0.0f ? times[0] / times[1] : 0.0f, maxDiff);
+            if (maxDiff > 1e-4f) {
+                MNN_ERROR("%s fused update mismatch\n", adam ? "ADAM" : "SGD");
+                code = 1;
+            }
+        }
+        return code;
+    }
+};
+
+DemoUnitSetRegister(OptimizerBenchmark, "OptimizerBenchmark");
@@ -7,6 +7,9 @@
 //
 
 #include "OpGrad.hpp"
+#include <algorithm>
+#include <mutex>
+#include <set>
 using namespace std;
 using namespace MNN::Express;
 namespace MNN {
@@ -62,11 +65,229 @@ std::map<Express::VARP, Express::VARP> OpGrad::grad(VARP loss, const std::set<Ex
     }
     return gradCommon(loss, parameters, backwardMap, blockName);
 }
+struct CheckpointRecord {
+    WeakEXPRP output;
+    std::shared_ptr<OpGrad::Checkpoint> checkpoint;
+};
+static std::mutex gCheckpointMutex;
+static std::map<Expr*, CheckpointRecord> gCheckpoints;
+
+void OpGrad::addCheckpoint(std::shared_ptr<Checkpoint> checkpoint) {
+    std::lock_guard<std::mutex> _l(gCheckpointMutex);
+    // Releasing a checkpoint may release the outputs of the checkpoints before it
+    bool removed = true;
+    while (removed) {
+        removed = false;
+        for (auto iter = gCheckpoints.begin(); iter != gCheckpoints.end();) {
+            if (iter->second.output.expired()) {
+                iter    = gCheckpoints.erase(iter);
+                removed = true;
+            } else {
+                iter++;
+            }
+        }
+    }
+    for (auto& output : checkpoint->outputs) {
+        auto expr = output.lock();
+        if (nullptr != expr) {
+            gCheckpoints[expr.get()] = {output, checkpoint};
+        }
+    }
+}
+
+static std::shared_ptr<OpGrad::Checkpoint> _findCheckpoint(const EXPRP& expr) {
+    std::lock_guard<std::mutex> _l(gCheckpointMutex);
+    auto iter = gCheckpoints.find(expr.get());
+    // The address may be reused by a new expr
+    if (iter == gCheckpoints.end() || iter->second.output.lock() != expr) {
+        return nullptr;
+    }
+    return iter->second.checkpoint;
+}
+
+// Same as Variable::getExecuteOrder, but the outputs of checkpoints are put after their inputs. The parameters are
+// leaves even if they are the outputs of checkpoints, such as the inputs of a checkpoint recomputed
+static std::vector<EXPRP> _getExecuteOrder(const std::vector<VARP>& outputs, const std::set<Expr*>& parameterExprs, std::map<Expr*, std::shared_ptr<OpGrad::Checkpoint>>& checkpoints) {
+    std::vector<EXPRP> sequence;
+    std::set<Expr*> visited;
+    std::function<void(EXPRP)> visit = [&](EXPRP expr) {
+        if (!visited.insert(expr.get()).second) {
+            return;
+        }
+        for (auto& input : expr->inputs()) {
+            if (nullptr != input.get()) {
+                visit(input->expr().first);
+            }
+        }
+        if (nullptr == expr->get() && parameterExprs.find(expr.get()) == parameterExprs.end()) {
+            auto checkpoint = _findCheckpoint(expr);
+            if (nullptr != checkpoint) {
+                checkpoints[expr.get()] = checkpoint;
+                for (auto& input : checkpoint->inputs) {
+                    visit(input->expr().first);
+                }
+            }
+        }
+        sequence.emplace_back(expr);
+    };
+    for (auto& output : outputs) {
+        visit(output->expr().first);
+    }
+    return sequence;
+}
+
+// Compute the vars and replace them by constants, so that the graph before them can be released
+static bool _computeToConst(const std::vector<VARP>& vars) {
+    std::vector<VARP> computeVars;
+    for (auto& var : vars) {
+        if (nullptr != var.get() && nullptr != var->expr().first->get()) {
+            computeVars.emplace_back(var);
+        }
+    }
+    Variable::prepareCompute(computeVars);
+    std::vector<VARP> constVars(computeVars.size());
+    for (int i = 0; i < computeVars.size(); ++i) {
+        auto info = computeVars[i]->getInfo();
+        auto ptr  = computeVars[i]->readMap<void>();
+        if (nullptr == info || nullptr == ptr) {
+            MNN_ERROR("Compute error for checkpoint\n");
+            return false;
+        }
+        constVars[i] = _Const(ptr, info->dim, info->order, info->type);
+    }
+    for (int i = 0; i < computeVars.size(); ++i) {
+        Variable::replace(computeVars[i], constVars[i]);
+    }
+    return true;
+}
+
+static void _addBackward(std::map<EXPRP, std::vector<VARP>>& backwardMap, VARP input, VARP backward) {
+    auto inputExpr = input->expr().first;
+    auto index     = input->expr().second;
+    if (backwardMap.find(inputExpr) == backwardMap.end()) {
+        backwardMap.insert(std::make_pair(inputExpr, std::vector<VARP>(inputExpr->outputSize())));
+    }
+    auto& inputVarMap = backwardMap[inputExpr];
+    if (nullptr == inputVarMap[index]) {
+        inputVarMap[index] = backward;
+    } else {
+        inputVarMap[index] = _Add(inputVarMap[index], backward);
+    }
+}
+
+static std::map<Express::VARP, Express::VARP> _gradCommon(const std::vector<VARP>& outputs, const std::set<Express::VARP>& parameters, std::map<EXPRP, std::vector<VARP>>& backwardMap, const std::vector<std::string>& blockName);
+
+static void _gradCheckpoint(OpGrad::Checkpoint* checkpoint, const std::set<Express::VARP>& parameters, std::map<EXPRP, std::vector<VARP>>& backwardMap, const std::vector<std::string>& blockName) {
+    if (nullptr == checkpoint->recompute) {
+        MNN_ERROR("The checkpoint has been used for backward\n");
+        return;
+    }
+    std::vector<VARP> outputDiff(checkpoint->outputs.size());
+    bool empty = true;
+    for (int i = 0; i < outputDiff.size(); ++i) {
+        auto expr = checkpoint->outputs[i].lock();
+        if (nullptr == expr) {
+            continue;
+        }
+        auto iter = backwardMap.find(expr);
+        if (iter != backwardMap.end()) {
+            outputDiff[i] = iter->second[0];
+            empty         = empty && nullptr == outputDiff[i];
+        }
+    }
+    if (empty) {
+        return;
+    }
+    auto outputs = checkpoint->recompute(checkpoint->inputValues);
+    if (outputs.size() != outputDiff.size()) {
+        MNN_ERROR("The checkpoint recomputes %d outputs, but has %d\n", (int)outputs.size(), (int)outputDiff.size());
+        return;
+    }
+    std::map<EXPRP, std::vector<VARP>> partBackwardMap;
+    std::vector<VARP> partOutputs;
+    for (int i = 0; i < outputs.size(); ++i) {
+        if (nullptr != outputDiff[i]) {
+            _addBackward(partBackwardMap, outputs[i], outputDiff[i]);
+            partOutputs.emplace_back(outputs[i]);
+        }
+    }
+    auto partParameters = parameters;
+    for (auto& input : checkpoint->inputValues) {
+        partParameters.insert(input);
+    }
+    auto partGrads = _gradCommon(partOutputs, partParameters, partBackwardMap, blockName);
+    // Run the recomputed part and its backward now, only the grads are kept
+    std::vector<VARP> grads;
+    for (auto& iter : partGrads) {
+        grads.emplace_back(iter.second);
+    }
+    if (!_computeToConst(grads)) {
+        return;
+    }
+    for (int i = 0; i < checkpoint->inputs.size(); ++i) {
+        auto iter = partGrads.find(checkpoint->inputValues[i]);
+        if (iter != partGrads.end() && nullptr != iter->second) {
+            _addBackward(backwardMap, checkpoint->inputs[i], iter->second);
+        }
+    }
+    for (auto& iter : partGrads) {
+        if (parameters.find(iter.first) != parameters.end() && nullptr != iter.second) {
+            _addBackward(backwardMap, iter.first, iter.second);
+        }
+    }
+    checkpoint->inputs.clear();
+    checkpoint->inputValues.clear();
+    checkpoint->recompute = nullptr;
+}
+
 std::map<Express::VARP, Express::VARP> OpGrad::gradCommon(Express::VARP loss, const std::set<Express::VARP>& parameters, std::map<EXPRP, std::vector<VARP>>& backwardMap, const std::vector<std::string> blockName) {
-    auto executeOrder = Variable::getExecuteOrder({loss});
-    for (auto iter = executeOrder.rbegin(); iter != executeOrder.rend(); iter++) {
-        auto expr    = *iter;
+    return _gradCommon({loss}, parameters, backwardMap, blockName);
+}
+
+static std::map<Express::VARP, Express::VARP> _gradCommon(const std::vector<VARP>& outputs, const std::set<Express::VARP>& parameters, std::map<EXPRP, std::vector<VARP>>& backwardMap, const std::vector<std::string>& blockName) {
+    std::set<Expr*> parameterExprs;
+    for (auto p : parameters) {
+        parameterExprs.insert(p->expr().first.get());
+    }
+    std::map<Expr*, std::shared_ptr<OpGrad::Checkpoint>> checkpoints;
+    auto executeOrder = _getExecuteOrder(outputs, parameterExprs, checkpoints);
+    std::map<OpGrad::Checkpoint*, int> checkpointRemain;
+    for (auto& iter : checkpoints) {
+        checkpointRemain[iter.second.get()]++;
+    }
+    std::map<Expr*, int> exprIndex;
+    for (int i = 0; i < executeOrder.size(); ++i) {
+        exprIndex[executeOrder[i].get()] = i;
+    }
+    for (int exprPos = (int)executeOrder.size() - 1; exprPos >= 0; --exprPos) {
+        auto expr    = executeOrder[exprPos];
         auto& inputs = expr->inputs();
+        auto checkpointIter = checkpoints.find(expr.get());
+        if (checkpointIter != checkpoints.end()) {
+            // All the outputs of the checkpoint have complete grads after the last one is visited
+            auto checkpoint = checkpointIter->second.get();
+            if (--checkpointRemain[checkpoint] > 0) {
+                continue;
+            }
+            // Compute the backward after the checkpoint before recomputing it, including the pending grads of
+            // the exprs before it and the parameters, which share the graph with the grads of the checkpoint
+            std::vector<VARP> pending;
+            for (auto& backward : backwardMap) {
+                auto isOutput = std::find_if(checkpoint->outputs.begin(), checkpoint->outputs.end(), [&](const WeakEXPRP& output) {
+                    return output.lock() == backward.first;
+                }) != checkpoint->outputs.end();
+                auto index = exprIndex.find(backward.first.get());
+                if (isOutput || parameterExprs.find(backward.first.get()) != parameterExprs.end() ||
+                    (index != exprIndex.end() && index->second < exprPos)) {
+                    pending.insert(pending.end(), backward.second.begin(), backward.second.end());
+                }
+            }
+            if (!_computeToConst(pending)) {
+                return {};
+            }
+            _gradCheckpoint(checkpoint, parameters, backwardMap, blockName);
+            continue;
+        }
         if (backwardMap.find(expr) == backwardMap.end()) {
             continue;
         }
@@ -112,21 +333,10 @@ std::map<Express::VARP, Express::VARP> OpGrad::gradCommon(Express::VARP loss, co
 #endif
         MNN_ASSERT(inputGrad.size() <= inputs.size());
         for (int i = 0; i < inputGrad.size(); ++i) {
-            auto inputExpr = inputs[i]->expr().first;
-            auto index     = inputs[i]->expr().second;
-            auto backward  = inputGrad[i];
-            if (nullptr == backward) {
+            if (nullptr == inputGrad[i]) {
                 continue;
             }
-            if (backwardMap.find(inputExpr) == backwardMap.end()) {
-                backwardMap.insert(std::make_pair(inputExpr, std::vector<VARP>(inputExpr->outputSize())));
-            }
-            auto& inputVarMap = backwardMap[inputExpr];
-            if (nullptr == inputVarMap[index]) {
-                inputVarMap[index] = backward;
-            } else {
-                inputVarMap[index] = _Add(inputVarMap[index], backward);
-            }
+            _addBackward(backwardMap, inputs[i], inputGrad[i]);
         }
     }
     std::map<Express::VARP, Express::VARP> grads;
@@ -11,7 +11,9 @@
 #include <MNN/expr/Expr.hpp>
 #include <MNN/expr/ExprCreator.hpp>
 #include <MNN/expr/Optimizer.hpp>
+#include <functional>
 #include <map>
+#include <memory>
 #include <vector>
 #include "MNN_generated.h"
 
@@ -36,6 +38,20 @@ public:
     static std::map<Express::VARP, Express::VARP> gradCommon(Express::VARP loss, const std::set<Express::VARP>& parameters, std::map<Express::EXPRP, std::vector<Express::VARP>>& backwardMap, const std::vector<std::string> blockExpr = {});
     static std::map<Express::VARP, Express::VARP> grad(Express::VARP loss, const std::set<Express::VARP>& parameters, const std::vector<std::string> blockExpr = {});
 
+    // A part of the graph whose intermediate tensors are not kept for backward, see NN::Checkpoint. Its outputs
+    // are constants, the grads of them are computed by recomputing the part from the inputs when they are ready
+    struct Checkpoint {
+        // The inputs in the graph, which receive the grads
+        std::vector<Express::VARP> inputs;
+        // Constant copies of the inputs
+        std::vector<Express::VARP> inputValues;
+        // The constant outputs
+        std::vector<Express::WeakEXPRP> outputs;
+        // Build the outputs again from the inputValues. The inputs and the function are released after the backward
+        std::function<std::vector<Express::VARP>(const std::vector<Express::VARP>&)> recompute;
+    };
+    static void addCheckpoint(std::shared_ptr<Checkpoint> checkpoint);
+
 protected:
     Type mType = LINEAR;
 };
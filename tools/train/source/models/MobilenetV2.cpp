@@ -111,7 +111,7 @@ std::vector<Express::VARP> _BottleNeck::onForward(const std::vector<Express::VAR
     return {x};
 }
 
-MobilenetV2::MobilenetV2(int numClasses, float widthMult, int divisor) {
+MobilenetV2::MobilenetV2(int numClasses, float widthMult, int divisor, bool checkpoint) {
     int inputChannels = 32;
     int lastChannels  = 1280;
 
@@ -144,7 +144,11 @@ MobilenetV2::MobilenetV2(int numClasses, float widthMult, int divisor) {
                 stride = s;
             }
 
-            bottleNeckBlocks.emplace_back(BottleNeck({inputChannels, outputChannels}, stride, t));
+            auto block = BottleNeck({inputChannels, outputChannels}, stride, t);
+            if (checkpoint) {
+                block.reset(NN::Checkpoint(block));
+            }
+            bottleNeckBlocks.emplace_back(block);
             inputChannels = outputChannels;
         }
     }
@@ -15,6 +15,7 @@
 #include "Initializer.hpp"
 #include "MNN_generated.h"
 #include "RandomGenerator.hpp"
+#include "OpGrad.hpp"
 #include "core/Macro.h"
 #include "math/WingoradGenerater.hpp"
 #include "common/WinogradInt8Attr.hpp"
@@ -246,6 +247,96 @@ private:
     std::vector<int> mReductionDims;
 };
 
+class CheckpointModule : public Module {
+public:
+    CheckpointModule(std::shared_ptr<Module> module) {
+        mModule = module;
+        registerModel({module});
+        setType("Checkpoint");
+    }
+
+    virtual std::vector<Express::VARP> onForward(const std::vector<Express::VARP>& inputs) override {
+        if (!getIsTraining()) {
+            return mModule->onForward(inputs);
+        }
+        std::shared_ptr<OpGrad::Checkpoint> checkpoint(new OpGrad::Checkpoint);
+        checkpoint->inputs = inputs;
+        // Only the copies of the inputs are kept, constant inputs such as the outputs of another checkpoint are shared
+        std::vector<VARP> computeVars;
+        for (auto& input : inputs) {
+            auto expr = input->expr().first;
+            if (nullptr == expr->get() && VARP::CONSTANT == expr->inputType()) {
+                checkpoint->inputValues.emplace_back(input);
+                continue;
+            }
+            auto info = input->getInfo();
+            auto ptr  = input->readMap<void>();
+            if (nullptr == info || nullptr == ptr) {
+                MNN_ERROR("Compute input error for checkpoint\n");
+                return {};
+            }
+            checkpoint->inputValues.emplace_back(_Const(ptr, info->dim, info->order, info->type));
+        }
+        auto random  = RandomGenerator::generator();
+        auto outputs = mModule->onForward(checkpoint->inputValues);
+        // Compute the outputs and the states updated by the forward, such as the running mean of batchnorm, then
+        // the intermediate tensors are released with the graph
+        for (auto& p : mModule->parameters()) {
+            if (nullptr != p.get() && nullptr != p->expr().first->get()) {
+                computeVars.emplace_back(p);
+            }
+        }
+        computeVars.insert(computeVars.end(), outputs.begin(), outputs.end());
+        Variable::prepareCompute(computeVars);
+        std::vector<VARP> constVars(computeVars.size());
+        for (int i = 0; i < computeVars.size(); ++i) {
+            auto info = computeVars[i]->getInfo();
+            auto ptr  = computeVars[i]->readMap<void>();
+            if (nullptr == info || nullptr == ptr) {
+                MNN_ERROR("Compute error for checkpoint\n");
+                return {};
+            }
+            constVars[i] = _Const(ptr, info->dim, info->order, info->type);
+        }
+        const int parameterSize = (int)computeVars.size() - (int)outputs.size();
+        for (int i = 0; i < parameterSize; ++i) {
+            Variable::replace(computeVars[i], constVars[i]);
+        }
+        std::vector<VARP> results(constVars.begin() + parameterSize, constVars.end());
+        for (int i = 0; i < results.size(); ++i) {
+            results[i]->setName(outputs[i]->name());
+            checkpoint->outputs.emplace_back(results[i]->expr().first);
+        }
+        auto module = mModule;
+        checkpoint->recompute = [module, random](const std::vector<VARP>& inputs) {
+            // Use the same random numbers as the first forward, and keep the states updated by it
+            auto parameters = module->parameters();
+            auto& generator = RandomGenerator::generator();
+            auto current    = generator;
+            generator       = random;
+            auto outputs    = module->onForward(inputs);
+            generator       = current;
+            if (!parameters.empty()) {
+                module->loadParameters(parameters);
+            }
+            return outputs;
+        };
+        OpGrad::addCheckpoint(checkpoint);
+        return results;
+    }
+
+private:
+    Module* clone(CloneContext* ctx) const override {
+        std::shared_ptr<Module> module(mModule->clone(ctx));
+        if (nullptr == module) {
+            return nullptr;
+        }
+        return this->cloneBaseTo(ctx, new CheckpointModule(module));
+    }
+
+    std::shared_ptr<Module> mModule;
+};
+
 void NN::ConvOption::reset(int size) {
     stride     = std::vector<int>(size, 1);
     channel    = std::vector<int>(size, 0);
@@ -418,6 +509,10 @@ Module* NN::BatchNorm(const int channels, const int dims, const float m, const f
     return new BatchNormModule(channels, dims, m, e);
 }
 
+Module* NN::Checkpoint(std::shared_ptr<Module> module) {
+    return new CheckpointModule(module);
+}
+
 NN::ConvParameters NN::Utils::ExtractConvolution(EXPRP source) {
     ConvParameters _default;
     if (source->get() == nullptr) {
@@ -56,6 +56,12 @@ public:
     static Module* Dropout(const float dropRatio);
     static Module* BatchNorm(const int channels, const int dims = 4, const float m = 0.999,
                                              const float e = 1e-5);
+    /* Gradient checkpointing: in training the module keeps only its inputs and outputs, the intermediate tensors
+       are released after forward and recomputed from the inputs when building the gradient, so that the activation
+       memory is traded for compute. The module must produce the same outputs for the same inputs, random numbers
+       are restored for the recompute.
+     */
+    static Module* Checkpoint(std::shared_ptr<Module> module);
 
     static Module* ConvInt8(const ConvOption& option, int bits = 8, bool bias = true,
                                             std::shared_ptr<Initializer> weightInit = nullptr,
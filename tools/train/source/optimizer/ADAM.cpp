@@ -6,6 +6,7 @@
 //  Copyright © 2018, Alibaba Group Holding Limited
 //
 
+#include <cmath>
 #include "ADAM.hpp"
 #include "OpGrad.hpp"
 
@@ -59,5 +60,30 @@ Express::VARP ADAM::onComputeUpdateValue(Express::VARP param, Express::VARP grad
     return updateValue;
 }
 
+void ADAM::onFusedUpdate(const std::vector<FusedTensor>& tensors) {
+    auto coefficients = regularizeCoefficients();
+    const float l1    = coefficients.first;
+    const float l2    = coefficients.second;
+    const float beta1 = mMomentum;
+    const float beta2 = mMomentum2;
+    const float eps   = mEps;
+    const float step  = (float)currentStep();
+    const float correction = std::sqrt(1.0f - std::pow(beta2, step)) / (1.0f - std::pow(beta1, step));
+    const float scale = mLearningRate * correction;
+    for (auto& t : tensors) {
+        auto m     = mHistory[t.param]->writeMap<float>();
+        auto v     = mHistory2[t.param]->writeMap<float>();
+        auto param = t.paramPtr;
+        auto grad  = t.gradPtr;
+        for (int i = 0; i < t.size; ++i) {
+            auto p   = param[i];
+            auto g   = grad[i] + l1 * (float)((p > 0.0f) - (p < 0.0f)) + l2 * p;
+            m[i]     = beta1 * m[i] + (1.0f - beta1) * g;
+            v[i]     = beta2 * v[i] + (1.0f - beta2) * g * g;
+            param[i] = p - scale * (m[i] / (std::sqrt(v[i]) + eps));
+        }
+    }
+}
+
 } // namespace Train
 } // namespace MNN
@@ -33,6 +33,9 @@ public:
 
     void setEps(float eps);
 
+protected:
+    virtual void onFusedUpdate(const std::vector<FusedTensor>& tensors) override;
+
 private:
     float mMomentum2 = 0.999; // default 0.999
     float mEps       = 1e-8;
@@ -52,9 +52,16 @@ bool ParameterOptimizer::step(Express::VARP loss) {
     mStep++;
     auto res = this->onGetNextParameter(loss);
     for (auto iter : res) {
+        // Updated in place by the optimizer
+        if (iter.first.get() == iter.second.get()) {
+            continue;
+        }
         iter.second.fix(Express::VARP::TRAINABLE);
     }
     for (auto iter : res) {
+        if (iter.first.get() == iter.second.get()) {
+            continue;
+        }
         iter.first->input(iter.second);
     }
     return !res.empty();
@@ -51,6 +51,14 @@ SGD::RegularizationMethod SGD::getRegularizationMethod() {
     return mRegularizationMethod;
 }
 
+void SGD::setFusedUpdate(bool fused) {
+    mFusedUpdate = fused;
+}
+
+bool SGD::getFusedUpdate() {
+    return mFusedUpdate;
+}
+
 Express::VARP SGD::regularizeParameters(Express::VARP param, Express::VARP grad) {
     VARP addWeightDecayGrad;
     if (mRegularizationMethod == L1) {
@@ -68,6 +76,40 @@ Express::VARP SGD::regularizeParameters(Express::VARP param, Express::VARP grad)
     return addWeightDecayGrad;
 }
 
+std::pair<float, float> SGD::regularizeCoefficients() {
+    switch (mRegularizationMethod) {
+        case L1:
+            return std::make_pair(mWeightDecay, 0.0f);
+        case L2:
+            return std::make_pair(0.0f, mWeightDecay);
+        case L1L2:
+            return std::make_pair(mWeightDecay, mWeightDecay);
+        default:
+            break;
+    }
+    return std::make_pair(0.0f, 0.0f);
+}
+
+void SGD::onFusedUpdate(const std::vector<FusedTensor>& tensors) {
+    auto coefficients    = regularizeCoefficients();
+    const float l1       = coefficients.first;
+    const float l2       = coefficients.second;
+    const float lr       = mLearningRate;
+    const float momentum = mMomentum;
+    for (auto& t : tensors) {
+        auto history = mHistory[t.param]->writeMap<float>();
+        auto param   = t.paramPtr;
+        auto grad    = t.gradPtr;
+        for (int i = 0; i < t.size; ++i) {
+            auto p     = param[i];
+            auto g     = grad[i] + l1 * (float)((p > 0.0f) - (p < 0.0f)) + l2 * p;
+            auto h     = lr * (g + momentum * history[i]);
+            history[i] = h;
+            param[i]   = p - h;
+        }
+    }
+}
+
 Express::VARP SGD::onComputeUpdateValue(Express::VARP param, Express::VARP grad) {
     auto lr         = _Const(mLearningRate, {}, NCHW);
     mHistory[param] = lr * (grad + _Const(mMomentum, {}, NCHW) * mHistory[param]);
@@ -104,6 +146,40 @@ std::map<Express::VARP, Express::VARP> SGD::onGetNextParameter(Express::VARP los
         Variable::replace(prepareCompute[i], replaceOp[i]);
     }
 
+    if (mFusedUpdate) {
+        std::vector<FusedTensor> tensors;
+        for (auto& iter : grad) {
+            auto paramInfo = iter.first->getInfo();
+            auto gradInfo  = iter.second->getInfo();
+            if (nullptr == paramInfo || nullptr == gradInfo || paramInfo->type != halide_type_of<float>() ||
+                gradInfo->type != halide_type_of<float>() || paramInfo->size != gradInfo->size) {
+                break;
+            }
+            FusedTensor t;
+            t.param    = iter.first;
+            t.paramPtr = nullptr;
+            t.gradPtr  = iter.second->readMap<float>();
+            t.size     = (int)paramInfo->size;
+            tensors.emplace_back(t);
+        }
+        if (tensors.size() == grad.size()) {
+            // Map the parameters for write after all the grads are read, which marks the ops using them dirty
+            for (auto& t : tensors) {
+                t.paramPtr = t.param->writeMap<float>();
+                if (nullptr == t.paramPtr) {
+                    MNN_ERROR("Can't update parameter in place in SGD\n");
+                    return {};
+                }
+            }
+            this->onFusedUpdate(tensors);
+            // The parameters are updated in place, ParameterOptimizer::step skips them
+            for (auto& iter : grad) {
+                iter.second = iter.first;
+            }
+            return grad;
+        }
+    }
+
     for (auto& iter : grad) {
         // apply regularization
         auto addWeightDecayGrad = regularizeParameters(iter.first, iter.second);
@@ -47,11 +47,31 @@ public:
         mGradBlockExprName = block;
     }
 
+    // Update the parameters and the optimizer states in place by one pass over their buffers, instead of
+    // building express ops for every parameter. Only float parameters are supported, otherwise it falls back
+    void setFusedUpdate(bool fused);
+
+    bool getFusedUpdate();
+
 protected:
+    struct FusedTensor {
+        Express::VARP param;
+        float* paramPtr;
+        const float* gradPtr;
+        int size;
+    };
+    // Apply the regularization and the update to all the tensors
+    virtual void onFusedUpdate(const std::vector<FusedTensor>& tensors);
+
+    // Return the coefficients of sign(param) and param added to grad by the regularization
+    std::pair<float, float> regularizeCoefficients();
+
+
     float mLearningRate                        = 0.001f;
     float mMomentum                            = 0;
     float mWeightDecay                         = 0;
     RegularizationMethod mRegularizationMethod = L2;
+    bool mFusedUpdate                          = false;
     std::map<MNN::Express::VARP, MNN::Express::VARP> mHistory;
 
     // For Cache